@@ -50,6 +50,10 @@
 
 #include "printing/wizard/printwizard.h"
 
+#include "odt_export/sheetbatchexport.h"
+#include "utils/files/openfileinfolder.h"
+#include <QProgressDialog>
+
 #ifdef ENABLE_USER_QUERY
 #    include "sqlconsole/sqlconsole.h"
 #endif
@@ -224,6 +228,7 @@ void MainWindow::setup_actions()
 
     databaseActionGroup->addAction(ui->actionExport_PDF);
     databaseActionGroup->addAction(ui->actionExport_Svg);
+    databaseActionGroup->addAction(ui->actionExport_All_Sheets);
 
     databaseActionGroup->addAction(ui->actionPrev_Job_Segment);
     databaseActionGroup->addAction(ui->actionNext_Job_Segment);
@@ -237,6 +242,7 @@ void MainWindow::setup_actions()
     connect(ui->actionPrint, &QAction::triggered, this, &MainWindow::onPrint);
     connect(ui->actionExport_PDF, &QAction::triggered, this, &MainWindow::onPrintPDF);
     connect(ui->actionExport_Svg, &QAction::triggered, this, &MainWindow::onExportSvg);
+    connect(ui->actionExport_All_Sheets, &QAction::triggered, this, &MainWindow::onExportAllSheets);
     connect(ui->actionProperties, &QAction::triggered, this, &MainWindow::onProperties);
 
     connect(ui->actionStations, &QAction::triggered, this, &MainWindow::onStationManager);
@@ -913,6 +919,81 @@ void MainWindow::onExportSvg()
     wizard->exec();
 }
 
+void MainWindow::onExportAllSheets()
+{
+    const QLatin1String all_sheets_key = QLatin1String("all_sheets_dir");
+
+    QString folder = QFileDialog::getExistingDirectory(
+      this, tr("Export All Sheets"),
+      RecentDirStore::getDir(all_sheets_key, RecentDirStore::Documents));
+    if (folder.isEmpty())
+        return;
+
+    RecentDirStore::setPath(all_sheets_key, folder);
+
+    OwningQPointer<QMessageBox> msgBox = new QMessageBox(this);
+    msgBox->setIcon(QMessageBox::Question);
+    msgBox->setWindowTitle(tr("Export All Sheets"));
+    msgBox->setText(tr("Choose sheet format.<br>"
+                       "Only sheets changed since last export to this folder will be written."));
+    QPushButton *odtBut = msgBox->addButton(tr("ODT"), QMessageBox::AcceptRole);
+    QPushButton *pdfBut = msgBox->addButton(tr("PDF"), QMessageBox::AcceptRole);
+    msgBox->addButton(QMessageBox::Cancel);
+    msgBox->setDefaultButton(odtBut);
+    msgBox->exec();
+    if (!msgBox)
+        return;
+
+    QAbstractButton *clicked = msgBox->clickedButton();
+    if (clicked != odtBut && clicked != pdfBut)
+        return;
+
+    OwningQPointer<QProgressDialog> progressDlg = new QProgressDialog(this);
+    progressDlg->setWindowModality(Qt::WindowModal);
+    progressDlg->setLabelText(tr("Exporting sheets..."));
+    progressDlg->setMinimumDuration(500);
+
+    SheetBatchExport exporter(Session->m_Db, folder, clicked == pdfBut);
+    const bool completed =
+      exporter.exportSheets(SheetBatchExport::AllSheets,
+                            [&progressDlg](int done, int total) -> bool
+                            {
+                                if (!progressDlg || progressDlg->wasCanceled())
+                                    return false;
+                                progressDlg->setMaximum(total);
+                                progressDlg->setValue(done);
+                                return true;
+                            });
+
+    if (progressDlg)
+        progressDlg->reset();
+
+    if (!completed && !exporter.wasCanceled() && exporter.getFailedCount() == 0)
+    {
+        // Nothing was exported
+        QMessageBox::warning(this, tr("Export Error"),
+                             tr("Could not create folder <b>%1</b>").arg(folder));
+        return;
+    }
+
+    QString msg = tr("Sheets written: %1, unchanged: %2, removed: %3<br>")
+                    .arg(exporter.getGeneratedCount())
+                    .arg(exporter.getSkippedCount())
+                    .arg(exporter.getRemovedCount());
+    if (exporter.getFailedCount() > 0)
+        msg += tr("<b>%1 sheets could not be written.</b><br>").arg(exporter.getFailedCount());
+    if (exporter.wasCanceled())
+        msg += tr("<b>Export was canceled.</b><br>");
+
+    OwningQPointer<utils::OpenFileInFolderDlg> dlg = new utils::OpenFileInFolderDlg(this);
+    dlg->setWindowTitle(completed ? tr("Sheets Exported") : tr("Sheets Export Incomplete"));
+    dlg->setFilePath(folder);
+    dlg->setLabelText(msg
+                      + tr("Do you want to open folder?<br><b>%1</b>")
+                          .arg(dlg->getInfo().canonicalFilePath()));
+    dlg->exec();
+}
+
 #ifdef ENABLE_USER_QUERY
 void MainWindow::onExecQuery()
 {
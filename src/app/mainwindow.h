@@ -82,6 +82,7 @@ private slots:
     void onPrint();
     void onPrintPDF();
     void onExportSvg();
+    void onExportAllSheets();
 
 #ifdef ENABLE_USER_QUERY
     void onExecQuery();
@@ -27,6 +27,8 @@
 
 #include "viewmanager/viewmanager.h"
 #include "db_metadata/metadatamanager.h"
+#include "stations/railwaytopology.h"
+#include "utils/delegates/sql/completionindex.h"
 
 #ifdef ENABLE_BACKGROUND_MANAGER
 #    include "backgroundmanager/backgroundmanager.h"
@@ -52,6 +54,7 @@ MeetingSession::MeetingSession() :
     jobLineWidth(6),
 
     m_Db(nullptr),
+    fullTextIndex(false),
     sheetExportTranslator(nullptr)
 {
     session = this; // Global singleton pointer
@@ -70,6 +73,10 @@ MeetingSession::MeetingSession() :
 
     metaDataMgr.reset(new MetaDataManager(m_Db));
 
+    railwayTopology.reset(new RailwayTopology(m_Db));
+
+    completionIndex.reset(new CompletionIndex(m_Db));
+
 #ifdef ENABLE_BACKGROUND_MANAGER
     backgroundManager.reset(new BackgroundManager);
 #endif
@@ -128,6 +135,14 @@ DB_Error MeetingSession::openDB(const QString &str, bool ignoreVersion)
     m_Db.enable_foreign_keys(true);
     m_Db.enable_extended_result_codes(true);
 
+    if (!createExtraTables())
+        qWarning() << "DB: could not create extra tables" << m_Db.error_msg();
+
+    // Job editor backups left by older versions would prevent removing their jobs and stations
+    // Old coupling rows are deleted by FK: ON DELETE CASCADE
+    if (m_Db.execute("DELETE FROM old_stops") != SQLITE_OK)
+        qWarning() << "DB: could not clear old_stops" << m_Db.error_msg();
+
     //    }catch(const char *msg)
     //    {
     //        QMessageBox::warning(nullptr,
@@ -206,6 +221,9 @@ DB_Error MeetingSession::closeDB()
     backgroundManager->clearResults();
 #endif
 
+    railwayTopology->invalidate();
+    completionIndex->invalidate();
+
     fileName.clear();
 
     return DB_Error::NoError;
@@ -435,9 +453,9 @@ DB_Error MeetingSession::createNewDB(const QString &file)
                           "UNIQUE(stop_id,rs_id))");
     CHECK(result);
 
-    // Create also backup tables to save old stops and couplings before editing a job and restore
-    // them if user cancels the edits. NOTE: the structure of the table must be the same, remember
-    // to update theese if updating stops or couplings
+    // NOTE: old_stops and old_coupling are not used anymore, job editor keeps its backup
+    // in memory. They are still created so files can be opened by older versions.
+    // Leftover rows are cleared in openDB()
 
     result = m_Db.execute(
       "CREATE TABLE old_stops ("
@@ -525,6 +543,9 @@ DB_Error MeetingSession::createNewDB(const QString &file)
                           "val BLOB)");
     CHECK(result);
 
+    result = createExtraTables() ? SQLITE_OK : SQLITE_ERROR;
+    CHECK(result);
+
     // Triggers
 
     // Prevent multiple segments on same station gate
@@ -633,6 +654,371 @@ DB_Error MeetingSession::createNewDB(const QString &file)
     return DB_Error::NoError;
 }
 
+/* Fill job_summary rows of jobs returned by %1 subquery (with a job_id column)
+ * First and last stop are found with UNIQUE(job_id,arrival) index.
+ * Jobs without stops get no row
+ */
+static QByteArray jobSummaryInsertSql(const char *jobsSubQuery)
+{
+    QByteArray sql = "INSERT INTO job_summary(job_id,first_stop_id,first_station_id,first_arrival,"
+                     "first_departure,last_stop_id,last_station_id,last_arrival,last_departure,"
+                     "stop_count,initial_axes)"
+                     " SELECT j.job_id,f.id,f.station_id,f.arrival,f.departure,"
+                     "l.id,l.station_id,l.arrival,l.departure,"
+                     "(SELECT COUNT(1) FROM stops WHERE job_id=j.job_id),"
+                     "(SELECT IFNULL(SUM(rs_models.axes),0) FROM coupling"
+                     " JOIN rs_list ON rs_list.id=coupling.rs_id"
+                     " JOIN rs_models ON rs_models.id=rs_list.model_id"
+                     " WHERE coupling.stop_id=f.id AND coupling.operation=1)"
+                     " FROM %1 AS j"
+                     " JOIN stops f ON f.id=(SELECT id FROM stops"
+                     " WHERE job_id=j.job_id ORDER BY arrival LIMIT 1)"
+                     " JOIN stops l ON l.id=(SELECT id FROM stops"
+                     " WHERE job_id=j.job_id ORDER BY arrival DESC LIMIT 1);";
+    sql.replace("%1", jobsSubQuery);
+    return sql;
+}
+
+// Recalculate job_summary row of a single job, used by triggers with NEW.job_id or OLD.job_id
+static QByteArray jobSummaryRecalcSql(const char *jobIdExpr)
+{
+    QByteArray sql = "DELETE FROM job_summary WHERE job_id=%1;";
+    sql += jobSummaryInsertSql("(SELECT %1 AS job_id)");
+    sql.replace("%1", jobIdExpr);
+    return sql;
+}
+
+// Recalculate axes of rollingstock coupled at first stop of jobs matching %1 condition
+static QByteArray jobSummaryAxesSql(const char *whereExpr)
+{
+    QByteArray sql = "UPDATE job_summary SET initial_axes="
+                     "(SELECT IFNULL(SUM(rs_models.axes),0) FROM coupling"
+                     " JOIN rs_list ON rs_list.id=coupling.rs_id"
+                     " JOIN rs_models ON rs_models.id=rs_list.model_id"
+                     " WHERE coupling.stop_id=job_summary.first_stop_id AND coupling.operation=1)"
+                     " WHERE %1;";
+    sql.replace("%1", whereExpr);
+    return sql;
+}
+
+/* bool MeetingSession::createJobSummaryTable()
+ * job_summary stores first and last stop of each job so job lists do not need
+ * to aggregate the stops table on every query.
+ * It is kept updated by triggers on stops, coupling and rollingstock.
+ * When the table is missing it is created and filled with current jobs.
+ */
+bool MeetingSession::createJobSummaryTable()
+{
+    query q(m_Db, "SELECT 1 FROM sqlite_master WHERE type='table' AND name='job_summary'");
+    if (q.step() == SQLITE_ROW)
+        return true; // Already created
+    q.reset();
+
+    sqlite3pp::transaction t(m_Db);
+
+    int result = m_Db.execute("CREATE TABLE job_summary ("
+                              "job_id INTEGER PRIMARY KEY,"
+                              "first_stop_id INTEGER,"
+                              "first_station_id INTEGER,"
+                              "first_arrival INTEGER,"
+                              "first_departure INTEGER,"
+                              "last_stop_id INTEGER,"
+                              "last_station_id INTEGER,"
+                              "last_arrival INTEGER,"
+                              "last_departure INTEGER,"
+                              "stop_count INTEGER NOT NULL DEFAULT 0,"
+                              "initial_axes INTEGER NOT NULL DEFAULT 0)");
+
+    if (result == SQLITE_OK)
+        result = m_Db.execute("CREATE INDEX job_summary_first_stop_idx"
+                              " ON job_summary(first_stop_id)");
+
+    // Stops
+    QByteArray sql;
+    if (result == SQLITE_OK)
+    {
+        sql = "CREATE TRIGGER job_summary_stop_insert AFTER INSERT ON stops\n"
+              "BEGIN\n";
+        sql += jobSummaryRecalcSql("NEW.job_id");
+        sql += "END";
+        result = m_Db.execute(sql.constData());
+    }
+
+    if (result == SQLITE_OK)
+    {
+        sql = "CREATE TRIGGER job_summary_stop_delete AFTER DELETE ON stops\n"
+              "BEGIN\n";
+        sql += jobSummaryRecalcSql("OLD.job_id");
+        sql += "END";
+        result = m_Db.execute(sql.constData());
+    }
+
+    if (result == SQLITE_OK)
+    {
+        // When job ID changes also old job row must be updated
+        sql = "CREATE TRIGGER job_summary_stop_update"
+              " AFTER UPDATE OF job_id,station_id,arrival,departure ON stops\n"
+              "BEGIN\n";
+        sql += jobSummaryRecalcSql("OLD.job_id");
+        sql += jobSummaryRecalcSql("NEW.job_id");
+        sql += "END";
+        result = m_Db.execute(sql.constData());
+    }
+
+    // Coupling, only operations at first stop are relevant
+    if (result == SQLITE_OK)
+    {
+        sql = "CREATE TRIGGER job_summary_coupling_insert AFTER INSERT ON coupling\n"
+              "BEGIN\n";
+        sql += jobSummaryAxesSql("first_stop_id=NEW.stop_id");
+        sql += "END";
+        result = m_Db.execute(sql.constData());
+    }
+
+    if (result == SQLITE_OK)
+    {
+        sql = "CREATE TRIGGER job_summary_coupling_delete AFTER DELETE ON coupling\n"
+              "BEGIN\n";
+        sql += jobSummaryAxesSql("first_stop_id=OLD.stop_id");
+        sql += "END";
+        result = m_Db.execute(sql.constData());
+    }
+
+    if (result == SQLITE_OK)
+    {
+        sql = "CREATE TRIGGER job_summary_coupling_update AFTER UPDATE ON coupling\n"
+              "BEGIN\n";
+        sql += jobSummaryAxesSql("first_stop_id IN (OLD.stop_id,NEW.stop_id)");
+        sql += "END";
+        result = m_Db.execute(sql.constData());
+    }
+
+    // Rollingstock axes
+    if (result == SQLITE_OK)
+    {
+        sql = "CREATE TRIGGER job_summary_rs_model_update AFTER UPDATE OF model_id ON rs_list\n"
+              "BEGIN\n";
+        sql += jobSummaryAxesSql("first_stop_id IN (SELECT stop_id FROM coupling"
+                                 " WHERE rs_id=NEW.id AND operation=1)");
+        sql += "END";
+        result = m_Db.execute(sql.constData());
+    }
+
+    if (result == SQLITE_OK)
+    {
+        sql = "CREATE TRIGGER job_summary_model_axes_update AFTER UPDATE OF axes ON rs_models\n"
+              "BEGIN\n";
+        sql += jobSummaryAxesSql("first_stop_id IN (SELECT coupling.stop_id FROM coupling"
+                                 " JOIN rs_list ON rs_list.id=coupling.rs_id"
+                                 " WHERE rs_list.model_id=NEW.id AND coupling.operation=1)");
+        sql += "END";
+        result = m_Db.execute(sql.constData());
+    }
+
+    // Fill with existing jobs
+    if (result == SQLITE_OK)
+    {
+        sql    = jobSummaryInsertSql("(SELECT DISTINCT job_id FROM stops)");
+        result = m_Db.execute(sql.constData());
+    }
+
+    if (result != SQLITE_OK)
+    {
+        qWarning() << "DB: cannot create job_summary" << m_Db.error_msg();
+        t.rollback();
+        return false;
+    }
+
+    t.commit();
+    return true;
+}
+
+// Tables indexed by full-text search, columns are separated by comma
+struct FullTextTable
+{
+    const char *table;
+    const char *columns;
+};
+
+static const FullTextTable fullTextTables[] = {
+  {"stations", "name,short_name"},
+  {"rs_models", "name,suffix"},
+  {"rs_owners", "name"},
+  {"rs_list", "number"},
+  {"jobs", "id"}};
+
+// Returns "NEW.col1,NEW.col2" from "col1,col2"
+static QByteArray fullTextColumnValues(const char *prefix, const char *columns)
+{
+    QByteArray sql;
+    const QList<QByteArray> cols = QByteArray(columns).split(',');
+    for (const QByteArray &col : cols)
+    {
+        if (!sql.isEmpty())
+            sql += ',';
+        sql += prefix;
+        sql += col;
+    }
+    return sql;
+}
+
+static QByteArray fullTextDeleteSql(const FullTextTable &info)
+{
+    QByteArray sql = "INSERT INTO %1_fts(%1_fts,rowid,%2) VALUES('delete',OLD.id,";
+    sql += fullTextColumnValues("OLD.", info.columns);
+    sql += ");\n";
+    return sql;
+}
+
+static QByteArray fullTextInsertSql(const FullTextTable &info)
+{
+    QByteArray sql = "INSERT INTO %1_fts(rowid,%2) VALUES(NEW.id,";
+    sql += fullTextColumnValues("NEW.", info.columns);
+    sql += ");\n";
+    return sql;
+}
+
+/* bool MeetingSession::createFullTextIndex()
+ * Names of stations, rollingstock models and owners and numbers of rollingstock
+ * and jobs are indexed in FTS5 trigram tables so filters with leading wildcard
+ * LIKE patterns do not need to scan the whole table.
+ * Index tables use original tables as external content and are kept updated by triggers.
+ * If SQLite is built without FTS5 or trigram tokenizer filters use plain LIKE.
+ */
+bool MeetingSession::createFullTextIndex()
+{
+    fullTextIndex = false;
+
+    // Check FTS5 trigram tokenizer is available
+    int result =
+      m_Db.execute("CREATE VIRTUAL TABLE temp.fts_probe USING fts5(x, tokenize='trigram')");
+    if (result == SQLITE_OK)
+        result = m_Db.execute("DROP TABLE temp.fts_probe");
+
+    if (result != SQLITE_OK)
+    {
+        qWarning() << "DB: full-text index not available" << m_Db.error_msg();
+
+        // Triggers would fail without FTS5 module, remove them so tables can still be edited
+        // Index will be rebuilt when opening file again with FTS5 support
+        for (const FullTextTable &info : fullTextTables)
+        {
+            for (const char *op : {"insert", "delete", "update"})
+            {
+                QByteArray sql = "DROP TRIGGER IF EXISTS %1_fts_%2";
+                sql.replace("%1", info.table);
+                sql.replace("%2", op);
+                m_Db.execute(sql.constData());
+            }
+        }
+        return true;
+    }
+
+    query q_triggerExists(m_Db, "SELECT 1 FROM sqlite_master WHERE type='trigger' AND name=?");
+
+    sqlite3pp::transaction t(m_Db);
+
+    for (const FullTextTable &info : fullTextTables)
+    {
+        const QByteArray triggerName = QByteArray(info.table) + "_fts_insert";
+        q_triggerExists.bind(1, triggerName, sqlite3pp::copy);
+        const bool exists = q_triggerExists.step() == SQLITE_ROW;
+        q_triggerExists.reset();
+        if (exists)
+            continue; // Already created and updated
+
+        QByteArray sql = "CREATE VIRTUAL TABLE IF NOT EXISTS %1_fts USING fts5("
+                         "%2,content='%1',content_rowid='id',tokenize='trigram')";
+        sql.replace("%2", info.columns);
+        sql.replace("%1", info.table);
+        result = m_Db.execute(sql.constData());
+
+        if (result == SQLITE_OK)
+        {
+            sql = "CREATE TRIGGER %1_fts_insert AFTER INSERT ON %1\n"
+                  "BEGIN\n";
+            sql += fullTextInsertSql(info);
+            sql += "END";
+            sql.replace("%2", info.columns);
+            sql.replace("%1", info.table);
+            result = m_Db.execute(sql.constData());
+        }
+
+        if (result == SQLITE_OK)
+        {
+            sql = "CREATE TRIGGER %1_fts_delete AFTER DELETE ON %1\n"
+                  "BEGIN\n";
+            sql += fullTextDeleteSql(info);
+            sql += "END";
+            sql.replace("%2", info.columns);
+            sql.replace("%1", info.table);
+            result = m_Db.execute(sql.constData());
+        }
+
+        if (result == SQLITE_OK)
+        {
+            // Row ID changes must also update the index
+            QByteArray updateCols = info.columns;
+            if (!updateCols.split(',').contains("id"))
+                updateCols.prepend("id,");
+
+            sql = "CREATE TRIGGER %1_fts_update AFTER UPDATE OF %3 ON %1\n"
+                  "BEGIN\n";
+            sql += fullTextDeleteSql(info);
+            sql += fullTextInsertSql(info);
+            sql += "END";
+            sql.replace("%3", updateCols);
+            sql.replace("%2", info.columns);
+            sql.replace("%1", info.table);
+            result = m_Db.execute(sql.constData());
+        }
+
+        // Index may be out of date if triggers were removed, rebuild it from content table
+        if (result == SQLITE_OK)
+        {
+            sql = "INSERT INTO %1_fts(%1_fts) VALUES('rebuild')";
+            sql.replace("%1", info.table);
+            result = m_Db.execute(sql.constData());
+        }
+
+        if (result != SQLITE_OK)
+        {
+            qWarning() << "DB: cannot create full-text index" << info.table << m_Db.error_msg();
+            t.rollback();
+            return false;
+        }
+    }
+
+    t.commit();
+    fullTextIndex = true;
+    return true;
+}
+
+bool MeetingSession::createExtraTables()
+{
+    int result = m_Db.execute("CREATE TABLE IF NOT EXISTS consist_templates ("
+                              "id INTEGER PRIMARY KEY,"
+                              "name TEXT NOT NULL UNIQUE)");
+    if (result != SQLITE_OK)
+        return false;
+
+    result = m_Db.execute(
+      "CREATE TABLE IF NOT EXISTS consist_template_items ("
+      "template_id INTEGER NOT NULL,"
+      "rs_id INTEGER NOT NULL,"
+      "pos INTEGER NOT NULL,"
+      "PRIMARY KEY(template_id,rs_id),"
+      "FOREIGN KEY(template_id) REFERENCES consist_templates(id) ON DELETE CASCADE,"
+      "FOREIGN KEY(rs_id) REFERENCES rs_list(id) ON UPDATE CASCADE ON DELETE CASCADE)");
+    if (result != SQLITE_OK)
+        return false;
+
+    if (!createJobSummaryTable())
+        return false;
+
+    return createFullTextIndex();
+}
+
 /* bool MeetingSession::checkImportRSTablesEmpty()
  * Check if import_rs_list, import_rs_models, import_rs_owners tables are empty
  * Theese tables are used during RS importation and are cleared when the process
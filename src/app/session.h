@@ -35,6 +35,8 @@ using namespace sqlite3pp;
 
 class ViewManager;
 class MetaDataManager;
+class RailwayTopology;
+class CompletionIndex;
 
 #ifdef ENABLE_BACKGROUND_MANAGER
 class BackgroundManager;
@@ -82,6 +84,16 @@ public:
         return metaDataMgr.get();
     }
 
+    inline RailwayTopology *getRailwayTopology()
+    {
+        return railwayTopology.get();
+    }
+
+    inline CompletionIndex *getCompletionIndex()
+    {
+        return completionIndex.get();
+    }
+
 #ifdef ENABLE_BACKGROUND_MANAGER
     BackgroundManager *getBackgroundManager() const;
 #endif
@@ -99,13 +111,16 @@ signals:
     void rollingstockRemoved(db_id rsId);
     void rollingStockPlanChanged(QSet<db_id> rsIds);
     void rollingStockModified(db_id rsId);
+    void rollingstockModelsChanged(); // Models added, removed or renamed
+    void rollingstockOwnersChanged(); // Owners added, removed or renamed
 
     // Jobs
-    void jobAdded(db_id jobId);
-    void jobChanged(db_id jobId, db_id oldJobId); // Updated id/category/stops
+    void jobAdded(db_id jobId); // 0 for many jobs
+    void jobChanged(db_id jobId, db_id oldJobId); // Updated id/category/stops, 0 for many jobs
     void jobRemoved(db_id jobId);
 
     // Stations
+    void stationAdded(db_id stationId);
     void stationNameChanged(db_id stationId);
     void stationJobsPlanChanged(const QSet<db_id> &stationIds);
     void stationTrackPlanChanged(const QSet<db_id> &stationIds);
@@ -128,6 +143,10 @@ private:
 
     std::unique_ptr<MetaDataManager> metaDataMgr;
 
+    std::unique_ptr<RailwayTopology> railwayTopology;
+
+    std::unique_ptr<CompletionIndex> completionIndex;
+
 #ifdef ENABLE_BACKGROUND_MANAGER
     std::unique_ptr<BackgroundManager> backgroundManager;
 #endif
@@ -179,8 +198,22 @@ public:
     bool checkImportRSTablesEmpty();
     bool clearImportRSTables();
 
+    // True if FTS5 trigram tables can be used to filter by name
+    inline bool hasFullTextIndex() const
+    {
+        return fullTextIndex;
+    }
+
     QString fileName;
 
+private:
+    // Tables added without a format version change, created also on older files
+    bool createExtraTables();
+    bool createJobSummaryTable();
+    bool createFullTextIndex();
+
+    bool fullTextIndex;
+
     // AppData
 public:
     static void locateAppdata();
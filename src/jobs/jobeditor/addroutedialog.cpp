@@ -0,0 +1,143 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "addroutedialog.h"
+
+#include "model/stopmodel.h"
+
+#include "app/session.h"
+
+#include "stations/match_models/stationsmatchmodel.h"
+#include "utils/delegates/sql/customcompletionlineedit.h"
+
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QListWidget>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QDialogButtonBox>
+
+#include <QMessageBox>
+
+AddRouteDialog::AddRouteDialog(StopModel *m, QWidget *parent) :
+    QDialog(parent),
+    stopModel(m)
+{
+    QFormLayout *lay                = new QFormLayout(this);
+
+    StationsMatchModel *originMatch = new StationsMatchModel(Session->m_Db, this);
+    StationsMatchModel *viaMatch    = new StationsMatchModel(Session->m_Db, this);
+    StationsMatchModel *destMatch   = new StationsMatchModel(Session->m_Db, this);
+    originMatch->setFilter(0);
+    viaMatch->setFilter(0);
+    destMatch->setFilter(0);
+
+    // Origin is needed only if job has no stops yet, otherwise route starts from last stop
+    const bool hasStops = stopModel->rowCount() > 1;
+    originEdit          = new CustomCompletionLineEdit(originMatch);
+    if (hasStops)
+    {
+        const StopItem last = stopModel->getItemAt(stopModel->rowCount() - 2);
+        originEdit->setData(last.stationId);
+        originEdit->setEnabled(false);
+    }
+    lay->addRow(tr("From:"), originEdit);
+
+    viaEdit                = new CustomCompletionLineEdit(viaMatch);
+    QPushButton *addBut    = new QPushButton(tr("Add"));
+    QPushButton *removeBut = new QPushButton(tr("Remove"));
+    QHBoxLayout *viaLay    = new QHBoxLayout;
+    viaLay->addWidget(viaEdit);
+    viaLay->addWidget(addBut);
+    viaLay->addWidget(removeBut);
+    lay->addRow(tr("Via:"), viaLay);
+
+    viaList = new QListWidget;
+    lay->addRow(viaList);
+
+    destEdit = new CustomCompletionLineEdit(destMatch);
+    lay->addRow(tr("To:"), destEdit);
+
+    runningTimeCheck = new QCheckBox(tr("Fastest route"));
+    runningTimeCheck->setToolTip(tr("Minimize running time at segment speed instead of distance"));
+    lay->addRow(runningTimeCheck);
+
+    QDialogButtonBox *box = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    lay->addRow(box);
+
+    connect(addBut, &QPushButton::clicked, this, &AddRouteDialog::addViaStation);
+    connect(removeBut, &QPushButton::clicked, this, &AddRouteDialog::removeViaStation);
+    connect(box, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(box, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    setMinimumSize(300, 250);
+    setWindowTitle(tr("Add Route"));
+}
+
+void AddRouteDialog::done(int ret)
+{
+    if (ret == QDialog::Accepted)
+    {
+        db_id originId = 0;
+        db_id destId   = 0;
+        QString name;
+        originEdit->getData(originId, name);
+        destEdit->getData(destId, name);
+
+        if (!originId || !destId)
+        {
+            QMessageBox::warning(this, tr("Add Route"),
+                                 tr("Please set origin and destination stations."));
+            return;
+        }
+
+        QVector<db_id> viaStations;
+        viaStations.reserve(viaList->count());
+        for (int i = 0; i < viaList->count(); i++)
+            viaStations.append(viaList->item(i)->data(Qt::UserRole).toLongLong());
+
+        QString errMsg;
+        if (!stopModel->addRoute(originId, viaStations, destId, runningTimeCheck->isChecked(),
+                                 &errMsg))
+        {
+            QMessageBox::warning(this, tr("Add Route"), errMsg);
+            return; // Give user a chance to change stations
+        }
+    }
+
+    QDialog::done(ret);
+}
+
+void AddRouteDialog::addViaStation()
+{
+    db_id stationId = 0;
+    QString name;
+    if (!viaEdit->getData(stationId, name))
+        return;
+
+    QListWidgetItem *item = new QListWidgetItem(name, viaList);
+    item->setData(Qt::UserRole, stationId);
+
+    viaEdit->setData(0);
+}
+
+void AddRouteDialog::removeViaStation()
+{
+    delete viaList->currentItem();
+}
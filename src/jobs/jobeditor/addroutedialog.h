@@ -0,0 +1,62 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ADDROUTEDIALOG_H
+#define ADDROUTEDIALOG_H
+
+#include <QDialog>
+
+#include "utils/types.h"
+
+class QListWidget;
+class QCheckBox;
+class CustomCompletionLineEdit;
+class StopModel;
+
+/*!
+ * \brief The AddRouteDialog class
+ *
+ * Let user choose destination and optional via stations.
+ * Shortest route is then appended to job stops.
+ *
+ * \sa StopModel::addRoute()
+ */
+class AddRouteDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit AddRouteDialog(StopModel *m, QWidget *parent = nullptr);
+
+    void done(int ret) override;
+
+private slots:
+    void addViaStation();
+    void removeViaStation();
+
+private:
+    StopModel *stopModel;
+
+    CustomCompletionLineEdit *originEdit;
+    CustomCompletionLineEdit *viaEdit;
+    CustomCompletionLineEdit *destEdit;
+    QListWidget *viaList;
+    QCheckBox *runningTimeCheck;
+};
+
+#endif // ADDROUTEDIALOG_H
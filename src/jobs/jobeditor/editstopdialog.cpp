@@ -36,6 +36,8 @@
 #include "jobs/jobsmanager/model/jobshelper.h"
 #include "jobs/jobsmanager/model/jobmatchmodel.h"
 
+#include "rollingstock/consisttemplatehelper.h"
+
 #include "utils/delegates/sql/modelpageswitcher.h"
 #include "utils/delegates/sql/customcompletionlineedit.h"
 #include "utils/delegates/sql/chooseitemdlg.h"
@@ -44,6 +46,7 @@
 
 #include "utils/owningqpointer.h"
 #include <QMenu>
+#include <QInputDialog>
 #include <QMessageBox>
 
 #include "app/scopedebug.h"
@@ -90,6 +93,8 @@ EditStopDialog::EditStopDialog(StopModel *m, QWidget *parent) :
     connect(ui->importJobRsBut, &QPushButton::clicked, this, &EditStopDialog::importJobRS);
     connect(ui->editCoupledBut, &QPushButton::clicked, this, &EditStopDialog::editCoupled);
     connect(ui->editUncoupledBut, &QPushButton::clicked, this, &EditStopDialog::editUncoupled);
+    connect(ui->consistTemplateBut, &QPushButton::clicked, this,
+            &EditStopDialog::showConsistTemplateMenu);
 
     ui->coupledView->setContextMenuPolicy(Qt::CustomContextMenu);
     ui->uncoupledView->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -222,6 +227,9 @@ void EditStopDialog::setStop(const QModelIndex &idx)
     // Calc passings
     calcPassings();
 
+    // Compare later to detect changes in coupled rollingstock
+    originalSpeedAfterStop = getTrainSpeedKmH(true);
+
     // Update Title
     const QString jobName = JobCategoryName::jobName(m_jobId, m_jobCat);
     setWindowTitle(jobName);
@@ -286,6 +294,9 @@ void EditStopDialog::saveDataToModel()
     const StopItem &curStop  = helper->getCurItem();
     const StopItem &prevStop = helper->getPrevItem();
 
+    // Description and stop info are undone together
+    EditStepScope editStep(stopModel);
+
     if (ui->descriptionEdit->document()->isModified())
     {
         stopModel->setDescription(stopIdx, ui->descriptionEdit->toPlainText());
@@ -379,6 +390,32 @@ void EditStopDialog::editUncoupled()
     trainAssetModelAfter->refreshData(true);
 }
 
+void EditStopDialog::showConsistTemplateMenu()
+{
+    OwningQPointer<QMenu> menu = new QMenu(this);
+    QAction *applyAct          = menu->addAction(tr("Couple Template..."));
+    QAction *saveAct           = menu->addAction(tr("Save Coupled As Template..."));
+    menu->addSeparator();
+    QAction *removeAct = menu->addAction(tr("Remove Template..."));
+
+    applyAct->setEnabled(!readOnly);
+    saveAct->setEnabled(!readOnly);
+    removeAct->setEnabled(!readOnly);
+
+    QAction *act = menu->exec(ui->consistTemplateBut->mapToGlobal(
+      QPoint(0, ui->consistTemplateBut->height())));
+
+    if (!act)
+        return;
+
+    if (act == saveAct)
+        saveConsistTemplate();
+    else if (act == applyAct)
+        applyConsistTemplate(false);
+    else if (act == removeAct)
+        applyConsistTemplate(true);
+}
+
 bool EditStopDialog::hasEngineAfterStop()
 {
     DEBUG_ENTRY;
@@ -464,6 +501,89 @@ void EditStopDialog::couplingCustomContextMenuRequested(const QPoint &pos)
     trainAssetModelAfter->refreshData(true);
 }
 
+void EditStopDialog::saveConsistTemplate()
+{
+    bool ok      = false;
+    QString name = QInputDialog::getText(this, tr("Save Consist Template"), tr("Template name:"),
+                                         QLineEdit::Normal, QString(), &ok);
+    if (!ok)
+        return;
+
+    ConsistTemplateHelper templHelper(Session->m_Db);
+
+    bool replace = false;
+    if (templHelper.templateExists(name))
+    {
+        int ret = QMessageBox::question(
+          this, tr("Save Consist Template"),
+          tr("A template named <b>%1</b> already exists.<br>"
+             "Do you want to replace it?")
+            .arg(name.simplified()));
+        if (ret != QMessageBox::Yes)
+            return;
+        replace = true;
+    }
+
+    QString errMsg;
+    if (!templHelper.saveFromStop(helper->getCurItem().stopId, name, replace, &errMsg))
+    {
+        QMessageBox::warning(this, tr("Save Consist Template"), errMsg);
+        return;
+    }
+}
+
+void EditStopDialog::applyConsistTemplate(bool remove)
+{
+    ConsistTemplateHelper templHelper(Session->m_Db);
+    const auto templates = templHelper.getTemplates();
+    if (templates.isEmpty())
+    {
+        QMessageBox::information(this, tr("Consist Templates"),
+                                 tr("There are no consist templates in this session.<br>"
+                                    "Use <b>Save Coupled As Template</b> to create one."));
+        return;
+    }
+
+    QStringList names;
+    names.reserve(templates.size());
+    for (const auto &templ : templates)
+        names.append(tr("%1 (%2 items)").arg(templ.name).arg(templ.itemCount));
+
+    bool ok              = false;
+    const QString choice =
+      QInputDialog::getItem(this, remove ? tr("Remove Consist Template") : tr("Couple Template"),
+                            tr("Template:"), names, 0, false, &ok);
+    if (!ok)
+        return;
+
+    const auto &templ = templates.at(names.indexOf(choice));
+
+    if (remove)
+    {
+        templHelper.removeTemplate(templ.templateId);
+        return;
+    }
+
+    const QVector<db_id> rsIds = templHelper.getTemplateItems(templ.templateId);
+
+    coupledModel->clearCache();
+    trainAssetModelAfter->clearCache();
+
+    // Availability of all items is checked at once
+    int count = couplingMgr->coupleRSBatch(rsIds, true);
+
+    coupledModel->refreshData(true);
+    trainAssetModelAfter->refreshData(true);
+
+    if (count < rsIds.size())
+    {
+        QMessageBox::information(this, tr("Couple Template"),
+                                 tr("<b>%1</b> of <b>%2</b> rollingstock items were coupled.")
+                                   .arg(count)
+                                   .arg(rsIds.size()));
+    }
+}
+
 int EditStopDialog::getTrainSpeedKmH(bool afterStop)
 {
     const StopItem &curStop = helper->getCurItem();
@@ -568,6 +688,8 @@ void EditStopDialog::done(int val)
 {
     if (val == QDialog::Accepted)
     {
+        bool rebaseTimes = false;
+
         if (stopIdx.row() < stopModel->rowCount() - 2)
         {
             // We are not last stop
@@ -597,27 +719,10 @@ void EditStopDialog::done(int val)
                 }
             }
 
-#ifdef ENABLE_AUTO_TIME_RECALC
+            const int newSpeedAfterStop = getTrainSpeedKmH(true);
             if (originalSpeedAfterStop != newSpeedAfterStop)
             {
-                int speedBefore        = originalSpeedAfterStop;
-                int speedAfter         = newSpeedAfterStop;
-
-                LinesModel *linesModel = stopModel->getLinesModel();
-                db_id lineId  = curLine ? curLine : stopIdx.data(NEXT_LINE_ROLE).toLongLong();
-                int lineSpeed = linesModel->getLineSpeed(lineId);
-                if (speedBefore == 0)
-                {
-                    // If speed is null (likely because there weren't RS coupled before)
-                    // Fall back to line max speed
-                    speedBefore = lineSpeed;
-                }
-                if (speedAfter == 0)
-                {
-                    // If speed is null (likely because there isn't RS coupled after this stop)
-                    // Fall back to line max speed
-                    speedAfter = lineSpeed;
-                }
+                // Zero speed means no rollingstock coupled, segment max speed is used instead
                 int ret = QMessageBox::question(
                   this, tr("Train Speed Changed"),
                   tr("Train speed after this stop has changed from a value of %1 km/h to <b>%2 "
@@ -625,8 +730,8 @@ void EditStopDialog::done(int val)
                      "Do you want to rebase travel times to this new speed?<br>"
                      "NOTE: this doesn't affect stop times but you will lose manual adjustments to "
                      "travel times")
-                    .arg(speedBefore)
-                    .arg(speedAfter),
+                    .arg(originalSpeedAfterStop)
+                    .arg(newSpeedAfterStop),
                   QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel, QMessageBox::Yes);
 
                 if (ret == QMessageBox::Cancel)
@@ -634,16 +739,17 @@ void EditStopDialog::done(int val)
                     return; // Second chance to edit couplings
                 }
 
-                if (ret == QMessageBox::Yes)
-                {
-                    stopModel->rebaseTimesToSpeed(stopIdx.row(), ui->arrivalTimeEdit->time(),
-                                                  ui->departureTimeEdit->time());
-                }
+                rebaseTimes = ret == QMessageBox::Yes;
             }
-#endif
         }
 
+        // Stop changes and new travel times are undone together
+        EditStepScope editStep(stopModel);
+
         saveDataToModel();
+
+        if (rebaseTimes)
+            stopModel->rebaseTimesToSpeed(stopIdx.row());
     }
 
     QDialog::done(val);
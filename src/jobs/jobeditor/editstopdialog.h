@@ -64,6 +64,7 @@ private slots:
     void importJobRS();
     void editCoupled();
     void editUncoupled();
+    void showConsistTemplateMenu();
 
     void calcPassings();
 
@@ -79,6 +80,9 @@ private:
 
     int getTrainSpeedKmH(bool afterStop);
 
+    void saveConsistTemplate();
+    void applyConsistTemplate(bool remove);
+
 private:
     Ui::EditStopDialog *ui;
 
@@ -102,6 +106,8 @@ private:
     JobPassingsModel *crossingsModel;
 
     bool readOnly;
+
+    int originalSpeedAfterStop = 0;
 };
 
 #endif // EDITSTOPDIALOG2_H
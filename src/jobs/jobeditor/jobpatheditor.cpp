@@ -32,6 +32,7 @@
 #include "model/nextprevrsjobsmodel.h"
 
 #include "jobs/jobeditor/editstopdialog.h"
+#include "jobs/jobeditor/addroutedialog.h"
 
 #include "utils/jobcategorystrings.h"
 
@@ -41,7 +42,7 @@
 #include "odt_export/jobsheetexport.h"
 #include "utils/files/openfileinfolder.h"
 
-#include "utils/files/file_format_names.h"
+#include "odt_export/common/sheetfiledialog.h"
 
 #include "utils/delegates/sql/customcompletionlineedit.h"
 #include "shifts/shiftcombomodel.h"
@@ -49,10 +50,9 @@
 #include "utils/owningqpointer.h"
 #include <QMenu>
 #include <QMessageBox>
-#include <QFileDialog>
-#include "utils/files/recentdirstore.h"
 
 #include <QCloseEvent>
+#include <QShortcut>
 
 JobPathEditor::JobPathEditor(QWidget *parent) :
     QDialog(parent),
@@ -127,6 +127,14 @@ JobPathEditor::JobPathEditor(QWidget *parent) :
             &JobPathEditor::showStopsContextMenu);
     connect(ui->stopsView, &QListView::clicked, this, &JobPathEditor::onStopIndexClicked);
 
+    QShortcut *undoShortcut = new QShortcut(QKeySequence::Undo, ui->stopsView);
+    undoShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(undoShortcut, &QShortcut::activated, this, &JobPathEditor::undoStopsEdit);
+
+    QShortcut *redoShortcut = new QShortcut(QKeySequence::Redo, ui->stopsView);
+    redoShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(redoShortcut, &QShortcut::activated, this, &JobPathEditor::redoStopsEdit);
+
     ui->prevJobsView->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(ui->prevJobsView, &QListView::customContextMenuRequested, this,
             &JobPathEditor::showJobContextMenu);
@@ -281,9 +289,22 @@ bool JobPathEditor::createNewJob(db_id *out)
 void JobPathEditor::showStopsContextMenu(const QPoint &pos)
 {
     QModelIndex index = ui->stopsView->indexAt(pos);
-    if (!index.isValid() || index.row() >= stopModel->rowCount() || stopModel->isAddHere(index))
+    if (!index.isValid() || index.row() >= stopModel->rowCount())
         return;
 
+    if (stopModel->isAddHere(index))
+    {
+        // Allow adding a whole route also to jobs without stops
+        if (m_readOnly)
+            return;
+
+        OwningQPointer<QMenu> menu = new QMenu(this);
+        QAction *addRouteAct       = menu->addAction(tr("Add Route..."));
+        if (menu->exec(ui->stopsView->viewport()->mapToGlobal(pos)) == addRouteAct)
+            addRoute();
+        return;
+    }
+
     OwningQPointer<QMenu> menu = new QMenu(this);
     QAction *toggleTransitAct  = menu->addAction(tr("Toggle transit"));
     QAction *setToTransitAct   = menu->addAction(tr("Set transit"));
@@ -293,17 +314,45 @@ void JobPathEditor::showStopsContextMenu(const QPoint &pos)
     QAction *showStationSVG = menu->addAction(tr("Station SVG Plan"));
     menu->insertSeparator(editStopAct);
     QAction *removeStopAct = menu->addAction(tr("Remove"));
+    QAction *addRouteAct   = menu->addAction(tr("Add Route..."));
+    QAction *undoAct       = menu->addAction(tr("Undo"));
+    QAction *redoAct       = menu->addAction(tr("Redo"));
+    menu->insertSeparator(undoAct);
+
+    undoAct->setShortcut(QKeySequence::Undo);
+    redoAct->setShortcut(QKeySequence::Redo);
+    undoAct->setEnabled(!m_readOnly && stopModel->canUndo());
+    redoAct->setEnabled(!m_readOnly && stopModel->canRedo());
 
     toggleTransitAct->setEnabled(!m_readOnly);
     setToTransitAct->setEnabled(!m_readOnly);
     unsetTransit->setEnabled(!m_readOnly);
     removeStopAct->setEnabled(!m_readOnly);
+    addRouteAct->setEnabled(!m_readOnly);
 
     const StopItem stop = stopModel->getItemAt(index.row());
     showStationSVG->setEnabled(stop.stationId != 0); // Enable only if station is set
 
     QAction *act            = menu->exec(ui->stopsView->viewport()->mapToGlobal(pos));
 
+    if (act == undoAct)
+    {
+        undoStopsEdit();
+        return;
+    }
+
+    if (act == redoAct)
+    {
+        redoStopsEdit();
+        return;
+    }
+
+    if (act == addRouteAct)
+    {
+        addRoute();
+        return;
+    }
+
     QItemSelectionModel *sm = ui->stopsView->selectionModel();
 
     QItemSelectionRange range;
@@ -363,6 +412,33 @@ void JobPathEditor::showStopsContextMenu(const QPoint &pos)
     }
 }
 
+void JobPathEditor::undoStopsEdit()
+{
+    if (m_readOnly)
+        return;
+
+    stopModel->undo();
+}
+
+void JobPathEditor::redoStopsEdit()
+{
+    if (m_readOnly)
+        return;
+
+    stopModel->redo();
+}
+
+void JobPathEditor::addRoute()
+{
+    if (m_readOnly)
+        return;
+
+    closeStopEditor();
+
+    OwningQPointer<AddRouteDialog> dlg = new AddRouteDialog(stopModel, this);
+    dlg->exec();
+}
+
 void JobPathEditor::showJobContextMenu(const QPoint &pos)
 {
     QTableView *jobView           = qobject_cast<QTableView *>(sender());
@@ -715,29 +791,21 @@ void JobPathEditor::onSaveSheet()
 {
     const QLatin1String job_sheet_key = QLatin1String("job_sheet_dir");
 
-    OwningQPointer<QFileDialog> dlg   = new QFileDialog(this, tr("Save Job Sheet"));
-    dlg->setFileMode(QFileDialog::AnyFile);
-    dlg->setAcceptMode(QFileDialog::AcceptSave);
-    dlg->setDirectory(RecentDirStore::getDir(job_sheet_key, RecentDirStore::Documents));
-    dlg->selectFile(tr("job%1_sheet.odt").arg(stopModel->getJobId()));
-
-    QStringList filters;
-    filters << FileFormats::tr(FileFormats::odtFormat);
-    dlg->setNameFilters(filters);
-
-    if (dlg->exec() != QDialog::Accepted || !dlg)
-        return;
-
-    QString fileName = dlg->selectedUrls().value(0).toLocalFile();
-
+    bool asPdf                        = false;
+    QString fileName                  = SheetFileDialog::getSaveFileName(
+      this, tr("Save Job Sheet"), job_sheet_key, tr("job%1_sheet.odt").arg(stopModel->getJobId()),
+      asPdf);
     if (fileName.isEmpty())
         return;
 
-    RecentDirStore::setPath(job_sheet_key, fileName);
-
     JobSheetExport sheet(stopModel->getJobId(), stopModel->getCategory());
     sheet.write();
-    sheet.save(fileName);
+    const bool ok = asPdf ? sheet.savePdf(fileName) : sheet.save(fileName);
+    if (!ok)
+    {
+        SheetFileDialog::showSaveError(this, fileName);
+        return;
+    }
 
     utils::OpenFileInFolderDlg::askUser(tr("Job Sheet Saved"), fileName, this);
 }
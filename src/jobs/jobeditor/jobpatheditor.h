@@ -89,6 +89,9 @@ private slots:
 
     void showJobContextMenu(const QPoint &pos);
     void showStopsContextMenu(const QPoint &pos);
+    void undoStopsEdit();
+    void redoStopsEdit();
+    void addRoute();
 
     void onStopIndexClicked(const QModelIndex &index);
 
@@ -0,0 +1,340 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "jobconflictpreview.h"
+
+#include "stopmodel.h"
+
+#include "utils/jobcategorystrings.h"
+#include "utils/rs_utils.h"
+
+#include <sqlite3pp/sqlite3pp.h>
+using namespace sqlite3pp;
+
+static inline bool timesOverlap(const QTime &from, const QTime &to, const QTime &otherFrom,
+                                const QTime &otherTo)
+{
+    return from <= otherTo && to >= otherFrom;
+}
+
+JobConflictPreview::JobConflictPreview(database &db) :
+    mDb(db),
+    m_jobId(0)
+{
+}
+
+void JobConflictPreview::clearCache()
+{
+    m_tracks.clear();
+    m_segConns.clear();
+    m_rollingstock.clear();
+    m_rsNames.clear();
+}
+
+void JobConflictPreview::evaluate(db_id jobId, const QList<StopItem> &stops,
+                                  ConflictMap &outConflicts)
+{
+    outConflicts.clear();
+
+    if (jobId != m_jobId)
+    {
+        // Cached lists exclude previous job, reload them
+        clearCache();
+        m_jobId = jobId;
+    }
+
+    if (!m_jobId)
+        return;
+
+    // Index of stops by ID to find coupling stops
+    QHash<db_id, int> stopRows;
+    stopRows.reserve(stops.size());
+
+    for (int i = 0; i < stops.size(); i++)
+    {
+        const StopItem &s = stops.at(i);
+        if (s.addHere != 0 || !s.stopId)
+            continue;
+
+        stopRows.insert(s.stopId, i);
+
+        // Station track
+        if (s.trackId)
+        {
+            for (const Occupancy &occ : getTrackOccupancy(s.trackId))
+            {
+                if (!timesOverlap(s.arrival, s.departure, occ.from, occ.to))
+                    continue;
+
+                Conflict c;
+                c.type          = TrackOccupied;
+                c.otherJobId    = occ.jobId;
+                c.otherCategory = occ.category;
+                c.otherFrom     = occ.from;
+                c.otherTo       = occ.to;
+                outConflicts[s.stopId].append(c);
+            }
+        }
+
+        // Next segment, travel ends at next stop arrival
+        if (!s.nextSegment.segConnId || i + 1 >= stops.size() || stops.at(i + 1).addHere != 0)
+            continue;
+
+        const QTime &dep = s.departure;
+        const QTime &arr = stops.at(i + 1).arrival;
+
+        for (const Occupancy &occ : getSegmentOccupancy(s.nextSegment.segConnId))
+        {
+            if (!timesOverlap(dep, arr, occ.from, occ.to))
+                continue;
+
+            const bool passing = occ.gateId == s.toGate.gateId;
+            if (passing)
+            {
+                // Same direction, one travel must be contained in the other
+                if (dep < occ.from && arr < occ.to)
+                    continue; // Travels before other job
+                if (dep > occ.from && arr > occ.to)
+                    continue; // Travels after other job
+            }
+
+            Conflict c;
+            c.type          = passing ? SegmentPassing : SegmentCrossing;
+            c.otherJobId    = occ.jobId;
+            c.otherCategory = occ.category;
+            c.otherFrom     = occ.from;
+            c.otherTo       = occ.to;
+            outConflicts[s.stopId].append(c);
+        }
+    }
+
+    // Rollingstock, couplings of edited job change often so they are not cached
+    query q_getCouplings(mDb, "SELECT coupling.rs_id, coupling.stop_id, coupling.operation"
+                              " FROM coupling"
+                              " JOIN stops ON stops.id=coupling.stop_id"
+                              " WHERE stops.job_id=? ORDER BY stops.arrival");
+    q_getCouplings.bind(1, m_jobId);
+
+    // Key: rs ID, Value: coupling stop row
+    QHash<db_id, int> coupledRs;
+
+    auto checkRs = [this, &stops, &outConflicts](db_id rsId, int fromRow, const QTime &to)
+    {
+        const StopItem &s = stops.at(fromRow);
+        for (const Occupancy &occ : getRsOccupancy(rsId))
+        {
+            // Other job can couple rollingstock in same minute it gets uncoupled
+            if (s.arrival >= occ.to || to <= occ.from)
+                continue;
+
+            Conflict c;
+            c.type          = RsBusy;
+            c.otherJobId    = occ.jobId;
+            c.otherCategory = occ.category;
+            c.rsId          = rsId;
+            c.otherFrom     = occ.from;
+            c.otherTo       = occ.to;
+            outConflicts[s.stopId].append(c);
+        }
+    };
+
+    for (auto coup : q_getCouplings)
+    {
+        db_id rsId   = coup.get<db_id>(0);
+        db_id stopId = coup.get<db_id>(1);
+        RsOp op      = RsOp(coup.get<int>(2));
+
+        auto stopIt  = stopRows.constFind(stopId);
+        if (stopIt == stopRows.constEnd())
+            continue;
+
+        if (op == RsOp::Coupled)
+        {
+            coupledRs.insert(rsId, stopIt.value());
+            continue;
+        }
+
+        auto it = coupledRs.find(rsId);
+        if (it == coupledRs.end())
+            continue; // Uncoupled when not coupled, left to RsErrWorker
+
+        checkRs(rsId, it.value(), stops.at(stopIt.value()).departure);
+        coupledRs.erase(it);
+    }
+
+    // Not uncoupled, consider busy until end of day
+    for (auto it = coupledRs.constBegin(); it != coupledRs.constEnd(); it++)
+    {
+        checkRs(it.key(), it.value(), QTime(23, 59));
+    }
+}
+
+QString JobConflictPreview::getConflictText(const Conflict &c) const
+{
+    const QString jobName = JobCategoryName::jobName(c.otherJobId, c.otherCategory);
+    const QString from    = c.otherFrom.toString("HH:mm");
+    const QString to      = c.otherTo.toString("HH:mm");
+
+    switch (c.type)
+    {
+    case TrackOccupied:
+        return tr("Station track used by %1 (%2 - %3)").arg(jobName, from, to);
+    case SegmentCrossing:
+        return tr("Crossing %1 on next segment (%2 - %3)").arg(jobName, from, to);
+    case SegmentPassing:
+        return tr("Passing %1 on next segment (%2 - %3)").arg(jobName, from, to);
+    case RsBusy:
+    {
+        auto it = m_rsNames.constFind(c.rsId);
+        const QString rsName = it == m_rsNames.constEnd() ? QString() : it.value();
+        return tr("%1 is coupled to %2 (%3 - %4)").arg(rsName, jobName, from, to);
+    }
+    }
+
+    return QString();
+}
+
+const JobConflictPreview::OccupancyList &JobConflictPreview::getTrackOccupancy(db_id trackId)
+{
+    auto it = m_tracks.constFind(trackId);
+    if (it != m_tracks.constEnd())
+        return it.value();
+
+    OccupancyList list;
+
+    // First stop has no in gate connection, use out gate connection
+    query q(mDb, "SELECT s.job_id, jobs.category, s.arrival, s.departure"
+                 " FROM stops s"
+                 " JOIN jobs ON jobs.id=s.job_id"
+                 " JOIN station_gate_connections g ON g.id=IFNULL(s.in_gate_conn,s.out_gate_conn)"
+                 " WHERE g.track_id=?1 AND s.job_id<>?2");
+    q.bind(1, trackId);
+    q.bind(2, m_jobId);
+
+    for (auto r : q)
+    {
+        Occupancy occ;
+        occ.jobId    = r.get<db_id>(0);
+        occ.category = JobCategory(r.get<int>(1));
+        occ.from     = r.get<QTime>(2);
+        occ.to       = r.get<QTime>(3);
+        list.append(occ);
+    }
+
+    return m_tracks.insert(trackId, list).value();
+}
+
+const JobConflictPreview::OccupancyList &JobConflictPreview::getSegmentOccupancy(db_id segConnId)
+{
+    auto it = m_segConns.constFind(segConnId);
+    if (it != m_segConns.constEnd())
+        return it.value();
+
+    OccupancyList list;
+
+    query q(mDb, "SELECT s.job_id, jobs.category, s.departure, MIN(s_next.arrival), g.gate_id"
+                 " FROM stops s"
+                 " JOIN stops s_next ON s_next.job_id=s.job_id AND s_next.arrival>s.arrival"
+                 " JOIN jobs ON jobs.id=s.job_id"
+                 " JOIN station_gate_connections g ON g.id=s.out_gate_conn"
+                 " WHERE s.next_segment_conn_id=?1 AND s.job_id<>?2"
+                 " GROUP BY s.id");
+    q.bind(1, segConnId);
+    q.bind(2, m_jobId);
+
+    for (auto r : q)
+    {
+        Occupancy occ;
+        occ.jobId    = r.get<db_id>(0);
+        occ.category = JobCategory(r.get<int>(1));
+        occ.from     = r.get<QTime>(2);
+        occ.to       = r.get<QTime>(3);
+        occ.gateId   = r.get<db_id>(4);
+        list.append(occ);
+    }
+
+    return m_segConns.insert(segConnId, list).value();
+}
+
+const JobConflictPreview::OccupancyList &JobConflictPreview::getRsOccupancy(db_id rsId)
+{
+    auto it = m_rollingstock.constFind(rsId);
+    if (it != m_rollingstock.constEnd())
+        return it.value();
+
+    query q(mDb, "SELECT rs_list.number,rs_models.name,rs_models.suffix,rs_models.type"
+                 " FROM rs_list"
+                 " LEFT JOIN rs_models ON rs_models.id=rs_list.model_id"
+                 " WHERE rs_list.id=?");
+    q.bind(1, rsId);
+    if (q.step() == SQLITE_ROW)
+    {
+        auto r = q.getRows();
+        m_rsNames.insert(rsId, rs_utils::formatName(r.get<QString>(1), r.get<int>(0),
+                                                    r.get<QString>(2), RsType(r.get<int>(3))));
+    }
+
+    OccupancyList list;
+    Occupancy coupled;
+
+    q.prepare("SELECT stops.job_id, jobs.category, stops.arrival, stops.departure,"
+              " coupling.operation"
+              " FROM coupling"
+              " JOIN stops ON stops.id=coupling.stop_id"
+              " JOIN jobs ON jobs.id=stops.job_id"
+              " WHERE coupling.rs_id=?1 AND stops.job_id<>?2"
+              " ORDER BY stops.arrival");
+    q.bind(1, rsId);
+    q.bind(2, m_jobId);
+
+    for (auto r : q)
+    {
+        db_id jobId = r.get<db_id>(0);
+        RsOp op     = RsOp(r.get<int>(4));
+
+        if (op == RsOp::Coupled)
+        {
+            if (coupled.jobId)
+            {
+                // Coupled twice, previous job keeps it until now
+                coupled.to = r.get<QTime>(2);
+                list.append(coupled);
+            }
+
+            coupled.jobId    = jobId;
+            coupled.category = JobCategory(r.get<int>(1));
+            coupled.from     = r.get<QTime>(2);
+        }
+        else if (coupled.jobId == jobId)
+        {
+            coupled.to = r.get<QTime>(3);
+            list.append(coupled);
+            coupled.jobId = 0;
+        }
+    }
+
+    if (coupled.jobId)
+    {
+        // Not uncoupled, busy until end of day
+        coupled.to = QTime(23, 59);
+        list.append(coupled);
+    }
+
+    return m_rollingstock.insert(rsId, list).value();
+}
@@ -0,0 +1,124 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef JOBCONFLICTPREVIEW_H
+#define JOBCONFLICTPREVIEW_H
+
+#include <QHash>
+#include <QVector>
+#include <QTime>
+#include <QString>
+#include <QCoreApplication>
+
+#include "utils/types.h"
+
+namespace sqlite3pp {
+class database;
+} // namespace sqlite3pp
+
+struct StopItem;
+
+/*!
+ * \brief The JobConflictPreview class
+ *
+ * Checks job being edited against other jobs while editing in JobPathEditor.
+ * Occupancy of station tracks, segment connections and rollingstock by other jobs
+ * is loaded once per item and kept in memory, so re-evaluating after every edit
+ * only needs to query couplings of edited job.
+ *
+ * Checks mirror the background checkers:
+ * - Station track used by another job at same time
+ * - Crossing or passing on same segment track (JobCrossingChecker)
+ * - Rollingstock coupled while coupled by another job (RsErrWorker)
+ *
+ * Call clearCache() when other jobs might have changed.
+ */
+class JobConflictPreview
+{
+    Q_DECLARE_TR_FUNCTIONS(JobConflictPreview)
+
+public:
+    enum ConflictType
+    {
+        TrackOccupied = 0,
+        SegmentCrossing,
+        SegmentPassing,
+        RsBusy
+    };
+
+    struct Conflict
+    {
+        ConflictType type         = TrackOccupied;
+        db_id otherJobId          = 0;
+        JobCategory otherCategory = JobCategory::FREIGHT;
+        db_id rsId                = 0;
+        QTime otherFrom;
+        QTime otherTo;
+    };
+
+    // Key: stop ID
+    typedef QHash<db_id, QVector<Conflict>> ConflictMap;
+
+    JobConflictPreview(sqlite3pp::database &db);
+
+    void clearCache();
+
+    /*!
+     * \brief evaluate
+     * \param jobId the edited job
+     * \param stops edited job stops, AddHere items are skipped
+     * \param outConflicts receives conflicts of each stop
+     *
+     * Track conflicts are reported on stop, segment conflicts on stop
+     * before segment and rollingstock conflicts on coupling stop.
+     */
+    void evaluate(db_id jobId, const QList<StopItem> &stops, ConflictMap &outConflicts);
+
+    QString getConflictText(const Conflict &c) const;
+
+private:
+    struct Occupancy
+    {
+        db_id jobId          = 0;
+        JobCategory category = JobCategory::FREIGHT;
+        QTime from;
+        QTime to;
+        db_id gateId = 0; // Segments only, gate from which other job enters segment
+    };
+
+    typedef QVector<Occupancy> OccupancyList;
+
+    const OccupancyList &getTrackOccupancy(db_id trackId);
+    const OccupancyList &getSegmentOccupancy(db_id segConnId);
+    const OccupancyList &getRsOccupancy(db_id rsId);
+
+private:
+    sqlite3pp::database &mDb;
+
+    // Edited job, it is excluded from occupancy lists
+    db_id m_jobId;
+
+    QHash<db_id, OccupancyList> m_tracks;
+    QHash<db_id, OccupancyList> m_segConns;
+    QHash<db_id, OccupancyList> m_rollingstock;
+
+    QHash<db_id, QString> m_rsNames;
+};
+
+#endif // JOBCONFLICTPREVIEW_H
@@ -20,6 +20,8 @@
 #include "rscouplinginterface.h"
 
 #include <QMessageBox>
+#include <QHash>
+#include <QStringList>
 
 #include <QApplication>
 
@@ -28,8 +30,6 @@
 #include "stopmodel.h"
 #include "utils/rs_utils.h"
 
-#include <QElapsedTimer>
-
 RSCouplingInterface::RSCouplingInterface(database &db, QObject *parent) :
     QObject(parent),
     stopsModel(nullptr),
@@ -78,6 +78,7 @@ bool RSCouplingInterface::contains(db_id rsId, RsOp op) const
 bool RSCouplingInterface::coupleRS(db_id rsId, const QString &rsName, bool on,
                                    bool checkTractionType)
 {
+    EditStepScope editStep(stopsModel);
     stopsModel->startStopsEditing();
     stopsModel->markRsToUpdate(rsId);
 
@@ -319,6 +320,7 @@ bool RSCouplingInterface::coupleRS(db_id rsId, const QString &rsName, bool on,
 
 bool RSCouplingInterface::uncoupleRS(db_id rsId, const QString &rsName, bool on)
 {
+    EditStepScope editStep(stopsModel);
     stopsModel->startStopsEditing();
     stopsModel->markRsToUpdate(rsId);
 
@@ -422,59 +424,326 @@ bool RSCouplingInterface::uncoupleRS(db_id rsId, const QString &rsName, bool on)
     return true;
 }
 
-int RSCouplingInterface::importRSFromJob(db_id otherStopId)
+// Rollingstock IDs are integers so they can be safely put in SQL
+static QByteArray rsIdList(const QVector<db_id> &rsIds)
 {
-    query q_getUncoupled(mDb, "SELECT coupling.rs_id, rs_list.number,"
-                              " rs_models.name, rs_models.suffix, rs_models.type"
-                              " FROM coupling"
-                              " JOIN rs_list ON rs_list.id=coupling.rs_id"
-                              " JOIN rs_models ON rs_models.id=rs_list.model_id"
-                              " WHERE coupling.stop_id=? AND coupling.operation=0");
-    q_getUncoupled.bind(1, otherStopId);
+    QByteArray list;
+    for (db_id rsId : rsIds)
+    {
+        if (!list.isEmpty())
+            list.append(',');
+        list.append(QByteArray::number(rsId));
+    }
+    return list;
+}
 
-    int count            = 0;
-    bool lineElectrified = stopsModel->isRailwayElectrifiedAfterStop(m_stopId);
+static QString joinRsNames(const QHash<db_id, QString> &names, const QVector<db_id> &rsIds)
+{
+    QStringList list;
+    list.reserve(rsIds.size());
+    for (db_id rsId : rsIds)
+        list.append(names.value(rsId));
+    return list.join(QLatin1String(", "));
+}
+
+int RSCouplingInterface::coupleRSBatch(const QVector<db_id> &rsIds, bool checkTractionType)
+{
+    QVector<db_id> toCouple;
+    toCouple.reserve(rsIds.size());
+    for (db_id rsId : rsIds)
+    {
+        if (!coupled.contains(rsId) && !toCouple.contains(rsId))
+            toCouple.append(rsId);
+    }
 
-    QElapsedTimer timer;
-    timer.start();
+    if (toCouple.isEmpty())
+        return 0;
 
-    for (auto rs : q_getUncoupled)
+    const QByteArray idList = rsIdList(toCouple);
+
+    // Get names and electric engines in a single query
+    QHash<db_id, QString> names;
+    QVector<db_id> electricEngines;
+
+    QByteArray sql = "SELECT rs_list.id,rs_list.number,rs_models.name,rs_models.suffix,"
+                     "rs_models.type,rs_models.sub_type"
+                     " FROM rs_list"
+                     " LEFT JOIN rs_models ON rs_models.id=rs_list.model_id"
+                     " WHERE rs_list.id IN (%1)";
+    sql.replace("%1", idList);
+
+    query q(mDb, sql.constData());
+    for (auto rs : q)
     {
-        db_id rsId       = rs.get<db_id>(0);
+        const db_id rsId = rs.get<db_id>(0);
+        const RsType type = RsType(rs.get<int>(4));
+        names.insert(rsId, rs_utils::formatName(rs.get<QString>(2), rs.get<int>(1),
+                                                rs.get<QString>(3), type));
+
+        if (type == RsType::Engine
+            && RsEngineSubType(rs.get<int>(5)) == RsEngineSubType::Electric)
+            electricEngines.append(rsId);
+    }
 
-        int number       = rs.get<int>(1);
-        int modelNameLen = sqlite3_column_bytes(q_getUncoupled.stmt(), 2);
-        const char *modelName =
-          reinterpret_cast<char const *>(sqlite3_column_text(q_getUncoupled.stmt(), 2));
+    // Last operation of each rollingstock before this stop
+    sql = "SELECT coupling.rs_id,coupling.operation,stops.job_id,MAX(stops.arrival)"
+          " FROM coupling"
+          " JOIN stops ON stops.id=coupling.stop_id"
+          " WHERE coupling.rs_id IN (%1) AND stops.arrival<?"
+          " GROUP BY coupling.rs_id";
+    sql.replace("%1", idList);
 
-        int modelSuffixLen = sqlite3_column_bytes(q_getUncoupled.stmt(), 3);
-        const char *modelSuffix =
-          reinterpret_cast<char const *>(sqlite3_column_text(q_getUncoupled.stmt(), 3));
-        RsType rsType  = RsType(rs.get<int>(4));
+    QVector<db_id> coupledByThisJob;
+    QVector<db_id> coupledByOtherJob;
 
-        QString rsName = rs_utils::formatNameRef(modelName, modelNameLen, number, modelSuffix,
-                                                 modelSuffixLen, rsType);
+    q.prepare(sql.constData());
+    q.bind(1, arrival);
+    for (auto rs : q)
+    {
+        if (RsOp(rs.get<int>(1)) != RsOp::Coupled)
+            continue; // No Op means RS is turned off in a depot so it isn't occupied
 
-        // TODO: optimize work
-        if (coupleRS(rsId, rsName, true, !lineElectrified))
-            count++;
+        const db_id rsId = rs.get<db_id>(0);
+        if (rs.get<db_id>(2) == m_jobId)
+            coupledByThisJob.append(rsId);
+        else
+            coupledByOtherJob.append(rsId);
+    }
+
+    if (!coupledByThisJob.isEmpty())
+    {
+        qWarning() << "Error while adding coupling op. Stop:" << m_stopId
+                   << "Rs already coupled by this job:" << coupledByThisJob;
+
+        QMessageBox::warning(qApp->activeWindow(), tr("Error"),
+                             tr("Error while adding coupling operation.\n"
+                                "These rollingstock items are already coupled by this job (%1) "
+                                "and will be skipped:\n%2")
+                               .arg(m_jobId)
+                               .arg(joinRsNames(names, coupledByThisJob)),
+                             QMessageBox::Ok);
+
+        for (db_id rsId : std::as_const(coupledByThisJob))
+            toCouple.removeOne(rsId);
+    }
 
-        if (timer.elapsed() > 10000)
+    if (!coupledByOtherJob.isEmpty())
+    {
+        int but = QMessageBox::warning(qApp->activeWindow(), tr("Error"),
+                                       tr("Error while adding coupling operation.\n"
+                                          "These rollingstock items are already coupled to "
+                                          "another job:\n%1\n"
+                                          "Do you still want to couple them?")
+                                         .arg(joinRsNames(names, coupledByOtherJob)),
+                                       QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+
+        if (but == QMessageBox::No)
         {
-            // After 10 seconds, give opportunity to stop
-            int ret = QMessageBox::question(
-              qApp->activeWindow(), tr("Continue Importation?"),
-              tr("Rollingstock importation is taking more time than expected.\n"
-                 "Do you want to continue?"));
+            for (db_id rsId : std::as_const(coupledByOtherJob))
+                toCouple.removeOne(rsId);
+        }
+    }
 
-            if (ret == QMessageBox::No)
-                return count; // Abort here
+    if (checkTractionType && !electricEngines.isEmpty()
+        && !stopsModel->isRailwayElectrifiedAfterStop(m_stopId))
+    {
+        int but = QMessageBox::warning(
+          qApp->activeWindow(), tr("Warning"),
+          tr("These rollingstock items are Electric engines but the line is not electrified:\n"
+             "%1\n"
+             "They will not be albe to move a train.\n"
+             "Do you still want to couple them?")
+            .arg(joinRsNames(names, electricEngines)),
+          QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+
+        if (but == QMessageBox::No)
+        {
+            for (db_id rsId : std::as_const(electricEngines))
+                toCouple.removeOne(rsId);
+        }
+    }
+
+    if (toCouple.isEmpty())
+        return 0;
+
+    // Check if there are next coupling operations in the same job
+    // Like coupleRS() only first next operation of each item is considered
+    // NOTE: with MIN() SQLite takes bare columns from the row with minimum arrival
+    sql = "SELECT coupling.rs_id,s2.id,MIN(s2.arrival)"
+          " FROM coupling"
+          " JOIN stops s2 ON s2.id=coupling.stop_id"
+          " WHERE coupling.rs_id IN (%1) AND coupling.operation=1"
+          " AND s2.job_id=?1 AND s2.arrival>?2"
+          " GROUP BY coupling.rs_id";
+    sql.replace("%1", rsIdList(toCouple));
+
+    QVector<db_id> nextCoupledRs;
+    QVector<db_id> nextCouplingStops;
+
+    q.prepare(sql.constData());
+    q.bind(1, m_jobId);
+    q.bind(2, arrival);
+    for (auto rs : q)
+    {
+        nextCoupledRs.append(rs.get<db_id>(0));
+        nextCouplingStops.append(rs.get<db_id>(1));
+    }
 
-            timer.restart(); // Count again
+    if (!nextCoupledRs.isEmpty())
+    {
+        int but =
+          QMessageBox::question(qApp->activeWindow(), tr("Delete coupling?"),
+                                tr("You couple these rollingstock items also in next stops:\n%1\n"
+                                   "Do you want to remove the other coupling operations?")
+                                  .arg(joinRsNames(names, nextCoupledRs)),
+                                QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
+        if (but == QMessageBox::No)
+        {
+            nextCoupledRs.clear();
+            nextCouplingStops.clear();
         }
     }
 
-    return count;
+    // Stops to clear are paired with rollingstock to clear
+    QVector<db_id> toClear;
+    toClear.reserve(nextCoupledRs.size() * 2);
+    for (int i = 0; i < nextCoupledRs.size(); i++)
+    {
+        toClear.append(nextCouplingStops.at(i));
+        toClear.append(nextCoupledRs.at(i));
+    }
+
+    if (!applyBatch(toCouple, RsOp::Coupled, toClear))
+        return 0;
+
+    return toCouple.size();
+}
+
+int RSCouplingInterface::uncoupleRSBatch(const QVector<db_id> &rsIds)
+{
+    QVector<db_id> toUncouple;
+    toUncouple.reserve(rsIds.size());
+    for (db_id rsId : rsIds)
+    {
+        if (!uncoupled.contains(rsId) && !toUncouple.contains(rsId))
+            toUncouple.append(rsId);
+    }
+
+    if (toUncouple.isEmpty())
+        return 0;
+
+    const QByteArray idList = rsIdList(toUncouple);
+
+    // Check if there are next uncoupling operations in the same job
+    // Like uncoupleRS() only first next operation of each item is considered
+    // NOTE: with MIN() SQLite takes bare columns from the row with minimum arrival
+    QByteArray sql = "SELECT coupling.rs_id,s2.id,rs_list.number,rs_models.name,"
+                     "rs_models.suffix,rs_models.type,MIN(s2.arrival)"
+                     " FROM coupling"
+                     " JOIN stops s2 ON s2.id=coupling.stop_id"
+                     " JOIN rs_list ON rs_list.id=coupling.rs_id"
+                     " LEFT JOIN rs_models ON rs_models.id=rs_list.model_id"
+                     " WHERE coupling.rs_id IN (%1) AND coupling.operation=0"
+                     " AND s2.job_id=?1 AND s2.arrival>?2"
+                     " GROUP BY coupling.rs_id";
+    sql.replace("%1", idList);
+
+    QHash<db_id, QString> names;
+    QVector<db_id> toClear;
+
+    query q(mDb, sql.constData());
+    q.bind(1, m_jobId);
+    q.bind(2, arrival);
+    for (auto rs : q)
+    {
+        const db_id rsId = rs.get<db_id>(0);
+        names.insert(rsId, rs_utils::formatName(rs.get<QString>(3), rs.get<int>(2),
+                                                rs.get<QString>(4), RsType(rs.get<int>(5))));
+        toClear.append(rs.get<db_id>(1));
+        toClear.append(rsId);
+    }
+
+    if (!toClear.isEmpty())
+    {
+        int but =
+          QMessageBox::question(qApp->activeWindow(), tr("Delete uncoupling?"),
+                                tr("You uncouple these rollingstock items also in next stops:\n"
+                                   "%1\n"
+                                   "Do you want to remove the other uncoupling operations?")
+                                  .arg(joinRsNames(names, names.keys().toVector())),
+                                QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
+        if (but == QMessageBox::No)
+            toClear.clear();
+    }
+
+    if (!applyBatch(toUncouple, RsOp::Uncoupled, toClear))
+        return 0;
+
+    return toUncouple.size();
+}
+
+bool RSCouplingInterface::applyBatch(const QVector<db_id> &rsIds, RsOp op,
+                                     const QVector<db_id> &stopsToClear)
+{
+    EditStepScope editStep(stopsModel);
+    stopsModel->startStopsEditing();
+
+    sqlite3pp::transaction t(mDb);
+
+    int ret = SQLITE_OK;
+    for (db_id rsId : rsIds)
+    {
+        q_addCoupling.bind(1, m_stopId);
+        q_addCoupling.bind(2, rsId);
+        q_addCoupling.bind(3, int(op));
+        ret = q_addCoupling.execute();
+        q_addCoupling.reset();
+
+        if (ret != SQLITE_OK)
+            break;
+    }
+
+    // Pairs of stop ID and rollingstock ID
+    for (int i = 0; ret == SQLITE_OK && i + 1 < stopsToClear.size(); i += 2)
+    {
+        q_deleteCoupling.bind(1, stopsToClear.at(i));
+        q_deleteCoupling.bind(2, stopsToClear.at(i + 1));
+        ret = q_deleteCoupling.execute();
+        q_deleteCoupling.reset();
+    }
+
+    if (ret != SQLITE_OK)
+    {
+        qWarning() << "Error while adding coupling batch. Stop:" << m_stopId
+                   << "Op:" << int(op) << "Ret:" << ret << mDb.error_msg();
+        t.rollback();
+        return false;
+    }
+
+    t.commit();
+
+    for (db_id rsId : rsIds)
+    {
+        stopsModel->markRsToUpdate(rsId);
+        if (op == RsOp::Coupled)
+            coupled.append(rsId);
+        else
+            uncoupled.append(rsId);
+    }
+
+    return true;
+}
+
+int RSCouplingInterface::importRSFromJob(db_id otherStopId)
+{
+    query q_getUncoupled(mDb, "SELECT rs_id FROM coupling WHERE stop_id=? AND operation=0");
+    q_getUncoupled.bind(1, otherStopId);
+
+    QVector<db_id> rsIds;
+    for (auto rs : q_getUncoupled)
+        rsIds.append(rs.get<db_id>(0));
+
+    return coupleRSBatch(rsIds, true);
 }
 
 bool RSCouplingInterface::hasEngineAfterStop(bool *isElectricOnNonElectrifiedLine)
@@ -23,6 +23,7 @@
 #include <QObject>
 
 #include <QList>
+#include <QVector>
 
 #include "sqlite3pp/sqlite3pp.h"
 using namespace sqlite3pp;
@@ -44,6 +45,11 @@ public:
     bool coupleRS(db_id rsId, const QString &rsName, bool on, bool checkTractionType);
     bool uncoupleRS(db_id rsId, const QString &rsName, bool on);
 
+    // Couple or uncouple many rollingstock items at once with set based queries
+    // All questions are asked before writing, return number of added operations
+    int coupleRSBatch(const QVector<db_id> &rsIds, bool checkTractionType);
+    int uncoupleRSBatch(const QVector<db_id> &rsIds);
+
     int importRSFromJob(db_id otherStopId);
 
     bool hasEngineAfterStop(bool *isElectricOnNonElectrifiedLine = nullptr);
@@ -52,6 +58,9 @@ public:
 
     db_id getJobId() const;
 
+private:
+    bool applyBatch(const QVector<db_id> &rsIds, RsOp op, const QVector<db_id> &stopsToClear);
+
 private:
     StopModel *stopsModel;
 
@@ -183,6 +183,40 @@ bool RSProxyModel::setData(const QModelIndex &idx, const QVariant &value, int ro
     return ret;
 }
 
+QVector<db_id> RSProxyModel::getRsIds(const QModelIndexList &indexes) const
+{
+    QVector<db_id> rsIds;
+    rsIds.reserve(indexes.size());
+
+    for (const QModelIndex &idx : indexes)
+    {
+        if (!idx.isValid() || idx.model() != this || idx.row() >= m_data.size())
+            continue;
+
+        rsIds.append(m_data.at(idx.row()).rsId);
+    }
+
+    return rsIds;
+}
+
+void RSProxyModel::updateItems(const QModelIndexList &indexes)
+{
+    int firstRow = m_data.size();
+    int lastRow  = -1;
+
+    for (const QModelIndex &idx : indexes)
+    {
+        if (!idx.isValid() || idx.model() != this || idx.row() >= m_data.size())
+            continue;
+
+        firstRow = qMin(firstRow, idx.row());
+        lastRow  = qMax(lastRow, idx.row());
+    }
+
+    if (lastRow >= 0)
+        emit dataChanged(index(firstRow, 0), index(lastRow, 0));
+}
+
 Qt::ItemFlags RSProxyModel::flags(const QModelIndex &index) const
 {
     if (index.isValid())
@@ -67,6 +67,12 @@ public:
 
     void loadData(const QList<RsItem> &items);
 
+    // Rollingstock of given rows, to be checked in a single batch
+    QVector<db_id> getRsIds(const QModelIndexList &indexes) const;
+
+    // Notify views that given rows may have changed check state
+    void updateItems(const QModelIndexList &indexes);
+
 private:
     QList<RsItem> m_data;
 
@@ -0,0 +1,316 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "runningtimecalculator.h"
+
+#include "app/session.h"
+
+#include <sqlite3pp/sqlite3pp.h>
+using namespace sqlite3pp;
+
+#include <QtMath>
+
+#include <QDebug>
+
+RunningTimeCalculator::RunningTimeCalculator(database &db) :
+    mDb(db)
+{
+}
+
+void RunningTimeCalculator::clearCache()
+{
+    m_segments.clear();
+    m_travelMins.clear();
+}
+
+int RunningTimeCalculator::getTravelTimeSecs(db_id segmentId, int trainSpeedKmH)
+{
+    const SegmentData &seg = getSegment(segmentId);
+
+    int speedKmH           = seg.maxSpeedKmH;
+    if (trainSpeedKmH > 0 && trainSpeedKmH < speedKmH)
+        speedKmH = trainSpeedKmH;
+
+    if (seg.distanceMeters == 0 || speedKmH < 1)
+        return 60; // Error
+
+    const QPair<db_id, int> key(segmentId, speedKmH);
+    auto it = m_travelMins.constFind(key);
+    if (it != m_travelMins.constEnd())
+        return it.value() * 60;
+
+    const double secs = (seg.distanceMeters + accelerationDistMeters) / speedKmH * 3.6;
+
+    // We don't support seconds in train scheduled times
+    const int mins = qMax(1, qCeil(secs / 60.0));
+    m_travelMins.insert(key, mins);
+    return mins * 60;
+}
+
+int RunningTimeCalculator::getTrainSpeedAfter(db_id jobId, const QTime &time)
+{
+    // For each rollingstock take last operation before time, keep only if coupled
+    query q(mDb, "SELECT MIN(rs_models.max_speed), rs_id FROM("
+                 "SELECT coupling.rs_id AS rs_id, MAX(stops.arrival)"
+                 " FROM stops"
+                 " JOIN coupling ON coupling.stop_id=stops.id"
+                 " WHERE stops.job_id=? AND stops.arrival<=?"
+                 " GROUP BY coupling.rs_id"
+                 " HAVING coupling.operation=1)"
+                 " JOIN rs_list ON rs_list.id=rs_id"
+                 " JOIN rs_models ON rs_models.id=rs_list.model_id");
+    q.bind(1, jobId);
+    q.bind(2, time);
+    if (q.step() != SQLITE_ROW)
+        return 0;
+    return q.getRows().get<int>(0);
+}
+
+bool RunningTimeCalculator::recalcJob(db_id jobId, db_id fromStopId, QSet<db_id> *outStations)
+{
+    transaction t(mDb);
+
+    if (!recalcJobInternal(jobId, fromStopId, outStations))
+    {
+        t.rollback();
+        return false;
+    }
+
+    int ret = t.commit();
+    if (ret != SQLITE_OK)
+    {
+        qWarning() << "RunningTimeCalculator: cannot commit job" << jobId << mDb.error_msg();
+        return false;
+    }
+
+    return true;
+}
+
+int RunningTimeCalculator::recalcJobsOnSegment(db_id segmentId)
+{
+    // Segment changed, reload it
+    clearCache();
+
+    QVector<db_id> jobs;
+    query q(mDb, "SELECT DISTINCT stops.job_id FROM stops"
+                 " JOIN railway_connections c ON c.id=stops.next_segment_conn_id"
+                 " WHERE c.seg_id=?");
+    q.bind(1, segmentId);
+    for (auto job : q)
+        jobs.append(job.get<db_id>(0));
+    q.finish();
+
+    if (jobs.isEmpty())
+        return 0;
+
+    QSet<db_id> stationsToUpdate;
+    int failedCount = 0;
+
+    transaction t(mDb);
+
+    for (db_id jobId : std::as_const(jobs))
+    {
+        // Each job is independent, undo only failed job and keep going
+        mDb.execute("SAVEPOINT recalc_job");
+        if (!recalcJobInternal(jobId, 0, &stationsToUpdate))
+        {
+            mDb.execute("ROLLBACK TO recalc_job");
+            failedCount++;
+        }
+        mDb.execute("RELEASE recalc_job");
+    }
+
+    int ret = t.commit();
+    if (ret != SQLITE_OK)
+    {
+        qWarning() << "RunningTimeCalculator: cannot commit segment" << segmentId
+                   << mDb.error_msg();
+        return jobs.size();
+    }
+
+    // Zero job ID means many jobs changed, views reload once
+    emit Session->jobChanged(0, 0);
+
+    // Refresh graphs and station views
+    emit Session->stationJobsPlanChanged(stationsToUpdate);
+
+    return failedCount;
+}
+
+const RunningTimeCalculator::SegmentData &RunningTimeCalculator::getSegment(db_id segmentId)
+{
+    auto it = m_segments.find(segmentId);
+    if (it != m_segments.end())
+        return it.value();
+
+    SegmentData seg;
+
+    query q(mDb, "SELECT max_speed_kmh,distance_meters FROM railway_segments WHERE id=?");
+    q.bind(1, segmentId);
+    if (q.step() == SQLITE_ROW)
+    {
+        auto r             = q.getRows();
+        seg.maxSpeedKmH    = r.get<int>(0);
+        seg.distanceMeters = r.get<int>(1);
+    }
+
+    return m_segments.insert(segmentId, seg).value();
+}
+
+bool RunningTimeCalculator::loadJobStops(db_id jobId, QVector<JobStop> &stops)
+{
+    // Single pass on stops and their couplings, a stop is repeated for each coupling
+    query q(mDb, "SELECT stops.id, stops.station_id, stops.arrival, stops.departure, c.seg_id,"
+                 " coupling.rs_id, coupling.operation, rs_models.max_speed"
+                 " FROM stops"
+                 " LEFT JOIN railway_connections c ON c.id=stops.next_segment_conn_id"
+                 " LEFT JOIN coupling ON coupling.stop_id=stops.id"
+                 " LEFT JOIN rs_list ON rs_list.id=coupling.rs_id"
+                 " LEFT JOIN rs_models ON rs_models.id=rs_list.model_id"
+                 " WHERE stops.job_id=?"
+                 " ORDER BY stops.arrival");
+    q.bind(1, jobId);
+
+    // Currently coupled rollingstock and its speed
+    QHash<db_id, int> coupled;
+
+    auto calcSpeed = [&coupled]() -> int
+    {
+        int speed = 0;
+        for (int rsSpeed : std::as_const(coupled))
+        {
+            if (rsSpeed > 0 && (speed == 0 || rsSpeed < speed))
+                speed = rsSpeed;
+        }
+        return speed;
+    };
+
+    for (auto row : q)
+    {
+        const db_id stopId = row.get<db_id>(0);
+        if (stops.isEmpty() || stops.last().stopId != stopId)
+        {
+            if (!stops.isEmpty())
+                stops.last().speedAfter = calcSpeed();
+
+            JobStop item;
+            item.stopId    = stopId;
+            item.stationId = row.get<db_id>(1);
+            item.arrival   = row.get<int>(2);
+            item.departure = row.get<int>(3);
+            item.segmentId = row.get<db_id>(4);
+            stops.append(item);
+        }
+
+        if (row.column_type(5) == SQLITE_NULL)
+            continue; // No coupling at this stop
+
+        const db_id rsId = row.get<db_id>(5);
+        if (RsOp(row.get<int>(6)) == RsOp::Coupled)
+            coupled.insert(rsId, row.get<int>(7));
+        else
+            coupled.remove(rsId);
+    }
+
+    if (!stops.isEmpty())
+        stops.last().speedAfter = calcSpeed();
+
+    return !stops.isEmpty();
+}
+
+bool RunningTimeCalculator::recalcJobInternal(db_id jobId, db_id fromStopId,
+                                              QSet<db_id> *outStations)
+{
+    QVector<JobStop> stops;
+    if (!loadJobStops(jobId, stops))
+        return false;
+
+    int firstIdx = 0;
+    if (fromStopId)
+    {
+        while (firstIdx < stops.size() && stops.at(firstIdx).stopId != fromStopId)
+            firstIdx++;
+        if (firstIdx == stops.size())
+            return false; // Stop not in job
+    }
+
+    // Calculate new times, keep stop durations
+    QVector<std::pair<int, int>> newTimes;
+    newTimes.reserve(stops.size());
+    for (int i = 0; i <= firstIdx; i++)
+        newTimes.append({stops.at(i).arrival, stops.at(i).departure});
+
+    for (int i = firstIdx + 1; i < stops.size(); i++)
+    {
+        const JobStop &prev = stops.at(i - 1);
+        const JobStop &item = stops.at(i);
+
+        // Without a segment keep original travel time
+        int travelMins = item.arrival - prev.departure;
+        if (prev.segmentId)
+            travelMins = getTravelTimeSecs(prev.segmentId, prev.speedAfter) / 60;
+
+        const int arrival = newTimes.last().second + travelMins;
+        newTimes.append({arrival, arrival + item.departure - item.arrival});
+    }
+
+    if (newTimes.last().second >= 24 * 60)
+    {
+        qWarning() << "RunningTimeCalculator: job" << jobId << "would end past midnight";
+        return false;
+    }
+
+    // Move changed stops after midnight to avoid UNIQUE constraint
+    // while setting new time. See StopModel::shiftStopsBy24hoursFrom()
+    command cmd(mDb, "UPDATE stops SET arrival=arrival+2880,departure=departure+2880 WHERE id=?");
+    for (int i = firstIdx + 1; i < stops.size(); i++)
+    {
+        if (newTimes.at(i).first == stops.at(i).arrival)
+            continue;
+
+        cmd.bind(1, stops.at(i).stopId);
+        if (cmd.execute() != SQLITE_OK)
+            return false;
+        cmd.reset();
+    }
+
+    cmd.prepare("UPDATE stops SET arrival=?,departure=? WHERE id=?");
+    for (int i = firstIdx + 1; i < stops.size(); i++)
+    {
+        const JobStop &item = stops.at(i);
+        if (newTimes.at(i).first == item.arrival)
+            continue;
+
+        cmd.bind(1, newTimes.at(i).first);
+        cmd.bind(2, newTimes.at(i).second);
+        cmd.bind(3, item.stopId);
+        if (cmd.execute() != SQLITE_OK)
+        {
+            qWarning() << "RunningTimeCalculator: cannot set stop" << item.stopId
+                       << mDb.error_msg();
+            return false;
+        }
+        cmd.reset();
+
+        if (outStations && item.stationId)
+            outStations->insert(item.stationId);
+    }
+
+    return true;
+}
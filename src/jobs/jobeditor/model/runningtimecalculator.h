@@ -0,0 +1,112 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RUNNINGTIMECALCULATOR_H
+#define RUNNINGTIMECALCULATOR_H
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QTime>
+
+#include "utils/types.h"
+
+namespace sqlite3pp {
+class database;
+} // namespace sqlite3pp
+
+/*!
+ * \brief The RunningTimeCalculator class
+ *
+ * Calculates travel times between stops from segment length and speed.
+ * Effective speed is the lowest between segment maximum speed and train speed.
+ * Train speed is the lowest max speed of rollingstock models coupled to the job.
+ * Segment data and travel times are cached so recalculation can run while editing.
+ * Call clearCache() when segments might have changed.
+ */
+class RunningTimeCalculator
+{
+public:
+    RunningTimeCalculator(sqlite3pp::database &db);
+
+    void clearCache();
+
+    // Travel time rounded up to whole minutes, at least 1 minute
+    int getTravelTimeSecs(db_id segmentId, int trainSpeedKmH);
+
+    // Train speed after stop at \a time, 0 if no rollingstock is coupled
+    int getTrainSpeedAfter(db_id jobId, const QTime &time);
+
+    /*!
+     * \brief recalcJob
+     * \param jobId the job
+     * \param fromStopId first stop to keep, following stops are moved. 0 for first stop
+     * \param outStations if not null, receives stations with changed stops
+     * \return true on success
+     *
+     * Recalculate travel times of job in a single pass, stop durations are kept.
+     * Nothing is changed if job would end past midnight.
+     */
+    bool recalcJob(db_id jobId, db_id fromStopId, QSet<db_id> *outStations = nullptr);
+
+    /*!
+     * \brief recalcJobsOnSegment
+     * \param segmentId the segment which changed
+     * \return number of jobs which failed recalculation
+     *
+     * Recalculate all jobs travelling on segment after its length or speed changed.
+     * Views are notified once for all jobs.
+     * Caller must close Job Editor first, it would otherwise keep stale stops.
+     */
+    int recalcJobsOnSegment(db_id segmentId);
+
+    // Distance covered while accelerating and braking, added to segment length
+    static constexpr double accelerationDistMeters = 4000.0;
+
+private:
+    struct SegmentData
+    {
+        int distanceMeters = 0;
+        int maxSpeedKmH    = 0;
+    };
+
+    struct JobStop
+    {
+        db_id stopId    = 0;
+        db_id stationId = 0;
+        int arrival     = 0;
+        int departure   = 0;
+        db_id segmentId = 0;
+        int speedAfter  = 0;
+    };
+
+    const SegmentData &getSegment(db_id segmentId);
+    bool loadJobStops(db_id jobId, QVector<JobStop> &stops);
+    bool recalcJobInternal(db_id jobId, db_id fromStopId, QSet<db_id> *outStations);
+
+private:
+    sqlite3pp::database &mDb;
+
+    QHash<db_id, SegmentData> m_segments;
+
+    // Key: segment ID and effective speed
+    QHash<QPair<db_id, int>, int> m_travelMins;
+};
+
+#endif // RUNNINGTIMECALCULATOR_H
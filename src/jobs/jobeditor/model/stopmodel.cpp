@@ -20,6 +20,7 @@
 #include "stopmodel.h"
 
 #include <QDebug>
+#include <QTimerEvent>
 
 #include "app/scopedebug.h"
 
@@ -29,12 +30,45 @@
 using namespace sqlite3pp;
 
 #include "stations/station_utils.h"
+#include "stations/railwaytopology.h"
 
 #include <QtMath>
 
+#include <QHash>
+
+#include <memory>
+#include <cstring>
+
+/* StopsSavepoint
+ *
+ * Like sqlite3pp::transaction with commit on destruction but uses a savepoint
+ * so it can be nested inside a transaction already opened by caller,
+ * for example when route completion adds and updates stops.
+ */
+class StopsSavepoint
+{
+public:
+    StopsSavepoint(database &db) :
+        mDb(db)
+    {
+        mDb.execute("SAVEPOINT stop_model_write");
+    }
+
+    ~StopsSavepoint()
+    {
+        mDb.execute("RELEASE stop_model_write");
+    }
+
+private:
+    database &mDb;
+};
+
 StopModel::StopModel(database &db, QObject *parent) :
     QAbstractListModel(parent),
     mDb(db),
+    runningTime(db),
+    conflictPreview(db),
+    conflictTimerId(0),
     mJobId(0),
     mNewJobId(0),
     jobShiftId(0),
@@ -42,6 +76,7 @@ StopModel::StopModel(database &db, QObject *parent) :
     category(JobCategory::FREIGHT),
     oldCategory(JobCategory::FREIGHT),
     editState(NotEditing),
+    editStepDepth(0),
     timeCalcEnabled(true),
     autoInsertTransits(false),
     autoMoveUncoupleToNewLast(true),
@@ -57,10 +92,26 @@ StopModel::StopModel(database &db, QObject *parent) :
             &StopModel::onStationSegmentNameChanged);
     connect(Session, &MeetingSession::stationNameChanged, this,
             &StopModel::onStationSegmentNameChanged);
+
+    // Other jobs might now conflict with current one
+    connect(Session, &MeetingSession::jobChanged, this, &StopModel::onOtherJobsChanged);
+    connect(Session, &MeetingSession::jobRemoved, this, &StopModel::onOtherJobsChanged);
+    connect(Session, &MeetingSession::rollingStockPlanChanged, this,
+            &StopModel::onOtherJobsChanged);
+
+    // Cached platforms and segments used by conflict check might have changed
+    connect(Session, &MeetingSession::stationTrackPlanChanged, this,
+            &StopModel::onOtherJobsChanged);
+    connect(Session, &MeetingSession::segmentStationsChanged, this,
+            &StopModel::onOtherJobsChanged);
+    connect(Session, &MeetingSession::segmentRemoved, this, &StopModel::onOtherJobsChanged);
 }
 
-QVariant StopModel::data(const QModelIndex & /*index*/, int /*role*/) const
+QVariant StopModel::data(const QModelIndex &index, int role) const
 {
+    if (role == Qt::ToolTipRole && index.isValid() && index.row() < stops.size())
+        return getConflictsTextAt(index.row());
+
     return QVariant(); // Use setters and getters instead of data() and setData()
 }
 
@@ -100,6 +151,7 @@ bool StopModel::loadJobStops(db_id jobId)
 
     beginResetModel();
     stops.clear();
+    stopConflicts.clear();
     rsToUpdate.clear();
     stationsToUpdate.clear();
 
@@ -147,75 +199,119 @@ bool StopModel::loadJobStops(db_id jobId)
     }
 
     stops.reserve(count);
+    readStopItems(stops, count);
 
-    int i = 0;
+    endResetModel();
 
-    StopItem::Segment prevSegment;
-    db_id prevOutGateId = 0;
+    insertAddHere(stops.count(), 1);
 
-    q_selectStops.prepare(
-      "SELECT stops.id, stops.station_id, stops.arrival, stops.departure, stops.type,"
-      "stops.in_gate_conn, g1.gate_id, g1.gate_track, g1.track_id, g1.track_side,"
-      "stops.out_gate_conn, g2.gate_id, g2.gate_track, g2.track_id, g2.track_side,"
-      "stops.next_segment_conn_id, c.seg_id, c.in_track, c.out_track,"
-      "seg.in_gate_id, seg.out_gate_id"
-      " FROM stops"
-      " LEFT JOIN railway_connections c ON c.id=stops.next_segment_conn_id"
-      " LEFT JOIN station_gate_connections g1 ON g1.id=stops.in_gate_conn"
-      " LEFT JOIN station_gate_connections g2 ON g2.id=stops.out_gate_conn"
-      " LEFT JOIN railway_segments seg ON seg.id=c.seg_id"
-      " WHERE stops.job_id=?1"
-      " ORDER BY stops.arrival ASC");
-    q_selectStops.bind(1, mJobId);
-    for (auto stop : q_selectStops)
-    {
-        StopItem s;
-        s.stopId                    = stop.get<db_id>(0);
-        s.stationId                 = stop.get<db_id>(1);
+    if (stops.count() < 3)   // First + Last + AddHere
+        startStopsEditing(); // Set editied to enable deletion if user clicks Cancel
+
+    stops.squeeze();
+    rsToUpdate.squeeze();
+    stationsToUpdate.squeeze();
+
+    scheduleConflictCheck();
+
+    return true;
+}
 
-        s.arrival                   = stop.get<QTime>(2);
-        s.departure                 = stop.get<QTime>(3);
+// Stop with its gates and next segment, parsed by readStopRow()
+static const char selectStopItemSql[] =
+  "SELECT stops.id, stops.station_id, stops.arrival, stops.departure, stops.type,"
+  "stops.in_gate_conn, g1.gate_id, g1.gate_track, g1.track_id, g1.track_side,"
+  "stops.out_gate_conn, g2.gate_id, g2.gate_track, g2.track_id, g2.track_side,"
+  "stops.next_segment_conn_id, c.seg_id, c.in_track, c.out_track,"
+  "seg.in_gate_id, seg.out_gate_id"
+  " FROM stops"
+  " LEFT JOIN railway_connections c ON c.id=stops.next_segment_conn_id"
+  " LEFT JOIN station_gate_connections g1 ON g1.id=stops.in_gate_conn"
+  " LEFT JOIN station_gate_connections g2 ON g2.id=stops.out_gate_conn"
+  " LEFT JOIN railway_segments seg ON seg.id=c.seg_id";
+
+struct StopRowExtra
+{
+    db_id otherTrackId = 0;
+    db_id segInGateId  = 0;
+    db_id segOutGateId = 0;
+    int stopType       = 0;
+};
 
-        int stopType                = stop.get<int>(4);
+/* readStopRow
+ *
+ * Fills StopItem from a row of selectStopItemSql.
+ * Type is set to Normal or Transit, First and Last depend on stop position.
+ */
+static void readStopRow(query::rows &stop, StopItem &s, StopRowExtra &extra)
+{
+    s.stopId                    = stop.get<db_id>(0);
+    s.stationId                 = stop.get<db_id>(1);
 
-        s.fromGate.gateConnId       = stop.get<db_id>(5);
-        s.fromGate.gateId           = stop.get<db_id>(6);
-        s.fromGate.gateTrackNum     = stop.get<int>(7);
-        s.trackId                   = stop.get<db_id>(8);
-        s.fromGate.stationTrackSide = utils::Side(stop.get<int>(9));
+    s.arrival                   = stop.get<QTime>(2);
+    s.departure                 = stop.get<QTime>(3);
 
-        s.toGate.gateConnId         = stop.get<db_id>(10);
-        s.toGate.gateId             = stop.get<db_id>(11);
-        s.toGate.gateTrackNum       = stop.get<int>(12);
-        db_id otherTrackId          = stop.get<db_id>(13);
-        s.toGate.stationTrackSide   = utils::Side(stop.get<int>(14));
+    extra.stopType              = stop.get<int>(4);
 
-        s.nextSegment.segConnId     = stop.get<db_id>(15);
-        s.nextSegment.segmentId     = stop.get<db_id>(16);
-        s.nextSegment.inTrackNum    = stop.get<db_id>(17);
-        s.nextSegment.outTrackNum   = stop.get<db_id>(18);
+    s.fromGate.gateConnId       = stop.get<db_id>(5);
+    s.fromGate.gateId           = stop.get<db_id>(6);
+    s.fromGate.gateTrackNum     = stop.get<int>(7);
+    s.trackId                   = stop.get<db_id>(8);
+    s.fromGate.stationTrackSide = utils::Side(stop.get<int>(9));
 
-        db_id segInGateId           = stop.get<db_id>(19);
-        db_id segOutGateId          = stop.get<db_id>(20);
+    s.toGate.gateConnId         = stop.get<db_id>(10);
+    s.toGate.gateId             = stop.get<db_id>(11);
+    s.toGate.gateTrackNum       = stop.get<int>(12);
+    extra.otherTrackId          = stop.get<db_id>(13);
+    s.toGate.stationTrackSide   = utils::Side(stop.get<int>(14));
 
-        if (s.toGate.gateId && s.toGate.gateId == segOutGateId)
-        {
-            // Segment is reversed
-            qSwap(segInGateId, segOutGateId);
-            qSwap(s.nextSegment.inTrackNum, s.nextSegment.outTrackNum);
-            s.nextSegment.reversed = true;
-        }
+    s.nextSegment.segConnId     = stop.get<db_id>(15);
+    s.nextSegment.segmentId     = stop.get<db_id>(16);
+    s.nextSegment.inTrackNum    = stop.get<db_id>(17);
+    s.nextSegment.outTrackNum   = stop.get<db_id>(18);
 
-        // Fix station track on First stop
-        if (!s.fromGate.gateConnId)
-        {
-            // If station has no 'in' connection use 'out' connection
-            // This might happen on first stop
-            s.trackId = otherTrackId;
-        }
+    extra.segInGateId           = stop.get<db_id>(19);
+    extra.segOutGateId          = stop.get<db_id>(20);
+
+    if (s.toGate.gateId && s.toGate.gateId == extra.segOutGateId)
+    {
+        // Segment is reversed
+        qSwap(extra.segInGateId, extra.segOutGateId);
+        qSwap(s.nextSegment.inTrackNum, s.nextSegment.outTrackNum);
+        s.nextSegment.reversed = true;
+    }
+
+    // Fix station track on First stop
+    if (!s.fromGate.gateConnId)
+    {
+        // If station has no 'in' connection use 'out' connection
+        // This might happen on first stop
+        s.trackId = extra.otherTrackId;
+    }
+
+    s.type = extra.stopType ? StopType::Transit : StopType::Normal;
+}
+
+void StopModel::readStopItems(QList<StopItem> &list, int count)
+{
+    int i = 0;
+
+    StopItem::Segment prevSegment;
+    db_id prevOutGateId = 0;
+
+    QByteArray sql      = selectStopItemSql;
+    sql.append(" WHERE stops.job_id=?1 ORDER BY stops.arrival ASC");
+
+    query q_selectStops(mDb, sql.constData());
+    q_selectStops.bind(1, mJobId);
+    for (auto stop : q_selectStops)
+    {
+        StopItem s;
+        StopRowExtra extra;
+        readStopRow(stop, s, extra);
 
         // Check consistency
-        if (s.trackId != otherTrackId && s.toGate.gateConnId)
+        if (s.trackId != extra.otherTrackId && s.toGate.gateConnId)
         {
             // Last stop has no 'out' connection so do not check track if on 'Last' stop
             // In gate leads to a different station track than out gate
@@ -242,7 +338,7 @@ bool StopModel::loadJobStops(db_id jobId)
         }
         if (s.nextSegment.segmentId != 0)
         {
-            if (segInGateId != s.toGate.gateId)
+            if (extra.segInGateId != s.toGate.gateId)
             {
                 // Out gate leads to a different next semgent
                 qWarning() << "Stop:" << s.stopId
@@ -260,51 +356,48 @@ bool StopModel::loadJobStops(db_id jobId)
         }
 
         prevSegment   = s.nextSegment;
-        prevOutGateId = segOutGateId;
-
-        s.type        = StopType::Normal;
+        prevOutGateId = extra.segOutGateId;
 
         if (i == 0)
         {
             s.type = StopType::First;
-            if (stopType != 0)
+            if (extra.stopType != 0)
             {
                 // Error First cannot be a transit
                 qWarning() << "Error: First stop cannot be transit! Job:" << mJobId
                            << "StopId:" << s.stopId;
             }
         }
-        else if (stopType)
+        else if (extra.stopType && i == count - 1)
         {
-            s.type = StopType::Transit;
-
-            if (i == count - 1)
-            {
-                // Error Last cannot be a transit
-                qWarning() << "Error: Last stop cannot be transit! Job:" << mJobId
-                           << "StopId:" << s.stopId;
-            }
+            // Error Last cannot be a transit
+            qWarning() << "Error: Last stop cannot be transit! Job:" << mJobId
+                       << "StopId:" << s.stopId;
         }
 
-        stops.append(s);
+        list.append(s);
         i++;
     }
     q_selectStops.finish();
 
-    if (!stops.isEmpty() && stops.last().type != StopType::First)
-        stops.last().type = StopType::Last; // Update Last stop type unless it's First
-
-    endResetModel();
-
-    insertAddHere(stops.count(), 1);
+    if (!list.isEmpty() && list.last().type != StopType::First)
+        list.last().type = StopType::Last; // Update Last stop type unless it's First
+}
 
-    if (stops.count() < 3)   // First + Last + AddHere
-        startStopsEditing(); // Set editied to enable deletion if user clicks Cancel
+bool StopModel::readStopItem(db_id stopId, StopItem &item)
+{
+    QByteArray sql = selectStopItemSql;
+    sql.append(" WHERE stops.id=?1 AND stops.job_id=?2");
 
-    stops.squeeze();
-    rsToUpdate.squeeze();
-    stationsToUpdate.squeeze();
+    query q(mDb, sql.constData());
+    q.bind(1, stopId);
+    q.bind(2, mJobId);
+    if (q.step() != SQLITE_ROW)
+        return false;
 
+    auto r = q.getRows();
+    StopRowExtra extra;
+    readStopRow(r, item, extra);
     return true;
 }
 
@@ -319,6 +412,9 @@ void StopModel::clearJob()
     oldCategory = category = JobCategory(-1);
     emit categoryChanged(int(category));
 
+    stopConflicts.clear();
+    conflictPreview.clearCache();
+
     int count = stops.count();
     if (count == 0)
         return;
@@ -421,52 +517,11 @@ bool StopModel::revertChanges()
 
     if (editState == StopsEditing)
     {
-        // Delete current data
-
-        // Clear stops (will automatically clear couplings with FK: ON DELETE CASCADE)
-        command cmd(mDb, "DELETE FROM stops WHERE job_id=?");
-        cmd.bind(1, mJobId);
-        int ret = cmd.execute();
-        cmd.finish();
-
-        if (ret != SQLITE_OK)
-        {
-            qDebug() << "Error while clearing current stops:" << ret << mDb.error_msg()
-                     << mDb.extended_error_code();
-            return false;
-        }
-
-        // Now restore old data
-
-        // Restore stops
-        cmd.prepare("INSERT INTO stops SELECT * FROM old_stops WHERE job_id=?");
-        cmd.bind(1, mJobId);
-        ret = cmd.execute();
-        cmd.reset();
-
-        if (ret != SQLITE_OK)
-        {
-            qDebug() << "Error while restoring old stops:" << ret << mDb.error_msg()
-                     << mDb.extended_error_code();
-            return false;
-        }
-
-        // Restore couplings
-        cmd.prepare("INSERT INTO coupling(id, stop_id, rs_id, operation)"
-                    " SELECT old_coupling.id, old_coupling.stop_id, old_coupling.rs_id, "
-                    "old_coupling.operation"
-                    " FROM old_coupling"
-                    " JOIN stops ON stops.id=old_coupling.stop_id WHERE stops.job_id=?");
-        cmd.bind(1, mJobId);
-        ret = cmd.execute();
-        cmd.reset();
-
-        if (ret != SQLITE_OK)
-        {
-            qDebug() << "Error while restoring old couplings:" << ret << mDb.error_msg()
-                     << mDb.extended_error_code();
+        // Write back only rows which differ from state before editing
+        JobState curState;
+        loadJobState(curState);
+        if (!applyJobDelta(diffJobState(curState, savedState)))
             return false;
-        }
 
         // Reload info and stops
         needsStopReload = true;
@@ -503,6 +558,8 @@ bool StopModel::revertChanges()
 void StopModel::addStop()
 {
     DEBUG_IMPORTANT_ENTRY;
+    EditStepScope editStep(this);
+
     if (stops.count() == 0)
         return;
 
@@ -547,7 +604,7 @@ void StopModel::addStop()
 
         int travelSecs = 60;
         if (s.nextSegment.segmentId)
-            travelSecs = calcTravelTime(s.nextSegment.segmentId);
+            travelSecs = calcTravelTime(s.nextSegment.segmentId, s.arrival);
 
         const QTime time = s.departure.addSecs(travelSecs);
         last.arrival     = time;
@@ -610,6 +667,8 @@ void StopModel::addStop()
 
 void StopModel::removeStop(const QModelIndex &idx)
 {
+    EditStepScope editStep(this);
+
     const int row = idx.row();
 
     if (!idx.isValid() && row >= stops.count())
@@ -736,6 +795,8 @@ void StopModel::removeStop(const QModelIndex &idx)
 
 void StopModel::removeLastIfEmpty()
 {
+    EditStepScope editStep(this);
+
     if (stops.count() < 2) // Empty stop + AddHere
         return;
 
@@ -766,6 +827,8 @@ void StopModel::removeLastIfEmpty()
 
 void StopModel::uncoupleStillCoupledAtLastStop()
 {
+    EditStepScope editStep(this);
+
     if (!autoUncoupleAtLast)
         return;
 
@@ -783,6 +846,8 @@ void StopModel::uncoupleStillCoupledAtLastStop()
 
 void StopModel::uncoupleStillCoupledAtStop(const StopItem &s)
 {
+    EditStepScope editStep(this);
+
     // Uncouple all still-coupled RS
     command q_uncoupleRS(
       mDb, "INSERT OR REPLACE INTO coupling(id,stop_id,rs_id,operation) VALUES(NULL,?,?,0)");
@@ -883,6 +948,8 @@ void StopModel::setNewShiftId(db_id shiftId)
 void StopModel::setStopInfo(const QModelIndex &idx, StopItem newStop, StopItem::Segment prevSeg,
                             bool avoidTimeRecalc)
 {
+    EditStepScope editStep(this);
+
     const int row      = idx.row();
     int lastUpdatedRow = row;
 
@@ -1021,7 +1088,7 @@ void StopModel::setStopInfo(const QModelIndex &idx, StopItem newStop, StopItem::
 
             if (timeCalcEnabled && !avoidTimeRecalc)
             {
-                const int secs         = calcTravelTime(s.nextSegment.segmentId);
+                const int secs         = calcTravelTime(s.nextSegment.segmentId, s.arrival);
                 const QTime oldNextArr = nextStop.arrival;
                 const QTime oldNextDep = nextStop.departure;
 
@@ -1050,6 +1117,8 @@ void StopModel::setStopInfo(const QModelIndex &idx, StopItem newStop, StopItem::
 
 bool StopModel::setStopTypeRange(int firstRow, int lastRow, StopType type)
 {
+    EditStepScope editStep(this);
+
     if (firstRow < 0 || firstRow > lastRow || lastRow >= stops.count())
         return false;
 
@@ -1061,6 +1130,10 @@ bool StopModel::setStopTypeRange(int firstRow, int lastRow, StopType type)
     StopType destType   = type;
 
     startStopsEditing();
+
+    // Write all rows at once, commit when going out of scope
+    StopsSavepoint savepoint(mDb);
+
     shiftStopsBy24hoursFrom(stops.at(firstRow).arrival);
 
     query q_getCoupled(mDb, "SELECT rs_id, operation FROM coupling WHERE stop_id=?");
@@ -1193,6 +1266,8 @@ QString StopModel::getDescription(const StopItem &s) const
 
 void StopModel::setDescription(const QModelIndex &idx, const QString &descr)
 {
+    EditStepScope editStep(this);
+
     if (!idx.isValid() && idx.row() >= stops.count())
         return;
 
@@ -1301,109 +1376,110 @@ bool StopModel::isRailwayElectrifiedAfterRow(int row) const
 
 bool StopModel::trySelectTrackForStop(StopItem &item)
 {
-    query q(mDb);
+    RailwayTopology::GraphPtr graph = Session->getRailwayTopology()->getGraph();
+    if (!graph)
+        return false;
+
     if (item.fromGate.gateId)
     {
         // TODO: choose 'default' track, corretto tracciato
         // Try to keep previous selected station track otherwise choose lowest position track
-        // possible
-        q.prepare("SELECT c.id, c.track_side, t.id"
-                  " FROM station_gate_connections c"
-                  " JOIN station_tracks t ON c.track_id=t.id"
-                  " WHERE c.gate_id=? AND c.gate_track=?"
-                  " ORDER BY c.track_id=? DESC, t.pos ASC"
-                  " LIMIT 1");
-        q.bind(1, item.fromGate.gateId);
-        q.bind(2, item.fromGate.gateTrackNum);
-        q.bind(3, item.trackId);
-        if (q.step() != SQLITE_ROW)
+        // possible. Gate connections are sorted by track position.
+        const RailwayTopology::GateConnection *found = nullptr;
+        for (const RailwayTopology::GateConnection &conn :
+             graph->getGateConnections(item.fromGate.gateId))
+        {
+            if (conn.gateTrack != item.fromGate.gateTrackNum)
+                continue;
+
+            if (!found)
+                found = &conn;
+            if (conn.trackId == item.trackId)
+            {
+                found = &conn;
+                break;
+            }
+        }
+
+        if (!found)
             return false;
 
-        auto gate                      = q.getRows();
-        item.fromGate.gateConnId       = gate.get<db_id>(0);
-        item.fromGate.stationTrackSide = utils::Side(gate.get<int>(1));
-        item.trackId                   = gate.get<db_id>(2);
+        item.fromGate.gateConnId       = found->connId;
+        item.fromGate.stationTrackSide = found->trackSide;
+        item.trackId                   = found->trackId;
         return true;
     }
 
-    // Select a random gate for first use
-    q.prepare("SELECT c.id, c.gate_id, c.gate_track, c.track_side, t.id, MIN(t.pos)"
-              " FROM station_tracks t"
-              " JOIN station_gate_connections c ON c.track_id=t.id"
-              " WHERE t.station_id=?"
-              " LIMIT 1");
-    q.bind(1, item.stationId);
-    if (q.step() != SQLITE_ROW || q.getRows().column_type(0) == SQLITE_NULL)
-        return false;
+    // Select a random gate for first use, on lowest position track with connections
+    for (db_id trackId : graph->getStationTracks(item.stationId))
+    {
+        const QVector<RailwayTopology::GateConnection> &conns = graph->getTrackConnections(trackId);
+        if (conns.isEmpty())
+            continue;
 
-    auto gate                      = q.getRows();
-    item.fromGate.gateConnId       = gate.get<db_id>(0);
-    item.fromGate.gateId           = gate.get<db_id>(1);
-    item.fromGate.gateTrackNum     = gate.get<int>(2);
-    item.fromGate.stationTrackSide = utils::Side(gate.get<int>(3));
-    item.trackId                   = gate.get<db_id>(4);
+        const RailwayTopology::GateConnection &conn = conns.first();
+        item.fromGate.gateConnId                    = conn.connId;
+        item.fromGate.gateId                        = conn.gateId;
+        item.fromGate.gateTrackNum                  = conn.gateTrack;
+        item.fromGate.stationTrackSide              = conn.trackSide;
+        item.trackId                                = trackId;
 
-    // TODO: should we reset out gate here?
+        // TODO: should we reset out gate here?
 
-    return true;
+        return true;
+    }
+
+    return false;
 }
 
 bool StopModel::trySetTrackConnections(StopItem &item, db_id trackId, QString *outErr)
 {
-    query q(mDb, "SELECT station_id FROM station_tracks WHERE id=?");
-    q.bind(1, trackId);
-    if (q.step() == SQLITE_ROW)
+    RailwayTopology::GraphPtr graph = Session->getRailwayTopology()->getGraph();
+
+    const RailwayTopology::Track *track = graph ? graph->getTrack(trackId) : nullptr;
+    if (!track)
     {
-        db_id stId = q.getRows().get<db_id>(0);
-        if (item.stationId != stId)
-        {
-            if (outErr)
-                *outErr = tr("Track belongs to a different station.");
-            return false;
-        }
+        if (outErr)
+            *outErr = tr("Track doesn't exist.");
+        return false;
     }
-    else
+
+    if (item.stationId != track->stationId)
     {
         if (outErr)
-            *outErr = tr("Track doesn't exist.");
+            *outErr = tr("Track belongs to a different station.");
         return false;
     }
 
     if (item.type == StopType::First)
     {
         // Fake in gate, select one just to set the track
-        q.prepare("SELECT id,gate_id,gate_track,track_side FROM station_gate_connections WHERE "
-                  "track_id=? LIMIT 1");
-        q.bind(1, trackId);
-        if (q.step() != SQLITE_ROW)
+        const QVector<RailwayTopology::GateConnection> &conns = graph->getTrackConnections(trackId);
+        if (conns.isEmpty())
         {
             if (outErr)
                 *outErr = tr("Track is not connected to any of station gates.");
             return false;
         }
 
-        auto gate                      = q.getRows();
-        item.fromGate.gateConnId       = gate.get<db_id>(0);
-        item.fromGate.gateId           = gate.get<db_id>(1);
-        item.fromGate.gateTrackNum     = gate.get<int>(2);
-        item.fromGate.stationTrackSide = utils::Side(gate.get<int>(3));
+        const RailwayTopology::GateConnection &gate = conns.first();
+        item.fromGate.gateConnId                    = gate.connId;
+        item.fromGate.gateId                        = gate.gateId;
+        item.fromGate.gateTrackNum                  = gate.gateTrack;
+        item.fromGate.stationTrackSide              = gate.trackSide;
     }
 
-    q.prepare("SELECT id, track_side FROM station_gate_connections"
-              " WHERE gate_id=? AND gate_track=? AND track_id=?");
-
     if (item.type != StopType::First)
     {
         // Item is not First stop, check in gate
-        q.bind(1, item.fromGate.gateId);
-        q.bind(2, item.fromGate.gateTrackNum);
-        q.bind(3, trackId);
+        const RailwayTopology::GateConnection *conn =
+          graph->findGateConnection(item.fromGate.gateId, item.fromGate.gateTrackNum, trackId);
 
-        if (q.step() == SQLITE_ROW)
+        if (conn)
         {
             // Found a connection
-            item.fromGate.gateConnId       = q.getRows().get<db_id>(0);
-            item.fromGate.stationTrackSide = utils::Side(q.getRows().get<int>(1));
+            item.fromGate.gateConnId       = conn->connId;
+            item.fromGate.stationTrackSide = conn->trackSide;
         }
         else
         {
@@ -1412,7 +1488,6 @@ bool StopModel::trySetTrackConnections(StopItem &item, db_id trackId, QString *o
                              "Please choose a new track or change previous segment.");
             return false;
         }
-        q.reset();
     }
 
     if (item.toGate.gateConnId)
@@ -1420,15 +1495,14 @@ bool StopModel::trySetTrackConnections(StopItem &item, db_id trackId, QString *o
         // For every type of stop, check out gate
         // User already chose an out gate but now changed station track
         // Check if they are connected together
-        q.bind(1, item.toGate.gateId);
-        q.bind(2, item.toGate.gateTrackNum);
-        q.bind(3, trackId);
+        const RailwayTopology::GateConnection *conn =
+          graph->findGateConnection(item.toGate.gateId, item.toGate.gateTrackNum, trackId);
 
-        if (q.step() == SQLITE_ROW)
+        if (conn)
         {
             // Found a connection
-            item.toGate.gateConnId       = q.getRows().get<db_id>(0);
-            item.toGate.stationTrackSide = utils::Side(q.getRows().get<int>(1));
+            item.toGate.gateConnId       = conn->connId;
+            item.toGate.stationTrackSide = conn->trackSide;
         }
         else
         {
@@ -1456,21 +1530,17 @@ bool StopModel::trySelectNextSegment(StopItem &item, db_id segmentId, int sugges
 {
     out_suggestedTrackId = -1;
 
-    bool reversed        = false;
-    query q(mDb, "SELECT s.in_gate_id,g1.station_id,s.out_gate_id,g2.station_id"
-                 " FROM railway_segments s"
-                 " JOIN station_gates g1 ON g1.id=s.in_gate_id"
-                 " JOIN station_gates g2 ON g2.id=s.out_gate_id"
-                 " WHERE s.id=?");
-    q.bind(1, segmentId);
-    if (q.step() != SQLITE_ROW)
+    RailwayTopology::GraphPtr graph = Session->getRailwayTopology()->getGraph();
+
+    const RailwayTopology::Segment *seg = graph ? graph->getSegment(segmentId) : nullptr;
+    if (!seg)
         return false;
 
-    auto seg            = q.getRows();
-    db_id seg_in_gateId = seg.get<db_id>(0);
-    db_id in_stationId  = seg.get<db_id>(1);
-    seg_out_gateId      = seg.get<db_id>(2);
-    db_id out_stationId = seg.get<db_id>(3);
+    bool reversed       = false;
+    db_id seg_in_gateId = seg->inGateId;
+    db_id in_stationId  = seg->inStationId;
+    seg_out_gateId      = seg->outGateId;
+    db_id out_stationId = seg->outStationId;
 
     if (out_stationId == item.stationId)
     {
@@ -1499,80 +1569,61 @@ bool StopModel::trySelectNextSegment(StopItem &item, db_id segmentId, int sugges
 
         // Try to find a gate connected to previous track_id
         // Prefer suggested gate out track num if possible or lowest one possible
-        QByteArray sql = "SELECT c.id,c.gate_track,c.track_side,sc.id,sc.%2_track"
-                         " FROM station_gate_connections c"
-                         " JOIN railway_connections sc ON sc.seg_id=?3 AND sc.%1_track=c.gate_track"
-                         " WHERE c.track_id=?1 AND c.gate_id=?2"
-                         " ORDER BY c.gate_track=?4 DESC,c.gate_track ASC"
-                         " LIMIT 1";
-
-        sql.replace("%1", reversed ? "out" : "in");
-        sql.replace("%2", reversed ? "in" : "out");
-
-        q.prepare(sql);
-        q.bind(1, item.trackId);
-        q.bind(2, seg_in_gateId);
-        q.bind(3, segmentId);
-        q.bind(4, suggestedOutGateTrk);
-        if (q.step() != SQLITE_ROW)
+        const RailwayTopology::GateConnection *outConn    = nullptr;
+        const RailwayTopology::SegmentConnection *segConn = nullptr;
+        for (const RailwayTopology::GateConnection &conn : graph->getGateConnections(seg_in_gateId))
         {
-            // Error: gate is not connected to previous track
-            // User must change previous track, make a suggestion (lowest track connected to in and
-            // out gates)
-
-            sql = "SELECT c2.track_id"
-                  " FROM station_gate_connections c2"
-                  " JOIN railway_connections sc ON sc.seg_id=?2 AND sc.%1_track=c2.gate_track"
-                  " %3"
-                  " JOIN station_tracks t ON t.id=c2.track_id"
-                  " WHERE c2.gate_id=?1"
-                  " ORDER BY c2.gate_track=?3 DESC,c2.gate_track ASC,t.pos ASC"
-                  " LIMIT 1";
-
-            if (item.type != StopType::First)
-            {
-                // Check also in gate
-                sql.replace("%3",
-                            "JOIN station_gate_connections c1 ON"
-                            " c1.gate_id=?4 AND c1.gate_track=?5 AND c1.track_id=c2.track_id");
-            }
-            else
-            {
-                // Do not check in gate for first stop
-                sql.replace("%3", "");
-            }
+            if (conn.trackId != item.trackId)
+                continue;
 
-            sql.replace("%1", reversed ? "out" : "in");
-            sql.replace("%2", reversed ? "in" : "out");
+            const RailwayTopology::SegmentConnection *sc =
+              graph->findSegmentConnection(segmentId, conn.gateTrack, reversed);
+            if (!sc)
+                continue;
 
-            q.prepare(sql);
-            q.bind(1, seg_in_gateId);
-            q.bind(2, segmentId);
-            q.bind(3, suggestedOutGateTrk);
-
-            if (item.type != StopType::First)
+            if (!outConn || conn.gateTrack == suggestedOutGateTrk)
             {
-                q.bind(4, item.fromGate.gateId);
-                q.bind(5, item.fromGate.gateTrackNum);
+                outConn = &conn;
+                segConn = sc;
             }
+            if (conn.gateTrack == suggestedOutGateTrk)
+                break;
+        }
 
-            if (q.step() == SQLITE_ROW)
+        if (!outConn)
+        {
+            // Error: gate is not connected to previous track
+            // User must change previous track, make a suggestion (lowest track connected to in and
+            // out gates). Gate connections are sorted by gate track and track position.
+            for (const RailwayTopology::GateConnection &conn :
+                 graph->getGateConnections(seg_in_gateId))
             {
-                out_suggestedTrackId = q.getRows().get<db_id>(0);
+                if (!graph->findSegmentConnection(segmentId, conn.gateTrack, reversed))
+                    continue;
+
+                // Do not check in gate for first stop
+                if (item.type != StopType::First
+                    && !graph->findGateConnection(item.fromGate.gateId,
+                                                  item.fromGate.gateTrackNum, conn.trackId))
+                    continue;
+
+                if (out_suggestedTrackId == 0 || conn.gateTrack == suggestedOutGateTrk)
+                    out_suggestedTrackId = conn.trackId;
+                if (conn.gateTrack == suggestedOutGateTrk)
+                    break;
             }
 
             return false;
         }
 
-        auto conn                    = q.getRows();
-        item.toGate.gateConnId       = conn.get<db_id>(0);
+        item.toGate.gateConnId       = outConn->connId;
         item.toGate.gateId           = seg_in_gateId;
-        item.toGate.gateTrackNum     = conn.get<int>(1);
-        item.toGate.stationTrackSide = utils::Side(conn.get<int>(2));
-        item.nextSegment.segConnId   = conn.get<db_id>(3);
+        item.toGate.gateTrackNum     = outConn->gateTrack;
+        item.toGate.stationTrackSide = outConn->trackSide;
+        item.nextSegment.segConnId   = segConn->connId;
         item.nextSegment.segmentId   = segmentId;
         item.nextSegment.inTrackNum  = item.toGate.gateTrackNum;
-        item.nextSegment.outTrackNum = conn.get<int>(4);
+        item.nextSegment.outTrackNum = reversed ? segConn->inTrack : segConn->outTrack;
         item.nextSegment.reversed    = reversed;
     }
 
@@ -1669,140 +1720,221 @@ void StopModel::deleteStop(db_id stopId)
     q_removeStop.reset();
 }
 
-#ifdef ENABLE_AUTO_TIME_RECALC
-void StopModel::rebaseTimesToSpeed(int firstIdx, QTime firstArr, QTime firstDep)
+bool StopModel::rebaseTimesToSpeed(int firstIdx)
 {
-    // Recalc times from this stop until last, also apply offset with new departure
+    // Recalc times from this stop until last, stop durations are kept
     if (firstIdx < 0 || firstIdx >= stops.size() - 2) // At least one before Last stop
-        return;                                       // Error
+        return false;                                 // Error
 
+    EditStepScope editStep(this);
     startStopsEditing();
 
-    StopItem &firstStop = stops[firstIdx];
+    if (!runningTime.recalcJob(mJobId, stops.at(firstIdx).stopId, &stationsToUpdate))
+        return false;
 
-    QTime minArrival;
-    if (firstIdx > 0)
-        minArrival = stops.at(firstIdx - 1).departure.addSecs(60);
+    // Rollingstock plans show job times
+    query q(mDb, "SELECT coupling.rs_id FROM coupling"
+                 " JOIN stops ON stops.id=coupling.stop_id"
+                 " WHERE stops.job_id=?");
+    q.bind(1, mJobId);
+    for (auto rs : q)
+        rsToUpdate.insert(rs.get<db_id>(0));
 
-    if (firstArr < minArrival)
-    {
-        firstDep = firstDep.addSecs(minArrival.secsTo(firstArr));
-    }
+    // Finally inform the view
+    reloadStopItems();
+    return true;
+}
 
-    if (firstDep < firstArr)
+bool StopModel::addRoute(db_id originStationId, const QVector<db_id> &viaStationIds,
+                         db_id destStationId, bool byRunningTime, QString *outErr)
+{
+    RailwayTopology::GraphPtr graph = Session->getRailwayTopology()->getGraph();
+    if (!graph || !mJobId)
     {
-        firstDep =
-          firstArr.addSecs(60); // At least 1 minute stop, it cannot be a transit if we couple RS
+        if (outErr)
+            *outErr = tr("Railway network is not available or no job is being edited.");
+        return false;
     }
 
-    int offsetSecs      = firstStop.departure.secsTo(firstDep);
-    firstStop.arrival   = firstArr;
-    firstStop.departure = firstDep;
+    // Last item is always AddHere
+    const bool hasStops = stops.count() > 1;
+    const int fromRow   = hasStops ? stops.count() - 2 : 0;
 
-    query q(Session->m_Db, "SELECT MIN(rs_models.max_speed), rs_id FROM("
-                           "SELECT coupling.rs_id AS rs_id, MAX(stops.arrival)"
-                           " FROM stops"
-                           " JOIN coupling ON coupling.stop_id=stops.id"
-                           " WHERE stops.job_id=? AND stops.arrival<?"
-                           " GROUP BY coupling.rs_id"
-                           " HAVING coupling.operation=1)"
-                           " JOIN rs_list ON rs_list.id=rs_id"
-                           " JOIN rs_models ON rs_models.id=rs_list.model_id");
+    db_id fromStationId = originStationId;
+    db_id fromGateId    = 0;
+    if (hasStops)
+    {
+        const StopItem &last = stops.at(fromRow);
+        fromStationId        = last.stationId;
+        if (last.type != StopType::First)
+            fromGateId = last.fromGate.gateId;
+    }
 
-    QTime prevDep  = firstDep;
-    db_id prevStId = firstStop.stationId;
+    if (!fromStationId)
+    {
+        if (outErr)
+            *outErr = tr("Origin station is not set.");
+        return false;
+    }
 
-    db_id lineId   = firstStop.nextLine ? firstStop.nextLine : firstStop.curLine;
-    int lineSpeed  = linesModel->getLineSpeed(lineId);
+    // Find whole route before changing anything
+    QVector<db_id> targets = viaStationIds;
+    targets.append(destStationId);
 
-    // size() - 1 to exclude AddHere
-    for (int idx = firstIdx + 1; idx < stops.size() - 1; idx++)
+    QVector<db_id> segments;
+    QVector<db_id> legSegments;
+    for (db_id targetId : std::as_const(targets))
     {
-        StopItem &item = stops[idx];
-        if (item.curLine != lineId)
+        if (targetId == fromStationId)
+            continue;
+
+        if (!graph->findRoute(fromStationId, fromGateId, targetId, byRunningTime, legSegments,
+                              &fromGateId))
         {
-            lineId    = item.curLine;
-            lineSpeed = linesModel->getLineSpeed(lineId);
+            if (outErr)
+            {
+                query q(mDb, "SELECT name FROM stations WHERE id=?");
+                q.bind(1, targetId);
+                q.step();
+                *outErr = tr("No route found to station <b>%1</b>.<br>"
+                             "Check segments and station track connections.")
+                            .arg(q.getRows().get<QString>(0));
+            }
+            return false;
         }
 
-        stationsToUpdate.insert(item.stationId);
-        // TODO: should update also RS
+        segments += legSegments;
+        fromStationId = targetId;
+    }
 
-        // Use original arrival to query train max speed
+    if (segments.isEmpty() && hasStops)
+        return true; // Already at destination
 
-        // Temporarily set arrival and departure
-        // Don't sync with database otherwise we could mess with stop order
-        // Sync at end when we calculated all new times
-        // If a previous stop gets postponed it appears after current stop
-        // until we postpone also current stop. This temp reorder breaks the
-        // query for retrieving train speed because this query is based on sorting by time
+    EditStepScope editStep(this);
+    startStopsEditing();
 
-        // Get train speed
-        q.bind(1, mJobId);
-        q.bind(2, item.arrival);
-        q.step();
-        int speedKmH = q.getRows().get<int>(0);
-        q.reset();
+    // Write all stops in a single transaction
+    sqlite3pp::transaction t(mDb);
+    if (!appendRouteStops(hasStops ? 0 : originStationId, segments))
+    {
+        t.rollback();
+        reloadStopItems();
+
+        if (outErr)
+            *outErr = tr("Cannot connect station tracks along the route.");
+        return false;
+    }
 
-        // If line is slower or we couldn't get trains speed (likely no RS coupled) use line max
-        // speed instead
-        if (speed <= 0 || (lineSpeed >= 0 && lineSpeed < speed))
-            speed = lineSpeed;
+    // Stations which are not origin, via or destination are passed in transit
+    QSet<db_id> stopStations(targets.cbegin(), targets.cend());
+    command q_setTransit(mDb, "UPDATE stops SET type=1,departure=arrival WHERE id=?");
+    for (int row = fromRow + 1; row < stops.count() - 2; row++)
+    {
+        StopItem &s = stops[row];
+        if (stopStations.contains(s.stationId))
+            continue;
 
-        double distanceMeters = linesModel->getStationsDistance(lineId, prevStId, item.stationId);
+        q_setTransit.bind(1, s.stopId);
+        q_setTransit.execute();
+        q_setTransit.reset();
 
-        if (qFuzzyIsNull(distance) || speed < 1.0)
-        {
-            // Error
-        }
+        s.type      = StopType::Transit;
+        s.departure = s.arrival;
+    }
 
-        const double secs = (distanceMeters + accelerationDistMeters) / double(speed) * 3.6;
-        int roundedTop    = qCeil(secs) + offsetSecs;
+    t.commit();
 
-        if (roundedTop < 60)
-        {
-            // At least 1 minute between stops
-            roundedTop = 60;
-        }
-        else
+    // Stop durations of transits changed, compact travel times
+    if (!timeCalcEnabled || !rebaseTimesToSpeed(fromRow))
+        reloadStopItems();
+
+    return true;
+}
+
+bool StopModel::appendRouteStops(db_id originStationId, const QVector<db_id> &segments)
+{
+    RailwayTopology::GraphPtr graph = Session->getRailwayTopology()->getGraph();
+    command cmd(mDb);
+
+    if (originStationId)
+    {
+        // Job has no stops, create First stop in origin
+        addStop();
+
+        StopItem &first = stops[0];
+        first.stationId = originStationId;
+        if (!trySelectTrackForStop(first))
+            return false;
+
+        cmd.prepare("UPDATE stops SET station_id=?,in_gate_conn=? WHERE id=?");
+        cmd.bind(1, first.stationId);
+        cmd.bind(2, first.fromGate.gateConnId);
+        cmd.bind(3, first.stopId);
+        if (cmd.execute() != SQLITE_OK)
+            return false;
+
+        stationsToUpdate.insert(first.stationId);
+    }
+
+    for (db_id segmentId : segments)
+    {
+        const RailwayTopology::Segment *seg = graph->getSegment(segmentId);
+        StopItem &s                         = stops[stops.count() - 2];
+
+        const db_id nextStationId =
+          seg->inStationId == s.stationId ? seg->outStationId : seg->inStationId;
+
+        db_id nextInGateId     = 0;
+        db_id suggestedTrackId = 0;
+        if (!trySelectNextSegment(s, segmentId, s.toGate.gateTrackNum, nextStationId,
+                                  nextInGateId, suggestedTrackId))
         {
-            // Align to minutes, we don't support seconds in train scheduled times
-            int rem = roundedTop % 60;
-            if (rem > 10) // TODO: maybe 20 as treshold, sync calcTimeBetweenStations()
-                roundedTop += 60 - rem; // Round to next minute
-            else
-                roundedTop -= rem;
+            // Current track is not connected to segment, use suggested track
+            QString errMsg;
+            if (suggestedTrackId <= 0 || !trySetTrackConnections(s, suggestedTrackId, &errMsg)
+                || !trySelectNextSegment(s, segmentId, s.toGate.gateTrackNum, nextStationId,
+                                         nextInGateId, suggestedTrackId))
+            {
+                qWarning() << "StopModel: cannot route stop" << s.stopId << "to segment"
+                           << segmentId << errMsg;
+                return false;
+            }
+
+            cmd.prepare("UPDATE stops SET in_gate_conn=? WHERE id=?");
+            cmd.bind(1, s.fromGate.gateConnId);
+            cmd.bind(2, s.stopId);
+            if (cmd.execute() != SQLITE_OK)
+                return false;
         }
 
-        int stopTime   = item.arrival.secsTo(item.departure);
-        item.arrival   = prevDep.addSecs(roundedTop);
-        item.departure = prevDep.addSecs(roundedTop + stopTime);
+        cmd.prepare("UPDATE stops SET out_gate_conn=?, next_segment_conn_id=? WHERE id=?");
+        cmd.bind(1, s.toGate.gateConnId);
+        cmd.bind(2, s.nextSegment.segConnId);
+        cmd.bind(3, s.stopId);
+        if (cmd.execute() != SQLITE_OK)
+            return false;
 
-        prevStId       = item.stationId;
-        prevDep        = item.departure;
-    }
+        if (s.type == StopType::First)
+        {
+            // No need to fake an in gate to set station track, we already have out gate
+            cmd.prepare("UPDATE stops SET in_gate_conn=NULL WHERE id=?");
+            cmd.bind(1, s.stopId);
+            cmd.execute();
+            s.fromGate = StopItem::Gate();
+        }
 
-    // Now prepare query to set Arrival and departure
-    q.prepare("UPDATE stops SET arrival=?,departure=? WHERE id=?");
+        // New Last stop gets station and in gate from previous segment
+        addStop();
 
-    for (int idx = firstIdx; idx < stops.size() - 1; idx++)
-    {
-        // Now sync with database
+        const StopItem &last = stops.at(stops.count() - 2);
+        if (last.stationId != nextStationId || !last.fromGate.gateConnId)
+            return false;
 
-        const StopItem &item = stops.at(idx);
-        q.bind(1, item.arrival);
-        q.bind(2, item.departure);
-        q.bind(3, item.stopId);
-        q.step();
-        q.reset();
+        stationsToUpdate.insert(nextStationId);
     }
 
-    // Finally inform the view
-    QModelIndex first = index(firstIdx, 0);
-    QModelIndex last  = index(stops.size() - 1);
-    emit dataChanged(first, last);
+    return true;
 }
-#endif
 
 bool StopModel::updateCurrentInGate(StopItem &curStop, const StopItem::Segment &prevSeg)
 {
@@ -1916,8 +2048,13 @@ bool StopModel::updateStopTime(StopItem &item, int row, bool propagate, const QT
         propagate = false; // We are last stop, nothing to propagate
     }
 
+    // Write shifted stops at once, commit when going out of scope
+    std::unique_ptr<StopsSavepoint> savepoint;
     if (propagate)
+    {
+        savepoint.reset(new StopsSavepoint(mDb));
         shiftStopsBy24hoursFrom(oldArr);
+    }
 
     // Update Arrival and Departure in database
     command cmd(mDb);
@@ -1971,24 +2108,13 @@ bool StopModel::updateStopTime(StopItem &item, int row, bool propagate, const QT
     return true;
 }
 
-int StopModel::calcTravelTime(db_id segmentId)
+int StopModel::calcTravelTime(db_id segmentId, const QTime &fromArrival)
 {
     DEBUG_IMPORTANT_ENTRY;
 
-    query q(mDb, "SELECT max_speed_kmh,distance_meters FROM railway_segments WHERE id=?");
-    q.bind(1, segmentId);
-    if (q.step() != SQLITE_ROW)
-        return 60; // Error
-
-    auto r             = q.getRows();
-    const int speedKmH = r.get<int>(0);
-    const int meters   = r.get<int>(1);
-
-    if (meters == 0 || speedKmH < 1.0)
-        return 60; // Error
-
-    const double secs = (meters + accelerationDistMeters) / speedKmH * 3.6;
-    return qMax(60, qCeil(secs));
+    // Train speed depends on rollingstock coupled up to previous stop
+    const int trainSpeedKmH = runningTime.getTrainSpeedAfter(mJobId, fromArrival);
+    return runningTime.getTravelTimeSecs(segmentId, trainSpeedKmH);
 }
 
 int StopModel::defaultStopTimeSec()
@@ -2044,68 +2170,761 @@ bool StopModel::startStopsEditing()
     bool alreadyEditing = editState == InfoEditing;
     editState           = StopsEditing;
 
-    // Backup stops
-    command q_backup(mDb, "INSERT INTO old_stops SELECT * FROM stops WHERE job_id=?");
-    q_backup.bind(1, mJobId);
-    int ret = q_backup.execute();
-    q_backup.reset();
+    // Segments might have changed since last editing
+    runningTime.clearCache();
 
-    if (ret != SQLITE_OK)
-    {
-        qWarning() << "Error while saving old stops:" << ret << mDb.error_msg()
-                   << mDb.extended_error_code();
-        return false;
-    }
+    // Save stops in memory, nothing is written to database
+    loadJobState(savedState);
+    lastState = savedState;
 
-    // Backup couplings
-    q_backup.prepare("INSERT INTO old_coupling(id, stop_id, rs_id, operation)"
-                     " SELECT coupling.id, coupling.stop_id, coupling.rs_id, coupling.operation"
-                     " FROM coupling"
-                     " JOIN stops ON stops.id=coupling.stop_id WHERE stops.job_id=?");
-    q_backup.bind(1, mJobId);
-    ret = q_backup.execute();
-    q_backup.reset();
+    if (!alreadyEditing)
+        emit edited(true);
 
-    if (ret != SQLITE_OK)
-    {
-        qDebug() << "Error while saving old couplings:" << ret << mDb.error_msg()
-                 << mDb.extended_error_code();
+    return true;
+}
+
+bool StopModel::endStopsEditing()
+{
+    if (editState == NotEditing)
         return false;
+
+    savedState = JobState();
+    lastState  = JobState();
+
+    const bool hadSteps = !undoSteps.isEmpty() || !redoSteps.isEmpty();
+    undoSteps.clear();
+    undoSteps.squeeze();
+    redoSteps.clear();
+    redoSteps.squeeze();
+    editStepDepth = 0;
+
+    rsToUpdate.clear();
+    stationsToUpdate.clear();
+
+    editState = NotEditing;
+
+    emit edited(false);
+
+    if (hadSteps)
+        emit undoRedoChanged();
+
+    return true;
+}
+
+bool StopModel::StopRow::operator==(const StopRow &other) const
+{
+    return stopId == other.stopId && stationId == other.stationId && arrival == other.arrival
+           && departure == other.departure && type == other.type
+           && description == other.description && description.isNull() == other.description.isNull()
+           && inGateConn == other.inGateConn && outGateConn == other.outGateConn
+           && nextSegConn == other.nextSegConn;
+}
+
+bool StopModel::loadJobState(JobState &state, const QSet<db_id> *stopIds,
+                             const QSet<db_id> *couplingIds)
+{
+    state = JobState();
+
+    auto readStop = [&state](query::rows &stop)
+    {
+        StopRow item;
+        item.stopId    = stop.get<db_id>(0);
+        item.stationId = stop.get<db_id>(1);
+        item.arrival   = stop.get<qint64>(2);
+        item.departure = stop.get<qint64>(3);
+        item.type      = stop.get<int>(4);
+        if (stop.column_type(5) != SQLITE_NULL)
+            item.description = stop.get<QString>(5);
+        item.inGateConn  = stop.get<db_id>(6);
+        item.outGateConn = stop.get<db_id>(7);
+        item.nextSegConn = stop.get<db_id>(8);
+        state.stops.insert(item.stopId, item);
+    };
+
+    auto readCoupling = [&state](query::rows &c)
+    {
+        CouplingRow item;
+        item.couplingId = c.get<db_id>(0);
+        item.stopId     = c.get<db_id>(1);
+        item.rsId       = c.get<db_id>(2);
+        item.operation  = c.get<int>(3);
+        state.couplings.insert(item.couplingId, item);
+    };
+
+    query q(mDb);
+
+    if (stopIds)
+    {
+        // Only requested rows, skip rows not existing anymore
+        q.prepare("SELECT id,station_id,arrival,departure,type,description,"
+                  "in_gate_conn,out_gate_conn,next_segment_conn_id"
+                  " FROM stops WHERE id=? AND job_id=?");
+        for (db_id stopId : *stopIds)
+        {
+            q.bind(1, stopId);
+            q.bind(2, mJobId);
+            if (q.step() == SQLITE_ROW)
+            {
+                auto r = q.getRows();
+                readStop(r);
+            }
+            q.reset();
+        }
+    }
+    else
+    {
+        q.prepare("SELECT id,station_id,arrival,departure,type,description,"
+                  "in_gate_conn,out_gate_conn,next_segment_conn_id"
+                  " FROM stops WHERE job_id=?");
+        q.bind(1, mJobId);
+        for (auto stop : q)
+            readStop(stop);
     }
 
-    if (!alreadyEditing)
-        emit edited(true);
+    if (couplingIds)
+    {
+        q.prepare("SELECT coupling.id, coupling.stop_id, coupling.rs_id, coupling.operation"
+                  " FROM coupling"
+                  " JOIN stops ON stops.id=coupling.stop_id"
+                  " WHERE coupling.id=? AND stops.job_id=?");
+        for (db_id couplingId : *couplingIds)
+        {
+            q.bind(1, couplingId);
+            q.bind(2, mJobId);
+            if (q.step() == SQLITE_ROW)
+            {
+                auto r = q.getRows();
+                readCoupling(r);
+            }
+            q.reset();
+        }
+    }
+    else
+    {
+        q.prepare("SELECT coupling.id, coupling.stop_id, coupling.rs_id, coupling.operation"
+                  " FROM coupling"
+                  " JOIN stops ON stops.id=coupling.stop_id WHERE stops.job_id=?");
+        q.bind(1, mJobId);
+        for (auto c : q)
+            readCoupling(c);
+    }
 
     return true;
 }
 
-bool StopModel::endStopsEditing()
+StopModel::JobDelta StopModel::diffJobState(const JobState &from, const JobState &to)
 {
-    if (editState == NotEditing)
-        return false;
+    JobDelta delta;
 
-    if (editState == StopsEditing)
+    // Changed couplings are removed and inserted again
+    auto sameCoupling = [](const CouplingRow &a, const CouplingRow &b)
+    { return a.stopId == b.stopId && a.rsId == b.rsId && a.operation == b.operation; };
+
+    for (const CouplingRow &c : from.couplings)
+    {
+        auto it = to.couplings.constFind(c.couplingId);
+        if (it == to.couplings.constEnd() || !sameCoupling(*it, c))
+            delta.removedCouplings.append(c.couplingId);
+    }
+
+    for (const CouplingRow &c : to.couplings)
+    {
+        auto it = from.couplings.constFind(c.couplingId);
+        if (it == from.couplings.constEnd() || !sameCoupling(*it, c))
+            delta.addedCouplings.append(c);
+    }
+
+    for (const StopRow &item : from.stops)
+    {
+        if (!to.stops.contains(item.stopId))
+            delta.removedStops.append(item.stopId);
+    }
+
+    for (const StopRow &item : to.stops)
+    {
+        auto it = from.stops.constFind(item.stopId);
+        if (it == from.stops.constEnd())
+        {
+            delta.addedStops.append(item);
+            continue;
+        }
+
+        if (*it == item)
+            continue;
+
+        delta.changedStops.append(item);
+        if (it->arrival != item.arrival || it->departure != item.departure)
+            delta.retimedStops.append(item.stopId);
+    }
+
+    return delta;
+}
+
+void StopModel::applyDeltaToState(JobState &state, const JobDelta &delta)
+{
+    for (db_id couplingId : delta.removedCouplings)
+        state.couplings.remove(couplingId);
+
+    for (db_id stopId : delta.removedStops)
+    {
+        state.stops.remove(stopId);
+
+        // Couplings of removed stops are deleted by FK: ON DELETE CASCADE
+        auto it = state.couplings.begin();
+        while (it != state.couplings.end())
+        {
+            if (it->stopId == stopId)
+                it = state.couplings.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    for (const StopRow &item : delta.addedStops)
+        state.stops.insert(item.stopId, item);
+
+    for (const StopRow &item : delta.changedStops)
+        state.stops.insert(item.stopId, item);
+
+    for (const CouplingRow &c : delta.addedCouplings)
+        state.couplings.insert(c.couplingId, c);
+}
+
+bool StopModel::applyJobDelta(const JobDelta &delta)
+{
+    command cmd(mDb);
+    int ret     = SQLITE_OK;
+
+    auto bindId = [&cmd](int idx, db_id id)
+    {
+        if (id)
+            cmd.bind(idx, id);
+        else
+            cmd.bind(idx); // Bind NULL
+    };
+
+    auto bindStop = [&cmd, &bindId](const StopRow &item)
+    {
+        bindId(1, item.stationId);
+        cmd.bind(2, item.arrival);
+        cmd.bind(3, item.departure);
+        cmd.bind(4, item.type);
+        if (item.description.isNull())
+            cmd.bind(5);
+        else
+            cmd.bind(5, item.description);
+        bindId(6, item.inGateConn);
+        bindId(7, item.outGateConn);
+        bindId(8, item.nextSegConn);
+        cmd.bind(9, item.stopId);
+    };
+
+    auto logError = [this, &ret](const char *msg)
     {
-        // Clear old_stops (will automatically clear old_couplings with FK: ON DELETE CASCADE)
-        command q_clearOldStops(mDb, "DELETE FROM old_stops WHERE job_id=?");
-        q_clearOldStops.bind(1, mJobId);
-        int ret = q_clearOldStops.execute();
-        q_clearOldStops.reset();
+        qWarning() << "StopModel: error while restoring" << msg << "Job:" << mJobId << ret
+                   << mDb.error_msg() << mDb.extended_error_code();
+    };
+
+    // Apply all changes at once
+    sqlite3pp::transaction t(mDb);
 
+    cmd.prepare("DELETE FROM coupling WHERE id=?");
+    for (db_id couplingId : delta.removedCouplings)
+    {
+        cmd.bind(1, couplingId);
+        ret = cmd.execute();
+        cmd.reset();
         if (ret != SQLITE_OK)
         {
-            qDebug() << "Error while clearing old stops:" << ret << mDb.error_msg()
-                     << mDb.extended_error_code();
+            logError("removing coupling");
+            t.rollback();
             return false;
         }
     }
 
-    rsToUpdate.clear();
-    stationsToUpdate.clear();
+    // Couplings of removed stops are cleared by FK: ON DELETE CASCADE
+    cmd.prepare("DELETE FROM stops WHERE id=?");
+    for (db_id stopId : delta.removedStops)
+    {
+        cmd.bind(1, stopId);
+        ret = cmd.execute();
+        cmd.reset();
+        if (ret != SQLITE_OK)
+        {
+            logError("removing stop");
+            t.rollback();
+            return false;
+        }
+    }
 
-    editState = NotEditing;
+    // Move stops with changed time after midnight to avoid UNIQUE constraint
+    // while setting new time. See shiftStopsBy24hoursFrom()
+    cmd.prepare("UPDATE stops SET arrival=arrival+?1,departure=departure+?1 WHERE id=?2");
+    for (db_id stopId : delta.retimedStops)
+    {
+        cmd.bind(1, 24 * 60);
+        cmd.bind(2, stopId);
+        ret = cmd.execute();
+        cmd.reset();
+        if (ret != SQLITE_OK)
+        {
+            logError("shifting stop");
+            t.rollback();
+            return false;
+        }
+    }
 
-    emit edited(false);
+    cmd.prepare("INSERT INTO stops(station_id,arrival,departure,type,description,"
+                "in_gate_conn,out_gate_conn,next_segment_conn_id,id,job_id)"
+                " VALUES(?,?,?,?,?,?,?,?,?,?)");
+    for (const StopRow &item : delta.addedStops)
+    {
+        bindStop(item);
+        cmd.bind(10, mJobId);
+        ret = cmd.execute();
+        cmd.reset();
+        if (ret != SQLITE_OK)
+        {
+            logError("inserting stop");
+            t.rollback();
+            return false;
+        }
+    }
+
+    cmd.prepare("UPDATE stops SET station_id=?,arrival=?,departure=?,type=?,description=?,"
+                "in_gate_conn=?,out_gate_conn=?,next_segment_conn_id=?"
+                " WHERE id=?");
+    for (const StopRow &item : delta.changedStops)
+    {
+        bindStop(item);
+        ret = cmd.execute();
+        cmd.reset();
+        if (ret != SQLITE_OK)
+        {
+            logError("updating stop");
+            t.rollback();
+            return false;
+        }
+    }
+
+    cmd.prepare("INSERT INTO coupling(id,stop_id,rs_id,operation) VALUES(?,?,?,?)");
+    for (const CouplingRow &c : delta.addedCouplings)
+    {
+        cmd.bind(1, c.couplingId);
+        cmd.bind(2, c.stopId);
+        cmd.bind(3, c.rsId);
+        cmd.bind(4, c.operation);
+        ret = cmd.execute();
+        cmd.reset();
+        if (ret != SQLITE_OK)
+        {
+            logError("inserting coupling");
+            t.rollback();
+            return false;
+        }
+    }
+
+    ret = t.commit();
+    if (ret != SQLITE_OK)
+    {
+        logError("commiting");
+        return false;
+    }
 
     return true;
 }
+
+void StopModel::markDeltaToUpdate(const JobDelta &delta, const JobState &before)
+{
+    // Stations and rollingstock touched by delta, both before and after applying it
+    for (db_id stopId : delta.removedStops)
+    {
+        db_id stationId = before.stops.value(stopId).stationId;
+        if (stationId)
+            stationsToUpdate.insert(stationId);
+    }
+
+    for (const StopRow &item : delta.addedStops)
+    {
+        if (item.stationId)
+            stationsToUpdate.insert(item.stationId);
+    }
+
+    for (const StopRow &item : delta.changedStops)
+    {
+        if (item.stationId)
+            stationsToUpdate.insert(item.stationId);
+
+        db_id oldStationId = before.stops.value(item.stopId).stationId;
+        if (oldStationId)
+            stationsToUpdate.insert(oldStationId);
+    }
+
+    for (db_id couplingId : delta.removedCouplings)
+    {
+        db_id rsId = before.couplings.value(couplingId).rsId;
+        if (rsId)
+            rsToUpdate.insert(rsId);
+    }
+
+    for (const CouplingRow &c : delta.addedCouplings)
+        rsToUpdate.insert(c.rsId);
+
+    // Retimed stops affect all rollingstock coupled to the job
+    if (!delta.retimedStops.isEmpty() || !delta.removedStops.isEmpty()
+        || !delta.addedStops.isEmpty())
+    {
+        for (const CouplingRow &c : before.couplings)
+            rsToUpdate.insert(c.rsId);
+    }
+}
+
+void StopModel::onRowWritten(const char *table, db_id rowId)
+{
+    if (strcmp(table, "stops") == 0)
+        writtenStops.insert(rowId);
+    else if (strcmp(table, "coupling") == 0)
+        writtenCouplings.insert(rowId);
+}
+
+void StopModel::recordUndoStep()
+{
+    // Couplings of removed stops are deleted by FK: ON DELETE CASCADE
+    // which might not be reported by update hook
+    for (const CouplingRow &c : std::as_const(lastState.couplings))
+    {
+        if (writtenStops.contains(c.stopId))
+            writtenCouplings.insert(c.couplingId);
+    }
+
+    // Compare only rows written by this step, before from memory and after from database
+    JobState before;
+    for (db_id stopId : std::as_const(writtenStops))
+    {
+        auto it = lastState.stops.constFind(stopId);
+        if (it != lastState.stops.constEnd())
+            before.stops.insert(stopId, it.value());
+    }
+    for (db_id couplingId : std::as_const(writtenCouplings))
+    {
+        auto it = lastState.couplings.constFind(couplingId);
+        if (it != lastState.couplings.constEnd())
+            before.couplings.insert(couplingId, it.value());
+    }
+
+    JobState after;
+    loadJobState(after, &writtenStops, &writtenCouplings);
+
+    writtenStops.clear();
+    writtenCouplings.clear();
+
+    EditStep step;
+    step.redo = diffJobState(before, after);
+    if (step.redo.isEmpty())
+        return; // Nothing changed
+
+    step.undo = diffJobState(after, before);
+    applyDeltaToState(lastState, step.redo);
+
+    undoSteps.append(step);
+    if (undoSteps.size() > MaxUndoSteps)
+        undoSteps.removeFirst();
+    redoSteps.clear();
+
+    emit undoRedoChanged();
+}
+
+bool StopModel::applyEditStep(bool isUndo)
+{
+    if (editState != StopsEditing || editStepDepth > 0)
+        return false;
+
+    QVector<EditStep> &fromStack = isUndo ? undoSteps : redoSteps;
+    QVector<EditStep> &toStack   = isUndo ? redoSteps : undoSteps;
+    if (fromStack.isEmpty())
+        return false;
+
+    const EditStep &step  = fromStack.last();
+    const JobDelta &delta = isUndo ? step.undo : step.redo;
+
+    if (!applyJobDelta(delta))
+        return false;
+
+    // Stops with changed couplings must be repainted
+    QSet<db_id> couplingStops;
+    for (db_id couplingId : delta.removedCouplings)
+        couplingStops.insert(lastState.couplings.value(couplingId).stopId);
+    for (const CouplingRow &c : delta.addedCouplings)
+        couplingStops.insert(c.stopId);
+
+    markDeltaToUpdate(delta, lastState);
+    applyDeltaToState(lastState, delta);
+    markDeltaToUpdate(delta, lastState);
+
+    // Update only rows in delta, keeps view selection and does not reload job
+    applyDeltaToStopItems(delta, couplingStops);
+
+    toStack.append(fromStack.takeLast());
+
+    scheduleConflictCheck();
+
+    emit undoRedoChanged();
+    return true;
+}
+
+void StopModel::reloadStopItems()
+{
+    query q(mDb, "SELECT COUNT(id) FROM stops WHERE job_id=?");
+    q.bind(1, mJobId);
+    q.step();
+    int count = q.getRows().get<int>(0);
+    q.finish();
+
+    QList<StopItem> newStops;
+    newStops.reserve(count + 1);
+    readStopItems(newStops, count);
+
+    scheduleConflictCheck();
+
+    // Stops are always followed by AddHere item
+    bool sameRows = newStops.size() == stops.size() - 1;
+    for (int i = 0; sameRows && i < newStops.size(); i++)
+    {
+        if (newStops.at(i).stopId != stops.at(i).stopId)
+            sameRows = false;
+    }
+
+    if (sameRows)
+    {
+        // Only contents changed, keep view selection
+        for (int i = 0; i < newStops.size(); i++)
+            stops[i] = newStops.at(i);
+
+        if (!newStops.isEmpty())
+            emit dataChanged(index(0, 0), index(newStops.size() - 1, 0));
+        return;
+    }
+
+    beginResetModel();
+    stops = newStops;
+    endResetModel();
+
+    insertAddHere(stops.count(), 1);
+}
+
+void StopModel::applyDeltaToStopItems(const JobDelta &delta, const QSet<db_id> &couplingStops)
+{
+    for (db_id stopId : delta.removedStops)
+    {
+        const int row = getStopRow(stopId);
+        if (row < 0)
+            continue;
+
+        beginRemoveRows(QModelIndex(), row, row);
+        stops.removeAt(row);
+        endRemoveRows();
+    }
+
+    for (const StopRow &item : delta.addedStops)
+        placeStopItem(item.stopId);
+
+    for (const StopRow &item : delta.changedStops)
+        placeStopItem(item.stopId);
+
+    // Couplings are not stored in StopItem, just repaint
+    for (db_id stopId : couplingStops)
+    {
+        const int row = getStopRow(stopId);
+        if (row >= 0)
+            emit dataChanged(index(row, 0), index(row, 0));
+    }
+
+    updateStopTypes();
+}
+
+void StopModel::placeStopItem(db_id stopId)
+{
+    StopItem item;
+    if (!readStopItem(stopId, item))
+        return;
+
+    // Stops are sorted by arrival and followed by AddHere
+    const int oldRow = getStopRow(stopId);
+    const int count  = stops.size() - 1;
+    int newRow       = 0;
+    for (; newRow < count; newRow++)
+    {
+        if (newRow != oldRow && stops.at(newRow).arrival > item.arrival)
+            break;
+    }
+
+    if (oldRow < 0)
+    {
+        beginInsertRows(QModelIndex(), newRow, newRow);
+        stops.insert(newRow, item);
+        endInsertRows();
+        return;
+    }
+
+    stops[oldRow] = item;
+
+    // Position after removing item from old row
+    const int destRow = newRow > oldRow ? newRow - 1 : newRow;
+    if (destRow != oldRow)
+    {
+        beginMoveRows(QModelIndex(), oldRow, oldRow, QModelIndex(), newRow);
+        stops.move(oldRow, destRow);
+        endMoveRows();
+    }
+
+    emit dataChanged(index(destRow, 0), index(destRow, 0));
+}
+
+void StopModel::updateStopTypes()
+{
+    // First and Last depend on position, other stops on type column
+    const int count = stops.size() - 1; // Last item is AddHere
+    for (int row = 0; row < count; row++)
+    {
+        StopItem &s   = stops[row];
+
+        StopType type = lastState.stops.value(s.stopId).type ? StopType::Transit : StopType::Normal;
+        if (row == 0)
+            type = StopType::First;
+        else if (row == count - 1)
+            type = StopType::Last;
+
+        if (s.type != type)
+        {
+            s.type = type;
+            emit dataChanged(index(row, 0), index(row, 0));
+        }
+    }
+}
+
+bool StopModel::canUndo() const
+{
+    return editState == StopsEditing && !undoSteps.isEmpty();
+}
+
+bool StopModel::canRedo() const
+{
+    return editState == StopsEditing && !redoSteps.isEmpty();
+}
+
+bool StopModel::undo()
+{
+    return applyEditStep(true);
+}
+
+bool StopModel::redo()
+{
+    return applyEditStep(false);
+}
+
+void StopModel::beginEditStep()
+{
+    if (editStepDepth++ > 0)
+        return;
+
+    // Collect rows written by this step so only they are compared
+    writtenStops.clear();
+    writtenCouplings.clear();
+    mDb.set_update_handler(
+      [this](int, const char *dbName, const char *table, long long int rowId)
+      {
+          if (strcmp(dbName, "main") == 0)
+              onRowWritten(table, rowId);
+      });
+}
+
+void StopModel::endEditStep()
+{
+    if (editStepDepth <= 0)
+        return;
+
+    editStepDepth--;
+    if (editStepDepth > 0)
+        return;
+
+    mDb.set_update_handler(nullptr);
+
+    if (editState == StopsEditing)
+        recordUndoStep();
+    else
+    {
+        writtenStops.clear();
+        writtenCouplings.clear();
+    }
+
+    scheduleConflictCheck();
+}
+
+bool StopModel::hasConflictsAt(int row) const
+{
+    return stopConflicts.contains(stops.at(row).stopId);
+}
+
+QString StopModel::getConflictsTextAt(int row) const
+{
+    auto it = stopConflicts.constFind(stops.at(row).stopId);
+    if (it == stopConflicts.constEnd())
+        return QString();
+
+    QStringList lines;
+    for (const JobConflictPreview::Conflict &c : it.value())
+        lines.append(conflictPreview.getConflictText(c));
+    return lines.join('\n');
+}
+
+void StopModel::scheduleConflictCheck()
+{
+    // Coalesce all changes of current event loop iteration in a single check
+    if (!conflictTimerId)
+        conflictTimerId = startTimer(0);
+}
+
+void StopModel::updateConflicts()
+{
+    JobConflictPreview::ConflictMap oldConflicts;
+    qSwap(oldConflicts, stopConflicts);
+
+    if (mJobId && !stops.isEmpty())
+        conflictPreview.evaluate(mJobId, stops, stopConflicts);
+
+    // Repaint rows which had or have conflicts
+    int firstRow = -1;
+    int lastRow  = -1;
+    for (int row = 0; row < stops.size(); row++)
+    {
+        const db_id stopId = stops.at(row).stopId;
+        if (!stopConflicts.contains(stopId) && !oldConflicts.contains(stopId))
+            continue;
+
+        if (firstRow < 0)
+            firstRow = row;
+        lastRow = row;
+    }
+
+    if (firstRow >= 0)
+        emit dataChanged(index(firstRow, 0), index(lastRow, 0));
+}
+
+void StopModel::timerEvent(QTimerEvent *e)
+{
+    if (e->timerId() == conflictTimerId)
+    {
+        killTimer(conflictTimerId);
+        conflictTimerId = 0;
+        updateConflicts();
+        return;
+    }
+
+    QAbstractListModel::timerEvent(e);
+}
+
+void StopModel::onOtherJobsChanged()
+{
+    conflictPreview.clearCache();
+    scheduleConflictCheck();
+}
@@ -25,9 +25,14 @@
 
 #include <QList>
 #include <QSet>
+#include <QVector>
+#include <QHash>
 
 #include "stations/station_utils.h"
 
+#include "runningtimecalculator.h"
+#include "jobconflictpreview.h"
+
 namespace sqlite3pp {
 class database;
 }
@@ -102,6 +107,16 @@ public:
     bool commitChanges();
     bool revertChanges();
 
+    // Undo/Redo of single edits, available while editing stops
+    bool canUndo() const;
+    bool canRedo() const;
+    bool undo();
+    bool redo();
+
+    // Group all changes until matching endEditStep() in a single undo step
+    void beginEditStep();
+    void endEditStep();
+
     // Editing
     void addStop();
     void removeStop(const QModelIndex &idx);
@@ -152,9 +167,17 @@ public:
         return stops.at(row).stationId;
     }
 
-#ifdef ENABLE_AUTO_TIME_RECALC
-    void rebaseTimesToSpeed(int firstIdx, QTime firstArr, QTime firstDep);
-#endif
+    // Conflicts with other jobs, updated after every change
+    bool hasConflictsAt(int row) const;
+    QString getConflictsTextAt(int row) const;
+
+    // Recalculate travel times after stop at row with current train speed
+    bool rebaseTimesToSpeed(int firstIdx);
+
+    // Append shortest route from last stop through via stations to destination
+    // If job has no stops, route starts from origin station
+    bool addRoute(db_id originStationId, const QVector<db_id> &viaStationIds,
+                  db_id destStationId, bool byRunningTime, QString *outErr = nullptr);
 
     bool trySelectTrackForStop(StopItem &item);
 
@@ -165,6 +188,7 @@ public:
 
 signals:
     void edited(bool val);
+    void undoRedoChanged();
 
     void categoryChanged(int newCat);
     void jobIdChanged(db_id jobId);
@@ -176,6 +200,9 @@ public slots:
     bool setNewJobId(db_id jobId);
     void setNewShiftId(db_id shiftId);
 
+protected:
+    void timerEvent(QTimerEvent *e) override;
+
 private slots:
     void reloadSettings();
 
@@ -184,6 +211,8 @@ private slots:
 
     void onStationSegmentNameChanged();
 
+    void onOtherJobsChanged();
+
 private:
     void insertAddHere(int row, int type);
     db_id createStop(db_id jobId, const QTime &arr, const QTime &dep, StopType type);
@@ -193,7 +222,9 @@ private:
     bool updateStopTime(StopItem &item, int row, bool propagate, const QTime &oldArr,
                         const QTime &oldDep);
 
-    int calcTravelTime(db_id segmentId);
+    bool appendRouteStops(db_id originStationId, const QVector<db_id> &segments);
+
+    int calcTravelTime(db_id segmentId, const QTime &fromArrival);
     int defaultStopTimeSec();
 
     void shiftStopsBy24hoursFrom(const QTime &startTime);
@@ -205,16 +236,23 @@ private:
     inline void markRsToUpdate(db_id rsId)
     {
         rsToUpdate.insert(rsId);
+        scheduleConflictCheck();
     }
 
-private:
-    // To simulate acceleration/braking we add 4 km to distance
-    static constexpr double accelerationDistMeters = 4000.0;
+    void scheduleConflictCheck();
+    void updateConflicts();
 
+private:
     sqlite3pp::database &mDb;
 
+    RunningTimeCalculator runningTime;
+
     QList<StopItem> stops;
 
+    JobConflictPreview conflictPreview;
+    JobConflictPreview::ConflictMap stopConflicts;
+    int conflictTimerId;
+
     QSet<db_id> rsToUpdate;
     QSet<db_id> stationsToUpdate;
 
@@ -236,10 +274,124 @@ private:
 
     EditState editState;
 
+    // Rows of stops and coupling tables for current job
+    struct StopRow
+    {
+        db_id stopId      = 0;
+        db_id stationId   = 0;
+        qint64 arrival    = 0;
+        qint64 departure  = 0;
+        int type          = 0;
+        QString description;
+        db_id inGateConn  = 0;
+        db_id outGateConn = 0;
+        db_id nextSegConn = 0;
+
+        bool operator==(const StopRow &other) const;
+    };
+
+    struct CouplingRow
+    {
+        db_id couplingId = 0;
+        db_id stopId     = 0;
+        db_id rsId       = 0;
+        int operation    = 0;
+    };
+
+    struct JobState
+    {
+        QHash<db_id, StopRow> stops;
+        QHash<db_id, CouplingRow> couplings;
+    };
+
+    // Rows to write to go from a JobState to another
+    struct JobDelta
+    {
+        QVector<db_id> removedCouplings;
+        QVector<CouplingRow> addedCouplings;
+        QVector<db_id> removedStops;
+        QVector<StopRow> addedStops;
+        QVector<StopRow> changedStops;
+        QVector<db_id> retimedStops;
+
+        inline bool isEmpty() const
+        {
+            return removedCouplings.isEmpty() && addedCouplings.isEmpty()
+                   && removedStops.isEmpty() && addedStops.isEmpty() && changedStops.isEmpty();
+        }
+    };
+
+    struct EditStep
+    {
+        JobDelta undo;
+        JobDelta redo;
+    };
+
+    // Keep memory bounded on very long editing sessions
+    static constexpr int MaxUndoSteps = 100;
+
+    // Load all rows of current job or only rows with given ids
+    bool loadJobState(JobState &state, const QSet<db_id> *stopIds = nullptr,
+                      const QSet<db_id> *couplingIds = nullptr);
+    static JobDelta diffJobState(const JobState &from, const JobState &to);
+    static void applyDeltaToState(JobState &state, const JobDelta &delta);
+    bool applyJobDelta(const JobDelta &delta);
+    void markDeltaToUpdate(const JobDelta &delta, const JobState &before);
+    void onRowWritten(const char *table, db_id rowId);
+    void recordUndoStep();
+    bool applyEditStep(bool isUndo);
+
+    void readStopItems(QList<StopItem> &list, int count);
+    bool readStopItem(db_id stopId, StopItem &item);
+    void reloadStopItems();
+
+    void applyDeltaToStopItems(const JobDelta &delta, const QSet<db_id> &couplingStops);
+    void placeStopItem(db_id stopId);
+    void updateStopTypes();
+
+    // State when editing started, used to revert all changes.
+    // Kept in memory so commiting does not need to write a copy of the job.
+    JobState savedState;
+
+    // State after last recorded step, updated with deltas of each step
+    JobState lastState;
+
+    QVector<EditStep> undoSteps;
+    QVector<EditStep> redoSteps;
+    int editStepDepth;
+
+    // Rows written during current edit step, reported by SQLite update hook
+    QSet<db_id> writtenStops;
+    QSet<db_id> writtenCouplings;
+
     bool timeCalcEnabled;
     bool autoInsertTransits;
     bool autoMoveUncoupleToNewLast;
     bool autoUncoupleAtLast;
 };
 
+/*!
+ * \brief The EditStepScope class
+ *
+ * Groups all database changes made while in scope in a single StopModel undo step.
+ * Scopes can be nested, the step is recorded when outermost scope ends.
+ */
+class EditStepScope
+{
+public:
+    EditStepScope(StopModel *m) :
+        model(m)
+    {
+        model->beginEditStep();
+    }
+
+    ~EditStepScope()
+    {
+        model->endEditStep();
+    }
+
+private:
+    StopModel *model;
+};
+
 #endif // STOPMODEL_H
@@ -28,6 +28,7 @@
 #include <QGridLayout>
 
 #include "model/rsproxymodel.h"
+#include "model/rscouplinginterface.h"
 
 #include "utils/rs_utils.h"
 
@@ -52,7 +53,8 @@ RSCoupleDialog::RSCoupleDialog(RSCouplingInterface *mgr, RsOp o, QWidget *parent
     f.setBold(true);
     f.setPointSize(10);
 
-    QListView *engView = new QListView;
+    engView = new QListView;
+    engView->setSelectionMode(QAbstractItemView::ExtendedSelection);
     engView->setModel(engModel);
     QLabel *engLabel = new QLabel(tr("Engines"));
     engLabel->setAlignment(Qt::AlignCenter);
@@ -60,7 +62,8 @@ RSCoupleDialog::RSCoupleDialog(RSCouplingInterface *mgr, RsOp o, QWidget *parent
     lay->addWidget(engLabel, 0, 0);
     lay->addWidget(engView, 1, 0);
 
-    QListView *coachView = new QListView;
+    coachView = new QListView;
+    coachView->setSelectionMode(QAbstractItemView::ExtendedSelection);
     coachView->setModel(coachModel);
     QLabel *coachLabel = new QLabel(tr("Coaches"));
     coachLabel->setAlignment(Qt::AlignCenter);
@@ -68,7 +71,8 @@ RSCoupleDialog::RSCoupleDialog(RSCouplingInterface *mgr, RsOp o, QWidget *parent
     lay->addWidget(coachLabel, 0, 1);
     lay->addWidget(coachView, 1, 1);
 
-    QListView *freightView = new QListView;
+    freightView = new QListView;
+    freightView->setSelectionMode(QAbstractItemView::ExtendedSelection);
     freightView->setModel(freightModel);
     QLabel *freightLabel = new QLabel(tr("Freight Wagons"));
     freightLabel->setAlignment(Qt::AlignCenter);
@@ -86,6 +90,12 @@ RSCoupleDialog::RSCoupleDialog(RSCouplingInterface *mgr, RsOp o, QWidget *parent
     showHideLegendBut = new QPushButton;
     buttonLay->addWidget(showHideLegendBut);
 
+    QPushButton *checkSelectedBut =
+      new QPushButton(op == RsOp::Coupled ? tr("Couple Selected") : tr("Uncouple Selected"));
+    checkSelectedBut->setToolTip(tr("Apply operation to all selected items at once"));
+    buttonLay->addWidget(checkSelectedBut);
+    connect(checkSelectedBut, &QPushButton::clicked, this, &RSCoupleDialog::checkSelected);
+
     QDialogButtonBox *box =
       new QDialogButtonBox(QDialogButtonBox::Ok); // TODO: implement also cancel
     connect(box, &QDialogButtonBox::accepted, this, &QDialog::accept);
@@ -298,6 +308,34 @@ void RSCoupleDialog::toggleLegend()
     setLegendVisible(!m_showLegend);
 }
 
+void RSCoupleDialog::checkSelected()
+{
+    const QModelIndexList engines = engView->selectionModel()->selectedIndexes();
+    const QModelIndexList coaches = coachView->selectionModel()->selectedIndexes();
+    const QModelIndexList freight = freightView->selectionModel()->selectedIndexes();
+
+    // Apply all lists in a single batch so user gets one undo step and one round of questions
+    QVector<db_id> rsIds = engModel->getRsIds(engines);
+    rsIds += coachModel->getRsIds(coaches);
+    rsIds += freightModel->getRsIds(freight);
+
+    if (rsIds.isEmpty())
+        return;
+
+    int count = 0;
+    if (op == RsOp::Coupled) // Traction type is checked only for engines
+        count = couplingMgr->coupleRSBatch(rsIds, true);
+    else
+        count = couplingMgr->uncoupleRSBatch(rsIds);
+
+    if (count == 0)
+        return;
+
+    engModel->updateItems(engines);
+    coachModel->updateItems(coaches);
+    freightModel->updateItems(freight);
+}
+
 void RSCoupleDialog::updateButText()
 {
     showHideLegendBut->setText(m_showLegend ? tr("Hide legend") : tr("Show legend"));
@@ -27,6 +27,7 @@
 class RSCouplingInterface;
 class RSProxyModel;
 class QPushButton;
+class QListView;
 
 namespace sqlite3pp {
 class database;
@@ -47,6 +48,7 @@ protected:
 
 private slots:
     void toggleLegend();
+    void checkSelected();
 
 private:
     void updateButText();
@@ -59,6 +61,10 @@ private:
     RSProxyModel *coachModel;
     RSProxyModel *freightModel;
 
+    QListView *engView;
+    QListView *coachView;
+    QListView *freightView;
+
     QPushButton *showHideLegendBut;
     QWidget *legend;
     bool m_showLegend;
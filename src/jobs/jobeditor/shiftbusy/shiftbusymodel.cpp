@@ -109,12 +109,10 @@ void ShiftBusyModel::loadData(db_id shiftId, db_id jobId, const QTime &start, co
 
     m_shiftName = q.getRows().get<QString>(0);
 
-    q.prepare("SELECT COUNT(jobs.id), MIN(s1.arrival), MAX(s1.departure)"
+    q.prepare("SELECT COUNT(1)"
               " FROM jobs"
-              " JOIN stops s1 ON s1.job_id=jobs.id"
-              " JOIN stops s2 ON s2.job_id=jobs.id"
-              " WHERE jobs.shift_id=? AND s2.departure>? AND s1.arrival<?"
-              " GROUP BY jobs.id");
+              " JOIN job_summary js ON js.job_id=jobs.id"
+              " WHERE jobs.shift_id=? AND js.last_departure>? AND js.first_arrival<?");
     q.bind(1, m_shiftId);
     q.bind(2, m_start);
     q.bind(3, m_end);
@@ -123,13 +121,11 @@ void ShiftBusyModel::loadData(db_id shiftId, db_id jobId, const QTime &start, co
     m_data.reserve(count);
 
     q.prepare("SELECT jobs.id, jobs.category,"
-              " MIN(s1.arrival), MAX(s1.departure)"
+              " js.first_arrival, js.last_departure"
               " FROM jobs"
-              " JOIN stops s1 ON s1.job_id=jobs.id"
-              " JOIN stops s2 ON s2.job_id=jobs.id"
-              " WHERE jobs.shift_id=? AND s2.departure>? AND s1.arrival<?"
-              " GROUP BY jobs.id"
-              " ORDER BY s1.arrival,jobs.id ASC");
+              " JOIN job_summary js ON js.job_id=jobs.id"
+              " WHERE jobs.shift_id=? AND js.last_departure>? AND js.first_arrival<?"
+              " ORDER BY js.first_arrival,jobs.id ASC");
     q.bind(1, m_shiftId);
     q.bind(2, m_start);
     q.bind(3, m_end);
@@ -146,8 +142,8 @@ void ShiftBusyModel::loadData(db_id shiftId, db_id jobId, const QTime &start, co
             continue;
         }
 
-        info.start = j.get<QTime>(3);
-        info.end   = j.get<QTime>(4);
+        info.start = j.get<QTime>(2);
+        info.end   = j.get<QTime>(3);
 
         m_data.append(info);
     }
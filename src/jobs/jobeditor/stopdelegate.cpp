@@ -184,6 +184,21 @@ void StopDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
             painter->drawEllipse(
               QRectF(transitLineX - 12 / 2, rect.top() + rect.height() * 0.4, 12, 12));
         }
+
+        if (model->hasConflictsAt(index.row()))
+        {
+            // Conflicts with other jobs, details are shown in tooltip
+            painter->setPen(QPen(Qt::red, 3));
+            painter->setBrush(Qt::NoBrush);
+            painter->drawRect(QRectF(option.rect).adjusted(1.5, 1.5, -1.5, -1.5));
+
+            const QRectF markRect(left + width - ConflictMarkSize, top, ConflictMarkSize,
+                                  ConflictMarkSize);
+            painter->setBrush(Qt::red);
+            painter->drawEllipse(markRect);
+            painter->setPen(QPen(Qt::white, 3));
+            painter->drawText(markRect, QStringLiteral("!"), QTextOption(Qt::AlignCenter));
+        }
     }
     else if (item.addHere == 1)
     {
@@ -93,6 +93,8 @@ private:
 
     static constexpr int PixWidth          = 35;
     static constexpr int PixHeight         = PixWidth;
+
+    static constexpr int ConflictMarkSize  = 22;
 };
 
 #endif // STOPDELEGATE_H
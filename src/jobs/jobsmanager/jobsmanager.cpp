@@ -37,6 +37,8 @@
 
 #include <QMessageBox>
 #include "newjobsamepathdlg.h"
+#include "jobstimeshiftdlg.h"
+#include "replicatejobdlg.h"
 #include "utils/owningqpointer.h"
 
 JobsManager::JobsManager(QWidget *parent) :
@@ -50,10 +52,12 @@ JobsManager::JobsManager(QWidget *parent) :
     actRemoveJob       = toolBar->addAction(tr("Remove"), this, &JobsManager::onRemove);
     actNewJobSamePath =
       toolBar->addAction(tr("New Same Path"), this, &JobsManager::onNewJobSamePath);
+    actRepeatJob      = toolBar->addAction(tr("Repeat"), this, &JobsManager::onRepeatJob);
     toolBar->addSeparator();
     actEditJob        = toolBar->addAction(tr("Edit"), this, &JobsManager::onEditJob);
     actShowJobInGraph = toolBar->addAction(tr("Show Graph"), this, &JobsManager::onShowJobGraph);
     toolBar->addSeparator();
+    QAction *actMoveJobs  = toolBar->addAction(tr("Move Jobs"), this, &JobsManager::onMoveJobs);
     QAction *actRemoveAll =
       toolBar->addAction(tr("Remove All"), this, &JobsManager::onRemoveAllJobs);
     l->addWidget(toolBar);
@@ -84,9 +88,11 @@ JobsManager::JobsManager(QWidget *parent) :
     actNewJob->setToolTip(tr("Create new Job and open Job Editor"));
     actRemoveJob->setToolTip(tr("Delete selected Job"));
     actNewJobSamePath->setToolTip(tr("Create new Job with same path of selected one"));
+    actRepeatJob->setToolTip(tr("Create many copies of selected Job at fixed interval"));
     actEditJob->setToolTip(tr("Open selected Job in Job Editor.<br>"
                               "<b>You can double click on a row to edit Job.</b>"));
     actShowJobInGraph->setToolTip(tr("Show selected Job in graph"));
+    actMoveJobs->setToolTip(tr("Move all Jobs of a shift or category by some minutes"));
     actRemoveAll->setToolTip(tr("Delete all Jobs of this session"));
 
     setWindowTitle("Jobs Manager");
@@ -138,6 +144,12 @@ void JobsManager::onRemoveAllJobs()
         JobsHelper::removeAllJobs(Session->m_Db);
 }
 
+void JobsManager::onMoveJobs()
+{
+    OwningQPointer<JobsTimeShiftDlg> dlg = new JobsTimeShiftDlg(this);
+    dlg->exec();
+}
+
 void JobsManager::onNewJobSamePath()
 {
     QModelIndex idx = view->currentIndex();
@@ -170,6 +182,23 @@ void JobsManager::onNewJobSamePath()
     Session->getViewManager()->requestJobEditor(newJobId);
 }
 
+void JobsManager::onRepeatJob()
+{
+    QModelIndex idx = view->currentIndex();
+    if (!idx.isValid())
+        return;
+
+    db_id jobId = jobsModel->getIdAtRow(idx.row());
+    if (!jobId)
+        return;
+    JobCategory jobCat                  = jobsModel->getShiftAnCatAtRow(idx.row()).second;
+    auto times                          = jobsModel->getOrigAndDestTimeAtRow(idx.row());
+
+    OwningQPointer<ReplicateJobDlg> dlg = new ReplicateJobDlg(this);
+    dlg->setSourceJob(jobId, jobCat, times.first, times.second);
+    dlg->exec();
+}
+
 void JobsManager::onEditJob()
 {
     editJobAtRow(view->currentIndex());
@@ -197,6 +226,7 @@ void JobsManager::onSelectionChanged()
 
     actRemoveJob->setEnabled(hasSel);
     actNewJobSamePath->setEnabled(hasSel);
+    actRepeatJob->setEnabled(hasSel);
     actEditJob->setEnabled(hasSel);
     actShowJobInGraph->setEnabled(hasSel);
 }
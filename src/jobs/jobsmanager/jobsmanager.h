@@ -37,10 +37,12 @@ private slots:
     void onNewJob();
     void onRemove();
     void onNewJobSamePath();
+    void onRepeatJob();
     void onEditJob();
     void onShowJobGraph();
 
     void onRemoveAllJobs();
+    void onMoveJobs();
 
     void onSelectionChanged();
 
@@ -49,6 +51,7 @@ private:
 
     QAction *actRemoveJob;
     QAction *actNewJobSamePath;
+    QAction *actRepeatJob;
     QAction *actEditJob;
     QAction *actShowJobInGraph;
 
@@ -0,0 +1,109 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "jobstimeshiftdlg.h"
+
+#include "app/session.h"
+#include "viewmanager/viewmanager.h"
+
+#include "model/jobshelper.h"
+
+#include "shifts/shiftcombomodel.h"
+#include "utils/delegates/sql/customcompletionlineedit.h"
+#include "utils/jobcategorystrings.h"
+
+#include <QFormLayout>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QDialogButtonBox>
+
+#include <QMessageBox>
+
+JobsTimeShiftDlg::JobsTimeShiftDlg(QWidget *parent) :
+    QDialog(parent)
+{
+    QFormLayout *lay = new QFormLayout(this);
+
+    ShiftComboModel *shiftComboModel = new ShiftComboModel(Session->m_Db, this);
+    shiftCombo                       = new CustomCompletionLineEdit(shiftComboModel);
+    shiftCombo->setToolTip(tr("Leave empty to move jobs of all shifts and without shift"));
+    lay->addRow(tr("Shift:"), shiftCombo);
+
+    categoryCombo = new QComboBox;
+    categoryCombo->addItem(tr("All categories"), int(JobCategory::NCategories));
+    for (int cat = 0; cat < int(JobCategory::NCategories); cat++)
+        categoryCombo->addItem(JobCategoryName::fullName(JobCategory(cat)), cat);
+    lay->addRow(tr("Category:"), categoryCombo);
+
+    offsetSpin = new QSpinBox;
+    offsetSpin->setRange(-(24 * 60 - 1), 24 * 60 - 1);
+    offsetSpin->setSuffix(tr(" min"));
+    lay->addRow(tr("Move by:"), offsetSpin);
+
+    QDialogButtonBox *box = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    lay->addRow(box);
+
+    connect(box, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(box, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    setMinimumSize(250, 100);
+    setWindowTitle(tr("Move Jobs"));
+}
+
+void JobsTimeShiftDlg::done(int ret)
+{
+    if (ret == QDialog::Accepted && getMinutesOffset() != 0)
+    {
+        // Job Editor must not hold stops we are going to move
+        if (!Session->getViewManager()->requestClearJob(true))
+        {
+            QMessageBox::warning(this, tr("Move Jobs Error"),
+                                 tr("Job Editor is still open, close it before moving jobs."));
+            return; // Give user a chance to save or discard job
+        }
+
+        QString errMsg;
+        if (!JobsHelper::shiftJobsTime(Session->m_Db, getMinutesOffset(), getShiftId(),
+                                       getCategory(), &errMsg))
+        {
+            QMessageBox::warning(this, tr("Move Jobs Error"), errMsg);
+            return; // Give user a chance to change offset
+        }
+    }
+
+    QDialog::done(ret);
+}
+
+int JobsTimeShiftDlg::getMinutesOffset() const
+{
+    return offsetSpin->value();
+}
+
+db_id JobsTimeShiftDlg::getShiftId() const
+{
+    db_id shiftId = 0;
+    QString shiftName;
+    shiftCombo->getData(shiftId, shiftName);
+    return shiftId;
+}
+
+JobCategory JobsTimeShiftDlg::getCategory() const
+{
+    return JobCategory(categoryCombo->currentData().toInt());
+}
@@ -0,0 +1,49 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef JOBSTIMESHIFTDLG_H
+#define JOBSTIMESHIFTDLG_H
+
+#include <QDialog>
+
+#include "utils/types.h"
+
+class QComboBox;
+class QSpinBox;
+class CustomCompletionLineEdit;
+
+class JobsTimeShiftDlg : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit JobsTimeShiftDlg(QWidget *parent = nullptr);
+
+    void done(int ret) override;
+
+    int getMinutesOffset() const;
+    db_id getShiftId() const;
+    JobCategory getCategory() const;
+
+private:
+    CustomCompletionLineEdit *shiftCombo;
+    QComboBox *categoryCombo;
+    QSpinBox *offsetSpin;
+};
+
+#endif // JOBSTIMESHIFTDLG_H
@@ -200,16 +200,16 @@ qint64 JobListModel::recalcTotalItemCount()
     return count;
 }
 
-void JobListModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData)
+void JobListModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData,
+                              const QVariantList &seekKey)
 {
     QByteArray sql;
     if (fullData)
     {
         sql = "SELECT jobs.id, jobs.category, jobs.shift_id, jobshifts.name,"
-              "MIN(s1.departure), s1.station_id, MAX(s2.arrival), s2.station_id"
+              "js.first_departure, js.first_station_id, js.last_arrival, js.last_station_id"
               " FROM jobs"
-              " LEFT JOIN stops s1 ON s1.job_id=jobs.id"
-              " LEFT JOIN stops s2 ON s2.job_id=jobs.id";
+              " LEFT JOIN job_summary js ON js.job_id=jobs.id";
     }
     else
     {
@@ -225,7 +225,10 @@ void JobListModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool
 
     if (!m_jobIdFilter.isEmpty())
     {
-        sql.append(" WHERE jobs.id LIKE ?3");
+        if (Session->hasFullTextIndex())
+            sql.append(" WHERE jobs.id IN (SELECT rowid FROM jobs_fts WHERE id LIKE ?3)");
+        else
+            sql.append(" WHERE jobs.id LIKE ?3");
         whereClauseAdded = true;
     }
 
@@ -240,44 +243,49 @@ void JobListModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool
             sql.append("jobs.shift_id IS NULL");
         else
             sql.append("jobshifts.name LIKE ?4");
+
+        whereClauseAdded = true;
     }
 
-    if (fullData)
+    // Sorting, last column is unique so it can be used for keyset pagination
+    const char *sortColExpr = nullptr;
+    switch (sortCol)
     {
-        // Group by Job
-        sql.append(" GROUP BY jobs.id");
+    case IdCol:
+    {
+        sortColExpr = "jobs.id"; // Order by 1 column, seek key has 1 value
+        break;
+    }
+    case Category:
+    {
+        sortColExpr = "jobs.category,jobs.id";
+        break;
+    }
+    case ShiftCol:
+    {
+        sortColExpr = "jobshifts.name,js.first_departure,jobs.id";
+        break;
+    }
+    case OriginTime:
+    {
+        sortColExpr = "js.first_departure,jobs.id";
+        break;
+    }
+    case DestinationTime:
+    {
+        sortColExpr = "js.last_arrival,jobs.id";
+        break;
+    }
+    }
 
-        // Apply sorting
-        const char *sortColExpr = nullptr;
-        switch (sortCol)
-        {
-        case IdCol:
-        {
-            sortColExpr = "jobs.id"; // Order by 1 column, no where clause
-            break;
-        }
-        case Category:
-        {
-            sortColExpr = "jobs.category,jobs.id";
-            break;
-        }
-        case ShiftCol:
-        {
-            sortColExpr = "jobshifts.name,s1.departure,jobs.id";
-            break;
-        }
-        case OriginTime:
-        {
-            sortColExpr = "s1.departure,jobs.id";
-            break;
-        }
-        case DestinationTime:
-        {
-            sortColExpr = "s2.arrival,jobs.id";
-            break;
-        }
-        }
+    if (fullData && !seekKey.isEmpty())
+    {
+        sql += whereClauseAdded ? " AND " : " WHERE ";
+        sql += seekCondition(sortColExpr, 5);
+    }
 
+    if (fullData)
+    {
         sql += " ORDER BY ";
         sql += sortColExpr;
 
@@ -294,6 +302,9 @@ void JobListModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool
         q.bind(1, BatchSize);
         if (offset)
             q.bind(2, offset);
+
+        if (!seekKey.isEmpty())
+            bindSeekKey(q, 5, seekKey);
     }
 
     // Apply filters
@@ -318,16 +329,20 @@ void JobListModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool
     }
 }
 
-void JobListModel::internalFetch(int first, int sortCol, int /*valRow*/, const QVariant & /*val*/)
+void JobListModel::internalFetch(int first, int sortCol, int valRow, const QVariant &val)
 {
     query q(mDb);
 
     query q_stationName(mDb, "SELECT name FROM stations WHERE id=?");
 
-    int offset = first + curPage * ItemsPerPage;
+    // Seek from key if available, skip only rows between key and first
+    const QVariantList seekKey = val.toList();
+    int offset                 = first + curPage * ItemsPerPage;
+    if (!seekKey.isEmpty())
+        offset = first - valRow;
 
-    qDebug() << "Fetching:" << first << "Offset:" << offset;
-    buildQuery(q, sortCol, offset, true);
+    qDebug() << "Fetching:" << first << "Offset:" << offset << "Seek:" << seekKey;
+    buildQuery(q, sortCol, offset, true, seekKey);
 
     QList<JobItem> vec(BatchSize);
 
@@ -399,3 +414,26 @@ void JobListModel::internalFetch(int first, int sortCol, int /*valRow*/, const Q
 
     postResult(vec, first);
 }
+
+QVariantList JobListModel::getSeekKey(const JobItem &item, int sortCol) const
+{
+    // Jobs without stops have NULL times, invalid QVariant means NULL
+    const QVariant originTime = item.originStId ? QVariant(item.originTime) : QVariant();
+    const QVariant destTime   = item.destStId ? QVariant(item.destTime) : QVariant();
+
+    switch (sortCol)
+    {
+    case IdCol:
+        return {item.jobId};
+    case Category:
+        return {int(item.category), item.jobId};
+    case ShiftCol:
+        return {item.shiftId ? QVariant(item.shiftName) : QVariant(), originTime, item.jobId};
+    case OriginTime:
+        return {originTime, item.jobId};
+    case DestinationTime:
+        return {destTime, item.jobId};
+    }
+
+    return QVariantList();
+}
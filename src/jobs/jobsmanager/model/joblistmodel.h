@@ -122,8 +122,10 @@ protected:
 
 private:
     friend BaseClass;
-    void buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData);
+    void buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData,
+                    const QVariantList &seekKey = QVariantList());
     Q_INVOKABLE void internalFetch(int first, int sortColumn, int valRow, const QVariant &val);
+    QVariantList getSeekKey(const JobItem &item, int sortCol) const;
 
 private:
     QString m_jobIdFilter;
@@ -22,6 +22,7 @@
 #include "utils/jobcategorystrings.h"
 
 #include "app/session.h"
+#include "utils/delegates/sql/completionindex.h"
 
 JobMatchModel::JobMatchModel(database &db, QObject *parent) :
     ISqlFKMatchModel(parent),
@@ -123,6 +124,7 @@ QVariant JobMatchModel::data(const QModelIndex &idx, int role) const
 
 void JobMatchModel::autoSuggest(const QString &text)
 {
+    mText = text;
     mQuery.clear();
     if (!text.isEmpty())
     {
@@ -140,6 +142,38 @@ void JobMatchModel::refreshData()
     if (!mDb.db())
         return;
 
+    // Stop station filter needs stops table, query database in that case
+    if (!m_stopStationId && &mDb == &Session->m_Db)
+    {
+        QVector<CompletionIndex::Entry> matches;
+        if (Session->getCompletionIndex()->findMatches(CompletionIndex::Jobs, mText,
+                                                       MaxMatchItems, m_exceptJobId, matches))
+        {
+            beginResetModel();
+
+            const int count = qMin(int(matches.size()), MaxMatchItems);
+            for (int i = 0; i < count; i++)
+            {
+                items[i].stop.jobId    = matches.at(i).id;
+                items[i].stop.category = matches.at(i).category;
+                items[i].stop.stopId   = 0;
+                items[i].stopArrival   = QTime();
+            }
+
+            size = count;
+            if (hasEmptyRow)
+                size++; // Items + Empty, add 1 row
+
+            if (matches.size() > MaxMatchItems)
+                size++; // Items + Empty + Ellispses
+
+            endResetModel();
+
+            emit resultsReady(false);
+            return;
+        }
+    }
+
     beginResetModel();
 
     char emptyQuery = '%';
@@ -247,7 +281,10 @@ void JobMatchModel::setFilter(db_id exceptJobId, db_id stopsInStationId, const Q
 
     // Filter by name (job ID number)
     // FIXME: filter also by category with regexp
-    sql += " jobs.id LIKE ?1";
+    if (Session->hasFullTextIndex())
+        sql += " jobs.id IN (SELECT rowid FROM jobs_fts WHERE id LIKE ?1)";
+    else
+        sql += " jobs.id LIKE ?1";
 
     sql += " ORDER BY ";
     if (m_stopStationId)
@@ -96,6 +96,7 @@ private:
     QTime m_maxStopArrival;
     DefaultId m_defaultId;
 
+    QString mText;
     QByteArray mQuery;
 
     QFont m_font;
@@ -24,6 +24,25 @@
 #include <sqlite3pp/sqlite3pp.h>
 
 #include <QDebug>
+#include <QHash>
+
+#include "utils/jobcategorystrings.h"
+
+#include <QCoreApplication>
+
+// Error messages
+class JobsHelperStrings
+{
+    Q_DECLARE_TR_FUNCTIONS(JobsHelperStrings)
+};
+
+static constexpr char errorShiftPastMidnightText[] =
+  QT_TRANSLATE_NOOP("JobsHelperStrings",
+                    "Job <b>%1</b> would start before or end after midnight.<br>"
+                    "No job was moved.");
+
+static constexpr char errorShiftDatabaseText[] =
+  QT_TRANSLATE_NOOP("JobsHelperStrings", "Database error while moving jobs: %1");
 
 bool JobsHelper::createNewJob(sqlite3pp::database &db, db_id &outJobId, JobCategory cat)
 {
@@ -74,9 +93,7 @@ bool JobsHelper::removeJob(sqlite3pp::database &db, db_id jobId)
 
     // Get stations in which job stopped or transited
     QSet<db_id> stationsToUpdate;
-    q.prepare("SELECT station_id FROM stops WHERE job_id=?"
-              " UNION "
-              "SELECT station_id FROM old_stops WHERE job_id=?");
+    q.prepare("SELECT station_id FROM stops WHERE job_id=?");
     q.bind(1, jobId);
     for (auto st : q)
     {
@@ -86,11 +103,7 @@ bool JobsHelper::removeJob(sqlite3pp::database &db, db_id jobId)
     // Get Rollingstock used by job
     QSet<db_id> rsToUpdate;
     q.prepare("SELECT coupling.rs_id FROM stops JOIN coupling ON coupling.stop_id=stops.id"
-              " WHERE stops.job_id=?"
-              " UNION "
-              "SELECT old_coupling.rs_id FROM old_stops JOIN old_coupling ON "
-              "old_coupling.stop_id=old_stops.id"
-              " WHERE old_stops.job_id=?");
+              " WHERE stops.job_id=?");
     q.bind(1, jobId);
     for (auto rs : q)
     {
@@ -106,15 +119,6 @@ bool JobsHelper::removeJob(sqlite3pp::database &db, db_id jobId)
     int ret = q.step();
     q.reset();
 
-    if (ret == SQLITE_OK || ret == SQLITE_DONE)
-    {
-        // Remove possible left over from editing
-        q.prepare("DELETE FROM old_stops WHERE job_id=?");
-        q.bind(1, jobId);
-        ret = q.step();
-        q.reset();
-    }
-
     if (ret == SQLITE_OK || ret == SQLITE_DONE)
     {
         q.prepare("DELETE FROM jobs WHERE id=?");
@@ -148,15 +152,7 @@ bool JobsHelper::removeJob(sqlite3pp::database &db, db_id jobId)
 
 bool JobsHelper::removeAllJobs(sqlite3pp::database &db)
 {
-    // Old
-    sqlite3pp::command cmd(db, "DELETE FROM old_coupling");
-    cmd.execute();
-
-    cmd.prepare("DELETE FROM old_stops");
-    cmd.execute();
-
-    // Current
-    cmd.prepare("DELETE FROM coupling");
+    sqlite3pp::command cmd(db, "DELETE FROM coupling");
     cmd.execute();
 
     cmd.prepare("DELETE FROM stops");
@@ -320,6 +316,409 @@ bool JobsHelper::copyStops(sqlite3pp::database &db, db_id fromJobId, db_id toJob
     return true;
 }
 
+bool JobsHelper::replicateJob(sqlite3pp::database &db, const JobReplicaPattern &pattern,
+                              QVector<db_id> *outJobIds, int *outSkipped)
+{
+    if (outSkipped)
+        *outSkipped = 0;
+
+    if (!pattern.templateJobId || pattern.intervalMinutes <= 0 || !pattern.firstStart.isValid()
+        || !pattern.lastStart.isValid())
+        return false;
+
+    struct TemplateStop
+    {
+        db_id stationId   = 0;
+        int arrival       = 0;
+        int departure     = 0;
+        int type          = 0;
+        QString description;
+        db_id inGateConn  = 0;
+        db_id outGateConn = 0;
+        db_id nextSegConn = 0;
+    };
+
+    struct TemplateCoupling
+    {
+        int stopIdx = 0;
+        db_id rsId  = 0;
+        int op      = 0;
+    };
+
+    // Read template job only once
+    sqlite3pp::query q(db, "SELECT category FROM jobs WHERE id=?");
+    q.bind(1, pattern.templateJobId);
+    if (q.step() != SQLITE_ROW)
+        return false;
+    const JobCategory cat = JobCategory(q.getRows().get<int>(0));
+
+    QVector<TemplateStop> stops;
+    QHash<db_id, int> stopIdxMap;
+
+    QSet<db_id> stationsToUpdate;
+    QSet<db_id> rsToUpdate;
+
+    q.prepare("SELECT id,station_id,arrival,departure,type,"
+              "description,in_gate_conn,out_gate_conn,next_segment_conn_id"
+              " FROM stops WHERE job_id=? ORDER BY arrival ASC");
+    q.bind(1, pattern.templateJobId);
+    for (auto stop : q)
+    {
+        TemplateStop item;
+        db_id stopId   = stop.get<db_id>(0);
+        item.stationId = stop.get<db_id>(1);
+        item.arrival   = stop.get<int>(2);
+        item.departure = stop.get<int>(3);
+        item.type      = stop.get<int>(4);
+        if (stop.column_type(5) != SQLITE_NULL)
+            item.description = stop.get<QString>(5);
+        item.inGateConn  = stop.get<db_id>(6);
+        item.outGateConn = stop.get<db_id>(7);
+        item.nextSegConn = stop.get<db_id>(8);
+
+        stopIdxMap.insert(stopId, stops.size());
+        stops.append(item);
+
+        if (item.stationId)
+            stationsToUpdate.insert(item.stationId);
+    }
+
+    if (stops.isEmpty())
+        return false;
+
+    QVector<TemplateCoupling> couplings;
+    if (pattern.copyRsOps)
+    {
+        q.prepare("SELECT coupling.stop_id,coupling.rs_id,coupling.operation FROM coupling"
+                  " JOIN stops ON stops.id=coupling.stop_id"
+                  " WHERE stops.job_id=? ORDER BY stops.arrival");
+        q.bind(1, pattern.templateJobId);
+        for (auto c : q)
+        {
+            TemplateCoupling item;
+            item.stopIdx = stopIdxMap.value(c.get<db_id>(0));
+            item.rsId    = c.get<db_id>(1);
+            item.op      = c.get<int>(2);
+            couplings.append(item);
+
+            rsToUpdate.insert(item.rsId);
+        }
+    }
+    q.finish();
+
+    const int templateStart = stops.first().arrival;
+    const int templateEnd   = stops.last().departure;
+    const int firstStart    = pattern.firstStart.msecsSinceStartOfDay() / 60000;
+    const int lastStart     = pattern.lastStart.msecsSinceStartOfDay() / 60000;
+    const int jobIdStep     = qMax(1, pattern.jobIdStep);
+
+    sqlite3pp::command q_newJob(db, "INSERT INTO jobs(id,category,shift_id) VALUES(?,?,NULL)");
+    sqlite3pp::query q_idInUse(db, "SELECT 1 FROM jobs WHERE id=?");
+    sqlite3pp::command q_newStop(db, "INSERT INTO stops(id,job_id,station_id,arrival,departure,"
+                                     "type,description,in_gate_conn,out_gate_conn,"
+                                     "next_segment_conn_id)"
+                                     " VALUES(NULL,?,?,?,?,?,?,?,?,?)");
+    sqlite3pp::command q_newCoupling(db, "INSERT INTO coupling(id,stop_id,rs_id,operation)"
+                                         " VALUES(NULL,?,?,?)");
+
+    // Same overlap condition used by JobCrossingTask
+    sqlite3pp::query q_segmentBusy(db, "SELECT s.id FROM stops s"
+                                       " JOIN stops s_next ON s_next.job_id=s.job_id"
+                                       " AND s_next.arrival>s.arrival"
+                                       " WHERE s.next_segment_conn_id=?1"
+                                       " GROUP BY s.id"
+                                       " HAVING s.departure<=?3 AND MIN(s_next.arrival)>=?2"
+                                       " LIMIT 1");
+
+    auto bindId = [](sqlite3pp::command &cmd, int idx, db_id id)
+    {
+        if (id)
+            cmd.bind(idx, id);
+        else
+            cmd.bind(idx); // Bind NULL
+    };
+
+    auto isSegmentBusy = [&stops, &q_segmentBusy](int offset) -> bool
+    {
+        for (int i = 0; i < stops.size() - 1; i++)
+        {
+            const TemplateStop &item = stops.at(i);
+            if (!item.nextSegConn)
+                continue;
+
+            q_segmentBusy.bind(1, item.nextSegConn);
+            q_segmentBusy.bind(2, item.departure + offset);
+            q_segmentBusy.bind(3, stops.at(i + 1).arrival + offset);
+            const bool busy = q_segmentBusy.step() == SQLITE_ROW;
+            q_segmentBusy.reset();
+
+            if (busy)
+                return true;
+        }
+        return false;
+    };
+
+    sqlite3_mutex *mutex = sqlite3_db_mutex(db.db());
+
+    QVector<db_id> newJobIds;
+    int skipped     = 0;
+    db_id nextJobId = pattern.firstJobId;
+    int ret         = SQLITE_OK;
+
+    sqlite3pp::transaction t(db);
+
+    for (int start = firstStart; start <= lastStart; start += pattern.intervalMinutes)
+    {
+        const int offset = start - templateStart;
+        if (templateEnd + offset >= 24 * 60)
+            break; // Next copies would end past midnight
+
+        // Newly created copies are already in database so they are checked too
+        if (pattern.skipConflicts && isSegmentBusy(offset))
+        {
+            skipped++;
+            continue;
+        }
+
+        if (nextJobId)
+        {
+            // Skip numbers already in use
+            while (true)
+            {
+                q_idInUse.bind(1, nextJobId);
+                const bool inUse = q_idInUse.step() == SQLITE_ROW;
+                q_idInUse.reset();
+                if (!inUse)
+                    break;
+                nextJobId += jobIdStep;
+            }
+
+            q_newJob.bind(1, nextJobId);
+            nextJobId += jobIdStep;
+        }
+        else
+        {
+            q_newJob.bind(1); // Bind NULL, get arbitrary free ID
+        }
+        q_newJob.bind(2, int(cat));
+
+        sqlite3_mutex_enter(mutex);
+        ret         = q_newJob.execute();
+        db_id jobId = db.last_insert_rowid();
+        sqlite3_mutex_leave(mutex);
+        q_newJob.reset();
+
+        if (ret != SQLITE_OK)
+            break;
+
+        QVector<db_id> newStopIds;
+        newStopIds.reserve(stops.size());
+
+        for (const TemplateStop &item : std::as_const(stops))
+        {
+            q_newStop.bind(1, jobId);
+            bindId(q_newStop, 2, item.stationId);
+            q_newStop.bind(3, item.arrival + offset);
+            q_newStop.bind(4, item.departure + offset);
+            q_newStop.bind(5, item.type);
+            if (item.description.isNull())
+                q_newStop.bind(6);
+            else
+                q_newStop.bind(6, item.description);
+            bindId(q_newStop, 7, item.inGateConn);
+            bindId(q_newStop, 8, item.outGateConn);
+            bindId(q_newStop, 9, item.nextSegConn);
+
+            sqlite3_mutex_enter(mutex);
+            ret          = q_newStop.execute();
+            db_id stopId = db.last_insert_rowid();
+            sqlite3_mutex_leave(mutex);
+            q_newStop.reset();
+
+            if (ret != SQLITE_OK)
+                break;
+            newStopIds.append(stopId);
+        }
+
+        for (int i = 0; ret == SQLITE_OK && i < couplings.size(); i++)
+        {
+            const TemplateCoupling &c = couplings.at(i);
+            q_newCoupling.bind(1, newStopIds.at(c.stopIdx));
+            q_newCoupling.bind(2, c.rsId);
+            q_newCoupling.bind(3, c.op);
+            ret = q_newCoupling.execute();
+            q_newCoupling.reset();
+        }
+
+        if (ret != SQLITE_OK)
+            break;
+
+        newJobIds.append(jobId);
+    }
+
+    if (ret != SQLITE_OK)
+    {
+        qWarning() << "JobsHelper::replicateJob() error:" << ret << db.error_msg()
+                   << db.extended_error_code() << "Template:" << pattern.templateJobId;
+        t.rollback();
+        return false;
+    }
+
+    ret = t.commit();
+    if (ret != SQLITE_OK)
+    {
+        qWarning() << "JobsHelper::replicateJob() cannot commit:" << ret << db.error_msg();
+        return false;
+    }
+
+    if (outJobIds)
+        *outJobIds = newJobIds;
+    if (outSkipped)
+        *outSkipped = skipped;
+
+    if (newJobIds.isEmpty())
+        return true;
+
+    // Zero job ID means many jobs were added, views reload once
+    emit Session->jobAdded(0);
+
+    // Refresh graphs and station views
+    emit Session->stationJobsPlanChanged(stationsToUpdate);
+
+    // Refresh Rollingstock views
+    emit Session->rollingStockPlanChanged(rsToUpdate);
+
+    return true;
+}
+
+bool JobsHelper::shiftJobsTime(sqlite3pp::database &db, int minutesOffset, db_id shiftId,
+                               JobCategory cat, QString *errOut)
+{
+    if (minutesOffset == 0)
+        return true;
+
+    // All statements share the same job filter so they operate on the whole set at once
+    QByteArray jobFilter = "SELECT id FROM jobs WHERE 1";
+    if (shiftId)
+        jobFilter += " AND shift_id=?2";
+    if (cat != JobCategory::NCategories)
+        jobFilter += " AND category=?3";
+
+    auto bindFilter = [shiftId, cat](auto &q)
+    {
+        if (shiftId)
+            q.bind(2, shiftId);
+        if (cat != JobCategory::NCategories)
+            q.bind(3, int(cat));
+    };
+
+    // Check all jobs stay in the same day before touching anything.
+    // UNIQUE(job_id,arrival) and UNIQUE(job_id,departure) cannot be violated by the result
+    // because all stops of a job are moved by the same amount.
+    QByteArray sql = "SELECT stops.job_id, jobs.category FROM stops"
+                     " JOIN jobs ON jobs.id=stops.job_id"
+                     " WHERE stops.job_id IN ("
+                     + jobFilter
+                     + ") GROUP BY stops.job_id"
+                       " HAVING MIN(stops.arrival)+?1<0 OR MAX(stops.departure)+?1>=1440"
+                       " LIMIT 1";
+    sqlite3pp::query q(db, sql.constData());
+    q.bind(1, minutesOffset);
+    bindFilter(q);
+    if (q.step() == SQLITE_ROW)
+    {
+        auto r = q.getRows();
+        if (errOut)
+            *errOut = JobsHelperStrings::tr(errorShiftPastMidnightText)
+                        .arg(JobCategoryName::jobName(r.get<db_id>(0), JobCategory(r.get<int>(1))));
+        return false;
+    }
+
+    // Collect views to update
+    QSet<db_id> stationsToUpdate;
+    QSet<db_id> rsToUpdate;
+    QSet<db_id> shiftsToUpdate;
+
+    sql = "SELECT DISTINCT station_id FROM stops WHERE station_id IS NOT NULL AND job_id IN ("
+          + jobFilter + ")";
+    q.prepare(sql.constData());
+    bindFilter(q);
+    for (auto st : q)
+        stationsToUpdate.insert(st.get<db_id>(0));
+
+    sql = "SELECT DISTINCT coupling.rs_id FROM coupling"
+          " JOIN stops ON stops.id=coupling.stop_id"
+          " WHERE stops.job_id IN ("
+          + jobFilter + ")";
+    q.prepare(sql.constData());
+    bindFilter(q);
+    for (auto rs : q)
+        rsToUpdate.insert(rs.get<db_id>(0));
+
+    sql = "SELECT DISTINCT shift_id FROM jobs WHERE shift_id IS NOT NULL AND id IN (" + jobFilter
+          + ")";
+    q.prepare(sql.constData());
+    bindFilter(q);
+    for (auto shift : q)
+        shiftsToUpdate.insert(shift.get<db_id>(0));
+    q.finish();
+
+    // Move stops to next day first so intermediate values never collide with times of
+    // other stops of same job which are not updated yet, then bring them back.
+    // See StopModel::shiftStopsBy24hoursFrom()
+    constexpr int TwoDays = 2 * 24 * 60;
+
+    sqlite3pp::transaction t(db);
+
+    sql = "UPDATE stops SET arrival=arrival+?1, departure=departure+?1 WHERE job_id IN ("
+          + jobFilter + ")";
+    sqlite3pp::command cmd(db, sql.constData());
+    cmd.bind(1, minutesOffset + TwoDays);
+    bindFilter(cmd);
+    int ret = cmd.execute();
+
+    if (ret == SQLITE_OK)
+    {
+        cmd.reset();
+        cmd.bind(1, -TwoDays);
+        bindFilter(cmd);
+        ret = cmd.execute();
+    }
+
+    if (ret != SQLITE_OK)
+    {
+        qWarning() << "JobsHelper::shiftJobsTime() error:" << ret << db.error_msg()
+                   << db.extended_error_code();
+        if (errOut)
+            *errOut = JobsHelperStrings::tr(errorShiftDatabaseText).arg(db.error_msg());
+        t.rollback();
+        return false;
+    }
+
+    ret = t.commit();
+    if (ret != SQLITE_OK)
+    {
+        qWarning() << "JobsHelper::shiftJobsTime() cannot commit:" << ret << db.error_msg();
+        if (errOut)
+            *errOut = JobsHelperStrings::tr(errorShiftDatabaseText).arg(db.error_msg());
+        return false;
+    }
+
+    // Zero job ID means many jobs changed, views reload once
+    emit Session->jobChanged(0, 0);
+
+    for (db_id id : std::as_const(shiftsToUpdate))
+        emit Session->shiftJobsChanged(id, 0);
+
+    // Refresh graphs and station views
+    emit Session->stationJobsPlanChanged(stationsToUpdate);
+
+    // Refresh Rollingstock views
+    emit Session->rollingStockPlanChanged(rsToUpdate);
+
+    return true;
+}
+
 bool JobsHelper::checkShiftsExist(sqlite3pp::database &db)
 {
     query q(db, "SELECT id FROM jobshifts LIMIT 1");
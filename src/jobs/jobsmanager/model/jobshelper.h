@@ -23,11 +23,38 @@
 #include "utils/types.h"
 #include "stations/station_utils.h"
 
+#include <QTime>
+#include <QVector>
+
 namespace sqlite3pp {
 class database;
 class query;
 } // namespace sqlite3pp
 
+/*!
+ * \brief The JobReplicaPattern struct
+ *
+ * Describes copies of a template job departing at fixed interval.
+ * Copies start from \a firstStart and continue until \a lastStart (included).
+ */
+struct JobReplicaPattern
+{
+    db_id templateJobId = 0;
+    QTime firstStart;
+    QTime lastStart;
+    int intervalMinutes = 0;
+
+    // Job number of first copy, next are incremented by jobIdStep.
+    // Numbers already in use are skipped. Zero means arbitrary free numbers
+    db_id firstJobId = 0;
+    int jobIdStep    = 1;
+
+    bool copyRsOps   = false;
+
+    // Do not create copies which travel on a segment already occupied at same time
+    bool skipConflicts = false;
+};
+
 class JobsHelper
 {
 public:
@@ -50,6 +77,36 @@ public:
     static bool copyStops(sqlite3pp::database &db, db_id fromJobId, db_id toJobId, int secsOffset,
                           bool copyRsOps, bool reversePath);
 
+    /*!
+     * \brief shiftJobsTime
+     * \param db open database connection
+     * \param minutesOffset minutes to add to all stops, can be negative
+     * \param shiftId if non zero, only jobs of this shift are moved
+     * \param cat if not NCategories, only jobs of this category are moved
+     * \param errOut if not null, receives reason of failure
+     * \return true on success
+     *
+     * Moves all stops of matching jobs in a single transaction.
+     * Nothing is changed if any job would end up past midnight.
+     * Views are notified once for all jobs, jobChanged() is emitted with zero job ID.
+     */
+    static bool shiftJobsTime(sqlite3pp::database &db, int minutesOffset, db_id shiftId,
+                              JobCategory cat, QString *errOut = nullptr);
+
+    /*!
+     * \brief replicateJob
+     * \param db open database connection
+     * \param pattern template job and departure times
+     * \param outJobIds if not null, receives IDs of created jobs
+     * \param outSkipped if not null, receives number of copies skipped due to conflicts
+     * \return true on success
+     *
+     * Template job is read once and all copies are inserted in a single transaction.
+     * Copies which would end past midnight are not created.
+     */
+    static bool replicateJob(sqlite3pp::database &db, const JobReplicaPattern &pattern,
+                             QVector<db_id> *outJobIds = nullptr, int *outSkipped = nullptr);
+
     static bool checkShiftsExist(sqlite3pp::database &db);
 };
 
@@ -0,0 +1,164 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "replicatejobdlg.h"
+
+#include "app/session.h"
+#include "model/jobshelper.h"
+
+#include "utils/jobcategorystrings.h"
+
+#include <QFormLayout>
+#include <QLabel>
+#include <QCheckBox>
+#include <QTimeEdit>
+#include <QSpinBox>
+#include <QDialogButtonBox>
+
+#include <QMessageBox>
+
+ReplicateJobDlg::ReplicateJobDlg(QWidget *parent) :
+    QDialog(parent)
+{
+    QFormLayout *lay = new QFormLayout(this);
+    label            = new QLabel;
+    label->setTextFormat(Qt::RichText);
+    label->setWordWrap(true);
+    lay->addRow(label);
+
+    firstStartEdit = new QTimeEdit;
+    lay->addRow(tr("First departure:"), firstStartEdit);
+
+    lastStartEdit = new QTimeEdit;
+    lay->addRow(tr("Last departure:"), lastStartEdit);
+
+    intervalSpin = new QSpinBox;
+    intervalSpin->setRange(1, 24 * 60 - 1);
+    intervalSpin->setValue(30);
+    intervalSpin->setSuffix(tr(" min"));
+    lay->addRow(tr("Interval:"), intervalSpin);
+
+    firstJobIdSpin = new QSpinBox;
+    firstJobIdSpin->setRange(0, 999999);
+    firstJobIdSpin->setSpecialValueText(tr("Automatic"));
+    firstJobIdSpin->setToolTip(tr("Number of first copy. Numbers already in use are skipped."));
+    lay->addRow(tr("First job number:"), firstJobIdSpin);
+
+    jobIdStepSpin = new QSpinBox;
+    jobIdStepSpin->setRange(1, 1000);
+    jobIdStepSpin->setValue(2);
+    lay->addRow(tr("Number increment:"), jobIdStepSpin);
+
+    copyRsCheck = new QCheckBox(tr("Copy Rollingstock items"));
+    copyRsCheck->setChecked(false); // Same rollingstock cannot be on many jobs at same time
+    lay->addRow(copyRsCheck);
+
+    skipConflictsCheck = new QCheckBox(tr("Skip copies occupying a busy segment"));
+    skipConflictsCheck->setChecked(true);
+    lay->addRow(skipConflictsCheck);
+
+    countLabel = new QLabel;
+    lay->addRow(countLabel);
+
+    QDialogButtonBox *box = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    lay->addRow(box);
+
+    connect(box, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(box, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    connect(firstStartEdit, &QTimeEdit::timeChanged, this, &ReplicateJobDlg::updateCopiesCount);
+    connect(lastStartEdit, &QTimeEdit::timeChanged, this, &ReplicateJobDlg::updateCopiesCount);
+    connect(intervalSpin, qOverload<int>(&QSpinBox::valueChanged), this,
+            &ReplicateJobDlg::updateCopiesCount);
+
+    setMinimumSize(300, 200);
+    setWindowTitle(tr("Repeat Job"));
+}
+
+void ReplicateJobDlg::setSourceJob(db_id jobId, JobCategory cat, const QTime &start,
+                                   const QTime &end)
+{
+    sourceJobId  = jobId;
+    sourceJobCat = cat;
+    sourceStart  = start;
+    sourceEnd    = end;
+
+    label->setText(tr("Create copies of <b>%1</b> departing at fixed interval.<br>"
+                      "Original job starts at <b>%2</b> and ends at <b>%3</b>.")
+                     .arg(JobCategoryName::jobName(sourceJobId, sourceJobCat),
+                          sourceStart.toString("HH:mm"), sourceEnd.toString("HH:mm")));
+
+    firstStartEdit->setTime(sourceStart.addSecs(intervalSpin->value() * 60));
+
+    // Go back from midnight to get maximum start value
+    const int travelDurationSecs = sourceStart.secsTo(sourceEnd);
+    lastStartEdit->setTime(QTime(23, 59).addSecs(-travelDurationSecs));
+
+    updateCopiesCount();
+}
+
+void ReplicateJobDlg::done(int ret)
+{
+    if (ret == QDialog::Accepted)
+    {
+        QVector<db_id> jobIds;
+        int skipped = 0;
+        if (!JobsHelper::replicateJob(Session->m_Db, getPattern(), &jobIds, &skipped))
+        {
+            QMessageBox::warning(this, tr("Repeat Job Error"),
+                                 tr("Could not create copies of job. See log for details."));
+            return;
+        }
+
+        QMessageBox::information(this, tr("Repeat Job"),
+                                 tr("Created %1 copies, %2 skipped because of busy segments.")
+                                   .arg(jobIds.size())
+                                   .arg(skipped));
+    }
+
+    QDialog::done(ret);
+}
+
+JobReplicaPattern ReplicateJobDlg::getPattern() const
+{
+    JobReplicaPattern pattern;
+    pattern.templateJobId   = sourceJobId;
+    pattern.firstStart      = firstStartEdit->time();
+    pattern.lastStart       = lastStartEdit->time();
+    pattern.intervalMinutes = intervalSpin->value();
+    pattern.firstJobId      = firstJobIdSpin->value();
+    pattern.jobIdStep       = jobIdStepSpin->value();
+    pattern.copyRsOps       = copyRsCheck->isChecked();
+    pattern.skipConflicts   = skipConflictsCheck->isChecked();
+    return pattern;
+}
+
+void ReplicateJobDlg::updateCopiesCount()
+{
+    const int travelDurationSecs = sourceStart.secsTo(sourceEnd);
+    const QTime lastValidStart   = QTime(23, 59).addSecs(-travelDurationSecs);
+
+    QTime lastStart              = lastStartEdit->time();
+    if (lastStart > lastValidStart)
+        lastStart = lastValidStart; // Copies past midnight are not created
+
+    const int spanMins = firstStartEdit->time().secsTo(lastStart) / 60;
+    const int count    = spanMins < 0 ? 0 : spanMins / intervalSpin->value() + 1;
+    countLabel->setText(tr("Up to %1 copies will be created.").arg(count));
+}
@@ -0,0 +1,67 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef REPLICATEJOBDLG_H
+#define REPLICATEJOBDLG_H
+
+#include <QDialog>
+
+#include "utils/types.h"
+#include <QTime>
+
+class QLabel;
+class QCheckBox;
+class QTimeEdit;
+class QSpinBox;
+
+struct JobReplicaPattern;
+
+class ReplicateJobDlg : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit ReplicateJobDlg(QWidget *parent = nullptr);
+
+    void setSourceJob(db_id jobId, JobCategory cat, const QTime &start, const QTime &end);
+
+    void done(int ret) override;
+
+    JobReplicaPattern getPattern() const;
+
+private slots:
+    void updateCopiesCount();
+
+private:
+    QLabel *label;
+    QLabel *countLabel;
+    QTimeEdit *firstStartEdit;
+    QTimeEdit *lastStartEdit;
+    QSpinBox *intervalSpin;
+    QSpinBox *firstJobIdSpin;
+    QSpinBox *jobIdStepSpin;
+    QCheckBox *copyRsCheck;
+    QCheckBox *skipConflictsCheck;
+
+    db_id sourceJobId        = 0;
+    JobCategory sourceJobCat = JobCategory::NCategories;
+    QTime sourceStart;
+    QTime sourceEnd;
+};
+
+#endif // REPLICATEJOBDLG_H
@@ -104,21 +104,12 @@ JobWriter::JobWriter(database &db) :
                        " LEFT JOIN station_tracks t2 ON t2.id=g2.track_id"
                        " WHERE stops.job_id=? ORDER BY stops.arrival"),
 
-    q_getFirstStop(mDb, "SELECT stops.id, stations.name, MIN(stops.departure)"
-                        " FROM stops"
-                        " JOIN stations ON stations.id=stops.station_id"
-                        " WHERE stops.job_id=?"),
-
-    q_getLastStop(mDb, "SELECT stops.id, stations.name, MAX(stops.arrival)"
-                       " FROM stops"
-                       " JOIN stations ON stations.id=stops.station_id"
-                       " WHERE stops.job_id=?"),
-
-    q_initialJobAxes(mDb, "SELECT SUM(rs_models.axes)"
-                          " FROM coupling"
-                          " JOIN rs_list ON rs_list.id=coupling.rs_id"
-                          " JOIN rs_models ON rs_models.id=rs_list.model_id"
-                          " WHERE stop_id=?"),
+    q_getJobSummary(mDb, "SELECT js.first_stop_id, st1.name, js.first_departure,"
+                         " js.last_stop_id, st2.name, js.last_arrival, js.initial_axes"
+                         " FROM job_summary js"
+                         " JOIN stations st1 ON st1.id=js.first_station_id"
+                         " JOIN stations st2 ON st2.id=js.last_station_id"
+                         " WHERE js.job_id=?"),
 
     q_selectPassings(mDb, "SELECT stops.id,stops.job_id,jobs.category,"
                           "stops.arrival,stops.departure"
@@ -136,7 +127,7 @@ JobWriter::JobWriter(database &db) :
 {
 }
 
-void JobWriter::writeJobAutomaticStyles(QXmlStreamWriter &xml)
+static void writeJobAutomaticStylesBlock(QXmlStreamWriter &xml)
 {
     // job_summary columns
     writeColumnStyle(xml, "job_5f_summary.A", "1.60cm");
@@ -351,7 +342,7 @@ void JobWriter::writeJobAutomaticStyles(QXmlStreamWriter &xml)
     xml.writeEndElement(); // style
 }
 
-void JobWriter::writeJobStyles(QXmlStreamWriter &xml)
+static void writeJobStylesBlock(QXmlStreamWriter &xml)
 {
     /* Style: job_5f_summary
      *
@@ -561,6 +552,16 @@ void JobWriter::writeJobStyles(QXmlStreamWriter &xml)
     xml.writeEndElement(); // style:style
 }
 
+void JobWriter::writeJobAutomaticStyles(QXmlStreamWriter &xml)
+{
+    writeCachedStyleBlock(xml, writeJobAutomaticStylesBlock);
+}
+
+void JobWriter::writeJobStyles(QXmlStreamWriter &xml)
+{
+    writeCachedStyleBlock(xml, writeJobStylesBlock);
+}
+
 void JobWriter::writeJob(QXmlStreamWriter &xml, db_id jobId, JobCategory jobCat)
 {
     query q_getRSInfo(mDb, "SELECT rs_list.number,rs_models.name,rs_models.suffix,rs_models.type"
@@ -589,33 +590,22 @@ void JobWriter::writeJob(QXmlStreamWriter &xml, db_id jobId, JobCategory jobCat)
     int axesCount = 0;
 
     // Job summary
-    q_getFirstStop.bind(1, jobId);
-    if (q_getFirstStop.step() == SQLITE_ROW
-        && q_getFirstStop.getRows().column_type(0) != SQLITE_NULL)
+    q_getJobSummary.bind(1, jobId);
+    if (q_getJobSummary.step() == SQLITE_ROW)
     {
-        auto r      = q_getFirstStop.getRows();
+        auto r      = q_getJobSummary.getRows();
 
         firstStopId = r.get<db_id>(0);
         fromStation = r.get<QString>(1);
         start       = r.get<QTime>(2);
 
-        q_initialJobAxes.bind(1, firstStopId);
-        q_initialJobAxes.step();
-        axesCount = q_initialJobAxes.getRows().get<int>(0);
-        q_initialJobAxes.reset();
-    }
-    q_getFirstStop.reset();
-
-    q_getLastStop.bind(1, jobId);
-    if (q_getLastStop.step() == SQLITE_ROW && q_getLastStop.getRows().column_type(0) != SQLITE_NULL)
-    {
-        auto r     = q_getLastStop.getRows();
+        lastStopId  = r.get<db_id>(3);
+        toStation   = r.get<QString>(4);
+        end         = r.get<QTime>(5);
 
-        lastStopId = r.get<db_id>(0);
-        toStation  = r.get<QString>(1);
-        end        = r.get<QTime>(2);
+        axesCount   = r.get<int>(6);
     }
-    q_getLastStop.reset();
+    q_getJobSummary.reset();
 
     if (firstStopId && lastStopId)
     {
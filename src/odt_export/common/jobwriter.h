@@ -41,9 +41,7 @@ private:
     database &mDb;
 
     query q_getJobStops;
-    query q_getFirstStop;
-    query q_getLastStop;
-    query q_initialJobAxes;
+    query q_getJobSummary;
     query q_selectPassings;
     query q_getStopCouplings;
 };
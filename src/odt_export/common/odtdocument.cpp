@@ -30,6 +30,7 @@
 #include "db_metadata/metadatamanager.h"
 
 #include "odtutils.h"
+#include "odtpdfrenderer.h"
 
 // content.xml
 static constexpr char contentFileStr[] = "content.xml";
@@ -228,6 +229,19 @@ bool OdtDocument::saveTo(const QString &fileName)
     return true;
 }
 
+bool OdtDocument::saveToPdf(const QString &fileName)
+{
+    // Lay out already written XML files, no need of external converters
+    OdtPdfRenderer renderer;
+    if (!renderer.loadStyles(dir.filePath(stylesFileName)))
+        return false;
+
+    if (!renderer.loadContent(dir.filePath(contentFileName), dir.path()))
+        return false;
+
+    return renderer.renderTo(fileName, documentTitle);
+}
+
 void OdtDocument::endDocument()
 {
     saveManifest(dir.path());
@@ -30,6 +30,7 @@ public:
     OdtDocument();
 
     bool saveTo(const QString &fileName);
+    bool saveToPdf(const QString &fileName);
 
     bool initDocument();
     void startBody();
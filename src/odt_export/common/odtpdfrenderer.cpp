@@ -0,0 +1,885 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "odtpdfrenderer.h"
+
+#include <QXmlStreamReader>
+#include <QFile>
+#include <QDir>
+#include <QUrl>
+#include <QImage>
+
+#include <QTextTable>
+#include <QTextBlock>
+#include <QAbstractTextDocumentLayout>
+#include <QFontMetricsF>
+
+#include <QPdfWriter>
+#include <QPainter>
+
+#include "info.h" // For App constants
+
+#include <QDebug>
+
+// Unit in which all layout lengths are expressed
+static constexpr double PointsPerInch = 72.0;
+
+// Default page margins, same as OpenDocument page layout written by writePageLayout()
+static constexpr double DefaultMarginPt = 2.0 * PointsPerInch / 2.54;
+
+// Default font size if style does not set it, same as LibreOffice default
+static constexpr int DefaultFontSizePt = 12;
+
+/* parseLengthPt
+ *
+ * Converts OpenDocument length like '2.60cm' or '0.05pt' to points
+ */
+static double parseLengthPt(const QString &str)
+{
+    struct Unit
+    {
+        const char *suffix;
+        double factor;
+    };
+
+    static const Unit units[] = {
+      {"cm", PointsPerInch / 2.54},
+      {"mm", PointsPerInch / 25.4},
+      {"in", PointsPerInch},
+      {"pt", 1.0},
+      {"pc", 12.0},
+      {"px", 0.75},
+    };
+
+    for (const Unit &u : units)
+    {
+        if (str.endsWith(QLatin1String(u.suffix)))
+            return str.chopped(2).toDouble() * u.factor;
+    }
+    return str.toDouble();
+}
+
+/* parseBorder
+ *
+ * Parses border like '0.05pt solid #000000'
+ * Returns false if border is 'none'
+ */
+static bool parseBorder(const QString &str, double &widthPt, QColor &color)
+{
+    const QStringList parts = str.split(' ', Qt::SkipEmptyParts);
+    if (parts.isEmpty() || parts.first() == QLatin1String("none"))
+        return false;
+
+    widthPt = parseLengthPt(parts.first());
+    color   = parts.size() >= 3 ? QColor(parts.at(2)) : QColor(Qt::black);
+    return widthPt > 0;
+}
+
+enum class CellSide
+{
+    Left = 0,
+    Top,
+    Right,
+    Bottom
+};
+
+static void setCellBorder(QTextTableCellFormat &fmt, CellSide side, const QString &value)
+{
+    double width = 0;
+    QColor color;
+    QTextFrameFormat::BorderStyle style = QTextFrameFormat::BorderStyle_Solid;
+    if (!parseBorder(value, width, color))
+    {
+        width = 0;
+        style = QTextFrameFormat::BorderStyle_None;
+    }
+
+    switch (side)
+    {
+    case CellSide::Left:
+        fmt.setLeftBorder(width);
+        fmt.setLeftBorderStyle(style);
+        fmt.setLeftBorderBrush(color);
+        break;
+    case CellSide::Top:
+        fmt.setTopBorder(width);
+        fmt.setTopBorderStyle(style);
+        fmt.setTopBorderBrush(color);
+        break;
+    case CellSide::Right:
+        fmt.setRightBorder(width);
+        fmt.setRightBorderStyle(style);
+        fmt.setRightBorderBrush(color);
+        break;
+    case CellSide::Bottom:
+        fmt.setBottomBorder(width);
+        fmt.setBottomBorderStyle(style);
+        fmt.setBottomBorderBrush(color);
+        break;
+    }
+}
+
+static Qt::Alignment parseAlignment(QStringView value)
+{
+    if (value == QLatin1String("center"))
+        return Qt::AlignHCenter;
+    if (value == QLatin1String("end") || value == QLatin1String("right"))
+        return Qt::AlignRight;
+    if (value == QLatin1String("justify"))
+        return Qt::AlignJustify;
+    return Qt::AlignLeft;
+}
+
+OdtPdfRenderer::OdtPdfRenderer()
+{
+    m_marginsPt = QMarginsF(DefaultMarginPt, DefaultMarginPt, DefaultMarginPt, DefaultMarginPt);
+
+    // Use pixel size so font and lengths share the same unit (points)
+    QFont font(QStringLiteral("Liberation Serif"));
+    font.setPixelSize(DefaultFontSizePt);
+    m_doc.setDefaultFont(font);
+    m_doc.setDocumentMargin(0);
+    m_doc.setUseDesignMetrics(true);
+}
+
+bool OdtPdfRenderer::loadStyles(const QString &fileName)
+{
+    QFile f(fileName);
+    if (!f.open(QFile::ReadOnly))
+    {
+        qWarning() << "OdtPdfRenderer: cannot open" << fileName << f.errorString();
+        return false;
+    }
+
+    QXmlStreamReader xml(&f);
+    readDocument(xml);
+
+    if (xml.hasError())
+    {
+        qWarning() << "OdtPdfRenderer: error reading styles" << xml.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool OdtPdfRenderer::loadContent(const QString &fileName, const QString &basePath)
+{
+    QFile f(fileName);
+    if (!f.open(QFile::ReadOnly))
+    {
+        qWarning() << "OdtPdfRenderer: cannot open" << fileName << f.errorString();
+        return false;
+    }
+
+    m_basePath = basePath;
+
+    QXmlStreamReader xml(&f);
+    readDocument(xml);
+
+    if (xml.hasError())
+    {
+        qWarning() << "OdtPdfRenderer: error reading content" << xml.errorString();
+        return false;
+    }
+
+    // Page break after last paragraph would add an empty page at the end
+    QTextCursor c(m_doc.lastBlock());
+    QTextBlockFormat fmt = c.blockFormat();
+    if (fmt.pageBreakPolicy() & QTextFormat::PageBreak_AlwaysAfter)
+    {
+        fmt.setPageBreakPolicy(QTextFormat::PageBreak_Auto);
+        c.setBlockFormat(fmt);
+    }
+
+    return true;
+}
+
+bool OdtPdfRenderer::renderTo(const QString &fileName, const QString &title)
+{
+    QPdfWriter writer(fileName);
+    writer.setCreator(AppDisplayName);
+    writer.setTitle(title);
+
+    // We draw margins, header and footer ourselves
+    QPageLayout pageLay(QPageSize(QPageSize::A4), QPageLayout::Portrait, m_marginsPt,
+                        QPageLayout::Point);
+    pageLay.setMode(QPageLayout::FullPageMode);
+    writer.setPageLayout(pageLay);
+
+    QRectF bodyRect = pageLay.fullRect(QPageLayout::Point).marginsRemoved(m_marginsPt);
+
+    // Reserve header and footer bands inside page margins like OpenDocument does
+    const double bandHeight = QFontMetricsF(m_doc.defaultFont()).height() * 1.5;
+    QRectF headerRect, footerRect;
+    if (!m_headerParts.isEmpty())
+    {
+        headerRect = QRectF(bodyRect.left(), bodyRect.top(), bodyRect.width(), bandHeight);
+        bodyRect.setTop(bodyRect.top() + bandHeight);
+    }
+    if (!m_footerParts.isEmpty())
+    {
+        footerRect =
+          QRectF(bodyRect.left(), bodyRect.bottom() - bandHeight, bodyRect.width(), bandHeight);
+        bodyRect.setBottom(bodyRect.bottom() - bandHeight);
+    }
+
+    m_doc.setPageSize(bodyRect.size());
+    const int pageCount = m_doc.pageCount();
+
+    QPainter painter;
+    if (!painter.begin(&writer))
+    {
+        qWarning() << "OdtPdfRenderer: cannot begin QPainter on" << fileName;
+        return false;
+    }
+
+    // Layout is in points, scale to PDF resolution
+    const double scale = writer.resolution() / PointsPerInch;
+    painter.scale(scale, scale);
+
+    QAbstractTextDocumentLayout::PaintContext ctx;
+    ctx.palette.setColor(QPalette::Text, Qt::black);
+
+    for (int i = 0; i < pageCount; i++)
+    {
+        if (i > 0)
+            writer.newPage();
+
+        drawHeaderFooter(&painter, m_headerParts, headerRect, i + 1);
+        drawHeaderFooter(&painter, m_footerParts, footerRect, i + 1);
+
+        // Document pages are stacked vertically, move current page in body rect
+        const QRectF pageClip(0, i * bodyRect.height(), bodyRect.width(), bodyRect.height());
+
+        painter.save();
+        painter.translate(bodyRect.left(), bodyRect.top() - pageClip.top());
+        painter.setClipRect(pageClip);
+        ctx.clip = pageClip;
+        m_doc.documentLayout()->draw(&painter, ctx);
+        painter.restore();
+    }
+
+    return painter.end();
+}
+
+void OdtPdfRenderer::readDocument(QXmlStreamReader &xml)
+{
+    // Root element (office:document-content or office:document-styles)
+    if (!xml.readNextStartElement())
+        return;
+
+    while (xml.readNextStartElement())
+    {
+        const QStringView name = xml.qualifiedName();
+        if (name == QLatin1String("office:font-face-decls"))
+        {
+            readFontFaces(xml);
+        }
+        else if (name == QLatin1String("office:styles")
+                 || name == QLatin1String("office:automatic-styles"))
+        {
+            readStyles(xml);
+        }
+        else if (name == QLatin1String("office:master-styles"))
+        {
+            while (xml.readNextStartElement())
+            {
+                if (xml.qualifiedName() == QLatin1String("style:master-page"))
+                    readMasterPage(xml);
+                else
+                    xml.skipCurrentElement();
+            }
+        }
+        else if (name == QLatin1String("office:body"))
+        {
+            while (xml.readNextStartElement())
+            {
+                if (xml.qualifiedName() == QLatin1String("office:text"))
+                {
+                    QTextCursor cursor(&m_doc);
+                    cursor.movePosition(QTextCursor::End);
+                    bool blockUsed = !m_doc.isEmpty();
+                    readBodyText(xml, cursor, blockUsed);
+                }
+                else
+                {
+                    xml.skipCurrentElement();
+                }
+            }
+        }
+        else
+        {
+            xml.skipCurrentElement();
+        }
+    }
+}
+
+void OdtPdfRenderer::readFontFaces(QXmlStreamReader &xml)
+{
+    while (xml.readNextStartElement())
+    {
+        if (xml.qualifiedName() == QLatin1String("style:font-face"))
+        {
+            const QXmlStreamAttributes attrs = xml.attributes();
+            QString family = attrs.value(QLatin1String("svg:font-family")).toString();
+            if (family.startsWith('\'') && family.endsWith('\'') && family.size() >= 2)
+                family = family.mid(1, family.size() - 2);
+
+            m_fontFamilies.insert(attrs.value(QLatin1String("style:name")).toString(), family);
+        }
+        xml.skipCurrentElement();
+    }
+}
+
+void OdtPdfRenderer::readStyles(QXmlStreamReader &xml)
+{
+    while (xml.readNextStartElement())
+    {
+        const QStringView name = xml.qualifiedName();
+        if (name == QLatin1String("style:style"))
+            readStyle(xml);
+        else if (name == QLatin1String("style:page-layout"))
+            readPageLayout(xml);
+        else
+            xml.skipCurrentElement();
+    }
+}
+
+void OdtPdfRenderer::readStyle(QXmlStreamReader &xml)
+{
+    const QXmlStreamAttributes styleAttrs = xml.attributes();
+    const QString family = styleAttrs.value(QLatin1String("style:family")).toString();
+    const QString name   = styleAttrs.value(QLatin1String("style:name")).toString();
+
+    Style style;
+    style.parent = styleAttrs.value(QLatin1String("style:parent-style-name")).toString();
+
+    while (xml.readNextStartElement())
+    {
+        const QStringView elemName       = xml.qualifiedName();
+        const QXmlStreamAttributes attrs = xml.attributes();
+
+        if (elemName == QLatin1String("style:paragraph-properties"))
+        {
+            for (const QXmlStreamAttribute &a : attrs)
+            {
+                const QStringView attrName = a.qualifiedName();
+                if (attrName == QLatin1String("fo:text-align"))
+                    style.blockFmt.setAlignment(parseAlignment(a.value()));
+                else if (attrName == QLatin1String("fo:break-after")
+                         && a.value() == QLatin1String("page"))
+                    style.blockFmt.setPageBreakPolicy(QTextFormat::PageBreak_AlwaysAfter);
+                else if (attrName == QLatin1String("fo:break-before")
+                         && a.value() == QLatin1String("page"))
+                    style.blockFmt.setPageBreakPolicy(QTextFormat::PageBreak_AlwaysBefore);
+                else if (attrName == QLatin1String("fo:margin-top"))
+                    style.blockFmt.setTopMargin(parseLengthPt(a.value().toString()));
+                else if (attrName == QLatin1String("fo:margin-bottom"))
+                    style.blockFmt.setBottomMargin(parseLengthPt(a.value().toString()));
+            }
+        }
+        else if (elemName == QLatin1String("style:text-properties"))
+        {
+            for (const QXmlStreamAttribute &a : attrs)
+            {
+                const QStringView attrName = a.qualifiedName();
+                if (attrName == QLatin1String("fo:font-size"))
+                {
+                    const int px = qMax(1, qRound(parseLengthPt(a.value().toString())));
+                    style.charFmt.setProperty(QTextFormat::FontPixelSize, px);
+                }
+                else if (attrName == QLatin1String("fo:font-weight"))
+                {
+                    if (a.value() == QLatin1String("bold"))
+                        style.charFmt.setFontWeight(QFont::Bold);
+                    else if (a.value() == QLatin1String("normal"))
+                        style.charFmt.setFontWeight(QFont::Normal);
+                    else
+                        style.charFmt.setFontWeight(a.value().toInt());
+                }
+                else if (attrName == QLatin1String("fo:font-style"))
+                {
+                    style.charFmt.setFontItalic(a.value() == QLatin1String("italic"));
+                }
+                else if (attrName == QLatin1String("style:font-name"))
+                {
+                    const QString fontName = a.value().toString();
+                    style.charFmt.setFontFamilies(
+                      QStringList{m_fontFamilies.value(fontName, fontName)});
+                }
+            }
+        }
+        else if (elemName == QLatin1String("style:table-cell-properties"))
+        {
+            QTextTableCellFormat &cell = style.cellFmt;
+            for (const QXmlStreamAttribute &a : attrs)
+            {
+                const QStringView attrName = a.qualifiedName();
+                const QString value        = a.value().toString();
+                if (attrName == QLatin1String("fo:padding"))
+                    cell.setPadding(parseLengthPt(value));
+                else if (attrName == QLatin1String("fo:padding-left"))
+                    cell.setLeftPadding(parseLengthPt(value));
+                else if (attrName == QLatin1String("fo:padding-top"))
+                    cell.setTopPadding(parseLengthPt(value));
+                else if (attrName == QLatin1String("fo:padding-right"))
+                    cell.setRightPadding(parseLengthPt(value));
+                else if (attrName == QLatin1String("fo:padding-bottom"))
+                    cell.setBottomPadding(parseLengthPt(value));
+                else if (attrName == QLatin1String("fo:border"))
+                {
+                    setCellBorder(cell, CellSide::Left, value);
+                    setCellBorder(cell, CellSide::Top, value);
+                    setCellBorder(cell, CellSide::Right, value);
+                    setCellBorder(cell, CellSide::Bottom, value);
+                }
+                else if (attrName == QLatin1String("fo:border-left"))
+                    setCellBorder(cell, CellSide::Left, value);
+                else if (attrName == QLatin1String("fo:border-top"))
+                    setCellBorder(cell, CellSide::Top, value);
+                else if (attrName == QLatin1String("fo:border-right"))
+                    setCellBorder(cell, CellSide::Right, value);
+                else if (attrName == QLatin1String("fo:border-bottom"))
+                    setCellBorder(cell, CellSide::Bottom, value);
+                else if (attrName == QLatin1String("style:vertical-align"))
+                {
+                    if (value == QLatin1String("middle"))
+                        cell.setVerticalAlignment(QTextCharFormat::AlignMiddle);
+                    else if (value == QLatin1String("bottom"))
+                        cell.setVerticalAlignment(QTextCharFormat::AlignBottom);
+                    else
+                        cell.setVerticalAlignment(QTextCharFormat::AlignTop);
+                }
+            }
+        }
+        else if (elemName == QLatin1String("style:table-column-properties"))
+        {
+            style.columnWidth =
+              parseLengthPt(attrs.value(QLatin1String("style:column-width")).toString());
+        }
+        else if (elemName == QLatin1String("style:table-properties"))
+        {
+            if (attrs.hasAttribute(QLatin1String("style:width")))
+            {
+                const double width =
+                  parseLengthPt(attrs.value(QLatin1String("style:width")).toString());
+                style.tableFmt.setWidth(QTextLength(QTextLength::FixedLength, width));
+            }
+            if (attrs.hasAttribute(QLatin1String("table:align")))
+                style.tableFmt.setAlignment(
+                  parseAlignment(attrs.value(QLatin1String("table:align"))));
+        }
+
+        xml.skipCurrentElement();
+    }
+
+    m_styles.insert(family + QLatin1Char('/') + name, style);
+}
+
+void OdtPdfRenderer::readPageLayout(QXmlStreamReader &xml)
+{
+    while (xml.readNextStartElement())
+    {
+        if (xml.qualifiedName() == QLatin1String("style:page-layout-properties"))
+        {
+            const QXmlStreamAttributes attrs = xml.attributes();
+            if (attrs.hasAttribute(QLatin1String("fo:margin-left")))
+                m_marginsPt.setLeft(
+                  parseLengthPt(attrs.value(QLatin1String("fo:margin-left")).toString()));
+            if (attrs.hasAttribute(QLatin1String("fo:margin-top")))
+                m_marginsPt.setTop(
+                  parseLengthPt(attrs.value(QLatin1String("fo:margin-top")).toString()));
+            if (attrs.hasAttribute(QLatin1String("fo:margin-right")))
+                m_marginsPt.setRight(
+                  parseLengthPt(attrs.value(QLatin1String("fo:margin-right")).toString()));
+            if (attrs.hasAttribute(QLatin1String("fo:margin-bottom")))
+                m_marginsPt.setBottom(
+                  parseLengthPt(attrs.value(QLatin1String("fo:margin-bottom")).toString()));
+        }
+        xml.skipCurrentElement();
+    }
+}
+
+void OdtPdfRenderer::readMasterPage(QXmlStreamReader &xml)
+{
+    while (xml.readNextStartElement())
+    {
+        const QStringView name = xml.qualifiedName();
+        if (name == QLatin1String("style:header"))
+            m_headerParts = readHeaderFooter(xml);
+        else if (name == QLatin1String("style:footer"))
+            m_footerParts = readHeaderFooter(xml);
+        else
+            xml.skipCurrentElement(); // Mirrored left pages are not supported
+    }
+}
+
+QStringList OdtPdfRenderer::readHeaderFooter(QXmlStreamReader &xml)
+{
+    QStringList parts{QString()};
+
+    while (xml.readNextStartElement())
+    {
+        if (xml.qualifiedName() != QLatin1String("text:p"))
+        {
+            xml.skipCurrentElement();
+            continue;
+        }
+
+        while (!xml.atEnd())
+        {
+            const QXmlStreamReader::TokenType token = xml.readNext();
+            if (token == QXmlStreamReader::Characters && !xml.isWhitespace())
+            {
+                parts.last().append(xml.text());
+            }
+            else if (token == QXmlStreamReader::StartElement)
+            {
+                if (xml.qualifiedName() == QLatin1String("text:tab"))
+                    parts.append(QString());
+                else if (xml.qualifiedName() == QLatin1String("text:page-number"))
+                    parts.last().append(QChar::ObjectReplacementCharacter);
+                xml.skipCurrentElement();
+            }
+            else if (token == QXmlStreamReader::EndElement)
+            {
+                break; // End of text:p
+            }
+        }
+    }
+
+    for (const QString &part : std::as_const(parts))
+    {
+        if (!part.trimmed().isEmpty())
+            return parts;
+    }
+
+    return QStringList(); // Nothing to draw
+}
+
+void OdtPdfRenderer::readBodyText(QXmlStreamReader &xml, QTextCursor &cursor, bool &blockUsed)
+{
+    while (xml.readNextStartElement())
+    {
+        const QStringView name = xml.qualifiedName();
+        if (name == QLatin1String("text:p") || name == QLatin1String("text:h"))
+            readParagraph(xml, cursor, blockUsed);
+        else if (name == QLatin1String("table:table"))
+            readTable(xml, cursor, blockUsed);
+        else
+            xml.skipCurrentElement();
+    }
+}
+
+void OdtPdfRenderer::readParagraph(QXmlStreamReader &xml, QTextCursor &cursor, bool &blockUsed)
+{
+    const QString styleName = xml.attributes().value(QLatin1String("text:style-name")).toString();
+    const Style style       = resolveStyle(QLatin1String("paragraph"), styleName);
+
+    if (blockUsed)
+    {
+        cursor.insertBlock(style.blockFmt, style.charFmt);
+    }
+    else
+    {
+        // Reuse empty block (start of document/cell or after a table)
+        cursor.setBlockFormat(style.blockFmt);
+        cursor.setBlockCharFormat(style.charFmt);
+        blockUsed = true;
+    }
+
+    // Top is current span format
+    QList<QTextCharFormat> fmtStack{style.charFmt};
+
+    // OpenDocument white space rules: runs are collapsed to a single space
+    // and leading space of each line is ignored
+    bool atLineStart  = true;
+    bool pendingSpace = false;
+
+    while (!xml.atEnd())
+    {
+        const QXmlStreamReader::TokenType token = xml.readNext();
+        if (token == QXmlStreamReader::Characters)
+        {
+            QString text          = xml.text().toString();
+            const bool leadSpace  = !text.isEmpty() && text.front().isSpace();
+            const bool trailSpace = !text.isEmpty() && text.back().isSpace();
+            text                  = text.simplified();
+            if (text.isEmpty())
+            {
+                pendingSpace = pendingSpace || !atLineStart;
+                continue;
+            }
+
+            if ((pendingSpace || leadSpace) && !atLineStart)
+                text.prepend(' ');
+            cursor.insertText(text, fmtStack.last());
+
+            pendingSpace = trailSpace;
+            atLineStart  = false;
+        }
+        else if (token == QXmlStreamReader::StartElement)
+        {
+            const QStringView name = xml.qualifiedName();
+            if (name == QLatin1String("text:span"))
+            {
+                const Style spanStyle =
+                  resolveStyle(QLatin1String("text"),
+                               xml.attributes().value(QLatin1String("text:style-name")).toString());
+                QTextCharFormat fmt = fmtStack.last();
+                fmt.merge(spanStyle.charFmt);
+                fmtStack.append(fmt);
+                continue; // Contents are read by this loop, end element pops format
+            }
+
+            if (name == QLatin1String("text:line-break"))
+            {
+                cursor.insertText(QString(QChar::LineSeparator), fmtStack.last());
+                atLineStart  = true;
+                pendingSpace = false;
+            }
+            else if (name == QLatin1String("text:tab"))
+            {
+                cursor.insertText(QLatin1String("\t"), fmtStack.last());
+                atLineStart  = false;
+                pendingSpace = false;
+            }
+            else if (name == QLatin1String("text:s"))
+            {
+                cursor.insertText(QLatin1String(" "), fmtStack.last());
+                pendingSpace = false;
+            }
+            else if (name == QLatin1String("draw:frame"))
+            {
+                readFrame(xml, cursor);
+                atLineStart = false;
+                continue; // Already read until end element
+            }
+
+            xml.skipCurrentElement();
+        }
+        else if (token == QXmlStreamReader::EndElement)
+        {
+            if (fmtStack.size() == 1)
+                break; // End of paragraph
+            fmtStack.removeLast(); // End of span
+        }
+    }
+}
+
+void OdtPdfRenderer::readTable(QXmlStreamReader &xml, QTextCursor &cursor, bool &blockUsed)
+{
+    const QString styleName = xml.attributes().value(QLatin1String("table:style-name")).toString();
+    const Style style       = resolveStyle(QLatin1String("table"), styleName);
+
+    // Borders are drawn by cells
+    QTextTableFormat tableFmt = style.tableFmt;
+    tableFmt.setBorder(0);
+    tableFmt.setBorderCollapse(true);
+    tableFmt.setCellSpacing(0);
+    tableFmt.setCellPadding(0);
+    tableFmt.setMargin(0);
+
+    QList<QTextLength> columnWidths;
+    QTextTable *table  = nullptr;
+    int headerRowCount = 0;
+
+    while (xml.readNextStartElement())
+    {
+        const QStringView name = xml.qualifiedName();
+        if (name == QLatin1String("table:table-column"))
+        {
+            const QXmlStreamAttributes attrs = xml.attributes();
+            const Style colStyle =
+              resolveStyle(QLatin1String("table-column"),
+                           attrs.value(QLatin1String("table:style-name")).toString());
+
+            const QTextLength width =
+              colStyle.columnWidth > 0
+                ? QTextLength(QTextLength::FixedLength, colStyle.columnWidth)
+                : QTextLength();
+
+            int repeat = attrs.value(QLatin1String("table:number-columns-repeated")).toInt();
+            for (int i = 0; i < qMax(1, repeat); i++)
+                columnWidths.append(width);
+
+            tableFmt.setColumnWidthConstraints(columnWidths);
+            xml.skipCurrentElement();
+        }
+        else if (name == QLatin1String("table:table-header-rows"))
+        {
+            while (xml.readNextStartElement())
+            {
+                if (xml.qualifiedName() == QLatin1String("table:table-row"))
+                {
+                    readTableRow(xml, cursor, table, tableFmt, columnWidths.size());
+                    headerRowCount++;
+                }
+                else
+                {
+                    xml.skipCurrentElement();
+                }
+            }
+        }
+        else if (name == QLatin1String("table:table-row"))
+        {
+            readTableRow(xml, cursor, table, tableFmt, columnWidths.size());
+        }
+        else
+        {
+            xml.skipCurrentElement();
+        }
+    }
+
+    if (!table)
+        return; // Empty table
+
+    if (headerRowCount > 0)
+    {
+        // Repeat heading on each page
+        QTextTableFormat fmt = table->format();
+        fmt.setHeaderRowCount(headerRowCount);
+        table->setFormat(fmt);
+    }
+
+    // Move after table, there is always an empty block after a frame
+    cursor = table->lastCursorPosition();
+    cursor.movePosition(QTextCursor::NextBlock);
+    blockUsed = false;
+}
+
+void OdtPdfRenderer::readTableRow(QXmlStreamReader &xml, QTextCursor &cursor, QTextTable *&table,
+                                  const QTextTableFormat &tableFmt, int columns)
+{
+    if (!table)
+        table = cursor.insertTable(1, qMax(1, columns), tableFmt);
+    else
+        table->appendRows(1);
+
+    const int row = table->rows() - 1;
+    int col       = 0;
+
+    while (xml.readNextStartElement())
+    {
+        if (xml.qualifiedName() != QLatin1String("table:table-cell"))
+        {
+            xml.skipCurrentElement();
+            continue;
+        }
+
+        if (col >= table->columns())
+            table->appendColumns(1);
+
+        const Style cellStyle =
+          resolveStyle(QLatin1String("table-cell"),
+                       xml.attributes().value(QLatin1String("table:style-name")).toString());
+
+        QTextTableCell cell = table->cellAt(row, col);
+        cell.setFormat(cellStyle.cellFmt);
+
+        QTextCursor cellCursor = cell.firstCursorPosition();
+        bool cellBlockUsed     = false;
+        readBodyText(xml, cellCursor, cellBlockUsed);
+
+        col++;
+    }
+}
+
+void OdtPdfRenderer::readFrame(QXmlStreamReader &xml, QTextCursor &cursor)
+{
+    const QXmlStreamAttributes attrs = xml.attributes();
+    const double width  = parseLengthPt(attrs.value(QLatin1String("svg:width")).toString());
+    const double height = parseLengthPt(attrs.value(QLatin1String("svg:height")).toString());
+
+    QString href;
+    while (xml.readNextStartElement())
+    {
+        if (xml.qualifiedName() == QLatin1String("draw:image"))
+            href = xml.attributes().value(QLatin1String("xlink:href")).toString();
+        xml.skipCurrentElement();
+    }
+
+    if (href.isEmpty())
+        return;
+
+    const QImage img(QDir(m_basePath).filePath(href));
+    if (img.isNull())
+    {
+        qWarning() << "OdtPdfRenderer: cannot load picture" << href;
+        return;
+    }
+
+    m_doc.addResource(QTextDocument::ImageResource, QUrl(href), img);
+
+    QTextImageFormat fmt;
+    fmt.setName(href);
+    if (width > 0)
+        fmt.setWidth(width);
+    if (height > 0)
+        fmt.setHeight(height);
+    cursor.insertImage(fmt);
+}
+
+OdtPdfRenderer::Style OdtPdfRenderer::resolveStyle(const QString &family, const QString &name,
+                                                   int depth) const
+{
+    auto it = m_styles.constFind(family + QLatin1Char('/') + name);
+    if (it == m_styles.constEnd())
+        return Style();
+
+    if (it->parent.isEmpty() || depth > 8)
+        return it.value();
+
+    // Apply own properties on top of parent style
+    Style result = resolveStyle(family, it->parent, depth + 1);
+    result.blockFmt.merge(it->blockFmt);
+    result.charFmt.merge(it->charFmt);
+    result.cellFmt.merge(it->cellFmt);
+    result.tableFmt.merge(it->tableFmt);
+    if (it->columnWidth > 0)
+        result.columnWidth = it->columnWidth;
+    return result;
+}
+
+void OdtPdfRenderer::drawHeaderFooter(QPainter *painter, const QStringList &parts,
+                                      const QRectF &rect, int pageNum) const
+{
+    if (parts.isEmpty() || rect.isNull())
+        return;
+
+    const QString pageStr = QString::number(pageNum);
+
+    painter->save();
+    painter->setFont(m_doc.defaultFont());
+    painter->setPen(Qt::black);
+
+    // Tab separated parts: first on left, last on right, others centered
+    for (int i = 0; i < parts.size(); i++)
+    {
+        Qt::Alignment align = Qt::AlignLeft;
+        if (i > 0)
+            align = (i == parts.size() - 1) ? Qt::AlignRight : Qt::AlignHCenter;
+
+        QString text = parts.at(i);
+        text.replace(QChar::ObjectReplacementCharacter, pageStr);
+        painter->drawText(rect, align | Qt::AlignVCenter, text);
+    }
+
+    painter->restore();
+}
@@ -0,0 +1,102 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ODTPDFRENDERER_H
+#define ODTPDFRENDERER_H
+
+#include <QHash>
+#include <QMarginsF>
+#include <QStringList>
+
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QTextFormat>
+
+class QXmlStreamReader;
+class QTextTable;
+class QPainter;
+
+/*!
+ * \brief The OdtPdfRenderer class
+ *
+ * Lays out styles.xml and content.xml written by OdtDocument in a QTextDocument
+ * and paints it page by page on a QPdfWriter.
+ * Only the OpenDocument subset used by sheet writers is supported:
+ * paragraphs, spans, line breaks, tables, page breaks, header/footer and frame images.
+ *
+ * All lengths are stored in points and fonts use pixel size
+ * so layout is resolution independent and then scaled to PDF resolution.
+ */
+class OdtPdfRenderer
+{
+public:
+    OdtPdfRenderer();
+
+    bool loadStyles(const QString &fileName);
+    bool loadContent(const QString &fileName, const QString &basePath);
+
+    bool renderTo(const QString &fileName, const QString &title);
+
+private:
+    struct Style
+    {
+        QString parent;
+        QTextBlockFormat blockFmt;
+        QTextCharFormat charFmt;
+        QTextTableCellFormat cellFmt;
+        QTextTableFormat tableFmt;
+        double columnWidth = 0;
+    };
+
+    void readDocument(QXmlStreamReader &xml);
+    void readFontFaces(QXmlStreamReader &xml);
+    void readStyles(QXmlStreamReader &xml);
+    void readStyle(QXmlStreamReader &xml);
+    void readPageLayout(QXmlStreamReader &xml);
+    void readMasterPage(QXmlStreamReader &xml);
+    QStringList readHeaderFooter(QXmlStreamReader &xml);
+
+    void readBodyText(QXmlStreamReader &xml, QTextCursor &cursor, bool &blockUsed);
+    void readParagraph(QXmlStreamReader &xml, QTextCursor &cursor, bool &blockUsed);
+    void readTable(QXmlStreamReader &xml, QTextCursor &cursor, bool &blockUsed);
+    void readTableRow(QXmlStreamReader &xml, QTextCursor &cursor, QTextTable *&table,
+                      const QTextTableFormat &tableFmt, int columns);
+    void readFrame(QXmlStreamReader &xml, QTextCursor &cursor);
+
+    Style resolveStyle(const QString &family, const QString &name, int depth = 0) const;
+
+    void drawHeaderFooter(QPainter *painter, const QStringList &parts, const QRectF &rect,
+                          int pageNum) const;
+
+private:
+    QTextDocument m_doc;
+    QString m_basePath;
+
+    // Key: family + '/' + name
+    QHash<QString, Style> m_styles;
+    QHash<QString, QString> m_fontFamilies;
+
+    QMarginsF m_marginsPt;
+
+    // Parts are separated by text:tab, page number is QChar::ObjectReplacementCharacter
+    QStringList m_headerParts;
+    QStringList m_footerParts;
+};
+
+#endif // ODTPDFRENDERER_H
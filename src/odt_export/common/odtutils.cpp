@@ -22,6 +22,9 @@
 #include "app/session.h"
 #include <QTranslator>
 
+#include <QMutex>
+#include <map>
+
 /* writeColumnStyle
  *
  * Helper function to write table column style of a certain width
@@ -404,3 +407,45 @@ QString Odt::text(const Text &t)
         result = tr(t.sourceText, t.disambiguation);
     return result;
 }
+
+/* writeCachedStyleBlock
+ *
+ * Style blocks do not depend on document contents nor on sheet locale
+ * so they are serialized only once per process by calling 'func'
+ * Then the cached bytes are copied directly to the output device of 'xml'
+ * Call it where 'func' would have been called, inside parent element
+ */
+void writeCachedStyleBlock(QXmlStreamWriter &xml, OdtStyleBlockFunc func)
+{
+    static QMutex cacheMutex;
+    static std::map<OdtStyleBlockFunc, QByteArray> cache;
+
+    QIODevice *dev = xml.device();
+    if (!dev)
+    {
+        // Writing to string, cannot splice raw bytes
+        func(xml);
+        return;
+    }
+
+    QByteArray block;
+    {
+        QMutexLocker locker(&cacheMutex);
+        auto it = cache.find(func);
+        if (it == cache.end())
+        {
+            QByteArray buf;
+            QXmlStreamWriter blockXml(&buf);
+            blockXml.setAutoFormatting(xml.autoFormatting());
+            blockXml.setAutoFormattingIndent(xml.autoFormattingIndent());
+            func(blockXml);
+            it = cache.emplace(func, buf).first;
+        }
+        block = it->second; // Implicitly shared, no deep copy
+    }
+
+    // Close pending parent start tag before splicing
+    // QXmlStreamWriter does not buffer so bytes land in the right place
+    xml.writeCharacters(QString());
+    dev->write(block);
+}
@@ -76,6 +76,10 @@ inline void writeFontFace(QXmlStreamWriter &xml, const QString &name, const QStr
 
 void writeLiberationFontFaces(QXmlStreamWriter &xml);
 
+typedef void (*OdtStyleBlockFunc)(QXmlStreamWriter &xml);
+
+void writeCachedStyleBlock(QXmlStreamWriter &xml, OdtStyleBlockFunc func);
+
 class Odt
 {
     Q_DECLARE_TR_FUNCTIONS(Odt)
@@ -75,7 +75,7 @@ SessionRSWriter::SessionRSWriter(database &db, SessionRSMode mode, SessionRSOrde
     q_getSessionRS.prepare(query.constData());
 }
 
-void SessionRSWriter::writeStyles(QXmlStreamWriter &xml)
+static void writeSessionRSStylesBlock(QXmlStreamWriter &xml)
 {
     /* Style P5           FIXME: merge with JobWriter and StationWriter
      * type: paragraph
@@ -221,6 +221,11 @@ void SessionRSWriter::writeStyles(QXmlStreamWriter &xml)
     xml.writeEndElement(); // style
 }
 
+void SessionRSWriter::writeStyles(QXmlStreamWriter &xml)
+{
+    writeCachedStyleBlock(xml, writeSessionRSStylesBlock);
+}
+
 db_id SessionRSWriter::writeTable(QXmlStreamWriter &xml, const QString &parentName)
 {
     // Table '???_table' where ??? is the station/owner name without spaces
@@ -0,0 +1,66 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sheetfiledialog.h"
+
+#include <QFileDialog>
+#include <QMessageBox>
+#include "utils/files/recentdirstore.h"
+#include "utils/files/file_format_names.h"
+#include "utils/owningqpointer.h"
+
+QString SheetFileDialog::getSaveFileName(QWidget *parent, const QString &title,
+                                         const QString &dirKey, const QString &defaultName,
+                                         bool &asPdfOut)
+{
+    asPdfOut                        = false;
+
+    OwningQPointer<QFileDialog> dlg = new QFileDialog(parent, title);
+    dlg->setFileMode(QFileDialog::AnyFile);
+    dlg->setAcceptMode(QFileDialog::AcceptSave);
+    dlg->setDirectory(RecentDirStore::getDir(dirKey, RecentDirStore::Documents));
+    if (!defaultName.isEmpty())
+        dlg->selectFile(defaultName);
+
+    QStringList filters;
+    filters << FileFormats::tr(FileFormats::odtFormat);
+    filters << FileFormats::tr(FileFormats::pdfFile);
+    dlg->setNameFilters(filters);
+
+    if (dlg->exec() != QDialog::Accepted || !dlg)
+        return QString();
+
+    QString fileName = dlg->selectedUrls().value(0).toLocalFile();
+    if (fileName.isEmpty())
+        return QString();
+
+    // Sheet is exported in PDF directly, without external converters
+    asPdfOut = dlg->selectedNameFilter() == filters.at(1);
+    if (asPdfOut && fileName.endsWith(QLatin1String(".odt"), Qt::CaseInsensitive))
+        fileName.replace(fileName.size() - 4, 4, QLatin1String(".pdf"));
+
+    RecentDirStore::setPath(dirKey, fileName);
+    return fileName;
+}
+
+void SheetFileDialog::showSaveError(QWidget *parent, const QString &fileName)
+{
+    QMessageBox::warning(parent, tr("Save Error"),
+                         tr("Could not save sheet to <b>%1</b>.").arg(fileName.toHtmlEscaped()));
+}
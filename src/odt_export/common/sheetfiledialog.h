@@ -0,0 +1,54 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SHEETFILEDIALOG_H
+#define SHEETFILEDIALOG_H
+
+#include <QCoreApplication>
+#include <QString>
+
+class QWidget;
+
+/*!
+ * \brief The SheetFileDialog class
+ *
+ * Common file dialog used to save a single sheet in ODT or PDF format.
+ */
+class SheetFileDialog
+{
+    Q_DECLARE_TR_FUNCTIONS(SheetFileDialog)
+public:
+    /*!
+     * \brief getSaveFileName
+     * \param parent dialog parent
+     * \param title dialog title
+     * \param dirKey RecentDirStore key
+     * \param defaultName proposed file name with '.odt' extension or empty
+     * \param asPdfOut set to true if user chose PDF format
+     * \return chosen file name or empty string if cancelled
+     *
+     * If PDF format is chosen the '.odt' extension is replaced by '.pdf'
+     */
+    static QString getSaveFileName(QWidget *parent, const QString &title, const QString &dirKey,
+                                   const QString &defaultName, bool &asPdfOut);
+
+    static void showSaveError(QWidget *parent, const QString &fileName);
+};
+
+#endif // SHEETFILEDIALOG_H
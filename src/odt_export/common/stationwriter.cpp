@@ -111,7 +111,7 @@ StationWriter::StationWriter(database &db) :
 }
 
 // TODO: common styles with JobWriter should go in common
-void StationWriter::writeStationAutomaticStyles(QXmlStreamWriter &xml)
+static void writeStationAutomaticStylesBlock(QXmlStreamWriter &xml)
 {
     /* Style: stationtable
      *
@@ -317,6 +317,11 @@ void StationWriter::writeStationAutomaticStyles(QXmlStreamWriter &xml)
     xml.writeEndElement(); // style:style
 }
 
+void StationWriter::writeStationAutomaticStyles(QXmlStreamWriter &xml)
+{
+    writeCachedStyleBlock(xml, writeStationAutomaticStylesBlock);
+}
+
 void StationWriter::writeStation(QXmlStreamWriter &xml, db_id stationId, QString *stNameOut)
 {
     QMap<QTime, Stop> stops; // Order by Departure ASC
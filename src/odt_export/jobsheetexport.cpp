@@ -66,7 +66,12 @@ void JobSheetExport::write()
     odt.endDocument();
 }
 
-void JobSheetExport::save(const QString &fileName)
+bool JobSheetExport::save(const QString &fileName)
 {
-    odt.saveTo(fileName);
+    return odt.saveTo(fileName);
+}
+
+bool JobSheetExport::savePdf(const QString &fileName)
+{
+    return odt.saveToPdf(fileName);
 }
@@ -30,7 +30,8 @@ public:
     JobSheetExport(db_id jobId, JobCategory cat);
 
     void write();
-    void save(const QString &fileName);
+    bool save(const QString &fileName);
+    bool savePdf(const QString &fileName);
 
 private:
     OdtDocument odt;
@@ -97,7 +97,12 @@ void SessionRSExport::write()
     odt.endDocument();
 }
 
-void SessionRSExport::save(const QString &fileName)
+bool SessionRSExport::save(const QString &fileName)
 {
-    odt.saveTo(fileName);
+    return odt.saveTo(fileName);
+}
+
+bool SessionRSExport::savePdf(const QString &fileName)
+{
+    return odt.saveToPdf(fileName);
 }
@@ -31,7 +31,8 @@ public:
     SessionRSExport(SessionRSMode mode, SessionRSOrder order);
 
     void write();
-    void save(const QString &fileName);
+    bool save(const QString &fileName);
+    bool savePdf(const QString &fileName);
 
 private:
     OdtDocument odt;
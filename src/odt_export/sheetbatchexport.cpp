@@ -0,0 +1,524 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sheetbatchexport.h"
+
+#include "jobsheetexport.h"
+#include "stationsheetexport.h"
+#include "shiftsheetexport.h"
+
+#include "app/session.h"
+#include "info.h"
+
+#include "utils/jobcategorystrings.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSet>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <QDebug>
+
+using namespace sqlite3pp;
+
+const QString SheetBatchExport::IndexFileName = QStringLiteral(".sheet_export_index.json");
+
+// Bump when sheet layout changes so previous exports get regenerated
+static constexpr int SheetIndexVersion = 1;
+
+/* sanitizeFileName
+ *
+ * Keep only characters which are safe on every file system
+ */
+static QString sanitizeFileName(const QString &name)
+{
+    QString result;
+    result.reserve(name.size());
+    for (const QChar ch : name)
+    {
+        if (ch.isLetterOrNumber() || ch == '-' || ch == '_')
+            result.append(ch);
+        else
+            result.append('_');
+    }
+    return result;
+}
+
+SheetBatchExport::SheetBatchExport(database &db, const QString &folder, bool asPdf) :
+    mDb(db),
+    m_folder(folder),
+    m_asPdf(asPdf),
+    m_generated(0),
+    m_skipped(0),
+    m_removed(0),
+    m_failed(0),
+    m_canceled(false)
+{
+    m_extension = m_asPdf ? QStringLiteral(".pdf") : QStringLiteral(".odt");
+}
+
+bool SheetBatchExport::exportSheets(int types, const ProgressCallback &progress)
+{
+    m_generated = m_skipped = m_removed = m_failed = 0;
+    m_canceled = false;
+    m_jobHashes.clear();
+
+    QDir dir(m_folder);
+    if (!dir.exists() && !dir.mkpath(QStringLiteral(".")))
+    {
+        qWarning() << "SheetBatchExport: cannot create folder" << m_folder;
+        return false;
+    }
+
+    loadIndex();
+
+    // Settings which affect every sheet: if they changed, regenerate all
+    const QByteArray salt = calcSalt();
+    if (salt != m_salt)
+    {
+        for (IndexEntry &item : m_index)
+            item.hash.clear();
+        m_salt = salt;
+    }
+
+    QVector<Entry> entries;
+    collectEntries(types, entries);
+
+    QSet<QString> currentKeys;
+    currentKeys.reserve(entries.size());
+
+    // Files of current items must never be removed, even if an old entry used the same name
+    // (items swapped names or a deleted item was replaced by a new one with same name)
+    QSet<QString> currentFileNames;
+    currentFileNames.reserve(entries.size());
+    for (const Entry &entry : qAsConst(entries))
+        currentFileNames.insert(entry.fileName);
+
+    const int total = entries.size();
+    int done        = 0;
+
+    for (const Entry &entry : qAsConst(entries))
+    {
+        if (progress && !progress(done, total))
+        {
+            m_canceled = true;
+            break;
+        }
+        done++;
+
+        currentKeys.insert(entry.key);
+
+        QByteArray hash;
+        switch (entry.type)
+        {
+        case JobSheets:
+            hash = hashJob(entry.itemId);
+            break;
+        case StationSheets:
+            hash = hashStation(entry.itemId);
+            break;
+        case ShiftSheets:
+            hash = hashShift(entry.itemId);
+            break;
+        default:
+            break;
+        }
+
+        const QString filePath = dir.filePath(entry.fileName);
+
+        auto it = m_index.find(entry.key);
+        if (it != m_index.end() && it->hash == hash && it->fileName == entry.fileName
+            && QFile::exists(filePath))
+        {
+            m_skipped++;
+            continue;
+        }
+
+        // Item was renamed, remove file generated previously
+        if (it != m_index.end() && it->fileName != entry.fileName
+            && !currentFileNames.contains(it->fileName))
+        {
+            if (QFile::remove(dir.filePath(it->fileName)))
+                m_removed++;
+        }
+
+        if (!writeSheet(entry, filePath))
+        {
+            // Forget old hash so sheet is written again on next export
+            qWarning() << "SheetBatchExport: cannot write" << filePath;
+            m_index.remove(entry.key);
+            m_failed++;
+            continue;
+        }
+        m_generated++;
+
+        IndexEntry &item = m_index[entry.key];
+        item.hash        = hash;
+        item.fileName    = entry.fileName;
+    }
+
+    if (!m_canceled)
+    {
+        // Remove sheets of deleted items, only for exported types
+        auto it = m_index.begin();
+        while (it != m_index.end())
+        {
+            const QString key = it.key();
+            const bool typeExported =
+              ((types & JobSheets) && key.startsWith(QLatin1String("job/")))
+              || ((types & StationSheets) && key.startsWith(QLatin1String("station/")))
+              || ((types & ShiftSheets) && key.startsWith(QLatin1String("shift/")));
+
+            if (typeExported && !currentKeys.contains(key))
+            {
+                if (!currentFileNames.contains(it->fileName)
+                    && QFile::remove(dir.filePath(it->fileName)))
+                    m_removed++;
+                it = m_index.erase(it);
+                continue;
+            }
+            ++it;
+        }
+    }
+
+    if (progress)
+        progress(total, total);
+
+    // Save also when canceled so already generated sheets are not exported again
+    saveIndex();
+    return !m_canceled && m_failed == 0;
+}
+
+bool SheetBatchExport::loadIndex()
+{
+    m_index.clear();
+    m_salt.clear();
+
+    QFile f(QDir(m_folder).filePath(IndexFileName));
+    if (!f.open(QFile::ReadOnly))
+        return false;
+
+    const QJsonObject root = QJsonDocument::fromJson(f.readAll()).object();
+    if (root.value(QLatin1String("version")).toInt() != SheetIndexVersion)
+        return false;
+
+    // Index created for the other format, sheets are different files
+    if (root.value(QLatin1String("format")).toString() != m_extension)
+        return false;
+
+    m_salt = QByteArray::fromHex(root.value(QLatin1String("salt")).toString().toLatin1());
+
+    const QJsonObject sheets = root.value(QLatin1String("sheets")).toObject();
+    for (auto it = sheets.constBegin(); it != sheets.constEnd(); ++it)
+    {
+        const QJsonObject obj = it.value().toObject();
+        IndexEntry item;
+        item.hash     = QByteArray::fromHex(obj.value(QLatin1String("hash")).toString().toLatin1());
+        item.fileName = obj.value(QLatin1String("file")).toString();
+        if (item.fileName.isEmpty())
+            continue;
+        m_index.insert(it.key(), item);
+    }
+
+    return true;
+}
+
+bool SheetBatchExport::saveIndex()
+{
+    QJsonObject sheets;
+    for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it)
+    {
+        QJsonObject obj;
+        obj.insert(QLatin1String("hash"), QString::fromLatin1(it->hash.toHex()));
+        obj.insert(QLatin1String("file"), it->fileName);
+        sheets.insert(it.key(), obj);
+    }
+
+    QJsonObject root;
+    root.insert(QLatin1String("version"), SheetIndexVersion);
+    root.insert(QLatin1String("format"), m_extension);
+    root.insert(QLatin1String("salt"), QString::fromLatin1(m_salt.toHex()));
+    root.insert(QLatin1String("sheets"), sheets);
+
+    QFile f(QDir(m_folder).filePath(IndexFileName));
+    if (!f.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        qWarning() << "SheetBatchExport: cannot write index" << f.fileName() << f.errorString();
+        return false;
+    }
+
+    f.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+QByteArray SheetBatchExport::calcSalt()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(AppVersion.toUtf8());
+    hash.addData(m_extension.toUtf8());
+    hash.addData(Session->getSheetExportLocale().bcp47Name().toUtf8());
+
+    // Application fallbacks for header/footer
+    hash.addData(AppSettings.getSheetHeader().toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(AppSettings.getSheetFooter().toUtf8());
+    hash.addData(QByteArray(1, AppSettings.getSheetStoreLocationDateInMeta() ? '1' : '0'));
+
+    // Meeting information, logo and session header/footer
+    query q(mDb, "SELECT name,val FROM metadata ORDER BY name");
+    addQueryRows(hash, q);
+
+    return hash.result();
+}
+
+void SheetBatchExport::collectEntries(int types, QVector<Entry> &entries)
+{
+    QSet<QString> usedNames;
+
+    auto makeFileName = [this, &usedNames](const QString &prefix, const QString &name, db_id id)
+    {
+        QString fileName = prefix + sanitizeFileName(name);
+        if (usedNames.contains(fileName))
+            fileName += QLatin1Char('_') + QString::number(id); // Disambiguate
+        usedNames.insert(fileName);
+        return fileName + m_extension;
+    };
+
+    if (types & JobSheets)
+    {
+        query q(mDb, "SELECT id,category FROM jobs ORDER BY id");
+        for (auto job : q)
+        {
+            Entry entry;
+            entry.type     = JobSheets;
+            entry.itemId   = job.get<db_id>(0);
+            entry.jobCat   = JobCategory(job.get<int>(1));
+            entry.key      = QStringLiteral("job/%1").arg(entry.itemId);
+            entry.fileName = makeFileName(QStringLiteral("job_"),
+                                          JobCategoryName::jobName(entry.itemId, entry.jobCat),
+                                          entry.itemId);
+            entries.append(entry);
+        }
+    }
+
+    if (types & StationSheets)
+    {
+        query q(mDb, "SELECT id,name FROM stations ORDER BY name,id");
+        for (auto st : q)
+        {
+            Entry entry;
+            entry.type     = StationSheets;
+            entry.itemId   = st.get<db_id>(0);
+            entry.key      = QStringLiteral("station/%1").arg(entry.itemId);
+            entry.fileName = makeFileName(QStringLiteral("station_"), st.get<QString>(1),
+                                          entry.itemId);
+            entries.append(entry);
+        }
+    }
+
+    if (types & ShiftSheets)
+    {
+        query q(mDb, "SELECT id,name FROM jobshifts ORDER BY name,id");
+        for (auto shift : q)
+        {
+            Entry entry;
+            entry.type     = ShiftSheets;
+            entry.itemId   = shift.get<db_id>(0);
+            entry.key      = QStringLiteral("shift/%1").arg(entry.itemId);
+            entry.fileName = makeFileName(QStringLiteral("shift_"), shift.get<QString>(1),
+                                          entry.itemId);
+            entries.append(entry);
+        }
+    }
+}
+
+QByteArray SheetBatchExport::hashJob(db_id jobId)
+{
+    auto cached = m_jobHashes.constFind(jobId);
+    if (cached != m_jobHashes.constEnd())
+        return cached.value();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    query q(mDb, "SELECT category FROM jobs WHERE id=?");
+    q.bind(1, jobId);
+    addQueryRows(hash, q);
+
+    // Same columns read by JobWriter plus gate sides for direction
+    q.prepare("SELECT stops.id,stops.station_id,stations.name,"
+              "stops.arrival,stops.departure,stops.type,stops.description,"
+              "t1.name,t2.name,g1.track_side,g2.track_side,"
+              "gt1.side,gt2.side"
+              " FROM stops"
+              " JOIN stations ON stations.id=stops.station_id"
+              " LEFT JOIN station_gate_connections g1 ON g1.id=stops.in_gate_conn"
+              " LEFT JOIN station_gate_connections g2 ON g2.id=stops.out_gate_conn"
+              " LEFT JOIN station_tracks t1 ON t1.id=g1.track_id"
+              " LEFT JOIN station_tracks t2 ON t2.id=g2.track_id"
+              " LEFT JOIN station_gates gt1 ON gt1.id=g1.gate_id"
+              " LEFT JOIN station_gates gt2 ON gt2.id=g2.gate_id"
+              " WHERE stops.job_id=? ORDER BY stops.arrival");
+    q.bind(1, jobId);
+    addQueryRows(hash, q);
+
+    q.prepare("SELECT coupling.stop_id,coupling.operation,coupling.rs_id,"
+              "rs_list.number,rs_models.name,rs_models.suffix,rs_models.type,rs_models.axes"
+              " FROM coupling"
+              " JOIN stops ON stops.id=coupling.stop_id"
+              " JOIN rs_list ON rs_list.id=coupling.rs_id"
+              " LEFT JOIN rs_models ON rs_models.id=rs_list.model_id"
+              " WHERE stops.job_id=?"
+              " ORDER BY stops.arrival,coupling.operation,coupling.rs_id");
+    q.bind(1, jobId);
+    addQueryRows(hash, q);
+
+    // Crossings and passings with other jobs
+    q.prepare("SELECT s1.id,s2.id,s2.job_id,jobs.category,s2.arrival,s2.departure"
+              " FROM stops s1"
+              " JOIN stops s2 ON s2.station_id=s1.station_id AND s2.departure>=s1.arrival"
+              " AND s2.arrival<=s1.departure AND s2.job_id<>s1.job_id"
+              " JOIN jobs ON jobs.id=s2.job_id"
+              " WHERE s1.job_id=? ORDER BY s1.id,s2.id");
+    q.bind(1, jobId);
+    addQueryRows(hash, q);
+
+    QByteArray result = hash.result();
+    m_jobHashes.insert(jobId, result);
+    return result;
+}
+
+QByteArray SheetBatchExport::hashStation(db_id stationId)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    query q(mDb, "SELECT name,short_name FROM stations WHERE id=?");
+    q.bind(1, stationId);
+    addQueryRows(hash, q);
+
+    // Same columns read by StationWriter plus previous and next station of each stop
+    q.prepare("SELECT stops.id,stops.job_id,jobs.category,"
+              "stops.arrival,stops.departure,stops.type,stops.description,"
+              "t1.name,t2.name,g1.track_side,g2.track_side,"
+              "(SELECT st.name FROM stops p JOIN stations st ON st.id=p.station_id"
+              " WHERE p.job_id=stops.job_id AND p.departure<stops.departure"
+              " ORDER BY p.departure DESC LIMIT 1),"
+              "(SELECT st.name FROM stops n JOIN stations st ON st.id=n.station_id"
+              " WHERE n.job_id=stops.job_id AND n.arrival>stops.arrival"
+              " ORDER BY n.arrival LIMIT 1)"
+              " FROM stops"
+              " JOIN jobs ON jobs.id=stops.job_id"
+              " LEFT JOIN station_gate_connections g1 ON g1.id=stops.in_gate_conn"
+              " LEFT JOIN station_gate_connections g2 ON g2.id=stops.out_gate_conn"
+              " LEFT JOIN station_tracks t1 ON t1.id=g1.track_id"
+              " LEFT JOIN station_tracks t2 ON t2.id=g2.track_id"
+              " WHERE stops.station_id=?"
+              " ORDER BY stops.arrival,stops.job_id");
+    q.bind(1, stationId);
+    addQueryRows(hash, q);
+
+    q.prepare("SELECT coupling.stop_id,coupling.operation,coupling.rs_id,"
+              "rs_list.number,rs_models.name,rs_models.suffix,rs_models.type"
+              " FROM coupling"
+              " JOIN stops ON stops.id=coupling.stop_id"
+              " JOIN rs_list ON rs_list.id=coupling.rs_id"
+              " LEFT JOIN rs_models ON rs_models.id=rs_list.model_id"
+              " WHERE stops.station_id=?"
+              " ORDER BY stops.arrival,stops.job_id,coupling.operation,coupling.rs_id");
+    q.bind(1, stationId);
+    addQueryRows(hash, q);
+
+    return hash.result();
+}
+
+QByteArray SheetBatchExport::hashShift(db_id shiftId)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    query q(mDb, "SELECT name FROM jobshifts WHERE id=?");
+    q.bind(1, shiftId);
+    addQueryRows(hash, q);
+
+    // Shift sheet contains a full job sheet for every job
+    QVector<db_id> jobs;
+    q.prepare("SELECT id FROM jobs WHERE shift_id=? ORDER BY id");
+    q.bind(1, shiftId);
+    for (auto job : q)
+        jobs.append(job.get<db_id>(0));
+
+    for (db_id jobId : qAsConst(jobs))
+        hash.addData(hashJob(jobId));
+
+    return hash.result();
+}
+
+bool SheetBatchExport::writeSheet(const Entry &entry, const QString &filePath)
+{
+    switch (entry.type)
+    {
+    case JobSheets:
+    {
+        JobSheetExport sheet(entry.itemId, entry.jobCat);
+        sheet.write();
+        return m_asPdf ? sheet.savePdf(filePath) : sheet.save(filePath);
+    }
+    case StationSheets:
+    {
+        StationSheetExport sheet(entry.itemId);
+        sheet.write();
+        return m_asPdf ? sheet.savePdf(filePath) : sheet.save(filePath);
+    }
+    case ShiftSheets:
+    {
+        ShiftSheetExport sheet(mDb, entry.itemId);
+        sheet.write();
+        return m_asPdf ? sheet.savePdf(filePath) : sheet.save(filePath);
+    }
+    default:
+        break;
+    }
+
+    return false;
+}
+
+void SheetBatchExport::addQueryRows(QCryptographicHash &hash, query &q)
+{
+    const int cols = q.column_count();
+    while (q.step() == SQLITE_ROW)
+    {
+        auto r = q.getRows();
+        for (int i = 0; i < cols; i++)
+        {
+            // Store type and length so adjacent values cannot be confused
+            const char type = char(r.column_type(i));
+            hash.addData(QByteArray(1, type));
+            if (type == SQLITE_NULL)
+                continue;
+
+            const char *data = static_cast<const char *>(r.get<void const *>(i));
+            const int len    = r.column_bytes(i);
+            hash.addData(QByteArray::number(len));
+            hash.addData(QByteArray::fromRawData(data, len));
+        }
+    }
+    q.reset();
+}
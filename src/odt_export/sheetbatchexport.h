@@ -0,0 +1,140 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SHEETBATCHEXPORT_H
+#define SHEETBATCHEXPORT_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+
+#include <functional>
+
+#include "utils/types.h"
+
+#include <sqlite3pp/sqlite3pp.h>
+
+class QCryptographicHash;
+
+/*!
+ * \brief The SheetBatchExport class
+ *
+ * Exports job, station and shift sheets of current session in a folder.
+ * For every sheet a content hash of the database rows it is generated from
+ * is stored in an index file inside the folder.
+ * On next export only sheets whose hash changed or whose file is missing are regenerated.
+ * Files of items no longer existing are removed if they were created by a previous export.
+ */
+class SheetBatchExport
+{
+public:
+    enum SheetType
+    {
+        JobSheets     = 0x1,
+        StationSheets = 0x2,
+        ShiftSheets   = 0x4,
+        AllSheets     = JobSheets | StationSheets | ShiftSheets
+    };
+
+    // Return false to cancel export
+    typedef std::function<bool(int done, int total)> ProgressCallback;
+
+    SheetBatchExport(sqlite3pp::database &db, const QString &folder, bool asPdf);
+
+    // Returns true if all sheets were written, check wasCanceled() and getFailedCount() otherwise
+    bool exportSheets(int types, const ProgressCallback &progress = ProgressCallback());
+
+    inline int getGeneratedCount() const
+    {
+        return m_generated;
+    }
+
+    inline int getSkippedCount() const
+    {
+        return m_skipped;
+    }
+
+    inline int getRemovedCount() const
+    {
+        return m_removed;
+    }
+
+    inline int getFailedCount() const
+    {
+        return m_failed;
+    }
+
+    inline bool wasCanceled() const
+    {
+        return m_canceled;
+    }
+
+    static const QString IndexFileName;
+
+private:
+    struct Entry
+    {
+        QString key;
+        QString fileName;
+        db_id itemId = 0;
+        SheetType type = JobSheets;
+        JobCategory jobCat = JobCategory::FREIGHT;
+    };
+
+    struct IndexEntry
+    {
+        QByteArray hash;
+        QString fileName;
+    };
+
+    bool loadIndex();
+    bool saveIndex();
+
+    QByteArray calcSalt();
+    void collectEntries(int types, QVector<Entry> &entries);
+
+    QByteArray hashJob(db_id jobId);
+    QByteArray hashStation(db_id stationId);
+    QByteArray hashShift(db_id shiftId);
+
+    bool writeSheet(const Entry &entry, const QString &filePath);
+
+    static void addQueryRows(QCryptographicHash &hash, sqlite3pp::query &q);
+
+private:
+    sqlite3pp::database &mDb;
+    QString m_folder;
+    QString m_extension;
+    bool m_asPdf;
+
+    QByteArray m_salt;
+    QHash<QString, IndexEntry> m_index;
+
+    // Cache job hashes, they are reused by shift hashes
+    QHash<db_id, QByteArray> m_jobHashes;
+
+    int m_generated;
+    int m_skipped;
+    int m_removed;
+    int m_failed;
+    bool m_canceled;
+};
+
+#endif // SHEETBATCHEXPORT_H
@@ -143,9 +143,14 @@ void ShiftSheetExport::write()
     odt.endDocument();
 }
 
-void ShiftSheetExport::save(const QString &fileName)
+bool ShiftSheetExport::save(const QString &fileName)
 {
-    odt.saveTo(fileName);
+    return odt.saveTo(fileName);
+}
+
+bool ShiftSheetExport::savePdf(const QString &fileName)
+{
+    return odt.saveToPdf(fileName);
 }
 
 void ShiftSheetExport::writeCoverStyles(QXmlStreamWriter &xml, bool hasImage)
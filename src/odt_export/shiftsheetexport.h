@@ -34,7 +34,8 @@ public:
     ShiftSheetExport(sqlite3pp::database &db, db_id shiftId);
 
     void write();
-    void save(const QString &fileName);
+    bool save(const QString &fileName);
+    bool savePdf(const QString &fileName);
 
     inline void setShiftId(db_id shiftId)
     {
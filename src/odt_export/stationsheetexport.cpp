@@ -97,7 +97,12 @@ void StationSheetExport::write()
     odt.endDocument();
 }
 
-void StationSheetExport::save(const QString &fileName)
+bool StationSheetExport::save(const QString &fileName)
 {
-    odt.saveTo(fileName);
+    return odt.saveTo(fileName);
+}
+
+bool StationSheetExport::savePdf(const QString &fileName)
+{
+    return odt.saveToPdf(fileName);
 }
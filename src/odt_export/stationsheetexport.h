@@ -30,7 +30,8 @@ public:
     StationSheetExport(db_id stationId);
 
     void write();
-    void save(const QString &fileName);
+    bool save(const QString &fileName);
+    bool savePdf(const QString &fileName);
 
 private:
     OdtDocument odt;
@@ -107,6 +107,92 @@ void PrintHelper::calculatePageCount(IGraphScene *scene, Print::PageLayoutOpt &p
       qMax(1, qCeil(srcContentsSize.height() / outEffectivePageSizePoints.height()));
 }
 
+/* renderPage
+ *
+ * Paints a single page tile of the scene.
+ * Painter must be already transformed so logical coordinates are scene coordinates.
+ * sourceRect is the page rect in scene coordinates, including overlap margins.
+ */
+static void renderPage(QPainter *painter, IGraphScene *scene, const QRectF &sourceRect,
+                       const QSizeF &contentsSize, const QSizeF &headerSize,
+                       const Print::PageLayoutScaled &pageLay,
+                       const Print::PageNumberOpt &pageNumOpt, const QString &pageNumStr,
+                       QRectF pageNumbersRect)
+{
+    // Fix margins by half pen with so pen does not draw on over contents
+    const double marginCorrection = pageLay.pageMarginsPen.widthF() / 2.0;
+
+    // Clipping must be set on every new page
+    // Since clipping works in logical (QPainter) coordinates
+    // we use sourceRect which is already transformed
+    painter->setClipRect(sourceRect);
+
+    // Last pages might extend past scene contents, do not render empty parts
+    const QRectF sceneRect = sourceRect.intersected(QRectF(QPointF(), contentsSize));
+
+    if (!sceneRect.isEmpty())
+    {
+        // Render scene contets
+        scene->renderContents(painter, sceneRect);
+
+        // Headers are at scene top and left edges, only first row and column of pages show them
+        // Skip them on other pages instead of rendering them all clipped out
+        if (sceneRect.top() < headerSize.height())
+        {
+            // Render horizontal header
+            QRectF horizHeaderRect = sceneRect;
+            horizHeaderRect.setBottom(headerSize.height());
+            scene->renderHeader(painter, horizHeaderRect, Qt::Horizontal, 0);
+        }
+
+        if (sceneRect.left() < headerSize.width())
+        {
+            // Render vertical header
+            QRectF vertHeaderRect = sceneRect;
+            vertHeaderRect.setRight(headerSize.width());
+            scene->renderHeader(painter, vertHeaderRect, Qt::Vertical, 0);
+        }
+    }
+
+    if (pageLay.lay.drawPageMargins)
+    {
+        // Draw a frame to help align printed pages
+        painter->setPen(pageLay.pageMarginsPen);
+        QLineF arr[4] = {
+          // Top
+          QLineF(sourceRect.left(),
+                 sourceRect.top() + pageLay.overlapMarginWidthScaled - marginCorrection,
+                 sourceRect.right(),
+                 sourceRect.top() + pageLay.overlapMarginWidthScaled - marginCorrection),
+          // Bottom
+          QLineF(sourceRect.left(),
+                 sourceRect.bottom() - pageLay.overlapMarginWidthScaled + marginCorrection,
+                 sourceRect.right(),
+                 sourceRect.bottom() - pageLay.overlapMarginWidthScaled + marginCorrection),
+          // Left
+          QLineF(sourceRect.left() + pageLay.overlapMarginWidthScaled - marginCorrection,
+                 sourceRect.top(),
+                 sourceRect.left() + pageLay.overlapMarginWidthScaled - marginCorrection,
+                 sourceRect.bottom()),
+          // Right
+          QLineF(sourceRect.right() - pageLay.overlapMarginWidthScaled + marginCorrection,
+                 sourceRect.top(),
+                 sourceRect.right() - pageLay.overlapMarginWidthScaled + marginCorrection,
+                 sourceRect.bottom())};
+        painter->drawLines(arr, 4);
+    }
+
+    if (pageNumOpt.enable)
+    {
+        // Draw page numbers to help laying out printed pages
+        // Move to top left but separate a bit from left margin
+        pageNumbersRect.moveTop(sourceRect.top());
+        pageNumbersRect.moveLeft(sourceRect.left() + pageLay.overlapMarginWidthScaled * 1.5);
+        painter->setFont(pageNumOpt.font);
+        painter->drawText(pageNumbersRect, Qt::AlignVCenter | Qt::AlignLeft, pageNumStr);
+    }
+}
+
 bool PrintHelper::printPagedScene(QPainter *painter, Print::IPagedPaintDevice *dev,
                                   IGraphScene *scene, Print::IProgress *progress,
                                   Print::PageLayoutScaled &pageLay,
@@ -118,9 +204,6 @@ bool PrintHelper::printPagedScene(QPainter *painter, Print::IPagedPaintDevice *d
     // NOTE: effectivePageSize is in points, we need to scale by inverse of source scene
     effectivePageSize /= pageLay.lay.sourceScaleFactor;
 
-    // Fix margins by half pen with so pen does not draw on over contents
-    const double marginCorrection = pageLay.pageMarginsPen.widthF() / 2.0;
-
     // Page info rect above top margin to draw page numbers
     QRectF pageNumbersRect(QPointF(pageLay.overlapMarginWidthScaled, 0),
                            QSizeF(effectivePageSize.width(), pageLay.overlapMarginWidthScaled));
@@ -134,137 +217,85 @@ bool PrintHelper::printPagedScene(QPainter *painter, Print::IPagedPaintDevice *d
 
     pageNumOpt.font.setPointSizeF(fontSizePt / pageLay.realScaleFactor);
 
-    const QSizeF headerSize = scene->getHeaderSize();
+    const int pageCount = pageLay.lay.pageCountHoriz * pageLay.lay.pageCountVert;
 
     // Set maximum progress (= total page count)
     if (progress
-        && !progress->reportProgressAndContinue(Print::IProgress::ProgressSetMaximum,
-                                                pageLay.lay.pageCountHoriz
-                                                  * pageLay.lay.pageCountVert))
+        && !progress->reportProgressAndContinue(Print::IProgress::ProgressSetMaximum, pageCount))
         return false;
 
     // Rect to paint on each page (inverse scale of source)
-    QRectF sourceRect =
+    QRectF baseSourceRect =
       QRectF(QPointF(), pageLay.lay.pageRectPoints.size() / pageLay.lay.sourceScaleFactor);
 
     // Shift by top left page margins
     const QPointF origin(pageLay.overlapMarginWidthScaled, pageLay.overlapMarginWidthScaled);
-    sourceRect.moveTopLeft(sourceRect.topLeft() - origin);
+    baseSourceRect.moveTopLeft(baseSourceRect.topLeft() - origin);
+
+    auto pageSourceRect = [&baseSourceRect, &effectivePageSize](int x, int y) -> QRectF
+    {
+        return baseSourceRect.translated(x * effectivePageSize.width(),
+                                         y * effectivePageSize.height());
+    };
 
-    for (int y = 0; y < pageLay.lay.pageCountVert; y++)
+    auto pageNumberString = [&pageLay, &pageNumOpt](int x, int y) -> QString
+    {
+        if (!pageNumOpt.enable)
+            return QString();
+
+        // Add +1 because loop starts from 0
+        return pageNumOpt.fmt.arg(y + 1)
+          .arg(pageLay.lay.pageCountVert)
+          .arg(x + 1)
+          .arg(pageLay.lay.pageCountHoriz);
+    };
+
+    // Scene size does not change while printing, query it once
+    const QSizeF contentsSize = scene->getContentsSize();
+    const QSizeF headerSize   = scene->getHeaderSize();
+
+    // NOTE: pages are painted directly on the device, in order.
+    // Scene rendering is not thread safe, and text sized with setFontPointSizeDPI() depends on
+    // resolution of the painted device. Recording on an intermediate device (QPicture or image)
+    // would not match printer resolution and rasterizing would lose vector output.
+    bool result = true;
+
+    for (int y = 0; y < pageLay.lay.pageCountVert && result; y++)
     {
         for (int x = 0; x < pageLay.lay.pageCountHoriz; x++)
         {
-            const bool onFirstPage = x + y == 0;
+            const int pageIdx      = y * pageLay.lay.pageCountHoriz + x;
+            const bool onFirstPage = pageIdx == 0;
+
             // To avoid calling newPage() at end of loop
             // which would result in an empty extra page after last drawn page
             dev->newPage(painter, pageLay.devicePageRectPixels, onFirstPage);
 
-            if (dev->needsInitForEachPage() || onFirstPage)
-            {
-                // If on first page of current scene or need init for every page
-                // Reset painter transform because device might be already inited
-                painter->resetTransform();
-
-                // Apply scaling
-                painter->scale(pageLay.realScaleFactor, pageLay.realScaleFactor);
-
-                // Shift by inverse of top left page margins
-                painter->translate(origin);
-            }
-
-            // Clipping must be set on every new page
-            // Since clipping works in logical (QPainter) coordinates
-            // we use sourceRect which is already transformed
-            painter->setClipRect(sourceRect);
-
-            QRectF sceneRect = sourceRect;
-            if (sceneRect.left() < 0)
-                sceneRect.setLeft(0);
-            if (sceneRect.top() < 0)
-                sceneRect.setTop(0);
+            const QRectF sourceRect = pageSourceRect(x, y);
 
-            // Render scene contets
-            scene->renderContents(painter, sceneRect);
+            // Reset painter transform on every page because device might be already inited
+            painter->resetTransform();
 
-            // Render horizontal header
-            QRectF horizHeaderRect = sceneRect;
-            horizHeaderRect.moveTop(0);
-            horizHeaderRect.setBottom(headerSize.height());
-            scene->renderHeader(painter, horizHeaderRect, Qt::Horizontal, 0);
+            // Apply scaling
+            painter->scale(pageLay.realScaleFactor, pageLay.realScaleFactor);
 
-            // Render vertical header
-            QRectF vertHeaderRect = sceneRect;
-            vertHeaderRect.moveLeft(0);
-            vertHeaderRect.setRight(headerSize.width());
-            scene->renderHeader(painter, vertHeaderRect, Qt::Vertical, 0);
+            // Shift by inverse of top left page margins and page position
+            painter->translate(-sourceRect.topLeft());
 
-            if (pageLay.lay.drawPageMargins)
-            {
-                // Draw a frame to help align printed pages
-                painter->setPen(pageLay.pageMarginsPen);
-                QLineF arr[4] = {
-                  // Top
-                  QLineF(sourceRect.left(),
-                         sourceRect.top() + pageLay.overlapMarginWidthScaled - marginCorrection,
-                         sourceRect.right(),
-                         sourceRect.top() + pageLay.overlapMarginWidthScaled - marginCorrection),
-                  // Bottom
-                  QLineF(sourceRect.left(),
-                         sourceRect.bottom() - pageLay.overlapMarginWidthScaled + marginCorrection,
-                         sourceRect.right(),
-                         sourceRect.bottom() - pageLay.overlapMarginWidthScaled + marginCorrection),
-                  // Left
-                  QLineF(sourceRect.left() + pageLay.overlapMarginWidthScaled - marginCorrection,
-                         sourceRect.top(),
-                         sourceRect.left() + pageLay.overlapMarginWidthScaled - marginCorrection,
-                         sourceRect.bottom()),
-                  // Right
-                  QLineF(sourceRect.right() - pageLay.overlapMarginWidthScaled + marginCorrection,
-                         sourceRect.top(),
-                         sourceRect.right() - pageLay.overlapMarginWidthScaled + marginCorrection,
-                         sourceRect.bottom())};
-                painter->drawLines(arr, 4);
-            }
+            renderPage(painter, scene, sourceRect, contentsSize, headerSize, pageLay, pageNumOpt,
+                       pageNumberString(x, y), pageNumbersRect);
 
-            if (pageNumOpt.enable)
+            // Report progress
+            if (progress && !progress->reportProgressAndContinue(pageIdx, pageCount))
             {
-                // Draw page numbers to help laying out printed pages
-                // Add +1 because loop starts from 0
-                const QString str = pageNumOpt.fmt.arg(y + 1)
-                                      .arg(pageLay.lay.pageCountVert)
-                                      .arg(x + 1)
-                                      .arg(pageLay.lay.pageCountHoriz);
-
-                // Move to top left but separate a bit from left margin
-                pageNumbersRect.moveTop(sourceRect.top());
-                pageNumbersRect.moveLeft(sourceRect.left()
-                                         + pageLay.overlapMarginWidthScaled * 1.5);
-                painter->setFont(pageNumOpt.font);
-                painter->drawText(pageNumbersRect, Qt::AlignVCenter | Qt::AlignLeft, str);
+                result = false;
+                break;
             }
-
-            // Go left
-            sourceRect.moveLeft(sourceRect.left() + effectivePageSize.width());
-            painter->translate(-effectivePageSize.width(), 0);
-
-            // Report progress
-            if (progress
-                && !progress->reportProgressAndContinue(y * pageLay.lay.pageCountHoriz + x,
-                                                        pageLay.lay.pageCountHoriz
-                                                          * pageLay.lay.pageCountVert))
-                return false;
         }
-
-        // Go down and back to left most column
-        sourceRect.moveTop(sourceRect.top() + effectivePageSize.height());
-        painter->translate(sourceRect.left() + origin.x(), -effectivePageSize.height());
-        sourceRect.moveLeft(-origin.x());
     }
 
     // Reset to top most and left most
-    painter->translate(sourceRect.topLeft());
-    sourceRect.moveTopLeft(QPointF());
+    painter->resetTransform();
 
-    return true;
+    return result;
 }
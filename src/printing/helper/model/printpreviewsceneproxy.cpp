@@ -28,8 +28,12 @@
 PrintPreviewSceneProxy::PrintPreviewSceneProxy(QObject *parent) :
     IGraphScene(parent),
     m_sourceScene(nullptr),
-    viewScaleFactor(1)
+    viewScaleFactor(1),
+    m_tileScale(0)
 {
+    // Cost is in KiB, keep about 64 MiB of tiles
+    m_tileCache.setMaxCost(64 * 1024);
+
     originalHeaderSize = QSizeF(70, 70);
     setViewScaleFactor(1.0);
 }
@@ -69,26 +73,11 @@ void PrintPreviewSceneProxy::renderContents(QPainter *painter, const QRectF &sce
         painter->translate(origin);
         painter->scale(m_pageLay.sourceScaleFactor, m_pageLay.sourceScaleFactor);
 
-        // Draw source contents
-        m_sourceScene->renderContents(painter, sourceRect);
-
-        QSizeF headerSize = m_sourceScene->getHeaderSize();
-
-        // If on top draw horizontal header
-        if (sourceRect.top() < headerSize.height())
-        {
-            QRectF horizHeaderRect = sourceRect;
-            horizHeaderRect.setBottom(headerSize.height());
-            m_sourceScene->renderHeader(painter, horizHeaderRect, Qt::Horizontal, 0);
-        }
-
-        // If on left draw vertical header
-        if (sourceRect.left() < headerSize.width())
-        {
-            QRectF vertHeaderRect = sourceRect;
-            vertHeaderRect.setRight(headerSize.width());
-            m_sourceScene->renderHeader(painter, vertHeaderRect, Qt::Vertical, 0);
-        }
+        // Draw source contents and headers, clipped to requested rect
+        painter->save();
+        painter->setClipRect(sourceRect, Qt::IntersectClip);
+        drawSourceTiles(painter, sourceRect);
+        painter->restore();
 
         // Wash out a bit to make page borders more visible
         painter->fillRect(sourceRect, QColor(40, 255, 40, 100));
@@ -170,9 +159,9 @@ void PrintPreviewSceneProxy::setSourceScene(IGraphScene *newSourceScene)
         disconnect(m_sourceScene, &QObject::destroyed, this,
                    &PrintPreviewSceneProxy::onSourceSceneDestroyed);
         disconnect(m_sourceScene, &IGraphScene::redrawGraph, this,
-                   &PrintPreviewSceneProxy::updateSourceSizeAndRedraw);
+                   &PrintPreviewSceneProxy::onSourceSceneChanged);
         disconnect(m_sourceScene, &IGraphScene::headersSizeChanged, this,
-                   &PrintPreviewSceneProxy::updateSourceSizeAndRedraw);
+                   &PrintPreviewSceneProxy::onSourceSceneChanged);
     }
     m_sourceScene = newSourceScene;
     if (m_sourceScene)
@@ -180,12 +169,12 @@ void PrintPreviewSceneProxy::setSourceScene(IGraphScene *newSourceScene)
         connect(m_sourceScene, &QObject::destroyed, this,
                 &PrintPreviewSceneProxy::onSourceSceneDestroyed);
         connect(m_sourceScene, &IGraphScene::redrawGraph, this,
-                &PrintPreviewSceneProxy::updateSourceSizeAndRedraw);
+                &PrintPreviewSceneProxy::onSourceSceneChanged);
         connect(m_sourceScene, &IGraphScene::headersSizeChanged, this,
-                &PrintPreviewSceneProxy::updateSourceSizeAndRedraw);
+                &PrintPreviewSceneProxy::onSourceSceneChanged);
     }
 
-    updateSourceSizeAndRedraw();
+    onSourceSceneChanged();
 }
 
 double PrintPreviewSceneProxy::getViewScaleFactor() const
@@ -221,9 +210,104 @@ void PrintPreviewSceneProxy::setPageLay(const Print::PageLayoutOpt &newPageLay)
 void PrintPreviewSceneProxy::onSourceSceneDestroyed()
 {
     m_sourceScene = nullptr;
+    onSourceSceneChanged();
+}
+
+void PrintPreviewSceneProxy::onSourceSceneChanged()
+{
+    // Render tiles again on next paint
+    m_tileCache.clear();
+
     updateSourceSizeAndRedraw();
 }
 
+void PrintPreviewSceneProxy::drawSourceTiles(QPainter *painter, const QRectF &sourceRect)
+{
+    if (sourceRect.isEmpty())
+        return;
+
+    // Device pixels per source unit, tiles rendered at a different scale are not valid
+    const QTransform t      = painter->combinedTransform();
+    const qreal deviceScale = qSqrt(t.m11() * t.m11() + t.m12() * t.m12())
+                            * painter->device()->devicePixelRatioF();
+    if (qFuzzyIsNull(deviceScale))
+        return;
+
+    if (!qFuzzyCompare(deviceScale, m_tileScale))
+    {
+        m_tileCache.clear();
+        m_tileScale = deviceScale;
+    }
+
+    // Only tiles intersecting painted rect are drawn
+    const qreal tileSize = TileSizePixels / deviceScale;
+    const int firstX     = qFloor(sourceRect.left() / tileSize);
+    const int lastX      = qFloor(sourceRect.right() / tileSize);
+    const int firstY     = qFloor(sourceRect.top() / tileSize);
+    const int lastY      = qFloor(sourceRect.bottom() / tileSize);
+
+    for (int y = firstY; y <= lastY; y++)
+    {
+        for (int x = firstX; x <= lastX; x++)
+        {
+            const QRectF tileRect(x * tileSize, y * tileSize, tileSize, tileSize);
+            const quint64 key = (quint64(quint32(y)) << 32) | quint32(x);
+
+            QPixmap *tile     = m_tileCache.object(key);
+            if (!tile)
+            {
+                tile           = new QPixmap(renderSourceTile(tileRect, painter->renderHints()));
+                const int cost = tile->width() * tile->height() * 4 / 1024;
+                if (!m_tileCache.insert(key, tile, cost))
+                    continue; // Already deleted by cache
+            }
+
+            painter->drawPixmap(tileRect, *tile, QRectF(tile->rect()));
+        }
+    }
+}
+
+QPixmap PrintPreviewSceneProxy::renderSourceTile(const QRectF &tileRect,
+                                                 QPainter::RenderHints hints) const
+{
+    QPixmap pix(TileSizePixels, TileSizePixels);
+    pix.fill(Qt::transparent);
+
+    const QRectF contentsRect(QPointF(), m_sourceScene->getContentsSize());
+    const QRectF sceneRect = tileRect.intersected(contentsRect);
+    if (sceneRect.isEmpty())
+        return pix;
+
+    const QSizeF headerSize = m_sourceScene->getHeaderSize();
+
+    // Fonts are sized on pixmap resolution (see setFontPointSizeDPI()), same as the view
+    QPainter painter(&pix);
+    painter.setRenderHints(hints);
+    painter.scale(m_tileScale, m_tileScale);
+    painter.translate(-tileRect.topLeft());
+    painter.setClipRect(sceneRect);
+
+    // Draw source contents
+    m_sourceScene->renderContents(&painter, sceneRect);
+
+    // Draw headers on top of contents, only tiles at scene top and left edges show them
+    if (sceneRect.top() < headerSize.height())
+    {
+        QRectF horizHeaderRect = sceneRect;
+        horizHeaderRect.setBottom(headerSize.height());
+        m_sourceScene->renderHeader(&painter, horizHeaderRect, Qt::Horizontal, 0);
+    }
+
+    if (sceneRect.left() < headerSize.width())
+    {
+        QRectF vertHeaderRect = sceneRect;
+        vertHeaderRect.setRight(headerSize.width());
+        m_sourceScene->renderHeader(&painter, vertHeaderRect, Qt::Vertical, 0);
+    }
+
+    return pix;
+}
+
 void PrintPreviewSceneProxy::updateSourceSizeAndRedraw()
 {
     PrintHelper::calculatePageCount(m_sourceScene, m_pageLay, effectivePageSize);
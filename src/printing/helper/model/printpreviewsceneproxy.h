@@ -24,6 +24,9 @@
 
 #include "printhelper.h"
 
+#include <QCache>
+#include <QPixmap>
+
 class PrintPreviewSceneProxy : public IGraphScene
 {
     Q_OBJECT
@@ -48,9 +51,13 @@ signals:
 
 private slots:
     void onSourceSceneDestroyed();
+    void onSourceSceneChanged();
     void updateSourceSizeAndRedraw();
 
 private:
+    void drawSourceTiles(QPainter *painter, const QRectF &sourceRect);
+    QPixmap renderSourceTile(const QRectF &tileRect, QPainter::RenderHints hints) const;
+
     void drawPageBorders(QPainter *painter, const QRectF &sceneRect, bool isHeader,
                          Qt::Orientation orient = Qt::Horizontal);
 
@@ -61,6 +68,12 @@ private:
 
     double viewScaleFactor;
     QSizeF originalHeaderSize;
+
+    // Source scene contents and headers rendered in square tiles at view resolution.
+    // Tiles are reused while zoom and source scale do not change, page margins only move them.
+    static constexpr int TileSizePixels = 256;
+    QCache<quint64, QPixmap> m_tileCache;
+    qreal m_tileScale;
 };
 
 #endif // PRINTPREVIEWSCENEPROXY_H
@@ -0,0 +1,162 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "consisttemplatehelper.h"
+
+#include <sqlite3pp/sqlite3pp.h>
+using namespace sqlite3pp;
+
+#include <QDebug>
+
+ConsistTemplateHelper::ConsistTemplateHelper(database &db) :
+    mDb(db)
+{
+}
+
+QVector<ConsistTemplateHelper::Template> ConsistTemplateHelper::getTemplates()
+{
+    QVector<Template> templates;
+
+    query q(mDb, "SELECT t.id,t.name,COUNT(i.rs_id) FROM consist_templates t"
+                 " LEFT JOIN consist_template_items i ON i.template_id=t.id"
+                 " GROUP BY t.id"
+                 " ORDER BY t.name");
+    for (auto r : q)
+    {
+        Template t;
+        t.templateId = r.get<db_id>(0);
+        t.name       = r.get<QString>(1);
+        t.itemCount  = r.get<int>(2);
+        templates.append(t);
+    }
+
+    return templates;
+}
+
+bool ConsistTemplateHelper::templateExists(const QString &name)
+{
+    query q(mDb, "SELECT id FROM consist_templates WHERE name=?");
+    q.bind(1, name.simplified());
+    return q.step() == SQLITE_ROW;
+}
+
+bool ConsistTemplateHelper::saveFromStop(db_id stopId, const QString &name, bool replace,
+                                         QString *errOut)
+{
+    const QString templName = name.simplified();
+    if (templName.isEmpty())
+    {
+        if (errOut)
+            *errOut = tr("Template name must not be empty.");
+        return false;
+    }
+
+    query q(mDb, "SELECT COUNT(1) FROM coupling WHERE stop_id=? AND operation=1");
+    q.bind(1, stopId);
+    q.step();
+    if (q.getRows().get<int>(0) == 0)
+    {
+        if (errOut)
+            *errOut = tr("No rollingstock is coupled at this stop.");
+        return false;
+    }
+
+    sqlite3pp::transaction t(mDb);
+
+    db_id templateId = 0;
+    q.prepare("SELECT id FROM consist_templates WHERE name=?");
+    q.bind(1, templName);
+    if (q.step() == SQLITE_ROW)
+        templateId = q.getRows().get<db_id>(0);
+    q.reset();
+
+    if (templateId && !replace)
+    {
+        if (errOut)
+            *errOut = tr("A template named <b>%1</b> already exists.").arg(templName);
+        t.rollback();
+        return false;
+    }
+
+    command cmd(mDb);
+    int ret = SQLITE_OK;
+
+    if (templateId)
+    {
+        // Replace old items
+        cmd.prepare("DELETE FROM consist_template_items WHERE template_id=?");
+        cmd.bind(1, templateId);
+        ret = cmd.execute();
+    }
+    else
+    {
+        cmd.prepare("INSERT INTO consist_templates(id,name) VALUES(NULL,?)");
+        cmd.bind(1, templName);
+        ret        = cmd.execute();
+        templateId = mDb.last_insert_rowid();
+    }
+
+    if (ret == SQLITE_OK)
+    {
+        // Coupling IDs keep the order in which items were coupled
+        cmd.prepare("INSERT INTO consist_template_items(template_id,rs_id,pos)"
+                    " SELECT ?1,rs_id,id FROM coupling WHERE stop_id=?2 AND operation=1");
+        cmd.bind(1, templateId);
+        cmd.bind(2, stopId);
+        ret = cmd.execute();
+    }
+
+    if (ret != SQLITE_OK)
+    {
+        qWarning() << "ConsistTemplateHelper: cannot save template" << templName << "Stop:"
+                   << stopId << mDb.error_msg();
+        if (errOut)
+            *errOut = tr("Database error: %1").arg(mDb.error_msg());
+        t.rollback();
+        return false;
+    }
+
+    t.commit();
+    return true;
+}
+
+bool ConsistTemplateHelper::removeTemplate(db_id templateId)
+{
+    command cmd(mDb, "DELETE FROM consist_templates WHERE id=?");
+    cmd.bind(1, templateId);
+    if (cmd.execute() != SQLITE_OK)
+    {
+        qWarning() << "ConsistTemplateHelper: cannot remove template" << templateId
+                   << mDb.error_msg();
+        return false;
+    }
+    return true;
+}
+
+QVector<db_id> ConsistTemplateHelper::getTemplateItems(db_id templateId)
+{
+    QVector<db_id> items;
+
+    query q(mDb, "SELECT rs_id FROM consist_template_items WHERE template_id=? ORDER BY pos");
+    q.bind(1, templateId);
+    for (auto r : q)
+        items.append(r.get<db_id>(0));
+
+    return items;
+}
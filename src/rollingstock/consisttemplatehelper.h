@@ -0,0 +1,70 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CONSISTTEMPLATEHELPER_H
+#define CONSISTTEMPLATEHELPER_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVector>
+
+#include "utils/types.h"
+
+namespace sqlite3pp {
+class database;
+} // namespace sqlite3pp
+
+/*!
+ * \brief The ConsistTemplateHelper class
+ *
+ * Named train compositions stored in the session.
+ * A template is saved from rollingstock coupled at a stop
+ * and can then be coupled again at another stop with a single batch operation.
+ */
+class ConsistTemplateHelper
+{
+    Q_DECLARE_TR_FUNCTIONS(ConsistTemplateHelper)
+
+public:
+    struct Template
+    {
+        db_id templateId;
+        QString name;
+        int itemCount;
+    };
+
+    ConsistTemplateHelper(sqlite3pp::database &db);
+
+    QVector<Template> getTemplates();
+
+    bool templateExists(const QString &name);
+
+    // Save rollingstock coupled at stop, template with same name is replaced only if requested
+    bool saveFromStop(db_id stopId, const QString &name, bool replace, QString *errOut = nullptr);
+
+    bool removeTemplate(db_id templateId);
+
+    // Rollingstock of template in saved order
+    QVector<db_id> getTemplateItems(db_id templateId);
+
+private:
+    sqlite3pp::database &mDb;
+};
+
+#endif // CONSISTTEMPLATEHELPER_H
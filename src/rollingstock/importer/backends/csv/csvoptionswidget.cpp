@@ -0,0 +1,87 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "csvoptionswidget.h"
+#include "csvoptions.h"
+
+#include "utils/files/file_format_names.h"
+
+#include <QFormLayout>
+#include <QLabel>
+#include <QSpinBox>
+#include <QComboBox>
+
+#include "app/session.h"
+
+CSVOptionsWidget::CSVOptionsWidget(QWidget *parent) :
+    IOptionsWidget(parent)
+{
+    // CSV Option
+    QFormLayout *lay = new QFormLayout(this);
+    lay->addRow(new QLabel(tr("Import rollingstock pieces and models from a text file.\n"
+                              "Fields must be separated by commas, semicolons or tabs.\n"
+                              "Owner name is taken from file name.\n"
+                              "Extension: (*.csv *.tsv *.txt)")));
+    separatorCombo = new QComboBox;
+    separatorCombo->addItem(tr("Detect automatically"), 0);
+    separatorCombo->addItem(tr("Comma (,)"), int(','));
+    separatorCombo->addItem(tr("Semicolon (;)"), int(';'));
+    separatorCombo->addItem(tr("Tab"), int('\t'));
+    lay->addRow(tr("Field separator"), separatorCombo);
+    csvFirstRowSpin = new QSpinBox;
+    csvFirstRowSpin->setRange(1, 9999);
+    lay->addRow(tr("First non-empty row that contains rollingstock piece information"),
+                csvFirstRowSpin);
+    csvNumColSpin = new QSpinBox;
+    csvNumColSpin->setRange(1, 9999);
+    lay->addRow(tr("Column from which item number is extracted"), csvNumColSpin);
+    csvNameColSpin = new QSpinBox;
+    csvNameColSpin->setRange(1, 9999);
+    lay->addRow(tr("Column from which item model name is extracted"), csvNameColSpin);
+    lay->setAlignment(Qt::AlignTop | Qt::AlignRight);
+}
+
+void CSVOptionsWidget::loadSettings(const QMap<QString, QVariant> &settings)
+{
+    // Same defaults of spreadsheet import
+    csvFirstRowSpin->setValue(settings.value(csvFirstRowKey, AppSettings.getODSFirstRow()).toInt());
+    csvNumColSpin->setValue(settings.value(csvNumColKey, AppSettings.getODSNumCol()).toInt());
+    csvNameColSpin->setValue(settings.value(csvNameColKey, AppSettings.getODSNameCol()).toInt());
+
+    int idx = separatorCombo->findData(settings.value(csvSeparatorKey, 0).toInt());
+    separatorCombo->setCurrentIndex(qMax(0, idx));
+}
+
+void CSVOptionsWidget::saveSettings(QMap<QString, QVariant> &settings)
+{
+    settings.insert(csvFirstRowKey, csvFirstRowSpin->value());
+    settings.insert(csvNumColKey, csvNumColSpin->value());
+    settings.insert(csvNameColKey, csvNameColSpin->value());
+    settings.insert(csvSeparatorKey, separatorCombo->currentData().toInt());
+}
+
+void CSVOptionsWidget::getFileDialogOptions(QString &title, QStringList &fileFormats)
+{
+    title = tr("Open Text File");
+
+    fileFormats.reserve(2);
+    fileFormats << FileFormats::tr(FileFormats::csvFormat);
+    fileFormats << FileFormats::tr(FileFormats::allFiles);
+}
@@ -0,0 +1,47 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef CSVOPTIONSWIDGET_H
+#define CSVOPTIONSWIDGET_H
+
+#include "../ioptionswidget.h"
+
+class QSpinBox;
+class QComboBox;
+
+class CSVOptionsWidget : public IOptionsWidget
+{
+    Q_OBJECT
+public:
+    explicit CSVOptionsWidget(QWidget *parent = nullptr);
+
+    void loadSettings(const QMap<QString, QVariant> &settings) override;
+    void saveSettings(QMap<QString, QVariant> &settings) override;
+
+    void getFileDialogOptions(QString &title, QStringList &fileFormats) override;
+
+private:
+    QSpinBox *csvFirstRowSpin;
+    QSpinBox *csvNumColSpin;
+    QSpinBox *csvNameColSpin;
+    QComboBox *separatorCombo;
+};
+
+#endif // CSVOPTIONSWIDGET_H
@@ -0,0 +1,139 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "csvtokenizer.h"
+
+QByteArray CSVTokenizer::Field::toByteArray() const
+{
+    if (!escapedQuotes)
+        return QByteArray(begin, int(end - begin));
+
+    QByteArray result;
+    result.reserve(int(end - begin));
+    for (const char *p = begin; p < end; p++)
+    {
+        result.append(*p);
+        if (*p == '"')
+            p++; // Skip second quote of pair
+    }
+    return result;
+}
+
+CSVTokenizer::CSVTokenizer(const char *data, qint64 size, char separator) :
+    mBegin(data),
+    mPos(data),
+    mEnd(data + size),
+    mSeparator(separator)
+{
+}
+
+bool CSVTokenizer::readRecord(QVector<Field> &fields)
+{
+    fields.clear();
+    if (mPos >= mEnd)
+        return false;
+
+    while (true)
+    {
+        Field field;
+        if (*mPos == '"')
+        {
+            mPos++;
+            field.begin = mPos;
+            while (mPos < mEnd)
+            {
+                if (*mPos == '"')
+                {
+                    if (mPos + 1 < mEnd && mPos[1] == '"')
+                    {
+                        field.escapedQuotes = true;
+                        mPos += 2;
+                        continue;
+                    }
+                    break; // Closing quote
+                }
+                mPos++;
+            }
+            field.end = mPos;
+
+            if (mPos < mEnd)
+                mPos++; // Skip closing quote
+
+            // Tolerate garbage after closing quote
+            while (mPos < mEnd && !isFieldEnd(*mPos))
+                mPos++;
+        }
+        else
+        {
+            field.begin = mPos;
+            while (mPos < mEnd && !isFieldEnd(*mPos))
+                mPos++;
+            field.end = mPos;
+        }
+
+        fields.append(field);
+
+        if (mPos < mEnd && *mPos == mSeparator)
+        {
+            mPos++;
+            if (mPos == mEnd)
+                fields.append(Field{mPos, mPos, false}); // Trailing empty field
+            else
+                continue;
+        }
+
+        // End of record, accept LF, CRLF and CR
+        if (mPos < mEnd && *mPos == '\r')
+            mPos++;
+        if (mPos < mEnd && *mPos == '\n')
+            mPos++;
+        return true;
+    }
+}
+
+char CSVTokenizer::detectSeparator(const char *data, qint64 size)
+{
+    int commas     = 0;
+    int semicolons = 0;
+    int tabs       = 0;
+    bool quoted    = false;
+
+    for (const char *p = data, *end = data + size; p < end; p++)
+    {
+        if (*p == '"')
+            quoted = !quoted;
+        else if (quoted)
+            continue;
+        else if (*p == '\n' || *p == '\r')
+            break;
+        else if (*p == ',')
+            commas++;
+        else if (*p == ';')
+            semicolons++;
+        else if (*p == '\t')
+            tabs++;
+    }
+
+    if (tabs >= commas && tabs >= semicolons && tabs > 0)
+        return '\t';
+    if (semicolons > commas)
+        return ';';
+    return ',';
+}
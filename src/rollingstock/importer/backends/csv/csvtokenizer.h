@@ -0,0 +1,78 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef CSVTOKENIZER_H
+#define CSVTOKENIZER_H
+
+#include <QByteArray>
+#include <QVector>
+
+/*!
+ * \brief The CSVTokenizer class
+ *
+ * Splits CSV/TSV records of a memory buffer, usually a mapped file.
+ * Fields point inside the buffer, data is copied only when converting
+ * a field to QByteArray.
+ * Quoted fields can contain separators, new lines and "" escaped quotes.
+ */
+class CSVTokenizer
+{
+public:
+    struct Field
+    {
+        const char *begin  = nullptr;
+        const char *end    = nullptr;
+        bool escapedQuotes = false; // Quoted field containing "" pairs
+
+        inline bool isEmpty() const
+        {
+            return begin == end;
+        }
+
+        QByteArray toByteArray() const;
+    };
+
+    CSVTokenizer(const char *data, qint64 size, char separator);
+
+    // Returns false when there are no more records
+    bool readRecord(QVector<Field> &fields);
+
+    inline qint64 position() const
+    {
+        return mPos - mBegin;
+    }
+
+    // Pick most frequent of ',' ';' and TAB in first line
+    static char detectSeparator(const char *data, qint64 size);
+
+private:
+    inline bool isFieldEnd(char c) const
+    {
+        return c == mSeparator || c == '\n' || c == '\r';
+    }
+
+private:
+    const char *mBegin;
+    const char *mPos;
+    const char *mEnd;
+    const char mSeparator;
+};
+
+#endif // CSVTOKENIZER_H
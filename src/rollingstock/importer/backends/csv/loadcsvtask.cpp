@@ -0,0 +1,176 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "loadcsvtask.h"
+#include "csvtokenizer.h"
+#include "csvoptions.h"
+
+#include "../ods/odsparser.h"
+#include "../ods/odsimporter.h"
+#include "../loadprogressevent.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+#include <QDebug>
+
+LoadCSVTask::LoadCSVTask(const QMap<QString, QVariant> &arguments, sqlite3pp::database &db,
+                         int mode, int defSpeed, RsType defType, const QString &fileName,
+                         QObject *receiver) :
+    ILoadRSTask(db, fileName, receiver),
+    importMode(mode),
+    defaultSpeed(defSpeed),
+    defaultType(defType)
+{
+    m_tblFirstRow     = arguments.value(csvFirstRowKey, 3).toInt();
+    m_tblRSNumberCol  = arguments.value(csvNumColKey, 1).toInt();
+    m_tblModelNameCol = arguments.value(csvNameColKey, 3).toInt();
+    m_separator       = char(arguments.value(csvSeparatorKey, 0).toInt());
+}
+
+void LoadCSVTask::run()
+{
+    if (wasStopped())
+    {
+        sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
+                                        LoadProgressEvent::ProgressMaxFinished),
+                  true);
+        return;
+    }
+
+    // Progress is reported in per mille of file read
+    const int max = 1000;
+    sendEvent(new LoadProgressEvent(this, 0, max), false);
+
+    QFile file(mFileName);
+    if (!file.open(QFile::ReadOnly))
+    {
+        endWithError(file.errorString());
+        return;
+    }
+
+    const qint64 size = file.size();
+    uchar *mapped     = nullptr;
+    if (size > 0)
+    {
+        mapped = file.map(0, size);
+        if (!mapped)
+        {
+            endWithError(file.errorString());
+            return;
+        }
+    }
+
+    const char *data = reinterpret_cast<const char *>(mapped);
+    qint64 dataSize  = size;
+
+    // Skip UTF-8 BOM
+    if (dataSize >= 3 && qstrncmp(data, "\xEF\xBB\xBF", 3) == 0)
+    {
+        data += 3;
+        dataSize -= 3;
+    }
+
+    ODSImporter importer(importMode, defaultSpeed, defaultType, mDb);
+    if (!importer.loadExistingItems())
+    {
+        endWithError(LoadTaskUtils::tr("Cannot load existing rollingstock items."));
+        return;
+    }
+
+    const char separator = m_separator ? m_separator
+                                       : CSVTokenizer::detectSeparator(data, dataSize);
+    CSVTokenizer tokenizer(data, dataSize, separator);
+
+    // Whole file is a single table, use file name as owner name
+    ODSRowBatch batch;
+    batch.sheetStart = true;
+    batch.sheetName  = QFileInfo(mFileName).completeBaseName().simplified();
+
+    const int minFields = qMax(m_tblRSNumberCol, m_tblModelNameCol);
+    QVector<CSVTokenizer::Field> fields;
+    int row = 0;
+
+    while (tokenizer.readRecord(fields))
+    {
+        row++;
+        if (row < m_tblFirstRow || fields.size() < minFields)
+            continue; // First n rows are table header / incomplete
+
+        const CSVTokenizer::Field &numField = fields.at(m_tblRSNumberCol - 1);
+        if (numField.isEmpty())
+            continue;
+
+        // Do not use toInt(), we must tolerate dashes and other non-digit
+        // characters in the middle
+        qint64 number = 0;
+        for (const char *p = numField.begin; p < numField.end; p++)
+        {
+            if (*p >= '0' && *p <= '9')
+                number = number * 10 + (*p - '0');
+        }
+
+        QByteArray model = fields.at(m_tblModelNameCol - 1).toByteArray().simplified();
+        if (model.isEmpty())
+            continue;
+
+        batch.rows.append({model, number});
+
+        if (batch.rows.size() >= RowsPerBatch)
+        {
+            if (wasStopped())
+            {
+                sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
+                                                LoadProgressEvent::ProgressMaxFinished),
+                          true);
+                return;
+            }
+
+            if (!importer.importBatch(batch))
+            {
+                endWithError(LoadTaskUtils::tr("Cannot store imported rollingstock items."));
+                return;
+            }
+
+            batch.rows.clear();
+            batch.sheetStart = false;
+
+            const int progress = int(tokenizer.position() * max / qMax(dataSize, qint64(1)));
+            sendEvent(new LoadProgressEvent(this, progress, max), false);
+        }
+    }
+
+    batch.sheetEnd = true;
+    if (!importer.importBatch(batch))
+    {
+        endWithError(LoadTaskUtils::tr("Cannot store imported rollingstock items."));
+        return;
+    }
+
+    sendEvent(new LoadProgressEvent(this, max, LoadProgressEvent::ProgressMaxFinished), true);
+}
+
+void LoadCSVTask::endWithError(const QString &text)
+{
+    errText = text;
+    sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressError,
+                                    LoadProgressEvent::ProgressMaxFinished),
+              true);
+}
@@ -0,0 +1,67 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef LOADCSVTASK_H
+#define LOADCSVTASK_H
+
+#include "../loadtaskutils.h"
+
+#include "utils/types.h"
+
+/* LoadCSVTask
+ *
+ * Loads rollingstock pieces/models from a CSV or TSV text file (UTF-8)
+ * File is memory mapped and tokenized in place.
+ * Owner name is taken from file name, like ODS uses sheet names.
+ *
+ * Table Characteristics
+ * 1) tblFirstRow: first non-empty RS row (starting from 1, not 0) DEFAULT: 3
+ * 2) tblRSNumberCol: column from which number is extracted  (starting from 1, not 0) DEFAULT: 1
+ * 3) tblModelNameCol: column from which model name is extracted (starting from 1, not 0) DEFAULT: 3
+ * 4) separator: field separator, 0 to detect it from first line DEFAULT: 0
+ */
+class LoadCSVTask : public ILoadRSTask
+{
+public:
+    enum
+    {
+        RowsPerBatch = 512
+    };
+
+    LoadCSVTask(const QMap<QString, QVariant> &arguments, sqlite3pp::database &db, int mode,
+                int defSpeed, RsType defType, const QString &fileName, QObject *receiver);
+
+    void run() override;
+
+private:
+    void endWithError(const QString &text);
+
+private:
+    int m_tblFirstRow;     // Start from 1 (not 0)
+    int m_tblRSNumberCol;  // Start from 1 (not 0)
+    int m_tblModelNameCol; // Start from 1 (not 0)
+    char m_separator;
+    int importMode;
+
+    int defaultSpeed;
+    RsType defaultType;
+};
+
+#endif // LOADCSVTASK_H
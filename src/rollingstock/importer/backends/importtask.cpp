@@ -18,177 +18,278 @@
  */
 
 #include "importtask.h"
+#include "loadprogressevent.h"
+
+#include "loadtaskutils.h"
 
 #include "utils/types.h"
 
 #include <sqlite3pp/sqlite3pp.h>
 
-#include "loadprogressevent.h"
-#include <QCoreApplication>
+#include <limits>
 
 ImportTask::ImportTask(sqlite3pp::database &db, QObject *receiver) :
     IQuittableTask(receiver),
-    mDb(db)
+    mDb(db),
+    inTransaction(false)
 {
 }
 
 void ImportTask::run()
 {
-    sendEvent(new LoadProgressEvent(this, 0, 4), false);
-
-    // FIXME: do copy in batches like LoadSQLiteTask
-    // TODO: get only owners used really
-    sqlite3pp::query q(mDb, "SELECT imp.id,imp.name,imp.new_name FROM imported_rs_owners imp WHERE "
-                            "imp.import=1 AND imp.match_existing_id IS NULL");
-    sqlite3pp::command q_create(mDb, "INSERT INTO rs_owners(id, name) VALUES(NULL, ?)");
-    sqlite3pp::command q_update(mDb,
-                                "UPDATE imported_rs_owners SET match_existing_id=? WHERE id=?");
+    inTransaction = false;
+    errText.clear();
 
-    sqlite3_stmt *st     = q.stmt();
-    sqlite3_stmt *create = q_create.stmt();
-    sqlite3_stmt *update = q_update.stmt();
+    if (wasStopped())
+    {
+        endStopped();
+        return;
+    }
 
-    sqlite3 *db          = mDb.db();
-    sqlite3_mutex *m     = sqlite3_db_mutex(db);
+    sendEvent(new LoadProgressEvent(this, 0, MaxProgress), false);
 
-    int n                = 0;
-    while (q.step() == SQLITE_ROW)
+    // Import everything or nothing, a cancelled import must not leave half created items
+    if (mDb.execute("BEGIN TRANSACTION") != SQLITE_OK)
     {
-        if (n % 8 == 0 && wasStopped())
-        {
-            sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
-                                            LoadProgressEvent::ProgressMaxFinished),
-                      true);
-            return;
-        }
+        endWithDbError(LoadTaskUtils::tr("Could not start transaction."));
+        return;
+    }
+    inTransaction = true;
 
-        // Get imported owner id
-        db_id importedOwnerId = sqlite3_column_int64(st, 0);
-        int len               = 2;
+    // Check foreign keys once on commit instead of after every statement.
+    // Pragma is reset automatically at end of transaction.
+    if (mDb.execute("PRAGMA defer_foreign_keys = ON") != SQLITE_OK)
+    {
+        endWithDbError(LoadTaskUtils::tr("Could not defer foreign keys."));
+        return;
+    }
 
-        if (sqlite3_column_type(st, 2) == SQLITE_NULL)
-        {
-            len = 1; // Get original name instead of the custom one
-        }
+    if (!importOwners())
+        return;
 
-        // Get its name (or new_name)
-        const char *name = reinterpret_cast<const char *>(sqlite3_column_text(st, len));
-        len              = sqlite3_column_bytes(st, len);
+    if (!importModels())
+        return;
 
-        // Create a real owner with this name and get its id
-        sqlite3_bind_text(create, 1, name, len, SQLITE_STATIC);
-        sqlite3_mutex_enter(m);
-        sqlite3_step(create);
-        db_id existingOwnerId = sqlite3_last_insert_rowid(db);
-        sqlite3_mutex_leave(m);
-        sqlite3_reset(create);
+    if (!importRS())
+        return;
 
-        // Set the real owner id in the imported owner record to use it later
-        sqlite3_bind_int64(update, 1, existingOwnerId);
-        sqlite3_bind_int64(update, 2, importedOwnerId);
-        sqlite3_step(update);
-        sqlite3_reset(update);
+    if (wasStopped())
+    {
+        endStopped();
+        return;
+    }
 
-        n++;
+    // Deferred foreign key violations are reported here
+    if (mDb.execute("COMMIT") != SQLITE_OK)
+    {
+        endWithDbError(LoadTaskUtils::tr("Could not commit imported items."));
+        return;
     }
+    inTransaction = false;
 
-    sendEvent(new LoadProgressEvent(this, 1, 4), false);
+    sendEvent(new LoadProgressEvent(this, MaxProgress, LoadProgressEvent::ProgressMaxFinished),
+              true);
+}
 
-    q.prepare(
-      "SELECT imp.id,imp.name,imp.suffix,imp.new_name,imp.max_speed,imp.axes,imp.type,imp.sub_type"
-      " FROM imported_rs_models imp WHERE imp.import=1 AND imp.match_existing_id IS NULL");
-    st = q.stmt();
+void ImportTask::endWithDbError(const QString &text)
+{
+    errText = LoadTaskUtils::tr("%1\n"
+                                "Code: %2\n"
+                                "Message: %3")
+                .arg(text)
+                .arg(mDb.extended_error_code())
+                .arg(mDb.error_msg());
+
+    cleanup();
+
+    sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressError,
+                                    LoadProgressEvent::ProgressMaxFinished),
+              true);
+}
 
-    q_create.prepare("INSERT INTO rs_models(id,name,suffix,max_speed,axes,type,sub_type) "
-                     "VALUES(NULL,?,?,?,?,?,?)"); // Create invalid engine
-    create = q_create.stmt();
+void ImportTask::endStopped()
+{
+    cleanup();
 
-    q_update.prepare("UPDATE imported_rs_models SET match_existing_id=? WHERE id=?");
-    update = q_update.stmt();
+    sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
+                                    LoadProgressEvent::ProgressMaxFinished),
+              true);
+}
 
-    n      = 0;
-    while (q.step() == SQLITE_ROW)
+void ImportTask::cleanup()
+{
+    if (inTransaction)
     {
-        if (n % 8 == 0 && wasStopped())
-        {
-            sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
-                                            LoadProgressEvent::ProgressMaxFinished),
-                      true);
-            return;
-        }
+        // Discard partially imported items and restore match_existing_id
+        mDb.execute("ROLLBACK");
+        inTransaction = false;
+    }
+}
+
+bool ImportTask::importOwners()
+{
+    // TODO: get only owners used really
+    if (!createItems("SELECT COALESCE((SELECT MAX(id) FROM rs_owners),0)"
+                     " - COALESCE((SELECT MIN(id) FROM imported_rs_owners"
+                     " WHERE import=1 AND match_existing_id IS NULL),0) + 1",
+                     "INSERT INTO rs_owners(id,name)"
+                     " SELECT ?1+imp.id,COALESCE(imp.new_name,imp.name)"
+                     " FROM imported_rs_owners imp"
+                     " WHERE imp.import=1 AND imp.match_existing_id IS NULL",
+                     "UPDATE imported_rs_owners SET match_existing_id=?1+id"
+                     " WHERE import=1 AND match_existing_id IS NULL",
+                     'A'))
+        return false;
+
+    sendEvent(new LoadProgressEvent(this, StepSize, MaxProgress), false);
+    return true;
+}
 
-        // Get imported model id
-        db_id importedModelId = sqlite3_column_int64(st, 0);
+bool ImportTask::importModels()
+{
+    if (!createItems("SELECT COALESCE((SELECT MAX(id) FROM rs_models),0)"
+                     " - COALESCE((SELECT MIN(id) FROM imported_rs_models"
+                     " WHERE import=1 AND match_existing_id IS NULL),0) + 1",
+                     "INSERT INTO rs_models(id,name,suffix,max_speed,axes,type,sub_type)"
+                     " SELECT ?1+imp.id,COALESCE(imp.new_name,imp.name),imp.suffix,"
+                     "imp.max_speed,imp.axes,imp.type,imp.sub_type"
+                     " FROM imported_rs_models imp"
+                     " WHERE imp.import=1 AND imp.match_existing_id IS NULL",
+                     "UPDATE imported_rs_models SET match_existing_id=?1+id"
+                     " WHERE import=1 AND match_existing_id IS NULL",
+                     'B'))
+        return false;
+
+    sendEvent(new LoadProgressEvent(this, 2 * StepSize, MaxProgress), false);
+    return true;
+}
 
-        int len               = 3;
-        if (sqlite3_column_type(st, 3) == SQLITE_NULL)
-        {
-            len = 1; // Get original name instead of the custom one ('name' instead of 'new_name'
-        }
+bool ImportTask::createItems(const char *offsetSql, const char *insertSql, const char *updateSql,
+                             char errCode)
+{
+    if (wasStopped())
+    {
+        endStopped();
+        return false;
+    }
 
-        // Get its name (or new_name)
-        const char *name = reinterpret_cast<const char *>(sqlite3_column_text(st, len));
-        len              = sqlite3_column_bytes(st, len);
-        sqlite3_bind_text(create, 1, name, len, SQLITE_STATIC);
+    // New items get imported id shifted after current max id.
+    // This way imported items can be linked to new ones without reading them row by row
+    // and it does not depend on rowid assignment order.
+    sqlite3pp::query q_offset(mDb);
+    if (q_offset.prepare(offsetSql) != SQLITE_OK || q_offset.step() != SQLITE_ROW)
+    {
+        endWithDbError(LoadTaskUtils::tr("Query preparation failed %1%2.").arg(errCode).arg(1));
+        return false;
+    }
+    const db_id idOffset = sqlite3_column_int64(q_offset.stmt(), 0);
+    q_offset.finish();
 
-        // Get its suffix
-        name = reinterpret_cast<const char *>(sqlite3_column_text(st, 2));
-        len  = sqlite3_column_bytes(st, 2);
-        sqlite3_bind_text(create, 2, name, len, SQLITE_STATIC);
+    sqlite3pp::command cmd(mDb);
+    if (cmd.prepare(insertSql) != SQLITE_OK)
+    {
+        endWithDbError(LoadTaskUtils::tr("Query preparation failed %1%2.").arg(errCode).arg(2));
+        return false;
+    }
 
-        // Get its max_speed
-        int val = sqlite3_column_int(st, 4);
-        sqlite3_bind_int(create, 3, val);
+    cmd.bind(1, idOffset);
+    if (cmd.execute() != SQLITE_OK)
+    {
+        endWithDbError(LoadTaskUtils::tr("Could not create imported items."));
+        return false;
+    }
 
-        // Get its axes count
-        val = sqlite3_column_int(st, 5);
-        sqlite3_bind_int(create, 4, val);
+    if (cmd.prepare(updateSql) != SQLITE_OK)
+    {
+        endWithDbError(LoadTaskUtils::tr("Query preparation failed %1%2.").arg(errCode).arg(3));
+        return false;
+    }
 
-        // Get its type
-        val = sqlite3_column_int(st, 6);
-        sqlite3_bind_int(create, 5, val);
+    cmd.bind(1, idOffset);
+    if (cmd.execute() != SQLITE_OK)
+    {
+        endWithDbError(LoadTaskUtils::tr("Could not link imported items."));
+        return false;
+    }
 
-        // Get its sub_type
-        val = sqlite3_column_int(st, 7);
-        sqlite3_bind_int(create, 6, val);
+    return true;
+}
 
-        // Create a real model with this name and get its id
-        sqlite3_mutex_enter(m);
-        sqlite3_step(create);
-        db_id existingModelId = sqlite3_last_insert_rowid(db);
-        sqlite3_mutex_leave(m);
-        sqlite3_reset(create);
+bool ImportTask::importRS()
+{
+    sqlite3pp::query q_getChunkEnd(mDb);
+    sqlite3pp::command q_copy(mDb);
 
-        // Set the real owner id in the imported model record to use it later
-        sqlite3_bind_int64(update, 1, existingModelId);
-        sqlite3_bind_int64(update, 2, importedModelId);
-        sqlite3_step(update);
-        sqlite3_reset(update);
-        n++;
+    // Progress is reported by rows copied
+    int ret = q_getChunkEnd.prepare("SELECT COUNT(*) FROM imported_rs_list");
+    if (ret != SQLITE_OK || q_getChunkEnd.step() != SQLITE_ROW)
+    {
+        endWithDbError(LoadTaskUtils::tr("Query preparation failed %1%2.").arg('C').arg(1));
+        return false;
     }
+    const int totalCount = qMax(1, sqlite3_column_int(q_getChunkEnd.stmt(), 0));
 
-    if (wasStopped())
+    ret = q_getChunkEnd.prepare("SELECT id FROM imported_rs_list WHERE id>?"
+                                " ORDER BY id LIMIT 1 OFFSET " QT_STRINGIFY(RowsPerChunk - 1));
+    if (ret != SQLITE_OK)
     {
-        sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
-                                        LoadProgressEvent::ProgressMaxFinished),
-                  true);
-        return;
+        endWithDbError(LoadTaskUtils::tr("Query preparation failed %1%2.").arg('C').arg(1));
+        return false;
     }
-    else
+
+    ret = q_copy.prepare("INSERT INTO rs_list(id, model_id, number, owner_id)"
+                         " SELECT NULL,m.match_existing_id,COALESCE(imp.new_number,imp.number),"
+                         "o.match_existing_id"
+                         " FROM imported_rs_list imp"
+                         " JOIN imported_rs_models m ON m.id=imp.model_id"
+                         " JOIN imported_rs_owners o ON o.id=imp.owner_id"
+                         " WHERE imp.import=1 AND m.import=1 AND o.import=1"
+                         " AND imp.id>?1 AND imp.id<=?2");
+    if (ret != SQLITE_OK)
     {
-        sendEvent(new LoadProgressEvent(this, 2, 4), false);
+        endWithDbError(LoadTaskUtils::tr("Query preparation failed %1%2.").arg('C').arg(2));
+        return false;
     }
 
-    // Finally import rollingstock
-    q_create.prepare("INSERT INTO rs_list(id, model_id, number, owner_id)"
-                     " SELECT NULL, m.match_existing_id, (CASE WHEN imp.new_number IS NULL THEN "
-                     "imp.number ELSE imp.new_number END), o.match_existing_id"
-                     " FROM imported_rs_list imp"
-                     " JOIN imported_rs_models m ON m.id=imp.model_id "
-                     " JOIN imported_rs_owners o ON o.id=imp.owner_id"
-                     " WHERE imp.import=1 AND m.import=1 AND o.import=1");
+    // Copy in chunks of staging ids so long imports can report progress and be cancelled
+    db_id lastId  = 0;
+    int copied    = 0;
+    bool finished = false;
+    while (!finished)
+    {
+        if (wasStopped())
+        {
+            endStopped();
+            return false;
+        }
+
+        db_id chunkEnd = std::numeric_limits<db_id>::max();
+
+        q_getChunkEnd.bind(1, lastId);
+        if (q_getChunkEnd.step() == SQLITE_ROW)
+            chunkEnd = sqlite3_column_int64(q_getChunkEnd.stmt(), 0);
+        else
+            finished = true; // Less than a chunk left, copy up to end
+        q_getChunkEnd.reset();
 
-    q_create.execute(); // Long running
+        q_copy.bind(1, lastId);
+        q_copy.bind(2, chunkEnd);
+        ret = q_copy.execute();
+        q_copy.reset();
+
+        if (ret != SQLITE_OK)
+        {
+            endWithDbError(LoadTaskUtils::tr("Could not import rollingstock pieces."));
+            return false;
+        }
+
+        lastId = chunkEnd;
+
+        copied = qMin(copied + int(RowsPerChunk), totalCount);
+        sendEvent(new LoadProgressEvent(this, 2 * StepSize + copied * StepSize / totalCount,
+                                        MaxProgress),
+                  false);
+    }
 
-    sendEvent(new LoadProgressEvent(this, 0, LoadProgressEvent::ProgressMaxFinished), true);
+    return true;
 }
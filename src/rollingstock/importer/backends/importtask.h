@@ -22,12 +22,22 @@
 
 #include "utils/thread/iquittabletask.h"
 
+#include <QString>
+
 class QObject;
 
 namespace sqlite3pp {
 class database;
 }
 
+/*!
+ * \brief The ImportTask class
+ *
+ * Copies selected owners, models and rollingstock pieces from imported_rs_* tables
+ * to session tables. Everything is done with set based queries in a single transaction
+ * so a cancelled or failed import leaves session unchanged.
+ * Foreign keys are checked once on commit.
+ */
 class ImportTask : public IQuittableTask
 {
 public:
@@ -35,8 +45,38 @@ public:
 
     void run() override;
 
+    inline QString getErrorText() const
+    {
+        return errText;
+    }
+
+private:
+    enum
+    {
+        StepSize    = 100,
+        MaxProgress = 3 * StepSize
+    };
+
+    enum
+    {
+        RowsPerChunk = 1000
+    };
+
+    bool importOwners();
+    bool importModels();
+    bool importRS();
+
+    bool createItems(const char *offsetSql, const char *insertSql, const char *updateSql,
+                     char errCode);
+
+    void endWithDbError(const QString &text);
+    void endStopped();
+    void cleanup();
+
 private:
     sqlite3pp::database &mDb;
+    QString errText;
+    bool inTransaction;
 };
 
 #endif // IMPORTTASK_H
@@ -18,15 +18,15 @@
  */
 
 #include "loadodstask.h"
+#include "odsparser.h"
 #include "odsimporter.h"
+#include "zipfiledevice.h"
 #include "../loadprogressevent.h"
 #include "options.h"
 
-#include <QTemporaryFile>
+#include <QThreadPool>
 #include <QXmlStreamReader>
 
-#include <zip.h>
-
 #include <QDebug>
 
 LoadODSTask::LoadODSTask(const QMap<QString, QVariant> &arguments, sqlite3pp::database &db,
@@ -52,145 +52,107 @@ void LoadODSTask::run()
         return;
     }
 
-    int max      = 4;
+    int max      = 2;
     int progress = 0;
     sendEvent(new LoadProgressEvent(this, progress++, max), false);
 
-    int err       = 0;
-    zip_t *zipper = zip_open(mFileName.toUtf8(), ZIP_RDONLY, &err);
-
-    if (!zipper)
+    ODSImporter importer(importMode, defaultSpeed, defaultType, mDb);
+    if (!importer.loadExistingItems())
     {
-        zip_error_t ziperror;
-        zip_error_init_with_code(&ziperror, err);
-        const char *msg = zip_error_strerror(&ziperror);
-        qDebug() << "Failed to open output file" << mFileName << "Err:" << msg;
-
-        errText = QString::fromUtf8(msg);
+        errText = LoadTaskUtils::tr("Cannot load existing rollingstock items.");
         sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressError,
                                         LoadProgressEvent::ProgressMaxFinished),
                   true);
         return;
     }
 
-    // Search for the file of given name
-    const char *name = "content.xml";
-    struct zip_stat st;
-    zip_stat_init(&st);
-    if (zip_stat(zipper, name, 0, &st) < 0)
+    sendEvent(new LoadProgressEvent(this, progress++, max++), false);
+
+    // Decompress and parse on a private pool while this thread stores rows
+    // because this worker is already running on global pool
+    ODSBatchQueue queue(MaxQueuedBatches);
+    QString parseError;
+
+    QThreadPool parsePool;
+    parsePool.start(
+      [this, &queue, &parseError]()
+      {
+          parseError = parseDocument(&queue);
+          queue.finish();
+      });
+
+    ODSRowBatch batch;
+    bool stopped = false;
+    bool ok      = true;
+    while (queue.pop(batch))
     {
-        const char *msg = zip_strerror(zipper);
-        errText         = QString::fromUtf8(msg);
+        if (wasStopped())
+        {
+            stopped = true;
+            break;
+        }
 
-        // Close archive
-        zip_close(zipper);
+        if (batch.sheetStart)
+            sendEvent(new LoadProgressEvent(this, progress++, max++), false);
 
-        sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressError,
-                                        LoadProgressEvent::ProgressMaxFinished),
-                  true);
-        return;
+        if (!importer.importBatch(batch))
+        {
+            ok = false;
+            break;
+        }
     }
 
-    QTemporaryFile mContentFile;
-
-    if (mContentFile.isOpen())
-        mContentFile.close();
+    // Unblock parser if we quit early
+    queue.abort();
+    parsePool.waitForDone();
 
-    if (!mContentFile.open() || !mContentFile.resize(qint64(st.size)))
+    if (stopped || wasStopped())
     {
-        errText = mContentFile.errorString();
-        // Close archive
-        zip_close(zipper);
-
-        sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressError,
-                                        LoadProgressEvent::ProgressMaxFinished),
-                  true);
-        return;
-    }
-
-    // Read the compressed file
-    zip_file *f = zip_fopen(zipper, name, 0);
-    if (!f)
-    {
-        const char *msg = zip_strerror(zipper);
-        errText         = QString::fromUtf8(msg);
-        // Close archive
-        zip_close(zipper);
-
-        sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressError,
+        sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
                                         LoadProgressEvent::ProgressMaxFinished),
                   true);
         return;
     }
 
-    zip_uint64_t sum = 0;
-    char buf[4096];
-    while (sum != st.size)
+    if (!ok)
     {
-        zip_int64_t len = zip_fread(f, buf, 4096);
-        if (len < 0)
-        {
-            const char *msg = zip_file_strerror(f);
-            errText         = QString::fromUtf8(msg);
-            // Close file and archive
-            zip_fclose(f);
-            zip_close(zipper);
-
-            sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressError,
-                                            LoadProgressEvent::ProgressMaxFinished),
-                      true);
-            return;
-        }
-        mContentFile.write(buf, len);
-        sum += zip_uint64_t(len);
+        progress = LoadProgressEvent::ProgressError;
+        errText  = LoadTaskUtils::tr("Cannot store imported rollingstock items.");
     }
-
-    // Close file and archive
-    zip_fclose(f);
-    zip_close(zipper);
-
-    if (wasStopped())
+    else if (!parseError.isNull())
     {
-        sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
-                                        LoadProgressEvent::ProgressMaxFinished),
-                  true);
-        return;
+        progress = LoadProgressEvent::ProgressError;
+        errText  = parseError;
     }
 
-    sendEvent(new LoadProgressEvent(this, progress++, max), false);
+    sendEvent(new LoadProgressEvent(this, progress, LoadProgressEvent::ProgressMaxFinished), true);
+}
 
-    mContentFile.reset(); // Seek to start
+QString LoadODSTask::parseDocument(ODSBatchQueue *queue)
+{
+    ZipFileDevice content;
+    if (!content.openArchiveFile(mFileName, "content.xml"))
+        return content.errorString();
 
-    QXmlStreamReader xml(&mContentFile);
+    QXmlStreamReader xml(&content);
 
-    ODSImporter importer(importMode, m_tblFirstRow, m_tblRSNumberCol, m_tblModelNameCol,
-                         defaultSpeed, defaultType, mDb);
-    if (!importer.loadDocument(xml))
+    ODSParser parser(m_tblFirstRow, m_tblRSNumberCol, m_tblModelNameCol,
+                     importMode & RSImportMode::ImportRSModels, queue);
+    if (!parser.loadDocument(xml))
     {
-        errText = xml.errorString();
-        sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressError,
-                                        LoadProgressEvent::ProgressMaxFinished),
-                  true);
-        return;
+        // Wrong structure does not set an XML error, do not report success with no rows
+        if (xml.hasError())
+            return xml.errorString();
+        return LoadTaskUtils::tr("File is not a valid ODS spreadsheet.");
     }
 
-    do
+    while (parser.readNextTable(xml))
     {
-        if (wasStopped())
-        {
-            sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
-                                            LoadProgressEvent::ProgressMaxFinished),
-                      true);
-            return;
-        }
-        sendEvent(new LoadProgressEvent(this, progress++, max++), false);
-    } while (importer.readNextTable(xml));
+        // Tables are pushed to queue
+    }
 
     if (xml.hasError())
-    {
-        progress = LoadProgressEvent::ProgressError;
-        errText  = xml.errorString();
-    }
+        return xml.errorString();
 
-    sendEvent(new LoadProgressEvent(this, progress, LoadProgressEvent::ProgressMaxFinished), true);
+    return QString();
 }
@@ -24,6 +24,8 @@
 
 #include "utils/types.h"
 
+class ODSBatchQueue;
+
 /* LoadODSTask
  *
  * Loads rollingstock pieces/models/owners from an ODS spreadsheet
@@ -33,6 +35,8 @@
  * 1) tblFirstRow: first non-empty RS row (starting from 1, not 0) DEFAULT: 3
  * 2) tblRSNumberCol: column from which number is extracted  (starting from 1, not 0) DEFAULT: 1
  * 3) tblFirstRow: column from which model name is extracted (starting from 1, not 0) DEFAULT: 3
+ *
+ * content.xml is decompressed and parsed on a separate thread while rows are stored
  */
 class LoadODSTask : public ILoadRSTask
 {
@@ -42,6 +46,14 @@ public:
 
     void run() override;
 
+private:
+    enum
+    {
+        MaxQueuedBatches = 8
+    };
+
+    QString parseDocument(ODSBatchQueue *queue);
+
 private:
     int m_tblFirstRow;     // Start from 1 (not 0)
     int m_tblRSNumberCol;  // Start from 1 (not 0)
@@ -17,458 +17,295 @@
  *
  */
 
-#include "odsimporter.h"
 
-#include "utils/types.h"
+#include "odsimporter.h"
+#include "odsparser.h"
 
 #include "../importmodes.h"
 
-#include <QXmlStreamReader>
-
 #include <QDebug>
 
-const QString offns   = QStringLiteral("xmlns:office");
-const QString offvers = QStringLiteral("office:version");
-const QString tbl     = QStringLiteral("table:table");
-const QString tblname = QStringLiteral("table:name");
-const QString offbody = QStringLiteral("office:body");
+// Multi-row inserts, values are repeated for each row
+static const char *addModelsSql   = "INSERT INTO imported_rs_models(id, name, suffix, import,"
+                                    " new_name, match_existing_id, max_speed, axes, type, sub_type)"
+                                    " VALUES";
+static const char *addModelValues = "(?, ?, '', 1, NULL, ?, ?, ?, ?, ?)";
+
+static const char *addRSSql =
+  "INSERT INTO imported_rs_list(id, import, model_id, owner_id, number, new_number) VALUES";
+static const char *addRSValues = "(NULL, 1, ?, ?, ?, NULL)";
 
-ODSImporter::ODSImporter(const int mode, const int firstRow, const int numColm, const int nameCol,
-                         int defSpeed, RsType defType, sqlite3pp::database &db) :
+ODSImporter::ODSImporter(const int mode, int defSpeed, RsType defType, sqlite3pp::database &db) :
     mDb(db),
     q_addOwner(
       mDb,
       "INSERT INTO imported_rs_owners(id, name, import, new_name, match_existing_id, sheet_idx)"
-      " VALUES(NULL, ?, 1, NULL, ?, ?)"),
+      " VALUES(?, ?, 1, NULL, ?, ?)"),
     q_unsetImported(mDb, "UPDATE imported_rs_owners SET import=0 WHERE id=?"),
-    q_addModel(mDb, "INSERT INTO imported_rs_models(id, name, suffix, import, new_name, "
-                    "match_existing_id, max_speed, axes, type, sub_type)"
-                    " VALUES(NULL, ?, '', 1, NULL, ?, ?, ?, ?, ?)"),
-    q_addRS(mDb, "INSERT INTO imported_rs_list(id, import, model_id, owner_id, number, new_number)"
-                 " VALUES(NULL, 1, ?, ?, ?, NULL)"),
-
-    q_findOwner(mDb, "SELECT id FROM rs_owners WHERE name=?"),
-    q_findModel(mDb, "SELECT id FROM rs_models WHERE name=?"),
-    q_findImportedModel(mDb, "SELECT id FROM imported_rs_models WHERE name=?"),
-
-    tableFirstRow(firstRow),
-    tableRSNumberCol(numColm),
-    tableModelNameCol(nameCol),
+    q_addModels(mDb),
+    q_addRS(mDb),
+    nextOwnerId(1),
+    nextModelId(1),
+    importedOwnerId(0),
+    sheetRSCount(0),
     importMode(mode),
-
-    sheetIdx(0),
-    row(0),
-    col(0),
-
     defaultSpeed(defSpeed),
     defaultType(defType)
 {
-    mutex = sqlite3_db_mutex(mDb.db());
+    // Full size statements are reused, remaining rows use a one shot statement
+    q_addModels.prepare(multiRowSql(addModelsSql, addModelValues, RowsPerInsert).constData());
+    q_addRS.prepare(multiRowSql(addRSSql, addRSValues, RowsPerInsert).constData());
 }
 
-bool ODSImporter::loadDocument(QXmlStreamReader &xml)
+bool ODSImporter::loadExistingItems()
 {
-    xml.setNamespaceProcessing(false);
-    sheetIdx = 0;
-
-    if (!xml.readNextStartElement()
-        || xml.qualifiedName() != QLatin1String("office:document-content"))
-        return false;
+    existingOwners.clear();
+    existingModels.clear();
+    importedModels.clear();
 
-    bool offNsFound            = false;
-    bool offVersFound          = false;
-
-    QXmlStreamAttributes attrs = xml.attributes();
-
-    for (int i = 0; i < attrs.size(); i++)
+    try
     {
-        const QXmlStreamAttribute &a = attrs[i];
-        if (!offVersFound && a.qualifiedName() == offvers)
+        sqlite3pp::query q(mDb, "SELECT id,name FROM rs_owners");
+        for (auto r : q)
         {
-            if (a.value().size() < 3 || a.value().at(1) != '.')
-            {
-                qWarning() << "WRONG OFFICE VERSION:" << a.value();
-            }
-            int major = a.value().at(0).digitValue();
-            int minor = a.value().at(2).digitValue();
-            qDebug() << "FOUND VERSION:" << a.value();
-            if (major != 1 || minor < 2)
-            {
-                qDebug() << "Error: wrong office:version value";
-            }
-            offVersFound = true;
-            if (offNsFound)
-                break;
+            existingOwners.insert(r.get<QString>(1), r.get<db_id>(0));
         }
-        else if (!offNsFound && a.qualifiedName() == offns)
+
+        q.prepare("SELECT id,name,max_speed,axes,type,sub_type FROM rs_models ORDER BY id DESC");
+        for (auto r : q)
         {
-            offNsFound = true;
-            if (offVersFound)
-                break;
+            // Same name with different suffix, keep lowest id like previous lookup by name
+            ModelInfo info;
+            info.modelId    = r.get<db_id>(0);
+            info.maxSpeedKm = r.get<int>(2);
+            info.axes       = r.get<int>(3);
+            info.type       = RsType(r.get<int>(4));
+            info.subType    = RsEngineSubType(r.get<int>(5));
+            existingModels.insert(QByteArray(r.get<const char *>(1)), info);
         }
-    }
 
-    if (!offVersFound || !offNsFound)
-        return false;
+        q.prepare("SELECT id,name FROM imported_rs_models");
+        for (auto r : q)
+        {
+            importedModels.insert(QByteArray(r.get<const char *>(1)), r.get<db_id>(0));
+        }
 
-    while (xml.readNextStartElement() && xml.qualifiedName() != offbody)
-    {
-        xml.skipCurrentElement();
-    }
+        q.prepare("SELECT MAX(id) FROM imported_rs_owners");
+        if (q.step() == SQLITE_ROW)
+            nextOwnerId = q.getRows().get<db_id>(0) + 1;
 
-    if (xml.hasError())
-    {
-        qDebug() << "XML Error:" << xml.error() << xml.errorString();
-        return false;
+        q.prepare("SELECT MAX(id) FROM imported_rs_models");
+        if (q.step() == SQLITE_ROW)
+            nextModelId = q.getRows().get<db_id>(0) + 1;
     }
-
-    if (!xml.readNextStartElement() || xml.qualifiedName() != QLatin1String("office:spreadsheet"))
-        return false;
-
-    if (xml.hasError())
+    catch (std::exception &e)
     {
+        qWarning() << "ODSImporter: cannot load existing items" << e.what();
         return false;
     }
 
     return true;
 }
 
-bool ODSImporter::readNextTable(QXmlStreamReader &xml)
+bool ODSImporter::importBatch(const ODSRowBatch &batch)
 {
-    while (xml.readNextStartElement())
-    {
-        if (xml.qualifiedName() != tbl)
-        {
-            xml.skipCurrentElement();
-            continue; // Skip unknown elements
-        }
-
-        readTable(xml);
-        sheetIdx++;
-        return true;
-    }
-
-    return false;
-}
+    sqlite3pp::transaction t(mDb);
 
-void ODSImporter::readTable(QXmlStreamReader &xml)
-{
-    db_id importedOwnerId = 0;
-    if (importMode & RSImportMode::ImportRSOwners)
+    if (batch.sheetStart)
     {
-        QString name;
-        for (const QXmlStreamAttribute &a : xml.attributes())
-        {
-            if (a.qualifiedName() == tblname)
-            {
-                name = a.value().toString().simplified();
-                break;
-            }
-        }
-
-        // qDebug() << "OWNER:" << name;
+        importedOwnerId = 0;
+        sheetRSCount    = 0;
 
-        // Try to match an existing owner, if returns 0 -> no match -> create new owner
-        db_id existingOwnerId = 0;
-        q_findOwner.bind(1, name);
-        if (q_findOwner.step() == SQLITE_ROW)
-            existingOwnerId = q_findOwner.getRows().get<db_id>(0);
-        q_findOwner.reset();
-
-        if (name.isEmpty())
-            q_addOwner.bind(1); // Bind NULL, will be handled by SelectOwnersPage
-        else
-            q_addOwner.bind(1, name);
-
-        if (existingOwnerId)
-            q_addOwner.bind(2, existingOwnerId);
-        else
-            q_addOwner.bind(2); // bind NULL
-
-        q_addOwner.bind(3, sheetIdx);
-
-        sqlite3_mutex_enter(mutex);
-        int ret         = q_addOwner.execute();
-        importedOwnerId = mDb.last_insert_rowid();
-        sqlite3_mutex_leave(mutex);
-        q_addOwner.reset();
-
-        if (ret != SQLITE_OK)
+        if (importMode & RSImportMode::ImportRSOwners && !addOwner(batch))
         {
             // FIXME: tell the user
-            qWarning() << "Error importing owner:" << name << "skipping...";
-            xml.skipCurrentElement();
-            return;
+            qWarning() << "Error importing owner:" << batch.sheetName << "skipping...";
+            importedOwnerId = -1;
         }
     }
 
-    row           = 0;
-    col           = 0;
+    bool ok = true;
 
-    int rsCount   = 0;
-    bool finished = false;
-
-    QByteArray model;
-    qint64 number = -1;
-
-    while (!finished && xml.readNext() != QXmlStreamReader::Invalid)
+    if (importedOwnerId != -1 && importMode & RSImportMode::ImportRSModels)
     {
-        switch (xml.tokenType())
+        for (const ODSRow &item : batch.rows)
         {
-        case QXmlStreamReader::StartElement:
-        {
-            if (importMode & RSImportMode::ImportRSModels
-                && xml.qualifiedName() == QLatin1String("table:table-row"))
+            db_id importedModelId = getImportedModel(item.model);
+
+            if (importMode & RSImportMode::ImportRSPieces)
             {
-                readRow(xml, model, number);
-
-                if (row < tableFirstRow || model.isEmpty() || number == -1)
-                    break; // First n rows are table header / empty
-
-                // qDebug() << "RS:" << model << number;
-
-                db_id importedModelId = 0;
-
-                sqlite3_bind_text(q_findImportedModel.stmt(), 1, model, model.size(),
-                                  SQLITE_STATIC);
-                if (q_findImportedModel.step() == SQLITE_ROW)
-                {
-                    importedModelId = q_findImportedModel.getRows().get<db_id>(0);
-                }
-                q_findImportedModel.reset();
-
-                if (!importedModelId)
-                {
-                    // Create new one
-                    db_id existingModelId   = 0;
-                    int maxSpeedKm          = defaultSpeed;
-                    int axes                = 4;
-                    RsType type             = defaultType;
-                    RsEngineSubType subType = RsEngineSubType::Invalid;
-
-                    // Try filling with matched name model infos
-                    sqlite3_bind_text(q_findModel.stmt(), 1, model, model.size(), SQLITE_STATIC);
-                    if (q_findModel.step() == SQLITE_ROW)
-                    {
-                        auto m          = q_findModel.getRows();
-                        existingModelId = m.get<db_id>(0);
-                        maxSpeedKm      = m.get<int>(1);
-                        axes            = m.get<int>(2);
-                        type            = RsType(m.get<int>(3));
-                        subType         = RsEngineSubType(m.get<int>(4));
-                    }
-                    q_findModel.reset();
-
-                    sqlite3_bind_text(q_addModel.stmt(), 1, model, model.size(), SQLITE_STATIC);
-                    if (existingModelId)
-                        q_addModel.bind(2, existingModelId);
-                    else
-                        q_addModel.bind(2); // bind NULL
-                    q_addModel.bind(3, maxSpeedKm);
-                    q_addModel.bind(4, axes);
-                    q_addModel.bind(5, int(type));
-                    q_addModel.bind(6, int(subType));
-
-                    sqlite3_mutex_enter(mutex);
-                    q_addModel.execute();
-                    importedModelId = mDb.last_insert_rowid();
-                    sqlite3_mutex_leave(mutex);
-
-                    q_addModel.reset();
-                }
-
-                if (importMode & RSImportMode::ImportRSPieces)
-                {
-                    int num = number % 10000; // Cut at 4 digits
-
-                    // Finally register RS
-                    q_addRS.bind(1, importedModelId);
-                    q_addRS.bind(2, importedOwnerId);
-                    q_addRS.bind(3, num);
-                    q_addRS.execute();
-                    q_addRS.reset();
-
-                    rsCount++;
-                }
+                int num = item.number % 10000; // Cut at 4 digits
+                pendingRS.append({importedModelId, num});
+
+                if (pendingRS.size() == RowsPerInsert)
+                    ok = flushModels() && flushRS();
             }
-            else
+            else if (pendingModels.size() == RowsPerInsert)
             {
-                xml.skipCurrentElement();
+                ok = flushModels();
             }
-            break;
-        }
-        case QXmlStreamReader::EndElement:
-        {
-            finished = true;
-            break;
-        }
-        default:
-            break;
+
+            if (!ok)
+                break;
         }
+
+        if (ok)
+            ok = flushModels() && flushRS();
     }
 
-    if (rsCount == 0 && importMode & RSImportMode::ImportRSPieces)
+    if (ok && batch.sheetEnd && sheetRSCount == 0 && importedOwnerId > 0
+        && importMode & RSImportMode::ImportRSPieces)
     {
         q_unsetImported.bind(1, importedOwnerId);
         q_unsetImported.execute();
         q_unsetImported.reset();
     }
+
+    if (!ok)
+    {
+        qWarning() << "ODSImporter: cannot store rows of sheet" << batch.sheetIdx
+                   << mDb.error_msg();
+        pendingModels.clear();
+        pendingRS.clear();
+        t.rollback();
+        return false;
+    }
+
+    t.commit();
+    return true;
 }
 
-void ODSImporter::readRow(QXmlStreamReader &xml, QByteArray &model, qint64 &number)
+bool ODSImporter::addOwner(const ODSRowBatch &batch)
 {
-    row++;
-    col = 0;
+    // Try to match an existing owner, if returns 0 -> no match -> create new owner
+    db_id existingOwnerId = 0;
+    if (!batch.sheetName.isEmpty())
+        existingOwnerId = existingOwners.value(batch.sheetName, 0);
+
+    q_addOwner.bind(1, nextOwnerId);
+
+    if (batch.sheetName.isEmpty())
+        q_addOwner.bind(2); // Bind NULL, will be handled by SelectOwnersPage
+    else
+        q_addOwner.bind(2, batch.sheetName);
+
+    if (existingOwnerId)
+        q_addOwner.bind(3, existingOwnerId);
+    else
+        q_addOwner.bind(3); // bind NULL
+
+    q_addOwner.bind(4, batch.sheetIdx);
+
+    int ret = q_addOwner.execute();
+    q_addOwner.reset();
 
-    for (const QXmlStreamAttribute &a : xml.attributes())
+    if (ret != SQLITE_OK)
+        return false;
+
+    importedOwnerId = nextOwnerId++;
+    return true;
+}
+
+db_id ODSImporter::getImportedModel(const QByteArray &model)
+{
+    auto it = importedModels.constFind(model);
+    if (it != importedModels.constEnd())
+        return it.value();
+
+    // Create new one, it will be stored on next flush
+    db_id importedModelId = nextModelId++;
+    importedModels.insert(model, importedModelId);
+    pendingModels.append({model, importedModelId});
+    return importedModelId;
+}
+
+bool ODSImporter::flushModels()
+{
+    if (pendingModels.isEmpty())
+        return true;
+
+    sqlite3pp::command cmd(mDb);
+    sqlite3pp::command *q = &q_addModels;
+    if (pendingModels.size() != RowsPerInsert)
     {
-        if (a.qualifiedName() == QLatin1String("table:number-rows-repeated"))
-        {
-            int rowsRepeated = a.value().toInt();
-            row += rowsRepeated - 1;
-            break;
-        }
+        const QByteArray sql = multiRowSql(addModelsSql, addModelValues, pendingModels.size());
+        if (cmd.prepare(sql.constData()) != SQLITE_OK)
+            return false;
+        q = &cmd;
     }
 
-    while (xml.readNext() != QXmlStreamReader::Invalid)
+    int idx = 1;
+    for (const auto &model : std::as_const(pendingModels))
     {
-        switch (xml.tokenType())
-        {
-        case QXmlStreamReader::StartElement:
-        {
-            if (xml.qualifiedName() == QLatin1String("table:table-cell"))
-            {
-                int oldCol = col;
-
-                col++;
-                for (const QXmlStreamAttribute &a : xml.attributes())
-                {
-                    if (a.qualifiedName() == QLatin1String("table:number-columns-repeated"))
-                    {
-                        int colsRepeated = a.value().toInt();
-                        col += colsRepeated - 1;
-                        break;
-                    }
-                }
-
-                // Read current cell
-                int depth                         = 1;
-                bool cellEmpty                    = true;
-                QXmlStreamReader::TokenType token = QXmlStreamReader::NoToken;
-                while (depth && (token = xml.readNext()) != QXmlStreamReader::Invalid)
-                {
-                    switch (token)
-                    {
-                    case QXmlStreamReader::StartElement:
-                        depth++;
-                        break;
-                    case QXmlStreamReader::EndElement:
-                        depth--;
-                        break;
-                    case QXmlStreamReader::Characters:
-                    {
-                        if (xml.isWhitespace())
-                            break;
-
-                        // Convert to QString immidiately because xml reader changes buffer contents
-                        // when reading next token
-                        QStringView val = xml.text();
-                        cellEmpty      = val.isEmpty();
-                        // qDebug() << "CELL:" << row << col << val;
-
-                        // Avoid allocating a QString copy of QStringView, directly convert to
-                        // QByteArray
-                        if (oldCol < tableRSNumberCol && col >= tableRSNumberCol && val.size())
-                        {
-                            // Do not use toInt(), we must tolerate dashes and other non-digit
-                            // characters in the middle
-                            qint64 tmp = 0;
-                            for (int i = 0; i < val.size(); i++)
-                            {
-                                int d = val.at(i).digitValue();
-                                if (d != -1) //-1 means it's not a digit so skip it
-                                {
-                                    tmp *= 10;
-                                    tmp += d;
-                                }
-                            }
-                            number = tmp;
-                        }
-
-                        if (oldCol < tableModelNameCol && col >= tableModelNameCol)
-                            model = val.toUtf8().simplified();
-
-                        break;
-                    }
-                    default:
-                        break;
-                    }
-                }
-
-                if (cellEmpty)
-                {
-                    if (oldCol < tableRSNumberCol && col >= tableRSNumberCol)
-                        number = -1;
-                    if (oldCol < tableModelNameCol && col >= tableModelNameCol)
-                        model.clear();
-                }
-            }
-            else
-            {
-                xml.skipCurrentElement();
-            }
-            break;
-        }
-        case QXmlStreamReader::EndElement:
-            return;
-        default:
-            break;
-        }
+        // Try filling with matched name model infos
+        ModelInfo info;
+        info.modelId    = 0;
+        info.maxSpeedKm = defaultSpeed;
+        info.axes       = 4;
+        info.type       = defaultType;
+        info.subType    = RsEngineSubType::Invalid;
+        info            = existingModels.value(model.first, info);
+
+        q->bind(idx++, model.second);
+        sqlite3_bind_text(q->stmt(), idx++, model.first.constData(), model.first.size(),
+                          SQLITE_STATIC);
+        if (info.modelId)
+            q->bind(idx++, info.modelId);
+        else
+            q->bind(idx++); // bind NULL
+        q->bind(idx++, info.maxSpeedKm);
+        q->bind(idx++, info.axes);
+        q->bind(idx++, int(info.type));
+        q->bind(idx++, int(info.subType));
     }
+
+    int ret = q->execute();
+    q->reset();
+    pendingModels.clear();
+
+    return ret == SQLITE_OK;
 }
 
-QString ODSImporter::readCell(QXmlStreamReader &xml)
+bool ODSImporter::flushRS()
 {
-    col++;
-    for (const QXmlStreamAttribute &a : xml.attributes())
+    if (pendingRS.isEmpty())
+        return true;
+
+    sqlite3pp::command cmd(mDb);
+    sqlite3pp::command *q = &q_addRS;
+    if (pendingRS.size() != RowsPerInsert)
     {
-        if (a.qualifiedName() == QLatin1String("table:number-columns-repeated"))
-        {
-            int colsRepeated = a.value().toInt();
-            col += colsRepeated - 1;
-            break;
-        }
+        const QByteArray sql = multiRowSql(addRSSql, addRSValues, pendingRS.size());
+        if (cmd.prepare(sql.constData()) != SQLITE_OK)
+            return false;
+        q = &cmd;
     }
 
-    QString val;
-
-    // Read current cell
-    int depth                         = 1;
-    QXmlStreamReader::TokenType token = QXmlStreamReader::NoToken;
-    while (depth && (token = xml.readNext()) != QXmlStreamReader::Invalid)
+    int idx = 1;
+    for (const RSItem &item : std::as_const(pendingRS))
     {
-        switch (token)
-        {
-        case QXmlStreamReader::StartElement:
-            depth++;
-            break;
-        case QXmlStreamReader::EndElement:
-            depth--;
-            break;
-        case QXmlStreamReader::Characters:
-        {
-            if (xml.isWhitespace())
-                break;
-
-            val = xml.text().toString(); // Convert to QString immidiately because xml reader
-                                         // changes buffer contents when reading next token
-            // qDebug() << "CELL:" << row << col << val;
-            break;
-        }
-        default:
-            break;
-        }
+        q->bind(idx++, item.importedModelId);
+        q->bind(idx++, importedOwnerId);
+        q->bind(idx++, item.number);
     }
 
-    return val;
+    int ret = q->execute();
+    q->reset();
+
+    sheetRSCount += pendingRS.size();
+    pendingRS.clear();
+
+    return ret == SQLITE_OK;
+}
+
+QByteArray ODSImporter::multiRowSql(const char *prefix, const char *values, int count)
+{
+    QByteArray sql = prefix;
+    for (int i = 0; i < count; i++)
+    {
+        if (i)
+            sql.append(',');
+        sql.append(values);
+    }
+    return sql;
 }
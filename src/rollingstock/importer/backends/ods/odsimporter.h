@@ -17,50 +17,85 @@
  *
  */
 
+
 #ifndef ODSIMPORTER_H
 #define ODSIMPORTER_H
 
+#include <QHash>
+#include <QVector>
+
 #include <sqlite3pp/sqlite3pp.h>
 
 #include "utils/types.h"
 
-class QXmlStreamReader;
-typedef struct sqlite3_mutex sqlite3_mutex;
+struct ODSRowBatch;
 
+/*!
+ * \brief The ODSImporter class
+ *
+ * Stores rows parsed by ODSParser in imported_rs_* tables.
+ * Existing owners and models are loaded once in hash tables so rows are
+ * resolved in memory, ids of new items are assigned directly so rows can be
+ * inserted with multi-row INSERT statements.
+ */
 class ODSImporter
 {
 public:
-    ODSImporter(const int mode, const int firstRow, const int numColm, const int nameCol,
-                int defSpeed, RsType defType, sqlite3pp::database &db);
+    enum
+    {
+        RowsPerInsert = 64
+    };
+
+    ODSImporter(const int mode, int defSpeed, RsType defType, sqlite3pp::database &db);
 
-    bool loadDocument(QXmlStreamReader &xml);
-    bool readNextTable(QXmlStreamReader &xml);
+    bool loadExistingItems();
+    bool importBatch(const ODSRowBatch &batch);
 
 private:
-    void readTable(QXmlStreamReader &xml);
-    void readRow(QXmlStreamReader &xml, QByteArray &model, qint64 &number);
-    QString readCell(QXmlStreamReader &xml);
+    struct ModelInfo
+    {
+        db_id modelId;
+        int maxSpeedKm;
+        int axes;
+        RsType type;
+        RsEngineSubType subType;
+    };
+
+    struct RSItem
+    {
+        db_id importedModelId;
+        int number;
+    };
+
+    bool addOwner(const ODSRowBatch &batch);
+    db_id getImportedModel(const QByteArray &model);
+    bool flushModels();
+    bool flushRS();
+
+    static QByteArray multiRowSql(const char *prefix, const char *values, int count);
 
 private:
     sqlite3pp::database &mDb;
-    sqlite3_mutex *mutex;
+
     sqlite3pp::command q_addOwner;
     sqlite3pp::command q_unsetImported;
-    sqlite3pp::command q_addModel;
+    sqlite3pp::command q_addModels;
     sqlite3pp::command q_addRS;
 
-    sqlite3pp::query q_findOwner;
-    sqlite3pp::query q_findModel;
-    sqlite3pp::query q_findImportedModel;
+    QHash<QString, db_id> existingOwners;
+    QHash<QByteArray, ModelInfo> existingModels;
+    QHash<QByteArray, db_id> importedModels;
 
-    const int tableFirstRow;     // Start from 1 (not 0)
-    const int tableRSNumberCol;  // Start from 1 (not 0)
-    const int tableModelNameCol; // Start from 1 (not 0)
-    const int importMode;
+    // New models are queued until there are enough for a multi-row insert
+    QVector<QPair<QByteArray, db_id>> pendingModels;
+    QVector<RSItem> pendingRS;
+
+    db_id nextOwnerId;
+    db_id nextModelId;
+    db_id importedOwnerId;
+    int sheetRSCount;
 
-    int sheetIdx;
-    int row;
-    int col;
+    const int importMode;
 
     int defaultSpeed;
     RsType defaultType;
@@ -0,0 +1,361 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "odsparser.h"
+
+#include <QXmlStreamReader>
+
+#include <QDebug>
+
+const QString offns   = QStringLiteral("xmlns:office");
+const QString offvers = QStringLiteral("office:version");
+const QString tbl     = QStringLiteral("table:table");
+const QString tblname = QStringLiteral("table:name");
+const QString offbody = QStringLiteral("office:body");
+
+ODSBatchQueue::ODSBatchQueue(int maxBatches) :
+    mMaxBatches(maxBatches),
+    mFinished(false),
+    mAborted(false)
+{
+}
+
+bool ODSBatchQueue::push(ODSRowBatch &&batch)
+{
+    QMutexLocker lock(&mMutex);
+    while (!mAborted && mBatches.size() >= mMaxBatches)
+        mNotFull.wait(&mMutex);
+
+    if (mAborted)
+        return false;
+
+    mBatches.enqueue(std::move(batch));
+    mNotEmpty.wakeOne();
+    return true;
+}
+
+void ODSBatchQueue::finish()
+{
+    QMutexLocker lock(&mMutex);
+    mFinished = true;
+    mNotEmpty.wakeAll();
+}
+
+bool ODSBatchQueue::pop(ODSRowBatch &batch)
+{
+    QMutexLocker lock(&mMutex);
+    while (!mFinished && !mAborted && mBatches.isEmpty())
+        mNotEmpty.wait(&mMutex);
+
+    if (mAborted || mBatches.isEmpty())
+        return false;
+
+    batch = mBatches.dequeue();
+    mNotFull.wakeOne();
+    return true;
+}
+
+void ODSBatchQueue::abort()
+{
+    QMutexLocker lock(&mMutex);
+    mAborted = true;
+    mBatches.clear();
+    mNotFull.wakeAll();
+    mNotEmpty.wakeAll();
+}
+
+ODSParser::ODSParser(const int firstRow, const int numColm, const int nameCol, bool readRows,
+                     ODSBatchQueue *queue) :
+    mQueue(queue),
+    tableFirstRow(firstRow),
+    tableRSNumberCol(numColm),
+    tableModelNameCol(nameCol),
+    readTableRows(readRows),
+    sheetIdx(0),
+    row(0),
+    col(0)
+{
+}
+
+bool ODSParser::loadDocument(QXmlStreamReader &xml)
+{
+    xml.setNamespaceProcessing(false);
+    sheetIdx = 0;
+
+    if (!xml.readNextStartElement()
+        || xml.qualifiedName() != QLatin1String("office:document-content"))
+        return false;
+
+    bool offNsFound            = false;
+    bool offVersFound          = false;
+
+    QXmlStreamAttributes attrs = xml.attributes();
+
+    for (int i = 0; i < attrs.size(); i++)
+    {
+        const QXmlStreamAttribute &a = attrs[i];
+        if (!offVersFound && a.qualifiedName() == offvers)
+        {
+            if (a.value().size() < 3 || a.value().at(1) != '.')
+            {
+                qWarning() << "WRONG OFFICE VERSION:" << a.value();
+            }
+            int major = a.value().at(0).digitValue();
+            int minor = a.value().at(2).digitValue();
+            qDebug() << "FOUND VERSION:" << a.value();
+            if (major != 1 || minor < 2)
+            {
+                qDebug() << "Error: wrong office:version value";
+            }
+            offVersFound = true;
+            if (offNsFound)
+                break;
+        }
+        else if (!offNsFound && a.qualifiedName() == offns)
+        {
+            offNsFound = true;
+            if (offVersFound)
+                break;
+        }
+    }
+
+    if (!offVersFound || !offNsFound)
+        return false;
+
+    while (xml.readNextStartElement() && xml.qualifiedName() != offbody)
+    {
+        xml.skipCurrentElement();
+    }
+
+    if (xml.hasError())
+    {
+        qDebug() << "XML Error:" << xml.error() << xml.errorString();
+        return false;
+    }
+
+    if (!xml.readNextStartElement() || xml.qualifiedName() != QLatin1String("office:spreadsheet"))
+        return false;
+
+    if (xml.hasError())
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool ODSParser::readNextTable(QXmlStreamReader &xml)
+{
+    while (xml.readNextStartElement())
+    {
+        if (xml.qualifiedName() != tbl)
+        {
+            xml.skipCurrentElement();
+            continue; // Skip unknown elements
+        }
+
+        if (!readTable(xml))
+            return false;
+        sheetIdx++;
+        return true;
+    }
+
+    return false;
+}
+
+bool ODSParser::readTable(QXmlStreamReader &xml)
+{
+    ODSRowBatch batch;
+    batch.sheetIdx   = sheetIdx;
+    batch.sheetStart = true;
+
+    for (const QXmlStreamAttribute &a : xml.attributes())
+    {
+        if (a.qualifiedName() == tblname)
+        {
+            batch.sheetName = a.value().toString().simplified();
+            break;
+        }
+    }
+
+    row           = 0;
+    col           = 0;
+
+    bool finished = false;
+
+    QByteArray model;
+    qint64 number = -1;
+
+    while (!finished && xml.readNext() != QXmlStreamReader::Invalid)
+    {
+        switch (xml.tokenType())
+        {
+        case QXmlStreamReader::StartElement:
+        {
+            if (readTableRows && xml.qualifiedName() == QLatin1String("table:table-row"))
+            {
+                readRow(xml, model, number);
+
+                if (row < tableFirstRow || model.isEmpty() || number == -1)
+                    break; // First n rows are table header / empty
+
+                batch.rows.append({model, number});
+
+                if (batch.rows.size() >= RowsPerBatch)
+                {
+                    // Hand over full batch and keep parsing while it gets stored
+                    ODSRowBatch next;
+                    next.sheetIdx = sheetIdx;
+                    std::swap(batch, next);
+                    if (!mQueue->push(std::move(next)))
+                        return false;
+                }
+            }
+            else
+            {
+                xml.skipCurrentElement();
+            }
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+        {
+            finished = true;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    batch.sheetEnd = true;
+    return mQueue->push(std::move(batch));
+}
+
+void ODSParser::readRow(QXmlStreamReader &xml, QByteArray &model, qint64 &number)
+{
+    row++;
+    col = 0;
+
+    for (const QXmlStreamAttribute &a : xml.attributes())
+    {
+        if (a.qualifiedName() == QLatin1String("table:number-rows-repeated"))
+        {
+            int rowsRepeated = a.value().toInt();
+            row += rowsRepeated - 1;
+            break;
+        }
+    }
+
+    while (xml.readNext() != QXmlStreamReader::Invalid)
+    {
+        switch (xml.tokenType())
+        {
+        case QXmlStreamReader::StartElement:
+        {
+            if (xml.qualifiedName() == QLatin1String("table:table-cell"))
+            {
+                int oldCol = col;
+
+                col++;
+                for (const QXmlStreamAttribute &a : xml.attributes())
+                {
+                    if (a.qualifiedName() == QLatin1String("table:number-columns-repeated"))
+                    {
+                        int colsRepeated = a.value().toInt();
+                        col += colsRepeated - 1;
+                        break;
+                    }
+                }
+
+                // Read current cell
+                int depth                         = 1;
+                bool cellEmpty                    = true;
+                QXmlStreamReader::TokenType token = QXmlStreamReader::NoToken;
+                while (depth && (token = xml.readNext()) != QXmlStreamReader::Invalid)
+                {
+                    switch (token)
+                    {
+                    case QXmlStreamReader::StartElement:
+                        depth++;
+                        break;
+                    case QXmlStreamReader::EndElement:
+                        depth--;
+                        break;
+                    case QXmlStreamReader::Characters:
+                    {
+                        if (xml.isWhitespace())
+                            break;
+
+                        // Convert to QString immidiately because xml reader changes buffer contents
+                        // when reading next token
+                        QStringView val = xml.text();
+                        cellEmpty      = val.isEmpty();
+                        // qDebug() << "CELL:" << row << col << val;
+
+                        // Avoid allocating a QString copy of QStringView, directly convert to
+                        // QByteArray
+                        if (oldCol < tableRSNumberCol && col >= tableRSNumberCol && val.size())
+                        {
+                            // Do not use toInt(), we must tolerate dashes and other non-digit
+                            // characters in the middle
+                            qint64 tmp = 0;
+                            for (int i = 0; i < val.size(); i++)
+                            {
+                                int d = val.at(i).digitValue();
+                                if (d != -1) //-1 means it's not a digit so skip it
+                                {
+                                    tmp *= 10;
+                                    tmp += d;
+                                }
+                            }
+                            number = tmp;
+                        }
+
+                        if (oldCol < tableModelNameCol && col >= tableModelNameCol)
+                            model = val.toUtf8().simplified();
+
+                        break;
+                    }
+                    default:
+                        break;
+                    }
+                }
+
+                if (cellEmpty)
+                {
+                    if (oldCol < tableRSNumberCol && col >= tableRSNumberCol)
+                        number = -1;
+                    if (oldCol < tableModelNameCol && col >= tableModelNameCol)
+                        model.clear();
+                }
+            }
+            else
+            {
+                xml.skipCurrentElement();
+            }
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            return;
+        default:
+            break;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef ODSPARSER_H
+#define ODSPARSER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QQueue>
+
+#include <QMutex>
+#include <QWaitCondition>
+
+class QXmlStreamReader;
+
+struct ODSRow
+{
+    QByteArray model;
+    qint64 number;
+};
+
+/*!
+ * \brief Rows parsed from a spreadsheet table
+ *
+ * Each table is split in one or more batches.
+ * First batch of a table has \a sheetStart set and carries table name,
+ * last batch has \a sheetEnd set.
+ */
+struct ODSRowBatch
+{
+    int sheetIdx    = 0;
+    bool sheetStart = false;
+    bool sheetEnd   = false;
+    QString sheetName;
+    QVector<ODSRow> rows;
+};
+
+/*!
+ * \brief The ODSBatchQueue class
+ *
+ * Bounded queue passing row batches from parser thread to the thread which
+ * inserts them in database. Parser blocks when queue is full so memory usage
+ * does not depend on spreadsheet size.
+ */
+class ODSBatchQueue
+{
+public:
+    ODSBatchQueue(int maxBatches);
+
+    // Producer side, returns false if consumer aborted
+    bool push(ODSRowBatch &&batch);
+    void finish();
+
+    // Consumer side, returns false when producer finished and queue is empty
+    bool pop(ODSRowBatch &batch);
+    void abort();
+
+private:
+    QMutex mMutex;
+    QWaitCondition mNotEmpty;
+    QWaitCondition mNotFull;
+    QQueue<ODSRowBatch> mBatches;
+    const int mMaxBatches;
+    bool mFinished;
+    bool mAborted;
+};
+
+/*!
+ * \brief The ODSParser class
+ *
+ * Pull-parses content.xml of an ODS document and pushes rolling stock rows
+ * to an ODSBatchQueue. It does not access database so it can run on a
+ * different thread than ODSImporter.
+ */
+class ODSParser
+{
+public:
+    enum
+    {
+        RowsPerBatch = 512
+    };
+
+    ODSParser(const int firstRow, const int numColm, const int nameCol, bool readRows,
+              ODSBatchQueue *queue);
+
+    bool loadDocument(QXmlStreamReader &xml);
+
+    // Returns false when there are no more tables or if queue was aborted
+    bool readNextTable(QXmlStreamReader &xml);
+
+private:
+    bool readTable(QXmlStreamReader &xml);
+    void readRow(QXmlStreamReader &xml, QByteArray &model, qint64 &number);
+
+private:
+    ODSBatchQueue *mQueue;
+
+    const int tableFirstRow;     // Start from 1 (not 0)
+    const int tableRSNumberCol;  // Start from 1 (not 0)
+    const int tableModelNameCol; // Start from 1 (not 0)
+    const bool readTableRows;
+
+    int sheetIdx;
+    int row;
+    int col;
+};
+
+#endif // ODSPARSER_H
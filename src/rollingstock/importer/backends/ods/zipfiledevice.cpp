@@ -0,0 +1,130 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "zipfiledevice.h"
+
+#include <zip.h>
+
+#include <QDebug>
+
+ZipFileDevice::ZipFileDevice(QObject *parent) :
+    QIODevice(parent),
+    mZip(nullptr),
+    mFile(nullptr),
+    mSize(0)
+{
+}
+
+ZipFileDevice::~ZipFileDevice()
+{
+    ZipFileDevice::close();
+}
+
+bool ZipFileDevice::openArchiveFile(const QString &archivePath, const char *fileName)
+{
+    if (isOpen())
+        close();
+
+    int err = 0;
+    mZip    = zip_open(archivePath.toUtf8(), ZIP_RDONLY, &err);
+    if (!mZip)
+    {
+        zip_error_t ziperror;
+        zip_error_init_with_code(&ziperror, err);
+        const char *msg = zip_error_strerror(&ziperror);
+        qDebug() << "Failed to open archive" << archivePath << "Err:" << msg;
+
+        setErrorString(QString::fromUtf8(msg));
+        zip_error_fini(&ziperror);
+        return false;
+    }
+
+    // Search for the file of given name
+    struct zip_stat st;
+    zip_stat_init(&st);
+    if (zip_stat(mZip, fileName, 0, &st) < 0)
+    {
+        setErrorString(QString::fromUtf8(zip_strerror(mZip)));
+        close();
+        return false;
+    }
+
+    mFile = zip_fopen(mZip, fileName, 0);
+    if (!mFile)
+    {
+        setErrorString(QString::fromUtf8(zip_strerror(mZip)));
+        close();
+        return false;
+    }
+
+    mSize = qint64(st.size);
+    return QIODevice::open(QIODevice::ReadOnly);
+}
+
+void ZipFileDevice::close()
+{
+    if (mFile)
+    {
+        zip_fclose(mFile);
+        mFile = nullptr;
+    }
+
+    if (mZip)
+    {
+        zip_close(mZip);
+        mZip = nullptr;
+    }
+
+    mSize = 0;
+
+    QIODevice::close();
+}
+
+bool ZipFileDevice::isSequential() const
+{
+    return true;
+}
+
+qint64 ZipFileDevice::size() const
+{
+    return mSize;
+}
+
+qint64 ZipFileDevice::readData(char *data, qint64 maxlen)
+{
+    if (!mFile)
+        return -1;
+
+    zip_int64_t len = zip_fread(mFile, data, zip_uint64_t(maxlen));
+    if (len < 0)
+    {
+        setErrorString(QString::fromUtf8(zip_file_strerror(mFile)));
+        return -1;
+    }
+
+    return qint64(len);
+}
+
+qint64 ZipFileDevice::writeData(const char *data, qint64 len)
+{
+    Q_UNUSED(data)
+    Q_UNUSED(len)
+    return -1;
+}
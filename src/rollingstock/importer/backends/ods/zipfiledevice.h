@@ -0,0 +1,57 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef ZIPFILEDEVICE_H
+#define ZIPFILEDEVICE_H
+
+#include <QIODevice>
+
+typedef struct zip zip_t;
+typedef struct zip_file zip_file_t;
+
+/*!
+ * \brief The ZipFileDevice class
+ *
+ * Sequential read only device which decompresses a file inside a zip archive
+ * while it's being read, without extracting it to a temporary file first.
+ */
+class ZipFileDevice : public QIODevice
+{
+public:
+    ZipFileDevice(QObject *parent = nullptr);
+    ~ZipFileDevice() override;
+
+    bool openArchiveFile(const QString &archivePath, const char *fileName);
+    virtual void close() override;
+
+    virtual bool isSequential() const override;
+    virtual qint64 size() const override;
+
+protected:
+    virtual qint64 readData(char *data, qint64 maxlen) override;
+    virtual qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    zip_t *mZip;
+    zip_file_t *mFile;
+    qint64 mSize;
+};
+
+#endif // ZIPFILEDEVICE_H
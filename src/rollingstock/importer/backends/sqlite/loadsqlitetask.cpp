@@ -26,6 +26,8 @@
 
 #include <QDebug>
 
+#include <limits>
+
 LoadSQLiteTask::LoadSQLiteTask(sqlite3pp::database &db, int mode, const QString &fileName,
                                QObject *receiver) :
     ILoadRSTask(db, fileName, receiver),
@@ -36,8 +38,9 @@ LoadSQLiteTask::LoadSQLiteTask(sqlite3pp::database &db, int mode, const QString
 void LoadSQLiteTask::run()
 {
     currentProgress = 0;
-    localCount      = 0;
+    localCount      = 1;
     localProgress   = 0;
+    inTransaction   = false;
 
     if (wasStopped())
     {
@@ -52,6 +55,14 @@ void LoadSQLiteTask::run()
     if (!attachDB())
         return;
 
+    // Copy everything in a single transaction, ATTACH/DETACH cannot run inside it
+    if (mDb.execute("BEGIN TRANSACTION") != SQLITE_OK)
+    {
+        endWithDbError(LoadTaskUtils::tr("Could not start transaction."));
+        return;
+    }
+    inTransaction = true;
+
     if (!copyOwners())
         return;
 
@@ -61,20 +72,25 @@ void LoadSQLiteTask::run()
     if (!copyRS())
         return;
 
-    // Cleanup
-    mDb.execute("DETACH rs_source");
-
     if (!unselectOwnersWithNoRS())
         return;
 
+    if (mDb.execute("COMMIT") != SQLITE_OK)
+    {
+        endWithDbError(LoadTaskUtils::tr("Could not commit imported items."));
+        return;
+    }
+    inTransaction = false;
+
+    // Cleanup
+    mDb.execute("DETACH rs_source");
+
     sendEvent(new LoadProgressEvent(this, MaxProgress, LoadProgressEvent::ProgressMaxFinished),
               true);
 }
 
 void LoadSQLiteTask::endWithDbError(const QString &text)
 {
-    mDb.execute("DETACH rs_source");
-
     errText = LoadTaskUtils::tr("%1\n"
                                 "Code: %2\n"
                                 "Message: %3")
@@ -82,11 +98,34 @@ void LoadSQLiteTask::endWithDbError(const QString &text)
                 .arg(mDb.extended_error_code())
                 .arg(mDb.error_msg());
 
+    cleanup();
+
     sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressError,
                                     LoadProgressEvent::ProgressMaxFinished),
               true);
 }
 
+void LoadSQLiteTask::endStopped()
+{
+    cleanup();
+
+    sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
+                                    LoadProgressEvent::ProgressMaxFinished),
+              true);
+}
+
+void LoadSQLiteTask::cleanup()
+{
+    if (inTransaction)
+    {
+        // Discard partially copied items
+        mDb.execute("ROLLBACK");
+        inTransaction = false;
+    }
+
+    mDb.execute("DETACH rs_source");
+}
+
 bool LoadSQLiteTask::attachDB()
 {
     // ATTACH other database to this session
@@ -111,77 +150,14 @@ bool LoadSQLiteTask::copyOwners()
     if ((importMode & RSImportMode::ImportRSOwners) == 0)
         return true; // Skip owners importation
 
-    sqlite3pp::query q(mDb);
-    sqlite3pp::query q_getFirstIdGreaterThan(mDb);
-
-    // Calculate maximum number of batches
-    q.prepare("SELECT MAX(id) FROM rs_source.rs_owners");
-    q.step();
-    localCount = sqlite3_column_int(q.stmt(), 0);
-    localCount = localCount / LoadTaskUtils::BatchSize
-                 + (localCount % LoadTaskUtils::BatchSize != 0); // Round up
-    if (localCount < 1)
-        localCount = 1; // At least 1 batch
-
-    // Init query: get first id to import
-    int ret = q_getFirstIdGreaterThan.prepare("SELECT MIN(id) FROM rs_source.rs_owners WHERE id>?");
-    sqlite3_stmt *stmt = q_getFirstIdGreaterThan.stmt();
-    if (ret != SQLITE_OK)
-    {
-        endWithDbError(LoadTaskUtils::tr("Query preparation failed A1."));
-        return false;
-    }
-
-    ret = q.prepare("INSERT OR IGNORE INTO main.imported_rs_owners(id, name, import, new_name, "
-                    "match_existing_id, sheet_idx)"
-                    " SELECT NULL,own1.name,1,NULL,own2.id,0"
-                    " FROM rs_source.rs_owners AS own1"
-                    " LEFT JOIN main.rs_owners own2 ON own1.name=own2.name"
-                    " WHERE own1.id BETWEEN ? AND ?");
-    if (ret != SQLITE_OK)
-    {
-        endWithDbError(LoadTaskUtils::tr("Query preparation failed A2."));
-        return false;
-    }
-
-    int firstId   = 0;
-    localProgress = 0;
-    while (true)
-    {
-        if (wasStopped())
-        {
-            q.prepare("DETACH rs_source"); // Cleanup
-            q.step();
-
-            sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
-                                            LoadProgressEvent::ProgressMaxFinished),
-                      true);
-            return false;
-        }
-
-        q_getFirstIdGreaterThan.bind(1, firstId);
-        q_getFirstIdGreaterThan.step();
-        if (sqlite3_column_type(stmt, 0) == SQLITE_NULL)
-            break; // No more owners to import
-
-        firstId = sqlite3_column_int(stmt, 0);
-        q_getFirstIdGreaterThan.reset();
-
-        const int lastId = firstId + LoadTaskUtils::BatchSize;
-        q.bind(1, firstId);
-        q.bind(2, lastId);
-        firstId = lastId;
-
-        q.step();
-
-        localProgress++;
-        sendEvent(new LoadProgressEvent(this, calcProgress(), MaxProgress), false);
-    }
-
-    localProgress = 0; // Advance by 1 step, clear partial progress
-    currentProgress += StepSize;
-    sendEvent(new LoadProgressEvent(this, calcProgress(), MaxProgress), false);
-    return true;
+    return copyTable("rs_owners",
+                     "INSERT OR IGNORE INTO main.imported_rs_owners(id, name, import, new_name, "
+                     "match_existing_id, sheet_idx)"
+                     " SELECT NULL,own1.name,1,NULL,own2.id,0"
+                     " FROM rs_source.rs_owners AS own1"
+                     " LEFT JOIN main.rs_owners own2 ON own1.name=own2.name"
+                     " WHERE own1.id>?1 AND own1.id<=?2",
+                     'A');
 }
 
 bool LoadSQLiteTask::copyModels()
@@ -189,79 +165,16 @@ bool LoadSQLiteTask::copyModels()
     if ((importMode & RSImportMode::ImportRSModels) == 0)
         return true; // Skip models importation
 
-    sqlite3pp::query q(mDb);
-    sqlite3pp::query q_getFirstIdGreaterThan(mDb);
-
-    // Calculate maximum number of batches
-    q.prepare("SELECT MAX(id) FROM rs_source.rs_models");
-    q.step();
-    localCount = sqlite3_column_int(q.stmt(), 0);
-    localCount = localCount / LoadTaskUtils::BatchSize
-                 + (localCount % LoadTaskUtils::BatchSize != 0); // Round up
-    if (localCount < 1)
-        localCount = 1; // At least 1 batch
-
-    // Init query: get first id to import
-    int ret = q_getFirstIdGreaterThan.prepare("SELECT MIN(id) FROM rs_source.rs_models WHERE id>?");
-    sqlite3_stmt *stmt = q_getFirstIdGreaterThan.stmt();
-    if (ret != SQLITE_OK)
-    {
-        endWithDbError(LoadTaskUtils::tr("Query preparation failed B1."));
-        return false;
-    }
-
-    ret = q.prepare(
+    return copyTable(
+      "rs_models",
       "INSERT OR IGNORE INTO main.imported_rs_models(id, name, suffix, import, new_name, "
       "match_existing_id, max_speed, axes, type, sub_type)"
       " SELECT "
       "NULL,mod1.name,mod1.suffix,1,NULL,mod2.id,mod1.max_speed,mod1.axes,mod1.type,mod1.sub_type"
       " FROM rs_source.rs_models AS mod1"
       " LEFT JOIN main.rs_models mod2 ON mod1.name=mod2.name AND mod1.suffix=mod2.suffix"
-      " WHERE mod1.id BETWEEN ? AND ?");
-    if (ret != SQLITE_OK)
-    {
-        endWithDbError(LoadTaskUtils::tr("Query preparation failed B2."));
-        return false;
-    }
-
-    int firstId   = 0;
-    localProgress = 0;
-    while (true)
-    {
-        if (wasStopped())
-        {
-            q.prepare("DETACH rs_source"); // Cleanup
-            q.step();
-
-            sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
-                                            LoadProgressEvent::ProgressMaxFinished),
-                      true);
-            return false;
-        }
-
-        q_getFirstIdGreaterThan.bind(1, firstId);
-        q_getFirstIdGreaterThan.step();
-        if (sqlite3_column_type(stmt, 0) == SQLITE_NULL)
-            break; // No more models to import
-
-        firstId = sqlite3_column_int(stmt, 0);
-        q_getFirstIdGreaterThan.reset();
-
-        const int lastId = firstId + LoadTaskUtils::BatchSize;
-        q.bind(1, firstId);
-        q.bind(2, lastId);
-        firstId = lastId;
-
-        q.step();
-
-        localProgress++;
-        sendEvent(new LoadProgressEvent(this, calcProgress(), MaxProgress), false);
-    }
-
-    localProgress = 0; // Advance by 1 step, clear partial progress
-    currentProgress += StepSize;
-    sendEvent(new LoadProgressEvent(this, calcProgress(), MaxProgress), false);
-    return true;
+      " WHERE mod1.id>?1 AND mod1.id<=?2",
+      'B');
 }
 
 bool LoadSQLiteTask::copyRS()
@@ -269,74 +182,90 @@ bool LoadSQLiteTask::copyRS()
     if ((importMode & RSImportMode::ImportRSPieces) == 0)
         return true; // Skip RS importation
 
-    sqlite3pp::query q(mDb);
-    sqlite3pp::query q_getFirstIdGreaterThan(mDb);
-
-    // Calculate maximum number of batches
-    q.prepare("SELECT MAX(id) FROM rs_source.rs_models");
-    q.step();
-    localCount = sqlite3_column_int(q.stmt(), 0);
-    localCount = localCount / LoadTaskUtils::BatchSize
-                 + (localCount % LoadTaskUtils::BatchSize != 0); // Round up
-    if (localCount < 1)
-        localCount = 1; // At least 1 batch
-
-    // Init query: get first id to import
-    int ret = q_getFirstIdGreaterThan.prepare("SELECT MIN(id) FROM rs_source.rs_models WHERE id>?");
-    sqlite3_stmt *stmt = q_getFirstIdGreaterThan.stmt();
-    if (ret != SQLITE_OK)
-    {
-        endWithDbError(LoadTaskUtils::tr("Query preparation failed C1."));
-        return false;
-    }
-
-    ret = q.prepare(
+    // Chunks are ranges of rs_list ids. Keep only RS with a source model like
+    // previous copy which iterated over model ids.
+    return copyTable(
+      "rs_list",
       "INSERT OR IGNORE INTO main.imported_rs_list(id, import, model_id, owner_id, number, "
       "new_number)"
       " SELECT NULL,1,mod2.id,own2.id,rs.number % 10000,NULL"
       " FROM rs_source.rs_list AS rs"
-      " LEFT JOIN rs_source.rs_models mod1 ON mod1.id=rs.model_id"
+      " JOIN rs_source.rs_models mod1 ON mod1.id=rs.model_id"
       " LEFT JOIN main.imported_rs_models mod2 ON mod1.name=mod2.name AND mod1.suffix=mod2.suffix"
       " LEFT JOIN rs_source.rs_owners own1 ON own1.id=rs.owner_id"
       " LEFT JOIN main.imported_rs_owners own2 ON own1.name=own2.name"
-      " WHERE mod1.id BETWEEN ? AND ?");
+      " WHERE rs.id>?1 AND rs.id<=?2",
+      'C');
+}
+
+bool LoadSQLiteTask::copyTable(const char *sourceTable, const char *insertSql, char errCode)
+{
+    sqlite3pp::query q_getChunkEnd(mDb);
+    sqlite3pp::command q_copy(mDb);
+
+    // Progress is reported by rows copied
+    QByteArray sql = "SELECT COUNT(*) FROM rs_source.";
+    sql.append(sourceTable);
+    int ret = q_getChunkEnd.prepare(sql.constData());
+    if (ret != SQLITE_OK || q_getChunkEnd.step() != SQLITE_ROW)
+    {
+        endWithDbError(LoadTaskUtils::tr("Query preparation failed %1%2.").arg(errCode).arg(1));
+        return false;
+    }
+    localCount = qMax(1, sqlite3_column_int(q_getChunkEnd.stmt(), 0));
+
+    // Find last id of next chunk, works with sparse ids unlike fixed id windows
+    sql = "SELECT id FROM rs_source.";
+    sql.append(sourceTable);
+    sql.append(" WHERE id>? ORDER BY id LIMIT 1 OFFSET " QT_STRINGIFY(RowsPerChunk - 1));
+    ret = q_getChunkEnd.prepare(sql.constData());
+    if (ret != SQLITE_OK)
+    {
+        endWithDbError(LoadTaskUtils::tr("Query preparation failed %1%2.").arg(errCode).arg(1));
+        return false;
+    }
+
+    ret = q_copy.prepare(insertSql);
     if (ret != SQLITE_OK)
     {
-        endWithDbError(LoadTaskUtils::tr("Query preparation failed C2."));
+        endWithDbError(LoadTaskUtils::tr("Query preparation failed %1%2.").arg(errCode).arg(2));
         return false;
     }
 
-    int firstId   = 0;
+    db_id lastId  = 0;
+    bool finished = false;
     localProgress = 0;
-    while (true)
+    while (!finished)
     {
         if (wasStopped())
         {
-            q.prepare("DETACH rs_source"); // Cleanup
-            q.step();
-
-            sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
-                                            LoadProgressEvent::ProgressMaxFinished),
-                      true);
+            endStopped();
             return false;
         }
 
-        q_getFirstIdGreaterThan.bind(1, firstId);
-        q_getFirstIdGreaterThan.step();
-        if (sqlite3_column_type(stmt, 0) == SQLITE_NULL)
-            break; // No more RS to import
+        db_id chunkEnd = std::numeric_limits<db_id>::max();
 
-        firstId = sqlite3_column_int(stmt, 0);
-        q_getFirstIdGreaterThan.reset();
+        q_getChunkEnd.bind(1, lastId);
+        if (q_getChunkEnd.step() == SQLITE_ROW)
+            chunkEnd = sqlite3_column_int64(q_getChunkEnd.stmt(), 0);
+        else
+            finished = true; // Less than a chunk left, copy up to end
+        q_getChunkEnd.reset();
 
-        const int lastId = firstId + LoadTaskUtils::BatchSize;
-        q.bind(1, firstId);
-        q.bind(2, lastId);
-        firstId = lastId;
+        q_copy.bind(1, lastId);
+        q_copy.bind(2, chunkEnd);
+        ret = q_copy.execute();
+        q_copy.reset();
+
+        if (ret != SQLITE_OK)
+        {
+            endWithDbError(LoadTaskUtils::tr("Could not copy items."));
+            return false;
+        }
 
-        q.step();
+        lastId = chunkEnd;
 
-        localProgress++;
+        localProgress = qMin(localProgress + int(RowsPerChunk), localCount);
         sendEvent(new LoadProgressEvent(this, calcProgress(), MaxProgress), false);
     }
 
@@ -348,72 +277,23 @@ bool LoadSQLiteTask::copyRS()
 
 bool LoadSQLiteTask::unselectOwnersWithNoRS()
 {
-    sqlite3pp::query q(mDb);
-    sqlite3pp::query q_getFirstIdGreaterThan(mDb);
-
-    // Calculate maximum number of batches
-    q.prepare("SELECT MAX(id) FROM imported_rs_owners");
-    q.step();
-    localCount = sqlite3_column_int(q.stmt(), 0);
-    localCount = localCount / LoadTaskUtils::BatchSize
-                 + (localCount % LoadTaskUtils::BatchSize != 0); // Round up
-    if (localCount < 1)
-        localCount = 1; // At least 1 batch
-
-    // Init query: get first id to query
-    int ret = q_getFirstIdGreaterThan.prepare("SELECT MIN(id) FROM imported_rs_owners WHERE id>?");
-    sqlite3_stmt *stmt = q_getFirstIdGreaterThan.stmt();
-    if (ret != SQLITE_OK)
+    localCount = 1;
+
+    if (wasStopped())
     {
-        endWithDbError(LoadTaskUtils::tr("Query preparation failed C1."));
+        endStopped();
         return false;
     }
 
-    ret = q.prepare("UPDATE imported_rs_owners SET import=0 WHERE id IN("
-                    " SELECT own.id"
-                    " FROM imported_rs_owners own"
-                    " LEFT JOIN imported_rs_list rs ON rs.owner_id=own.id"
-                    " WHERE own.id BETWEEN ? AND ?"
-                    " GROUP BY own.id"
-                    " HAVING COUNT(rs.id)=0)");
+    int ret = mDb.execute("UPDATE imported_rs_owners SET import=0 WHERE NOT EXISTS("
+                          " SELECT 1 FROM imported_rs_list rs"
+                          " WHERE rs.owner_id=imported_rs_owners.id)");
     if (ret != SQLITE_OK)
     {
-        endWithDbError(LoadTaskUtils::tr("Query preparation failed C2."));
+        endWithDbError(LoadTaskUtils::tr("Could not unselect owners without rollingstock."));
         return false;
     }
 
-    int firstId   = 0;
-    localProgress = 0;
-    while (true)
-    {
-        if (wasStopped())
-        {
-            // No cleanup, already done after importing RS
-            sendEvent(new LoadProgressEvent(this, LoadProgressEvent::ProgressAbortedByUser,
-                                            LoadProgressEvent::ProgressMaxFinished),
-                      true);
-            return false;
-        }
-
-        q_getFirstIdGreaterThan.bind(1, firstId);
-        q_getFirstIdGreaterThan.step();
-        if (sqlite3_column_type(stmt, 0) == SQLITE_NULL)
-            break; // No more owners to edit
-
-        firstId = sqlite3_column_int(stmt, 0);
-        q_getFirstIdGreaterThan.reset();
-
-        const int lastId = firstId + LoadTaskUtils::BatchSize;
-        q.bind(1, firstId);
-        q.bind(2, lastId);
-        firstId = lastId;
-
-        q.step();
-
-        localProgress++;
-        sendEvent(new LoadProgressEvent(this, calcProgress(), MaxProgress), false);
-    }
-
     localProgress = 0; // Advance by 1 step, clear partial progress
     currentProgress += StepSize;
     sendEvent(new LoadProgressEvent(this, calcProgress(), MaxProgress), false);
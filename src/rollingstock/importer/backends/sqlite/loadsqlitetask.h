@@ -22,6 +22,8 @@
 
 #include "../loadtaskutils.h"
 
+#include "utils/types.h"
+
 /* LoadSQLiteTask
  *
  * Loads rollingstock pieces/models/owners from
@@ -38,22 +40,31 @@ public:
         MaxProgress = 5 * StepSize
     };
 
+    // Rows copied by each INSERT ... SELECT statement
+    enum
+    {
+        RowsPerChunk = 1000
+    };
+
     LoadSQLiteTask(sqlite3pp::database &db, int mode, const QString &fileName, QObject *receiver);
 
     void run() override;
 
 private:
     void endWithDbError(const QString &text);
+    void endStopped();
+    void cleanup();
 
     inline int calcProgress() const
     {
-        return currentProgress + localProgress / localCount * StepSize;
+        return currentProgress + localProgress * StepSize / localCount;
     }
 
     bool attachDB();
     bool copyOwners();
     bool copyModels();
     bool copyRS();
+    bool copyTable(const char *sourceTable, const char *insertSql, char errCode);
     bool unselectOwnersWithNoRS();
 
 private:
@@ -61,6 +72,7 @@ private:
     int currentProgress;
     int localCount;
     int localProgress;
+    bool inTransaction;
 };
 
 #endif // LOADSQLITETASK_H
@@ -18,6 +18,7 @@
  */
 
 #include "duplicatesimporteditemsmodel.h"
+#include "importduplicatesanalysis.h"
 
 #include "../rsimportstrings.h"
 
@@ -28,8 +29,6 @@
 
 #include <QBrush>
 
-#include <QElapsedTimer>
-
 class DuplicatesImportedItemsModelTask : public IQuittableTask
 {
 public:
@@ -46,9 +45,6 @@ public:
 
     void run() override
     {
-        QElapsedTimer timer;
-        timer.start();
-
         int count                         = -1;
         IDuplicatesItemModel::State state = IDuplicatesItemModel::CountingItems;
 
@@ -66,119 +62,28 @@ public:
         int progress = 0;
         sendEvent(new IDuplicatesItemEvent(this, progress, max, count, state), false);
 
-        // Count how many items
-        QByteArray sql =
-          "SELECT COUNT(imp.id),"
-          " (CASE WHEN imp.new_name NOT NULL THEN imp.new_name ELSE imp.name END) AS name1,"
-          " (CASE WHEN dup.new_name NOT NULL THEN dup.new_name ELSE dup.name END) AS name2"
-          " FROM %1 imp"
-          " JOIN %1 dup ON dup.id<>imp.id AND %2 name1=name2"
-          " WHERE imp.match_existing_id IS NULL AND imp.import=1 AND dup.import=1";
-        if (m_mode == ModelModes::Models)
-        {
-            sql = sql.replace("%1", "imported_rs_models");
-            sql = sql.replace("%2", "imp.suffix=dup.suffix AND");
-        }
-        else
-        {
-            sql = sql.replace("%1", "imported_rs_owners");
-            sql = sql.replace("%2", "  ");
-        }
-
-        query q(mDb, sql);
-        q.step();
-        count = q.getRows().get<int>(0);
+        // Single pass on imported items, result is cached until next edit
+        const bool ok = ImportDuplicatesAnalysis::findItemDuplicates(mDb, m_mode, this, items);
 
-        if (wasStopped())
+        if (!ok)
         {
-            sendEvent(new IDuplicatesItemEvent(this, IDuplicatesItemEvent::ProgressAbortedByUser,
+            const int result = wasStopped() ? int(IDuplicatesItemEvent::ProgressAbortedByUser)
+                                            : int(IDuplicatesItemEvent::ProgressError);
+            sendEvent(new IDuplicatesItemEvent(this, result,
                                                IDuplicatesItemEvent::ProgressMaxFinished, count,
                                                state),
                       true);
             return;
         }
 
-        if (count == 0)
-        {
-            // No data to load, finish
-            state = IDuplicatesItemModel::Loaded;
-            sendEvent(new IDuplicatesItemEvent(
-                        this, progress, IDuplicatesItemEvent::ProgressMaxFinished, count, state),
-                      true);
-            return;
-        }
-
-        // Now load data
-        state    = IDuplicatesItemModel::LoadingData;
-        max      = count + 10;
-        progress = 10;
-
-        // Do not send event if the process is fast
-        if (timer.elapsed() > IDuplicatesItemEvent::MinimumMSecsBeforeFirstEvent)
-            sendEvent(new IDuplicatesItemEvent(this, progress, max, count, state), false);
-
-        items.reserve(count);
-
-        sql = "SELECT imp.id, imp.name, imp.new_name, %2"
-              " (CASE WHEN imp.new_name NOT NULL THEN imp.new_name ELSE imp.name END) AS name1,"
-              " (CASE WHEN dup.new_name NOT NULL THEN dup.new_name ELSE dup.name END) AS name2"
-              " FROM %1 imp"
-              " JOIN %1 dup ON dup.id<>imp.id AND %3 name1=name2"
-              " WHERE imp.match_existing_id IS NULL AND imp.import=1 AND dup.import=1"
-              " ORDER BY imp.name";
-        if (m_mode == ModelModes::Models)
-        {
-            sql = sql.replace("%1", "imported_rs_models");
-            sql = sql.replace("%2", "  ");
-            sql = sql.replace("%3", "imp.suffix=dup.suffix AND");
-        }
-        else
-        {
-            sql = sql.replace("%1", "imported_rs_owners");
-            sql = sql.replace("%2", "imp.sheet_idx,");
-            sql = sql.replace("%3", "  ");
-        }
-
-        q.prepare(sql);
-
-        // Send about 5 progress events during loading (but process at least 5 items between 2
-        // events)
-        const int sentTreshold = qMax(5, max / 5);
-
-        for (auto r : q)
-        {
-            if (progress % 8 == 0 && wasStopped())
-            {
-                sendEvent(
-                  new IDuplicatesItemEvent(this, IDuplicatesItemEvent::ProgressAbortedByUser,
-                                           IDuplicatesItemEvent::ProgressMaxFinished, count, state),
-                  true);
-                return;
-            }
-
-            if (progress % sentTreshold
-                && timer.elapsed() > IDuplicatesItemEvent::MinimumMSecsBeforeFirstEvent)
-            {
-                // It's time to report our progress
-                sendEvent(new IDuplicatesItemEvent(this, progress, max, count, state), false);
-            }
-
-            DuplicatesImportedItemsModel::DuplicatedItem item;
-            item.importedId   = r.get<db_id>(0);
-            item.originalName = r.get<QString>(1);
-            item.customName   = r.get<QString>(2);
-            item.sheetIdx     = m_mode == ModelModes::Owners ? r.get<int>(3) : 0;
-            item.import       = true;
-
-            items.append(item);
-        }
-
+        count = items.size();
         state = IDuplicatesItemModel::Loaded;
-        sendEvent(new IDuplicatesItemEvent(this, progress,
-                                           IDuplicatesItemEvent::ProgressMaxFinished, count, state),
+        sendEvent(new IDuplicatesItemEvent(this, max, IDuplicatesItemEvent::ProgressMaxFinished,
+                                           count, state),
                   true);
     }
 
+private:
 private:
     sqlite3pp::database &mDb;
 };
@@ -18,6 +18,7 @@
  */
 
 #include "duplicatesimportedrsmodel.h"
+#include "importduplicatesanalysis.h"
 
 #include "rollingstock/importer/intefaces/icheckname.h"
 
@@ -29,8 +30,6 @@
 
 #include <QBrush>
 
-#include <QElapsedTimer>
-
 class DuplicatesImportedRSModelTask : public IQuittableTask
 {
 public:
@@ -45,8 +44,6 @@ public:
 
     void run() override
     {
-        timer.start();
-
         int count                         = -1;
         IDuplicatesItemModel::State state = IDuplicatesItemModel::CountingItems;
 
@@ -62,208 +59,29 @@ public:
         // Inform model that task is started
         int max      = 100;
         int progress = 0;
-        sendEvent(new IDuplicatesItemEvent(this, progress++, max, count, state), false);
+        sendEvent(new IDuplicatesItemEvent(this, progress, max, count, state), false);
 
         if (fixItemsWithSameValues)
             execFixItemsWithSameValues();
 
-        // Count how many items
-        query q(
-          mDb,
-          "SELECT COUNT(1) FROM ("
-          "SELECT (CASE WHEN imp.new_number NOT NULL THEN imp.new_number ELSE imp.number END) AS "
-          "num,"
-          " (CASE WHEN dup.new_number NOT NULL THEN dup.new_number ELSE dup.number END) AS dup_num"
-          " FROM imported_rs_list imp"
-          " JOIN imported_rs_models mod1 ON mod1.id=imp.model_id"
-          " JOIN imported_rs_owners own1 ON own1.id=imp.owner_id"
-
-          " LEFT JOIN imported_rs_list dup ON dup.id<>imp.id"
-          " LEFT JOIN imported_rs_models mod2 ON mod2.id=dup.model_id"
-          " LEFT JOIN imported_rs_owners own2 ON own2.id=dup.owner_id"
-          " LEFT JOIN rs_list ON rs_list.model_id=mod1.match_existing_id"
-          " WHERE own1.import AND mod1.import AND imp.import=1 AND"
-          " ("
-          "  rs_list.number=num OR"
-          "  ("
-          "   ("
-          "     imp.model_id=dup.model_id OR"
-          "     ("
-          "       mod1.match_existing_id NOT NULL AND mod1.match_existing_id=mod2.match_existing_id"
-          "     )"
-          "   )"
-          "   AND num=dup_num AND own2.import=1 AND mod2.import=1 AND dup.import=1"
-          "  )"
-          " )"
-          " GROUP BY imp.id)");
-        q.step();
-        count = q.getRows().get<int>(0);
-        if (wasStopped())
+        // Single pass on imported and existing items, result is cached until next edit
+        const bool ok = ImportDuplicatesAnalysis::findRSDuplicates(mDb, this, items);
+
+        if (!ok)
         {
-            sendEvent(new IDuplicatesItemEvent(this, IDuplicatesItemEvent::ProgressAbortedByUser,
+            const int result = wasStopped() ? int(IDuplicatesItemEvent::ProgressAbortedByUser)
+                                            : int(IDuplicatesItemEvent::ProgressError);
+            sendEvent(new IDuplicatesItemEvent(this, result,
                                                IDuplicatesItemEvent::ProgressMaxFinished, count,
                                                state),
                       true);
             return;
         }
 
-        if (count == 0)
-        {
-            // No data to load, finish
-            state = IDuplicatesItemModel::Loaded;
-            sendEvent(new IDuplicatesItemEvent(
-                        this, progress, IDuplicatesItemEvent::ProgressMaxFinished, count, state),
-                      true);
-            return;
-        }
-
-        // Now load data
-        state    = IDuplicatesItemModel::LoadingData;
-        max      = count + 10;
-        progress = 10;
-
-        // Do not send event if the process is fast
-        if (timer.elapsed() > IDuplicatesItemEvent::MinimumMSecsBeforeFirstEvent)
-            sendEvent(new IDuplicatesItemEvent(this, progress, max, count, state), false);
-
-        items.reserve(count);
-
-        q.prepare(
-          "SELECT imp.id, mod1.id, mod1.match_existing_id, mod1.type,"
-          " mod1.name, mod1.new_name, rs_models.name, rs_models.type,"
-          " imp.number, imp.new_number,"
-          " own1.name, own1.new_name, rs_owners.name,"
-          " (CASE WHEN imp.new_number NOT NULL THEN imp.new_number ELSE imp.number END) AS num,"
-          " (CASE WHEN dup.new_number NOT NULL THEN dup.new_number ELSE dup.number END) AS dup_num"
-          " FROM imported_rs_list imp"
-          " JOIN imported_rs_models mod1 ON mod1.id=imp.model_id"
-          " JOIN imported_rs_owners own1 ON own1.id=imp.owner_id"
-
-          " LEFT JOIN imported_rs_list dup ON dup.id<>imp.id"
-          " LEFT JOIN imported_rs_models mod2 ON mod2.id=dup.model_id"
-          " LEFT JOIN imported_rs_owners own2 ON own2.id=dup.owner_id"
-          " LEFT JOIN rs_list ON rs_list.model_id=mod1.match_existing_id"
-
-          " LEFT JOIN rs_owners ON rs_owners.id=own1.match_existing_id"
-          " LEFT JOIN rs_models ON rs_models.id=mod1.match_existing_id"
-
-          " WHERE own1.import AND mod1.import AND imp.import=1 AND"
-          " ("
-          "  rs_list.number=num OR"
-          "  ("
-          "   ("
-          "     imp.model_id=dup.model_id OR"
-          "     ("
-          "       mod1.match_existing_id NOT NULL AND mod1.match_existing_id=mod2.match_existing_id"
-          "     )"
-          "   )"
-          "   AND num=dup_num AND own2.import=1 AND mod2.import=1 AND dup.import=1"
-          "  )"
-          " )"
-          " GROUP BY imp.id"
-          " ORDER BY mod1.name, imp.number, own1.name");
-        sqlite3_stmt *st = q.stmt();
-
-        // Send about 5 progress events during loading (but process at least 5 items between 2
-        // events)
-        const int sentTreshold = qMax(5, max / 5);
-
-        for (auto r : q)
-        {
-            if (progress % 8 == 0 && wasStopped())
-            {
-                sendEvent(
-                  new IDuplicatesItemEvent(this, IDuplicatesItemEvent::ProgressAbortedByUser,
-                                           IDuplicatesItemEvent::ProgressMaxFinished, count, state),
-                  true);
-                return;
-            }
-
-            if (progress % sentTreshold
-                && timer.elapsed() > IDuplicatesItemEvent::MinimumMSecsBeforeFirstEvent)
-            {
-                // It's time to report our progress
-                sendEvent(new IDuplicatesItemEvent(this, progress, max, count, state), false);
-            }
-
-            DuplicatesImportedRSModel::DuplicatedItem item;
-            item.importedId      = r.get<db_id>(0);
-            item.importedModelId = r.get<db_id>(1);
-
-            // Model
-            item.matchExistingModelId = r.get<db_id>(2);
-            item.type                 = RsType(r.get<int>(3));
-            item.modelName = QByteArray(reinterpret_cast<char const *>(sqlite3_column_text(st, 4)),
-                                        sqlite3_column_bytes(st, 4));
-            if (r.column_type(5) != SQLITE_NULL)
-            {
-                // 'name (new_name)'
-                item.modelName.append(" (", 2);
-                item.modelName.append(reinterpret_cast<char const *>(sqlite3_column_text(st, 5)),
-                                      sqlite3_column_bytes(st, 5));
-                item.modelName.append(')');
-            }
-
-            if (r.column_type(6) != SQLITE_NULL)
-            {
-                // 'name (match_existing name)'
-                QByteArray tmp = QByteArray::fromRawData(
-                  reinterpret_cast<char const *>(sqlite3_column_text(st, 6)),
-                  sqlite3_column_bytes(st, 6));
-
-                if (tmp != item.modelName)
-                {
-                    item.modelName.append(" (", 2);
-                    item.modelName.append(tmp);
-                    item.modelName.append(')');
-                }
-                // Prefer matched model type when available
-                item.type = RsType(r.get<int>(7));
-            }
-
-            // Number
-            item.number = r.get<int>(8);
-
-            if (r.column_type(9) == SQLITE_NULL)
-                item.new_number = -1;
-            else
-                item.new_number = r.get<int>(9);
-
-            item.ownerName = QByteArray(reinterpret_cast<char const *>(sqlite3_column_text(st, 10)),
-                                        sqlite3_column_bytes(st, 10));
-            if (r.column_type(11) != SQLITE_NULL)
-            {
-                // 'name (new_name)'
-                item.ownerName.append(" (", 2);
-                item.ownerName.append(reinterpret_cast<char const *>(sqlite3_column_text(st, 11)),
-                                      sqlite3_column_bytes(st, 11));
-                item.ownerName.append(')');
-            }
-
-            if (r.column_type(12) != SQLITE_NULL)
-            {
-                // 'name (match_existing name)'
-                QByteArray tmp = QByteArray::fromRawData(
-                  reinterpret_cast<char const *>(sqlite3_column_text(st, 12)),
-                  sqlite3_column_bytes(st, 12));
-
-                if (tmp != item.ownerName)
-                {
-                    item.ownerName.append(" (", 2);
-                    item.ownerName.append(tmp);
-                    item.ownerName.append(')');
-                }
-            }
-            item.import = true; // Only imported items get selected so import is true
-
-            items.append(item);
-
-            progress++;
-        }
-
+        count = items.size();
         state = IDuplicatesItemModel::Loaded;
-        sendEvent(new IDuplicatesItemEvent(this, progress,
-                                           IDuplicatesItemEvent::ProgressMaxFinished, count, state),
+        sendEvent(new IDuplicatesItemEvent(this, max, IDuplicatesItemEvent::ProgressMaxFinished,
+                                           count, state),
                   true);
     }
 
@@ -278,7 +96,6 @@ public:
 
 private:
     sqlite3pp::database &mDb;
-    QElapsedTimer timer;
     bool fixItemsWithSameValues;
 };
 
@@ -0,0 +1,395 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "importduplicatesanalysis.h"
+
+#include "utils/thread/iquittabletask.h"
+
+#include <sqlite3pp/sqlite3pp.h>
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QMutex>
+
+#include <QDebug>
+
+#include <algorithm>
+
+namespace {
+
+template <typename Item>
+struct CachedResult
+{
+    sqlite3 *db        = nullptr;
+    qint64 changeStamp = -1;
+    QList<Item> items;
+};
+
+QMutex cacheMutex;
+CachedResult<DuplicatesImportedItemsModel::DuplicatedItem> itemsCache[2]; // Owners, Models
+CachedResult<DuplicatesImportedRSModel::DuplicatedItem> rsCache;
+
+template <typename Item>
+bool getCached(const CachedResult<Item> &cache, sqlite3pp::database &db, QList<Item> &items)
+{
+    QMutexLocker lock(&cacheMutex);
+    if (!cache.db || cache.db != db.db() || cache.changeStamp != sqlite3_total_changes(db.db()))
+        return false;
+
+    items = cache.items;
+    return true;
+}
+
+template <typename Item>
+void storeCache(CachedResult<Item> &cache, sqlite3pp::database &db, qint64 stamp,
+                const QList<Item> &items)
+{
+    QMutexLocker lock(&cacheMutex);
+    cache.db          = db.db();
+    cache.changeStamp = stamp;
+    cache.items       = items;
+}
+
+inline QByteArray columnBytes(sqlite3_stmt *stmt, int col)
+{
+    return QByteArray(reinterpret_cast<char const *>(sqlite3_column_text(stmt, col)),
+                      sqlite3_column_bytes(stmt, col));
+}
+
+// Append ' (other)' like 'name (new_name)'
+inline void appendInParenthesis(QByteArray &name, const QByteArray &other)
+{
+    name.append(" (", 2);
+    name.append(other);
+    name.append(')');
+}
+
+} // namespace
+
+bool ImportDuplicatesAnalysis::findItemDuplicates(
+  sqlite3pp::database &db, ModelModes::Mode mode, IQuittableTask *task,
+  QList<DuplicatesImportedItemsModel::DuplicatedItem> &items)
+{
+    items.clear();
+
+    if (mode != ModelModes::Owners && mode != ModelModes::Models)
+        return false;
+
+    auto &cache = itemsCache[mode];
+    if (getCached(cache, db, items))
+        return true;
+
+    const qint64 stamp = sqlite3_total_changes(db.db());
+
+    struct Row
+    {
+        db_id importedId;
+        QString originalName;
+        QString customName;
+        QString key;
+        int sheetIdx;
+        bool hasMatch;
+    };
+
+    QVector<Row> rows;
+    QHash<QString, int> keyCount;
+
+    const char *sql = mode == ModelModes::Models
+                        ? "SELECT id,name,new_name,match_existing_id,suffix,0"
+                          " FROM imported_rs_models WHERE import=1"
+                        : "SELECT id,name,new_name,match_existing_id,NULL,sheet_idx"
+                          " FROM imported_rs_owners WHERE import=1";
+
+    try
+    {
+        sqlite3pp::query q(db, sql);
+        int i = 0;
+        for (auto r : q)
+        {
+            if (++i % 512 == 0 && task && task->wasStopped())
+                return false;
+
+            Row row;
+            row.importedId   = r.get<db_id>(0);
+            row.originalName = r.get<QString>(1);
+            row.customName   = r.get<QString>(2);
+            row.hasMatch     = r.column_type(3) != SQLITE_NULL;
+            row.sheetIdx     = r.get<int>(5);
+
+            // Same as SQL comparison, NULL name never matches
+            if (r.column_type(2) == SQLITE_NULL && r.column_type(1) == SQLITE_NULL)
+                continue;
+            row.key = r.column_type(2) != SQLITE_NULL ? row.customName : row.originalName;
+
+            if (mode == ModelModes::Models)
+            {
+                // Separate suffix with a character which cannot be in a name
+                row.key.append(QChar('\0'));
+                row.key.append(r.get<QString>(4));
+            }
+
+            keyCount[row.key]++;
+            rows.append(row);
+        }
+    }
+    catch (std::exception &e)
+    {
+        qWarning() << "ImportDuplicatesAnalysis: cannot scan items" << e.what();
+        return false;
+    }
+
+    for (const Row &row : std::as_const(rows))
+    {
+        // Items matching an existing one are not duplicates, they are merged
+        if (row.hasMatch || keyCount.value(row.key) < 2)
+            continue;
+
+        DuplicatesImportedItemsModel::DuplicatedItem item;
+        item.importedId   = row.importedId;
+        item.originalName = row.originalName;
+        item.customName   = row.customName;
+        item.sheetIdx     = mode == ModelModes::Owners ? row.sheetIdx : 0;
+        item.import       = true;
+        items.append(item);
+    }
+
+    std::stable_sort(items.begin(), items.end(),
+                     [](const DuplicatesImportedItemsModel::DuplicatedItem &a,
+                        const DuplicatesImportedItemsModel::DuplicatedItem &b)
+                     { return a.originalName < b.originalName; });
+
+    storeCache(cache, db, stamp, items);
+    return true;
+}
+
+bool ImportDuplicatesAnalysis::findRSDuplicates(
+  sqlite3pp::database &db, IQuittableTask *task,
+  QList<DuplicatesImportedRSModel::DuplicatedItem> &items)
+{
+    items.clear();
+
+    if (getCached(rsCache, db, items))
+        return true;
+
+    const qint64 stamp = sqlite3_total_changes(db.db());
+
+    struct ModelInfo
+    {
+        db_id matchExistingId;
+        RsType type;
+        QByteArray rawName;
+        QByteArray displayName;
+    };
+
+    struct OwnerInfo
+    {
+        QByteArray rawName;
+        QByteArray displayName;
+    };
+
+    struct Row
+    {
+        db_id importedId;
+        db_id importedModelId;
+        db_id ownerId;
+        int number;
+        int newNumber;
+    };
+
+    // Models are grouped by matched existing model, or by imported id if not matched
+    // Use negative values for imported ids so they never clash with existing ids
+    auto modelKey = [](db_id importedModelId, const ModelInfo &info) -> db_id
+    { return info.matchExistingId ? info.matchExistingId : -importedModelId; };
+
+    QHash<db_id, ModelInfo> models;
+    QHash<db_id, OwnerInfo> owners;
+    QSet<QPair<db_id, int>> existingNumbers;
+    QHash<QPair<db_id, int>, int> importedNumbers;
+    QVector<Row> rows;
+
+    try
+    {
+        sqlite3pp::query q(db, "SELECT own.id,own.name,own.new_name,rs_owners.name"
+                               " FROM imported_rs_owners own"
+                               " LEFT JOIN rs_owners ON rs_owners.id=own.match_existing_id"
+                               " WHERE own.import");
+        sqlite3_stmt *st = q.stmt();
+        for (auto r : q)
+        {
+            OwnerInfo info;
+            info.rawName     = columnBytes(st, 1);
+            info.displayName = info.rawName;
+            if (r.column_type(2) != SQLITE_NULL)
+                appendInParenthesis(info.displayName, columnBytes(st, 2));
+
+            if (r.column_type(3) != SQLITE_NULL)
+            {
+                // 'name (match_existing name)'
+                QByteArray tmp = columnBytes(st, 3);
+                if (tmp != info.displayName)
+                    appendInParenthesis(info.displayName, tmp);
+            }
+            owners.insert(r.get<db_id>(0), info);
+        }
+
+        q.prepare("SELECT mod.id,mod.match_existing_id,mod.type,mod.name,mod.new_name,"
+                  "rs_models.name,rs_models.type"
+                  " FROM imported_rs_models mod"
+                  " LEFT JOIN rs_models ON rs_models.id=mod.match_existing_id"
+                  " WHERE mod.import");
+        st = q.stmt();
+        for (auto r : q)
+        {
+            ModelInfo info;
+            info.matchExistingId = r.get<db_id>(1);
+            info.type            = RsType(r.get<int>(2));
+            info.rawName         = columnBytes(st, 3);
+            info.displayName     = info.rawName;
+            if (r.column_type(4) != SQLITE_NULL)
+                appendInParenthesis(info.displayName, columnBytes(st, 4));
+
+            if (r.column_type(5) != SQLITE_NULL)
+            {
+                // 'name (match_existing name)'
+                QByteArray tmp = columnBytes(st, 5);
+                if (tmp != info.displayName)
+                    appendInParenthesis(info.displayName, tmp);
+
+                // Prefer matched model type when available
+                info.type = RsType(r.get<int>(6));
+            }
+            models.insert(r.get<db_id>(0), info);
+        }
+
+        if (task && task->wasStopped())
+            return false;
+
+        // Collect imported pieces which will be imported
+        q.prepare("SELECT id,model_id,owner_id,number,new_number FROM imported_rs_list"
+                  " WHERE import=1");
+        int i = 0;
+        for (auto r : q)
+        {
+            if (++i % 512 == 0 && task && task->wasStopped())
+                return false;
+
+            Row row;
+            row.importedId      = r.get<db_id>(0);
+            row.importedModelId = r.get<db_id>(1);
+            row.ownerId         = r.get<db_id>(2);
+            row.number          = r.get<int>(3);
+            row.newNumber       = r.column_type(4) == SQLITE_NULL ? -1 : r.get<int>(4);
+
+            auto model          = models.constFind(row.importedModelId);
+            if (model == models.constEnd() || !owners.contains(row.ownerId))
+                continue; // Model or owner not imported
+
+            const int num = row.newNumber == -1 ? row.number : row.newNumber;
+            importedNumbers[qMakePair(modelKey(row.importedModelId, model.value()), num)]++;
+            rows.append(row);
+        }
+
+        // Collect existing numbers of matched models only
+        QSet<db_id> matchedModels;
+        for (const ModelInfo &info : std::as_const(models))
+        {
+            if (info.matchExistingId)
+                matchedModels.insert(info.matchExistingId);
+        }
+
+        if (!matchedModels.isEmpty())
+        {
+            q.prepare("SELECT model_id,number FROM rs_list");
+            for (auto r : q)
+            {
+                const db_id modelId = r.get<db_id>(0);
+                if (matchedModels.contains(modelId))
+                    existingNumbers.insert(qMakePair(modelId, r.get<int>(1)));
+            }
+        }
+    }
+    catch (std::exception &e)
+    {
+        qWarning() << "ImportDuplicatesAnalysis: cannot scan rollingstock" << e.what();
+        return false;
+    }
+
+    if (task && task->wasStopped())
+        return false;
+
+    QVector<Row> duplicates;
+    for (const Row &row : std::as_const(rows))
+    {
+        const ModelInfo &model = models[row.importedModelId];
+        const int num          = row.newNumber == -1 ? row.number : row.newNumber;
+
+        const bool existingDup =
+          model.matchExistingId && existingNumbers.contains(qMakePair(model.matchExistingId, num));
+        const bool importedDup =
+          importedNumbers.value(qMakePair(modelKey(row.importedModelId, model), num)) > 1;
+        if (existingDup || importedDup)
+            duplicates.append(row);
+    }
+
+    // Same order of previous query: model name, number, owner name
+    std::stable_sort(duplicates.begin(), duplicates.end(),
+                     [&models, &owners](const Row &a, const Row &b)
+                     {
+                         const QByteArray modelA = models.value(a.importedModelId).rawName;
+                         const QByteArray modelB = models.value(b.importedModelId).rawName;
+                         if (modelA != modelB)
+                             return modelA < modelB;
+                         if (a.number != b.number)
+                             return a.number < b.number;
+                         return owners.value(a.ownerId).rawName < owners.value(b.ownerId).rawName;
+                     });
+
+    items.reserve(duplicates.size());
+    for (const Row &row : std::as_const(duplicates))
+    {
+        const ModelInfo &model = models[row.importedModelId];
+
+        DuplicatesImportedRSModel::DuplicatedItem item;
+        item.importedId           = row.importedId;
+        item.importedModelId      = row.importedModelId;
+        item.matchExistingModelId = model.matchExistingId;
+        item.type                 = model.type;
+        item.modelName            = model.displayName;
+        item.ownerName            = owners[row.ownerId].displayName;
+        item.number               = row.number;
+        item.new_number           = row.newNumber;
+        item.import               = true; // Only imported items get selected so import is true
+        items.append(item);
+    }
+
+    storeCache(rsCache, db, stamp, items);
+    return true;
+}
+
+void ImportDuplicatesAnalysis::clearCache()
+{
+    QMutexLocker lock(&cacheMutex);
+    for (auto &cache : itemsCache)
+    {
+        cache = CachedResult<DuplicatesImportedItemsModel::DuplicatedItem>();
+    }
+    rsCache = CachedResult<DuplicatesImportedRSModel::DuplicatedItem>();
+}
@@ -0,0 +1,67 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef IMPORTDUPLICATESANALYSIS_H
+#define IMPORTDUPLICATESANALYSIS_H
+
+#include <QList>
+
+#include "duplicatesimporteditemsmodel.h"
+#include "duplicatesimportedrsmodel.h"
+
+class IQuittableTask;
+
+/*!
+ * \brief The ImportDuplicatesAnalysis class
+ *
+ * Finds duplicated items in imported_rs_* tables with a single scan of each table.
+ * Keys of imported and existing items are collected in hash tables and conflicts
+ * are computed in memory instead of self joining tables in SQL.
+ *
+ * Results are cached until database connection reports a change, so reopening
+ * wizard pages or confirming FixDuplicatesDlg without edits does not scan again.
+ * Both functions return false if \a task was stopped or on database error.
+ */
+class ImportDuplicatesAnalysis
+{
+public:
+    /*!
+     * \brief find owners or models with same name
+     *
+     * Lists imported items without a matching existing item which have
+     * same name (and suffix for models) of another imported item.
+     */
+    static bool findItemDuplicates(sqlite3pp::database &db, ModelModes::Mode mode,
+                                   IQuittableTask *task,
+                                   QList<DuplicatesImportedItemsModel::DuplicatedItem> &items);
+
+    /*!
+     * \brief find rollingstock pieces with same model and number
+     *
+     * Lists imported pieces whose number is already used by an existing piece
+     * of matched model, or by another imported piece of same model.
+     */
+    static bool findRSDuplicates(sqlite3pp::database &db, IQuittableTask *task,
+                                 QList<DuplicatesImportedRSModel::DuplicatedItem> &items);
+
+    static void clearCache();
+};
+
+#endif // IMPORTDUPLICATESANALYSIS_H
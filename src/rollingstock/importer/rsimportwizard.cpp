@@ -23,6 +23,7 @@
 #include "model/rsimportedmodelsmodel.h"
 #include "model/rsimportedownersmodel.h"
 #include "model/rsimportedrollingstockmodel.h"
+#include "model/importduplicatesanalysis.h"
 
 #include "app/session.h"
 
@@ -42,6 +43,7 @@
 #include <QThreadPool>
 
 // Backends
+#include "backends/csv/rsimportcsvbackend.h"
 #include "backends/ods/rsimportodsbackend.h"
 #include "backends/sqlite/rsimportsqlitebackend.h"
 
@@ -64,6 +66,7 @@ RSImportWizard::RSImportWizard(bool resume, QWidget *parent) :
     backends = new RSImportBackendsModel(this);
     backends->addBackend(new RSImportODSBackend);
     backends->addBackend(new RSImportSQLiteBackend);
+    backends->addBackend(new RSImportCSVBackend);
 
     modelsModel  = new RSImportedModelsModel(Session->m_Db, this);
     ownersModel  = new RSImportedOwnersModel(Session->m_Db, this);
@@ -173,6 +176,7 @@ void RSImportWizard::done(int result)
 
     // Clear tables after import process completed or was aborted
     Session->clearImportRSTables();
+    ImportDuplicatesAnalysis::clearCache();
 
     QWizard::done(result);
 }
@@ -266,8 +270,20 @@ bool RSImportWizard::event(QEvent *e)
         }
         else if (ev->task == importTask)
         {
+            QString errText;
             if (ev->max == LoadProgressEvent::ProgressMaxFinished)
             {
+                if (ev->progress == LoadProgressEvent::ProgressError)
+                {
+                    errText = importTask->getErrorText();
+                }
+                else if (ev->progress != LoadProgressEvent::ProgressAbortedByUser)
+                {
+                    // New models and owners might have been imported
+                    emit Session->rollingstockModelsChanged();
+                    emit Session->rollingstockOwnersChanged();
+                }
+
                 // Delete task before handling event because otherwise it is detected as still
                 // running
                 delete importTask;
@@ -279,7 +295,7 @@ bool RSImportWizard::event(QEvent *e)
 
             if (ev->progress == LoadProgressEvent::ProgressError)
             {
-                // QMessageBox::warning(this, RsImportStrings::tr("Loading Error"), errText); TODO
+                QMessageBox::warning(this, RsImportStrings::tr("Importation Error"), errText);
                 reject();
             }
             else if (ev->progress == LoadProgressEvent::ProgressAbortedByUser)
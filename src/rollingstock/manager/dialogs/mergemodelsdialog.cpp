@@ -206,6 +206,10 @@ int MergeModelsDialog::mergeModels(db_id sourceModelId, db_id destModelId, bool
             qDebug() << "Removing model" << sourceModelId;
             qDebug() << "DB Error:" << ret << mDb.error_msg() << mDb.extended_error_code();
         }
+        else
+        {
+            emit Session->rollingstockModelsChanged();
+        }
     }
 
     return true;
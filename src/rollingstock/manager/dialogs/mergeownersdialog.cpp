@@ -125,6 +125,10 @@ bool MergeOwnersDialog::mergeOwners(db_id sourceOwnerId, db_id destOwnerId, bool
             qDebug() << "Removing owner" << sourceOwnerId;
             qDebug() << "DB Error:" << ret << mDb.error_msg() << mDb.extended_error_code();
         }
+        else
+        {
+            emit Session->rollingstockOwnersChanged();
+        }
     }
 
     return true;
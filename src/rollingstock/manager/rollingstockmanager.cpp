@@ -677,9 +677,11 @@ void RollingStockManager::onImportRS()
 {
     importRS(false, this);
 
-    rsSQLModel->refreshData();
-    modelsSQLModel->refreshData();
-    ownersSQLModel->refreshData();
+    // Import does not notify single items, reload everything once.
+    // Force it because cached pages are stale even if row count did not change
+    rsSQLModel->refreshData(true);
+    modelsSQLModel->refreshData(true);
+    ownersSQLModel->refreshData(true);
 }
 
 void RollingStockManager::showSessionRSViewer()
@@ -19,6 +19,8 @@
 
 #include "rollingstockmatchmodel.h"
 
+#include "app/session.h"
+
 #include "utils/rs_utils.h"
 
 RollingstockMatchModel::RollingstockMatchModel(database &db, QObject *parent) :
@@ -29,17 +31,41 @@ RollingstockMatchModel::RollingstockMatchModel(database &db, QObject *parent) :
     regExp.setPattern(
       "(?<model>[\\w\\s-]*)\\s*\\.?\\s*(?<num>\\d*)\\s*(:(?<owner>[\\w\\s-]+)?)?\\w*");
     regExp.optimize();
-    q_getMatches.prepare(
-      "SELECT "
-      "rs_list.id,rs_list.number,rs_models.name,rs_models.suffix,rs_models.type,rs_owners.name,"
-      "(CASE WHEN rs_list.number LIKE ?1 THEN 2 ELSE 0 END +"
-      " CASE WHEN rs_models.name LIKE ?2 THEN 1 ELSE 0 END +"
-      " CASE WHEN rs_models.suffix LIKE ?2 THEN 1 ELSE 0 END +"
-      " CASE WHEN rs_owners.name LIKE ?3 THEN 3 ELSE 0 END) AS s"
-      " FROM rs_list"
-      " JOIN rs_models ON rs_models.id=rs_list.model_id"
-      " JOIN rs_owners ON rs_owners.id=rs_list.owner_id"
-      " ORDER BY s DESC LIMIT " QT_STRINGIFY(MaxMatchItems + 1));
+
+    if (Session->hasFullTextIndex())
+    {
+        // Matching sets are evaluated once by full-text index instead of
+        // matching patterns on every rollingstock row
+        q_getMatches.prepare(
+          "SELECT "
+          "rs_list.id,rs_list.number,rs_models.name,rs_models.suffix,rs_models.type,rs_owners.name,"
+          "(CASE WHEN rs_list.id IN (SELECT rowid FROM rs_list_fts WHERE number LIKE ?1)"
+          " THEN 2 ELSE 0 END +"
+          " CASE WHEN rs_list.model_id IN (SELECT rowid FROM rs_models_fts WHERE name LIKE ?2)"
+          " THEN 1 ELSE 0 END +"
+          " CASE WHEN rs_list.model_id IN (SELECT rowid FROM rs_models_fts WHERE suffix LIKE ?2)"
+          " THEN 1 ELSE 0 END +"
+          " CASE WHEN rs_list.owner_id IN (SELECT rowid FROM rs_owners_fts WHERE name LIKE ?3)"
+          " THEN 3 ELSE 0 END) AS s"
+          " FROM rs_list"
+          " JOIN rs_models ON rs_models.id=rs_list.model_id"
+          " JOIN rs_owners ON rs_owners.id=rs_list.owner_id"
+          " ORDER BY s DESC LIMIT " QT_STRINGIFY(MaxMatchItems + 1));
+    }
+    else
+    {
+        q_getMatches.prepare(
+          "SELECT "
+          "rs_list.id,rs_list.number,rs_models.name,rs_models.suffix,rs_models.type,rs_owners.name,"
+          "(CASE WHEN rs_list.number LIKE ?1 THEN 2 ELSE 0 END +"
+          " CASE WHEN rs_models.name LIKE ?2 THEN 1 ELSE 0 END +"
+          " CASE WHEN rs_models.suffix LIKE ?2 THEN 1 ELSE 0 END +"
+          " CASE WHEN rs_owners.name LIKE ?3 THEN 3 ELSE 0 END) AS s"
+          " FROM rs_list"
+          " JOIN rs_models ON rs_models.id=rs_list.model_id"
+          " JOIN rs_owners ON rs_owners.id=rs_list.owner_id"
+          " ORDER BY s DESC LIMIT " QT_STRINGIFY(MaxMatchItems + 1));
+    }
     // FIXME: non funziona bene, i risultati sembrano casuali
 }
 
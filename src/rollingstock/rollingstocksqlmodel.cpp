@@ -435,7 +435,8 @@ qint64 RollingstockSQLModel::recalcTotalItemCount()
     return count;
 }
 
-void RollingstockSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData)
+void RollingstockSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData,
+                                      const QVariantList &seekKey)
 {
     QByteArray sql;
     if (fullData)
@@ -469,6 +470,10 @@ void RollingstockSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offs
         {
             sql.append("rs_list.model_id IS NULL");
         }
+        else if (Session->hasFullTextIndex())
+        {
+            sql.append("rs_list.model_id IN (SELECT rowid FROM rs_models_fts WHERE name LIKE ?3)");
+        }
         else
         {
             sql.append("rs_models.name LIKE ?3");
@@ -484,7 +489,10 @@ void RollingstockSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offs
         else
             sql.append(" WHERE ");
 
-        sql.append("rs_list.number LIKE ?4");
+        if (Session->hasFullTextIndex())
+            sql.append("rs_list.id IN (SELECT rowid FROM rs_list_fts WHERE number LIKE ?4)");
+        else
+            sql.append("rs_list.number LIKE ?4");
 
         whereClauseAdded = true;
     }
@@ -500,37 +508,47 @@ void RollingstockSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offs
         {
             sql.append("rs_list.owner_id IS NULL");
         }
+        else if (Session->hasFullTextIndex())
+        {
+            sql.append("rs_list.owner_id IN (SELECT rowid FROM rs_owners_fts WHERE name LIKE ?5)");
+        }
         else
         {
             sql.append("rs_owners.name LIKE ?5");
         }
+
+        whereClauseAdded = true;
     }
 
-    if (fullData)
+    // Sorting, last column is unique so it can be used for keyset pagination
+    const char *sortColExpr = nullptr;
+    switch (sortCol)
     {
-        // Apply sorting
-        const char *sortColExpr = nullptr;
-        switch (sortCol)
-        {
-        case Model:
-        {
-            sortColExpr = "rs_models.name,rs_list.number"; // Order by 2 columns, no where clause
-            break;
-        }
-        case Owner:
-        {
-            sortColExpr =
-              "rs_owners.name,rs_models.name,rs_list.number"; // Order by 3 columns, no where clause
-            break;
-        }
-        case TypeCol:
-        {
-            sortColExpr =
-              "rs_models.type,rs_models.name,rs_list.number"; // Order by 3 columns, no where clause
-            break;
-        }
-        }
+    case Model:
+    {
+        sortColExpr = "rs_models.name,rs_list.number,rs_list.id";
+        break;
+    }
+    case Owner:
+    {
+        sortColExpr = "rs_owners.name,rs_models.name,rs_list.number,rs_list.id";
+        break;
+    }
+    case TypeCol:
+    {
+        sortColExpr = "rs_models.type,rs_models.name,rs_list.number,rs_list.id";
+        break;
+    }
+    }
 
+    if (fullData && !seekKey.isEmpty())
+    {
+        sql += whereClauseAdded ? " AND " : " WHERE ";
+        sql += seekCondition(sortColExpr, 6);
+    }
+
+    if (fullData)
+    {
         sql += " ORDER BY ";
         sql += sortColExpr;
 
@@ -547,6 +565,9 @@ void RollingstockSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offs
         q.bind(1, BatchSize);
         if (offset)
             q.bind(2, offset);
+
+        if (!seekKey.isEmpty())
+            bindSeekKey(q, 6, seekKey);
     }
 
     // Apply filters
@@ -585,16 +606,19 @@ void RollingstockSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offs
     }
 }
 
-void RollingstockSQLModel::internalFetch(int first, int sortCol, int /*valRow*/,
-                                         const QVariant & /*val*/)
+void RollingstockSQLModel::internalFetch(int first, int sortCol, int valRow, const QVariant &val)
 {
     query q(mDb);
 
-    int offset = first + curPage * ItemsPerPage;
+    // Seek from key if available, skip only rows between key and first
+    const QVariantList seekKey = val.toList();
+    int offset                 = first + curPage * ItemsPerPage;
+    if (!seekKey.isEmpty())
+        offset = first - valRow;
 
-    qDebug() << "Fetching:" << first << "Offset:" << offset;
+    qDebug() << "Fetching:" << first << "Offset:" << offset << "Seek:" << seekKey;
 
-    buildQuery(q, sortCol, offset, true);
+    buildQuery(q, sortCol, offset, true, seekKey);
 
     QList<RSItem> vec(BatchSize);
 
@@ -679,8 +703,7 @@ bool RollingstockSQLModel::setModel(RSItem &item, db_id modelId, const QString &
     // This row has now changed position so we need to invalidate cache
     // HACK: we emit dataChanged for this index (that doesn't exist anymore)
     // but the view will trigger fetching at same scroll position so it is enough
-    cache.clear();
-    cacheFirstRow = 0;
+    clearCache();
 
     emit Session->rollingStockModified(item.rsId);
 
@@ -711,8 +734,7 @@ bool RollingstockSQLModel::setOwner(RSItem &item, db_id ownerId, const QString &
         // This row has now changed position so we need to invalidate cache
         // HACK: we emit dataChanged for this index (that doesn't exist anymore)
         // but the view will trigger fetching at same scroll position so it is enough
-        cache.clear();
-        cacheFirstRow = 0;
+        clearCache();
     }
 
     return true;
@@ -750,10 +772,33 @@ bool RollingstockSQLModel::setNumber(RSItem &item, int number)
     // This row has now changed position so we need to invalidate cache
     // HACK: we emit dataChanged for this index (that doesn't exist anymore)
     // but the view will trigger fetching at same scroll position so it is enough
-    cache.clear();
-    cacheFirstRow = 0;
+    clearCache();
 
     emit Session->rollingStockModified(item.rsId);
 
     return true;
 }
+
+QVariantList RollingstockSQLModel::getSeekKey(const RSItem &item, int sortCol) const
+{
+    // Invalid QVariant means NULL
+    const QVariant modelName = item.modelId ? QVariant(item.modelName) : QVariant();
+
+    switch (sortCol)
+    {
+    case Model:
+        return {modelName, item.number, item.rsId};
+    case Owner:
+    {
+        const QVariant ownerName = item.ownerId ? QVariant(item.ownerName) : QVariant();
+        return {ownerName, modelName, item.number, item.rsId};
+    }
+    case TypeCol:
+    {
+        const QVariant type = item.modelId ? QVariant(int(item.type)) : QVariant();
+        return {type, modelName, item.number, item.rsId};
+    }
+    }
+
+    return QVariantList();
+}
@@ -117,8 +117,10 @@ protected:
 
 private:
     friend BaseClass;
-    void buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData);
+    void buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData,
+                    const QVariantList &seekKey = QVariantList());
     Q_INVOKABLE void internalFetch(int first, int sortColumn, int valRow, const QVariant &val);
+    QVariantList getSeekKey(const RSItem &item, int sortCol) const;
 
     bool setModel(RSItem &item, db_id modelId, const QString &name);
     bool setOwner(RSItem &item, db_id ownerId, const QString &name);
@@ -19,13 +19,22 @@
 
 #include "rsmodelsmatchmodel.h"
 
+#include "app/session.h"
+#include "utils/delegates/sql/completionindex.h"
+
 RSModelsMatchModel::RSModelsMatchModel(database &db, QObject *parent) :
     ISqlFKMatchModel(parent),
     mDb(db),
     q_getMatches(mDb)
 {
-    q_getMatches.prepare("SELECT id,name,suffix FROM rs_models WHERE name LIKE ?1 OR suffix LIKE "
-                         "?1 LIMIT " QT_STRINGIFY(MaxMatchItems + 1));
+    if (Session->hasFullTextIndex())
+        q_getMatches.prepare("SELECT id,name,suffix FROM rs_models WHERE id IN ("
+                             "SELECT rowid FROM rs_models_fts WHERE name LIKE ?1"
+                             " UNION ALL SELECT rowid FROM rs_models_fts WHERE suffix LIKE ?1)"
+                             " LIMIT " QT_STRINGIFY(MaxMatchItems + 1));
+    else
+        q_getMatches.prepare("SELECT id,name,suffix FROM rs_models WHERE name LIKE ?1 OR suffix "
+                             "LIKE ?1 LIMIT " QT_STRINGIFY(MaxMatchItems + 1));
 }
 
 QVariant RSModelsMatchModel::data(const QModelIndex &idx, int role) const
@@ -63,6 +72,7 @@ QVariant RSModelsMatchModel::data(const QModelIndex &idx, int role) const
 
 void RSModelsMatchModel::autoSuggest(const QString &text)
 {
+    mText = text;
     mQuery.clear();
     if (!text.isEmpty())
     {
@@ -81,6 +91,39 @@ void RSModelsMatchModel::refreshData()
     if (!mDb.db())
         return;
 
+    if (&mDb == &Session->m_Db)
+    {
+        // Use session cache instead of querying database on every keystroke
+        QVector<CompletionIndex::Entry> matches;
+        if (Session->getCompletionIndex()->findMatches(CompletionIndex::RSModels, mText,
+                                                       MaxMatchItems, 0, matches))
+        {
+            beginResetModel();
+
+            const int count = qMin(int(matches.size()), MaxMatchItems);
+            for (int i = 0; i < count; i++)
+            {
+                const CompletionIndex::Entry &entry = matches.at(i);
+                items[i].modelId                    = entry.id;
+                items[i].nameLength                 = entry.name.size();
+                if (entry.suffix.isEmpty())
+                    items[i].nameWithSuffix = entry.name;
+                else
+                    items[i].nameWithSuffix = entry.name + QLatin1String(" (") + entry.suffix
+                                              + QLatin1Char(')');
+            }
+
+            size = count + 1; // Items + Empty
+            if (matches.size() > MaxMatchItems)
+                size++; // Items + Empty + Ellispses
+
+            endResetModel();
+
+            emit resultsReady(false);
+            return;
+        }
+    }
+
     beginResetModel();
 
     char emptyQuery = '%';
@@ -56,6 +56,7 @@ private:
 
     database &mDb;
     query q_getMatches;
+    QString mText;
     QByteArray mQuery;
 };
 
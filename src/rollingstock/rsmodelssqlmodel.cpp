@@ -27,6 +27,8 @@ using namespace sqlite3pp;
 #include "utils/model_roles.h"
 #include "utils/rs_types_names.h"
 
+#include "app/session.h"
+
 #include <QDebug>
 
 static constexpr char errorModelNameAlreadyUsedWithSameSuffix[] = QT_TRANSLATE_NOOP(
@@ -375,6 +377,8 @@ bool RSModelsSQLModel::removeRSModel(db_id modelId, const QString &name)
         return false;
     }
 
+    emit Session->rollingstockModelsChanged();
+
     refreshData(); // Recalc row count
     return true;
 }
@@ -449,6 +453,9 @@ db_id RSModelsSQLModel::addRSModel(int *outRow, db_id sourceModelId, const QStri
                  << mDb.extended_error_code();
     }
 
+    if (ret == SQLITE_OK)
+        emit Session->rollingstockModelsChanged();
+
     // Clear filters
     m_nameFilter.clear();
     m_nameFilter.squeeze();
@@ -483,6 +490,8 @@ bool RSModelsSQLModel::removeAllRSModels()
         return false;
     }
 
+    emit Session->rollingstockModelsChanged();
+
     refreshData(); // Recalc row count
     return true;
 }
@@ -497,7 +506,8 @@ qint64 RSModelsSQLModel::recalcTotalItemCount()
     return count;
 }
 
-void RSModelsSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData)
+void RSModelsSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData,
+                                  const QVariantList &seekKey)
 {
     QByteArray sql;
     if (fullData)
@@ -527,6 +537,8 @@ void RSModelsSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset,
             sql.append("suffix = ''");
         else
             sql.append("suffix LIKE ?4");
+
+        whereClauseAdded = true;
     }
 
     if (!m_speedFilter.isEmpty())
@@ -537,26 +549,34 @@ void RSModelsSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset,
             sql.append(" WHERE ");
 
         sql.append("max_speed LIKE ?5");
+
+        whereClauseAdded = true;
     }
 
     if (fullData)
     {
-        // Apply sorting
+        // Apply sorting, last column is unique so it can be used for keyset pagination
         const char *sortColExpr = nullptr;
         switch (sortCol)
         {
         case Name:
         {
-            sortColExpr = "name,suffix"; // Order by 2 columns, no where clause
+            sortColExpr = "name,suffix,id";
             break;
         }
         case TypeCol:
         {
-            sortColExpr = "type,sub_type,name,suffix"; // Order by 4 columns, no where clause
+            sortColExpr = "type,sub_type,name,suffix,id";
             break;
         }
         }
 
+        if (!seekKey.isEmpty())
+        {
+            sql += whereClauseAdded ? " AND " : " WHERE ";
+            sql += seekCondition(sortColExpr, 6);
+        }
+
         sql += " ORDER BY ";
         sql += sortColExpr;
 
@@ -573,6 +593,9 @@ void RSModelsSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset,
         q.bind(1, BatchSize);
         if (offset)
             q.bind(2, offset);
+
+        if (!seekKey.isEmpty())
+            bindSeekKey(q, 6, seekKey);
     }
 
     // Apply filters
@@ -607,16 +630,19 @@ void RSModelsSQLModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset,
     }
 }
 
-void RSModelsSQLModel::internalFetch(int first, int sortCol, int /*valRow*/,
-                                     const QVariant & /*val*/)
+void RSModelsSQLModel::internalFetch(int first, int sortCol, int valRow, const QVariant &val)
 {
     query q(mDb);
 
-    int offset = first + curPage * ItemsPerPage;
+    // Seek from key if available, skip only rows between key and first
+    const QVariantList seekKey = val.toList();
+    int offset                 = first + curPage * ItemsPerPage;
+    if (!seekKey.isEmpty())
+        offset = first - valRow;
 
-    qDebug() << "Fetching:" << first << "Offset:" << offset;
+    qDebug() << "Fetching:" << first << "Offset:" << offset << "Seek:" << seekKey;
 
-    buildQuery(q, sortCol, offset, true);
+    buildQuery(q, sortCol, offset, true, seekKey);
 
     QList<RSModel> vec(BatchSize);
 
@@ -645,6 +671,23 @@ void RSModelsSQLModel::internalFetch(int first, int sortCol, int /*valRow*/,
     postResult(vec, first);
 }
 
+QVariantList RSModelsSQLModel::getSeekKey(const RSModel &item, int sortCol) const
+{
+    // Empty name might be NULL, do not seek
+    if (item.name.isEmpty())
+        return QVariantList();
+
+    switch (sortCol)
+    {
+    case Name:
+        return {item.name, item.suffix, item.modelId};
+    case TypeCol:
+        return {int(item.type), int(item.sub_type), item.name, item.suffix, item.modelId};
+    }
+
+    return QVariantList();
+}
+
 bool RSModelsSQLModel::setNameOrSuffix(RSModel &item, const QString &newName, bool suffix)
 {
     if (suffix ? item.suffix == newName : item.name == newName)
@@ -674,11 +717,12 @@ bool RSModelsSQLModel::setNameOrSuffix(RSModel &item, const QString &newName, bo
     else
         item.name = newName;
 
+    emit Session->rollingstockModelsChanged();
+
     // This row has now changed position so we need to invalidate cache
     // HACK: we emit dataChanged for this index (that doesn't exist anymore)
     // but the view will trigger fetching at same scroll position so it is enough
-    cache.clear();
-    cacheFirstRow = 0;
+    clearCache();
 
     return true;
 }
@@ -708,8 +752,7 @@ bool RSModelsSQLModel::setType(RSModel &item, RsType type, RsEngineSubType subTy
         // This row has now changed position so we need to invalidate cache
         // HACK: we emit dataChanged for this index (that doesn't exist anymore)
         // but the view will trigger fetching at same scroll position so it is enough
-        cache.clear();
-        cacheFirstRow = 0;
+        clearCache();
     }
 
     return true;
@@ -100,8 +100,10 @@ protected:
 
 private:
     friend BaseClass;
-    void buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData);
+    void buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData,
+                    const QVariantList &seekKey = QVariantList());
     Q_INVOKABLE void internalFetch(int first, int sortColumn, int valRow, const QVariant &val);
+    QVariantList getSeekKey(const RSModel &item, int sortCol) const;
 
     bool setNameOrSuffix(RSModel &item, const QString &newName, bool suffix);
     bool setType(RSModel &item, RsType type, RsEngineSubType subType);
@@ -19,13 +19,21 @@
 
 #include "rsownersmatchmodel.h"
 
+#include "app/session.h"
+#include "utils/delegates/sql/completionindex.h"
+
 RSOwnersMatchModel::RSOwnersMatchModel(database &db, QObject *parent) :
     ISqlFKMatchModel(parent),
     mDb(db),
     q_getMatches(mDb)
 {
-    q_getMatches.prepare(
-      "SELECT id,name FROM rs_owners WHERE name LIKE ? LIMIT " QT_STRINGIFY(MaxMatchItems));
+    if (Session->hasFullTextIndex())
+        q_getMatches.prepare("SELECT id,name FROM rs_owners WHERE id IN ("
+                             "SELECT rowid FROM rs_owners_fts WHERE name LIKE ?)"
+                             " LIMIT " QT_STRINGIFY(MaxMatchItems));
+    else
+        q_getMatches.prepare(
+          "SELECT id,name FROM rs_owners WHERE name LIKE ? LIMIT " QT_STRINGIFY(MaxMatchItems));
 }
 
 QVariant RSOwnersMatchModel::data(const QModelIndex &idx, int role) const
@@ -63,6 +71,7 @@ QVariant RSOwnersMatchModel::data(const QModelIndex &idx, int role) const
 
 void RSOwnersMatchModel::autoSuggest(const QString &text)
 {
+    mText = text;
     mQuery.clear();
     if (!text.isEmpty())
     {
@@ -81,6 +90,33 @@ void RSOwnersMatchModel::refreshData()
     if (!mDb.db())
         return;
 
+    if (&mDb == &Session->m_Db)
+    {
+        // Use session cache instead of querying database on every keystroke
+        QVector<CompletionIndex::Entry> matches;
+        if (Session->getCompletionIndex()->findMatches(CompletionIndex::RSOwners, mText,
+                                                       MaxMatchItems, 0, matches))
+        {
+            beginResetModel();
+
+            const int count = qMin(int(matches.size()), MaxMatchItems);
+            for (int i = 0; i < count; i++)
+            {
+                items[i].ownerId = matches.at(i).id;
+                items[i].name    = matches.at(i).name;
+            }
+
+            size = count + 1; // Items + Empty
+            if (matches.size() > MaxMatchItems)
+                size++; // Items + Empty + Ellispses
+
+            endResetModel();
+
+            emit resultsReady(false);
+            return;
+        }
+    }
+
     beginResetModel();
 
     char emptyQuery = '%';
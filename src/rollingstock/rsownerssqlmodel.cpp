@@ -26,6 +26,8 @@ using namespace sqlite3pp;
 
 #include "utils/rs_types_names.h"
 
+#include "app/session.h"
+
 #include <QDebug>
 
 static constexpr char errorOwnerNameAlreadyUsed[] =
@@ -144,13 +146,12 @@ bool RSOwnersSQLModel::setData(const QModelIndex &idx, const QVariant &value, in
             }
 
             item.name = newName;
-            // FIXME: maybe emit some signals?
+            emit Session->rollingstockOwnersChanged();
 
             // This row has now changed position so we need to invalidate cache
             // HACK: we emit dataChanged for this index (that doesn't exist anymore)
             // but the view will trigger fetching at same scroll position so it is enough
-            cache.clear();
-            cacheFirstRow = 0;
+            clearCache();
 
             break;
         }
@@ -240,6 +241,8 @@ bool RSOwnersSQLModel::removeRSOwner(db_id ownerId, const QString &name)
         return false;
     }
 
+    emit Session->rollingstockOwnersChanged();
+
     refreshData(); // Recalc row count
     return true;
 }
@@ -283,6 +286,9 @@ db_id RSOwnersSQLModel::addRSOwner(int *outRow)
                  << mDb.extended_error_code();
     }
 
+    if (ret == SQLITE_OK)
+        emit Session->rollingstockOwnersChanged();
+
     // Clear filters
     m_ownerFilter.clear();
     m_ownerFilter.squeeze();
@@ -308,6 +314,8 @@ bool RSOwnersSQLModel::removeAllRSOwners()
         return false;
     }
 
+    emit Session->rollingstockOwnersChanged();
+
     refreshData(); // Recalc row count
     return true;
 }
@@ -337,6 +345,71 @@ qint64 RSOwnersSQLModel::recalcTotalItemCount()
     return count;
 }
 
+void RSOwnersSQLModel::internalFetch(int first, int sortCol, int valRow, const QVariant &val)
+{
+    query q(mDb);
+
+    // Seek from key if available, skip only rows between key and first
+    const QVariantList seekKey = val.toList();
+    int offset                 = first + curPage * ItemsPerPage;
+    if (!seekKey.isEmpty())
+        offset = first - valRow;
+
+    qDebug() << "Fetching:" << first << "Offset:" << offset << "Seek:" << seekKey;
+
+    QByteArray sql = "SELECT id,name FROM rs_owners";
+    if (!m_ownerFilter.isEmpty())
+    {
+        sql.append(" WHERE rs_owners.name LIKE ?3");
+    }
+
+    // Last column is unique so it can be used for keyset pagination
+    const char *sertColExpr = nullptr;
+    switch (sortCol)
+    {
+    case Name:
+    {
+        sertColExpr = "name,id";
+        break;
+    }
+    }
+
+    if (!seekKey.isEmpty())
+    {
+        sql += m_ownerFilter.isEmpty() ? " WHERE " : " AND ";
+        sql += seekCondition(sertColExpr, 4);
+    }
+
+    sql += " ORDER BY ";
+    sql += sertColExpr;
+
+    sql += " LIMIT ?1";
+    if (offset)
+        sql += " OFFSET ?2";
+
+    q.prepare(sql);
+    q.bind(1, BatchSize);
+    if (offset)
+        q.bind(2, offset);
+
+    if (!seekKey.isEmpty())
+        bindSeekKey(q, 4, seekKey);
+
+    if (!m_ownerFilter.isEmpty())
+    {
+        QByteArray ownerFilter;
+        ownerFilter.reserve(m_ownerFilter.size() + 2);
+        ownerFilter.append('%');
+        ownerFilter.append(m_ownerFilter.toUtf8());
+        ownerFilter.append('%');
+        q.bind(1, ownerFilter, sqlite3pp::copy);
+    }
+
+    q.step();
+    const qint64 count = q.getRows().get<qint64>(0);
+    return count;
+}
+
 void RSOwnersSQLModel::internalFetch(int first, int sortCol, int /*valRow*/,
                                      const QVariant & /*val*/)
 {
@@ -405,3 +478,11 @@ void RSOwnersSQLModel::internalFetch(int first, int sortCol, int /*valRow*/,
 
     postResult(vec, first);
 }
+
+QVariantList RSOwnersSQLModel::getSeekKey(const RSOwner &item, int sortCol) const
+{
+    // Empty name might be NULL, do not seek
+    if (sortCol != Name || item.name.isEmpty())
+        return QVariantList();
+    return {item.name, item.ownerId};
+}
@@ -84,6 +84,7 @@ protected:
 private:
     friend BaseClass;
     Q_INVOKABLE void internalFetch(int first, int sortColumn, int valRow, const QVariant &val);
+    QVariantList getSeekKey(const RSOwner &item, int sortCol) const;
 
 private:
     QString m_ownerFilter;
@@ -38,14 +38,12 @@ static constexpr const char *sql_countJobs = "SELECT COUNT(1) FROM jobs"
                                              " WHERE jobs.shift_id=?";
 
 static constexpr const char *sql_getJobs   = "SELECT jobs.id, jobs.category,"
-                                             " MIN(s1.arrival), s1.station_id,"
-                                             " MAX(s2.departure), s2.station_id"
+                                             " js.first_arrival, js.first_station_id,"
+                                             " js.last_departure, js.last_station_id"
                                              " FROM jobs"
-                                             " JOIN stops s1 ON s1.job_id=jobs.id"
-                                             " JOIN stops s2 ON s2.job_id=jobs.id"
+                                             " JOIN job_summary js ON js.job_id=jobs.id"
                                              " WHERE jobs.shift_id=?"
-                                             " GROUP BY jobs.id"
-                                             " ORDER BY s1.arrival ASC";
+                                             " ORDER BY js.first_arrival ASC";
 
 ShiftGraphScene::ShiftGraphScene(sqlite3pp::database &db, QObject *parent) :
     IGraphScene(parent),
@@ -95,17 +95,15 @@ void ShiftJobsModel::loadShiftJobs(db_id shiftId)
     m_data.clear();
 
     query q(mDb, "SELECT jobs.id, jobs.category,"
-                 " MIN(s1.arrival), s1.station_id,"
-                 " MAX(s2.departure), s2.station_id,"
+                 " js.first_arrival, js.first_station_id,"
+                 " js.last_departure, js.last_station_id,"
                  " st1.name,st2.name"
                  " FROM jobs"
-                 " JOIN stops s1 ON s1.job_id=jobs.id"
-                 " JOIN stops s2 ON s2.job_id=jobs.id"
-                 " JOIN stations st1 ON st1.id=s1.station_id"
-                 " JOIN stations st2 ON st2.id=s2.station_id"
+                 " JOIN job_summary js ON js.job_id=jobs.id"
+                 " JOIN stations st1 ON st1.id=js.first_station_id"
+                 " JOIN stations st2 ON st2.id=js.last_station_id"
                  " WHERE jobs.shift_id=?"
-                 " GROUP BY jobs.id"
-                 " ORDER BY s1.arrival ASC");
+                 " ORDER BY js.first_arrival ASC");
 
     q.bind(1, shiftId);
 
@@ -29,8 +29,6 @@
 
 #include <QVBoxLayout>
 
-#include <QFileDialog>
-#include "utils/files/recentdirstore.h"
 #include <QMessageBox>
 #include <QInputDialog>
 #include "utils/owningqpointer.h"
@@ -43,7 +41,7 @@
 #include "odt_export/shiftsheetexport.h"
 #include "utils/files/openfileinfolder.h"
 
-#include "utils/files/file_format_names.h"
+#include "odt_export/common/sheetfiledialog.h"
 
 ShiftManager::ShiftManager(QWidget *parent) :
     QWidget(parent),
@@ -230,28 +228,20 @@ void ShiftManager::onSaveSheet()
     QString shiftName = model->shiftNameAtRow(idx.row());
     qDebug() << "Printing Shift:" << shiftId;
 
-    OwningQPointer<QFileDialog> dlg = new QFileDialog(this, tr("Save Shift Sheet"));
-    dlg->setFileMode(QFileDialog::AnyFile);
-    dlg->setAcceptMode(QFileDialog::AcceptSave);
-    dlg->setDirectory(RecentDirStore::getDir(shiftSheetDirKey, RecentDirStore::Documents));
-    dlg->selectFile(tr("shift_%1.odt").arg(shiftName));
-
-    QStringList filters;
-    filters << FileFormats::tr(FileFormats::odtFormat);
-    dlg->setNameFilters(filters);
-
-    if (dlg->exec() != QDialog::Accepted || !dlg)
-        return;
-
-    QString fileName = dlg->selectedUrls().value(0).toLocalFile();
+    bool asPdf       = false;
+    QString fileName = SheetFileDialog::getSaveFileName(
+      this, tr("Save Shift Sheet"), shiftSheetDirKey, tr("shift_%1.odt").arg(shiftName), asPdf);
     if (fileName.isEmpty())
         return;
 
-    RecentDirStore::setPath(shiftSheetDirKey, fileName);
-
     ShiftSheetExport w(Session->m_Db, shiftId);
     w.write();
-    w.save(fileName);
+    const bool ok = asPdf ? w.savePdf(fileName) : w.save(fileName);
+    if (!ok)
+    {
+        SheetFileDialog::showSaveError(this, fileName);
+        return;
+    }
 
     utils::OpenFileInFolderDlg::askUser(tr("Shift Sheet Saved"), fileName, this);
 }
@@ -148,8 +148,7 @@ bool ShiftsModel::setData(const QModelIndex &idx, const QVariant &value, int rol
             // This row has now changed position so we need to invalidate cache
             // HACK: we emit dataChanged for this index (that doesn't exist anymore)
             // but the view will trigger fetching at same scroll position so it is enough
-            cache.clear();
-            cacheFirstRow = 0;
+            clearCache();
 
             break;
         }
@@ -232,14 +231,17 @@ bool ShiftsModel::setFilterAtCol(int col, const QString &str)
     return true;
 }
 
-void ShiftsModel::internalFetch(int first, int /*sortColumn*/, int /*valRow*/,
-                                const QVariant & /*val*/)
+void ShiftsModel::internalFetch(int first, int /*sortColumn*/, int valRow, const QVariant &val)
 {
     query q(mDb);
 
-    int offset = first;
+    // Seek from key if available, skip only rows between key and first
+    const QVariantList seekKey = val.toList();
+    int offset                 = first;
+    if (!seekKey.isEmpty())
+        offset = first - valRow;
 
-    qDebug() << "Fetching:" << first << "Offset:" << offset;
+    qDebug() << "Fetching:" << first << "Offset:" << offset << "Seek:" << seekKey;
 
     QByteArray sql = "SELECT id,name FROM jobshifts";
 
@@ -248,6 +250,13 @@ void ShiftsModel::internalFetch(int first, int /*sortColumn*/, int /*valRow*/,
         sql.append(" WHERE name LIKE ?3");
     }
 
+    // Name is unique so it can be used for keyset pagination
+    if (!seekKey.isEmpty())
+    {
+        sql += m_nameFilter.isEmpty() ? " WHERE " : " AND ";
+        sql += seekCondition("name", 4);
+    }
+
     sql += " ORDER BY name LIMIT ?1";
 
     if (offset)
@@ -258,6 +267,9 @@ void ShiftsModel::internalFetch(int first, int /*sortColumn*/, int /*valRow*/,
     if (offset)
         q.bind(2, offset);
 
+    if (!seekKey.isEmpty())
+        bindSeekKey(q, 4, seekKey);
+
     QByteArray nameFilter;
     if (!m_nameFilter.isEmpty())
     {
@@ -289,6 +301,11 @@ void ShiftsModel::internalFetch(int first, int /*sortColumn*/, int /*valRow*/,
     postResult(vec, first);
 }
 
+QVariantList ShiftsModel::getSeekKey(const ShiftItem &item, int /*sortCol*/) const
+{
+    return {item.shiftName};
+}
+
 bool ShiftsModel::removeShift(db_id shiftId, const QString &name)
 {
     if (!shiftId)
@@ -107,6 +107,7 @@ protected:
 private:
     friend BaseClass;
     Q_INVOKABLE void internalFetch(int first, int sortColumn, int valRow, const QVariant &val);
+    QVariantList getSeekKey(const ShiftItem &item, int sortCol) const;
     void handleResult(const QList<ShiftItem> items, int firstRow);
 
 private:
@@ -307,7 +307,14 @@ bool StationImportWizard::addStation(db_id sourceStId, const QString &fullName,
     // Copy SVG blob
     copySVGData(sourceStId, destStId);
 
-    stTranaction.commit();
+    if (stTranaction.commit() != SQLITE_OK)
+        return false;
+
+    emit Session->stationAdded(destStId);
+
+    // Railway topology and other views must load new tracks and gates
+    emit Session->stationTrackPlanChanged({destStId});
+
     return true;
 }
 
@@ -220,45 +220,35 @@ void LinesModel::internalFetch(int first, int sortCol, int valRow, const QVarian
 {
     query q(mDb);
 
-    int offset   = first - valRow + curPage * ItemsPerPage;
-    bool reverse = false;
+    // Seek from key if available, skip only rows between key and first
+    const QVariantList seekKey = val.toList();
+    int offset                 = first + curPage * ItemsPerPage;
+    if (!seekKey.isEmpty())
+        offset = first - valRow;
 
-    if (valRow > first)
-    {
-        offset  = 0;
-        reverse = true;
-    }
+    qDebug() << "Fetching:" << first << "Offset:" << offset << "Seek:" << seekKey;
 
-    qDebug() << "Fetching:" << first << "ValRow:" << valRow << val << "Offset:" << offset
-             << "Reverse:" << reverse;
+    QByteArray sql = "SELECT id,name,start_meters FROM lines";
 
-    const char *whereCol = nullptr;
-
-    QByteArray sql       = "SELECT id,name,start_meters FROM lines";
+    // Name is unique so it can be used for keyset pagination
+    const char *sortColExpr = nullptr;
     switch (sortCol)
     {
     case NameCol:
     {
-        whereCol = "name"; // Order by 1 column, no where clause
+        sortColExpr = "name"; // Order by 1 column, seek key has 1 value
         break;
     }
     }
 
-    if (val.isValid())
+    if (!seekKey.isEmpty())
     {
         sql += " WHERE ";
-        sql += whereCol;
-        if (reverse)
-            sql += "<?3";
-        else
-            sql += ">?3";
+        sql += seekCondition(sortColExpr, 3);
     }
 
     sql += " ORDER BY ";
-    sql += whereCol;
-
-    if (reverse)
-        sql += " DESC";
+    sql += sortColExpr;
 
     sql += " LIMIT ?1";
     if (offset)
@@ -269,25 +259,15 @@ void LinesModel::internalFetch(int first, int sortCol, int valRow, const QVarian
     if (offset)
         q.bind(2, offset);
 
-    //    if(val.isValid())
-    //    {
-    //        switch (sortCol)
-    //        {
-    //        case LineNameCol:
-    //        {
-    //            q.bind(3, val.toString());
-    //            break;
-    //        }
-    //        }
-    //    }
+    if (!seekKey.isEmpty())
+        bindSeekKey(q, 3, seekKey);
 
     QList<LineItem> vec(BatchSize);
 
-    auto it             = q.begin();
-    const auto end      = q.end();
+    auto it        = q.begin();
+    const auto end = q.end();
 
-    int i               = reverse ? BatchSize - 1 : 0;
-    const int increment = reverse ? -1 : 1;
+    int i          = 0;
 
     for (; it != end; ++it)
     {
@@ -297,13 +277,18 @@ void LinesModel::internalFetch(int first, int sortCol, int valRow, const QVarian
         item.name        = r.get<QString>(1);
         item.startMeters = r.get<int>(2);
 
-        i += increment;
+        i += 1;
     }
 
-    if (reverse && i > -1)
-        vec.remove(0, i + 1);
-    else if (i < BatchSize)
+    if (i < BatchSize)
         vec.remove(i, BatchSize - i);
 
     postResult(vec, first);
 }
+
+QVariantList LinesModel::getSeekKey(const LineItem &item, int sortCol) const
+{
+    if (sortCol == NameCol)
+        return {item.name};
+    return QVariantList();
+}
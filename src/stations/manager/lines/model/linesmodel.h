@@ -93,6 +93,7 @@ protected:
 private:
     friend BaseClass;
     Q_INVOKABLE void internalFetch(int first, int sortCol, int valRow, const QVariant &val);
+    QVariantList getSeekKey(const LineItem &item, int sortCol) const;
 };
 
 #endif // LINESMODEL_H
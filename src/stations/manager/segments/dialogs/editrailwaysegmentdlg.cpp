@@ -42,6 +42,10 @@
 
 #include "stations/manager/segments/dialogs/editrailwayconnectiondlg.h"
 
+#include "app/session.h"
+#include "viewmanager/viewmanager.h"
+#include "jobs/jobeditor/model/runningtimecalculator.h"
+
 EditRailwaySegmentDlg::EditRailwaySegmentDlg(sqlite3pp::database &db,
                                              RailwaySegmentConnectionsModel *conn,
                                              QWidget *parent) :
@@ -327,6 +331,19 @@ bool EditRailwaySegmentDlg::applyChanges()
     utils::RailwaySegmentInfo info;
     fillSegInfo(info);
 
+    // Check if travel times of jobs on this segment are affected
+    bool travelTimeChanged = false;
+    if (m_segmentId)
+    {
+        utils::RailwaySegmentInfo oldInfo;
+        oldInfo.segmentId = m_segmentId;
+        if (helper->getSegmentInfo(oldInfo))
+        {
+            travelTimeChanged = oldInfo.distanceMeters != info.distanceMeters
+                                || oldInfo.maxSpeedKmH != info.maxSpeedKmH;
+        }
+    }
+
     QString errMsg;
     if (!helper->setSegmentInfo(m_segmentId, m_segmentId == 0, info.segmentName, info.type,
                                 info.distanceMeters, info.maxSpeedKmH, info.from.gateId,
@@ -338,6 +355,37 @@ bool EditRailwaySegmentDlg::applyChanges()
 
     connModel->applyChanges(m_segmentId);
 
+    if (travelTimeChanged)
+    {
+        int ret = QMessageBox::question(
+          this, tr("Recalculate Travel Times"),
+          tr("Segment length or speed has changed.<br>"
+             "Do you want to recalculate travel times of all jobs travelling on this segment?<br>"
+             "NOTE: you will lose manual adjustments to travel times"));
+        if (ret == QMessageBox::Yes)
+        {
+            // Job Editor must not hold stops we are going to recalculate
+            if (!Session->getViewManager()->requestClearJob(true))
+            {
+                // Segment changes are already saved, only skip recalculation
+                QMessageBox::warning(this, tr("Recalculate Travel Times"),
+                                     tr("Job Editor is still open, travel times were not "
+                                        "recalculated."));
+                return true;
+            }
+
+            RunningTimeCalculator calculator(Session->m_Db);
+            int failed = calculator.recalcJobsOnSegment(m_segmentId);
+            if (failed > 0)
+            {
+                QMessageBox::warning(this, tr("Recalculate Travel Times"),
+                                     tr("%1 jobs could not be recalculated because they would end "
+                                        "past midnight.")
+                                       .arg(failed));
+            }
+        }
+    }
+
     return true;
 }
 
@@ -245,78 +245,70 @@ void RailwaySegmentsModel::internalFetch(int first, int sortCol, int valRow, con
 {
     query q(mDb);
 
-    int offset   = first - valRow + curPage * ItemsPerPage;
-    bool reverse = false;
-
-    if (valRow > first)
-    {
-        offset  = 0;
-        reverse = true;
-    }
-
-    qDebug() << "Fetching:" << first << "ValRow:" << valRow << val << "Offset:" << offset
-             << "Reverse:" << reverse;
-
-    const char *whereCol = nullptr;
-
-    QByteArray sql       = "SELECT s.id, s.name, s.max_speed_kmh, s.type, s.distance_meters,"
-                           "g1.station_id, g2.station_id,"
-                           "s.in_gate_id, g1.name, st1.name,"
-                           "s.out_gate_id,g2.name, st2.name"
-                           " FROM railway_segments s"
-                           " JOIN station_gates g1 ON g1.id=s.in_gate_id"
-                           " JOIN station_gates g2 ON g2.id=s.out_gate_id"
-                           " JOIN stations st1 ON st1.id=g1.station_id"
-                           " JOIN stations st2 ON st2.id=g2.station_id";
+    // Seek from key if available, skip only rows between key and first
+    const QVariantList seekKey = val.toList();
+    int offset                 = first + curPage * ItemsPerPage;
+    if (!seekKey.isEmpty())
+        offset = first - valRow;
+
+    qDebug() << "Fetching:" << first << "Offset:" << offset << "Seek:" << seekKey;
+
+    // Last column is unique so it can be used for keyset pagination
+    const char *sortColExpr = nullptr;
+
+    QByteArray sql          = "SELECT s.id, s.name, s.max_speed_kmh, s.type, s.distance_meters,"
+                              "g1.station_id, g2.station_id,"
+                              "s.in_gate_id, g1.name, st1.name,"
+                              "s.out_gate_id,g2.name, st2.name"
+                              " FROM railway_segments s"
+                              " JOIN station_gates g1 ON g1.id=s.in_gate_id"
+                              " JOIN station_gates g2 ON g2.id=s.out_gate_id"
+                              " JOIN stations st1 ON st1.id=g1.station_id"
+                              " JOIN stations st2 ON st2.id=g2.station_id";
     switch (sortCol)
     {
     case NameCol:
     {
-        whereCol = "s.name"; // Order by 1 column, no where clause
+        sortColExpr = "s.name,s.id";
         break;
     }
     case FromStationCol:
     {
-        whereCol = "st1.name";
+        sortColExpr = "st1.name,s.id";
         break;
     }
     case ToStationCol:
     {
-        whereCol = "st2.name";
+        sortColExpr = "st2.name,s.id";
         break;
     }
     case MaxSpeedCol:
     {
-        whereCol = "s.max_speed_kmh";
+        sortColExpr = "s.max_speed_kmh,s.id";
         break;
     }
     case DistanceCol:
     {
-        whereCol = "s.distance_meters";
+        sortColExpr = "s.distance_meters,s.id";
         break;
     }
     }
 
-    if (val.isValid())
+    bool whereClauseAdded = false;
+    if (filterFromStationId)
     {
-        sql += " WHERE ";
-        sql += whereCol;
-        if (reverse)
-            sql += "<?3";
-        else
-            sql += ">?3";
+        sql += " WHERE (g1.station_id=?4 OR g2.station_id=?4)";
+        whereClauseAdded = true;
     }
 
-    if (filterFromStationId)
+    if (!seekKey.isEmpty())
     {
-        sql += " WHERE g1.station_id=?4 OR g2.station_id=?4";
+        sql += whereClauseAdded ? " AND " : " WHERE ";
+        sql += seekCondition(sortColExpr, 5);
     }
 
     sql += " ORDER BY ";
-    sql += whereCol;
-
-    if (reverse)
-        sql += " DESC";
+    sql += sortColExpr;
 
     sql += " LIMIT ?1";
     if (offset)
@@ -330,25 +322,15 @@ void RailwaySegmentsModel::internalFetch(int first, int sortCol, int valRow, con
     if (filterFromStationId)
         q.bind(4, filterFromStationId);
 
-    //    if(val.isValid())
-    //    {
-    //        switch (sortCol)
-    //        {
-    //        case LineNameCol:
-    //        {
-    //            q.bind(3, val.toString());
-    //            break;
-    //        }
-    //        }
-    //    }
+    if (!seekKey.isEmpty())
+        bindSeekKey(q, 5, seekKey);
 
     QList<RailwaySegmentItem> vec(BatchSize);
 
-    auto it             = q.begin();
-    const auto end      = q.end();
+    auto it        = q.begin();
+    const auto end = q.end();
 
-    int i               = reverse ? BatchSize - 1 : 0;
-    const int increment = reverse ? -1 : 1;
+    int i          = 0;
 
     for (; it != end; ++it)
     {
@@ -386,13 +368,39 @@ void RailwaySegmentsModel::internalFetch(int first, int sortCol, int valRow, con
             // item.fromStationName.clear(); //Save some memory???
         }
 
-        i += increment;
+        i += 1;
     }
 
-    if (reverse && i > -1)
-        vec.remove(0, i + 1);
-    else if (i < BatchSize)
+    if (i < BatchSize)
         vec.remove(i, BatchSize - i);
 
     postResult(vec, first);
 }
+
+QVariantList RailwaySegmentsModel::getSeekKey(const RailwaySegmentItem &item, int sortCol) const
+{
+    // Station names are swapped when filtering by station, use original order
+    const QString &inStationName  = item.reversed ? item.toStationName : item.fromStationName;
+    const QString &outStationName = item.reversed ? item.fromStationName : item.toStationName;
+
+    switch (sortCol)
+    {
+    case NameCol:
+    {
+        // Empty name might be NULL, do not seek
+        if (item.segmentName.isEmpty())
+            break;
+        return {item.segmentName, item.segmentId};
+    }
+    case FromStationCol:
+        return {inStationName, item.segmentId};
+    case ToStationCol:
+        return {outStationName, item.segmentId};
+    case MaxSpeedCol:
+        return {item.maxSpeedKmH, item.segmentId};
+    case DistanceCol:
+        return {item.distanceMeters, item.segmentId};
+    }
+
+    return QVariantList();
+}
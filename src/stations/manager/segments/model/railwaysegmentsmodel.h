@@ -117,6 +117,7 @@ protected:
 private:
     friend BaseClass;
     Q_INVOKABLE void internalFetch(int firstRow, int sortCol, int valRow, const QVariant &val);
+    QVariantList getSeekKey(const RailwaySegmentItem &item, int sortCol) const;
 
 private:
     db_id filterFromStationId;
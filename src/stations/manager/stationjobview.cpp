@@ -27,8 +27,6 @@
 #include "app/scopedebug.h"
 
 #include "utils/owningqpointer.h"
-#include <QFileDialog>
-#include "utils/files/recentdirstore.h"
 #include <QMenu>
 
 #include "odt_export/stationsheetexport.h"
@@ -36,7 +34,7 @@
 
 #include "stationplanmodel.h"
 
-#include "utils/files/file_format_names.h"
+#include "odt_export/common/sheetfiledialog.h"
 
 StationJobView::StationJobView(QWidget *parent) :
     QWidget(parent),
@@ -136,29 +134,21 @@ void StationJobView::onSaveSheet()
 
     const QLatin1String station_sheet_key = QLatin1String("station_sheet_dir");
 
-    OwningQPointer<QFileDialog> dlg       = new QFileDialog(this, tr("Save Station Sheet"));
-    dlg->setFileMode(QFileDialog::AnyFile);
-    dlg->setAcceptMode(QFileDialog::AcceptSave);
-    dlg->setDirectory(RecentDirStore::getDir(station_sheet_key, RecentDirStore::Documents));
-    dlg->selectFile(tr("%1_station.odt").arg(windowTitle()));
-
-    QStringList filters;
-    filters << FileFormats::tr(FileFormats::odtFormat);
-    dlg->setNameFilters(filters);
-
-    if (dlg->exec() != QDialog::Accepted || !dlg)
-        return;
-
-    QString fileName = dlg->selectedUrls().value(0).toLocalFile();
-
+    bool asPdf                            = false;
+    QString fileName                      = SheetFileDialog::getSaveFileName(
+      this, tr("Save Station Sheet"), station_sheet_key, tr("%1_station.odt").arg(windowTitle()),
+      asPdf);
     if (fileName.isEmpty())
         return;
 
-    RecentDirStore::setPath(station_sheet_key, fileName);
-
     StationSheetExport sheet(m_stationId);
     sheet.write();
-    sheet.save(fileName);
+    const bool ok = asPdf ? sheet.savePdf(fileName) : sheet.save(fileName);
+    if (!ok)
+    {
+        SheetFileDialog::showSaveError(this, fileName);
+        return;
+    }
 
     utils::OpenFileInFolderDlg::askUser(tr("Station Sheet Saved"), fileName, this);
 }
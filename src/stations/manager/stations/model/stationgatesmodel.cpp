@@ -620,8 +620,7 @@ bool StationGatesModel::setName(StationGatesModel::GateItem &item, const QChar &
     // This row has now changed position so we need to invalidate cache
     // HACK: we emit dataChanged for this index (that doesn't exist anymore)
     // but the view will trigger fetching at same scroll position so it is enough
-    cache.clear();
-    cacheFirstRow = 0;
+    clearCache();
 
     return true;
 }
@@ -649,8 +648,7 @@ bool StationGatesModel::setSide(StationGatesModel::GateItem &item, int val)
         // This row has now changed position so we need to invalidate cache
         // HACK: we emit dataChanged for this index (that doesn't exist anymore)
         // but the view will trigger fetching at same scroll position so it is enough
-        cache.clear();
-        cacheFirstRow = 0;
+        clearCache();
     }
 
     return true;
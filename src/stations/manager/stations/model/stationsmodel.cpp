@@ -226,7 +226,8 @@ qint64 StationsModel::recalcTotalItemCount()
     return count;
 }
 
-void StationsModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData)
+void StationsModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData,
+                               const QVariantList &seekKey)
 {
     QByteArray sql;
     if (fullData)
@@ -252,27 +253,38 @@ void StationsModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, boo
             sql.append(" AND ");
         else
             sql.append(" WHERE ");
-        sql.append("(name LIKE ?4 OR short_name LIKE ?4)");
+        if (Session->hasFullTextIndex())
+            sql.append("id IN (SELECT rowid FROM stations_fts WHERE name LIKE ?4"
+                       " UNION ALL SELECT rowid FROM stations_fts WHERE short_name LIKE ?4)");
+        else
+            sql.append("(name LIKE ?4 OR short_name LIKE ?4)");
+        whereClauseAdded = true;
     }
 
-    if (fullData)
+    // Sorting, name is unique so it can be used for keyset pagination
+    const char *sortColExpr = nullptr;
+    switch (sortCol)
     {
-        // Apply sorting
-        const char *sortColExpr = nullptr;
-        switch (sortCol)
-        {
-        case NameCol:
-        {
-            sortColExpr = "name"; // Order by 1 column, no where clause
-            break;
-        }
-        case TypeCol:
-        {
-            sortColExpr = "type,name";
-            break;
-        }
-        }
+    case NameCol:
+    {
+        sortColExpr = "name"; // Order by 1 column, seek key has 1 value
+        break;
+    }
+    case TypeCol:
+    {
+        sortColExpr = "type,name";
+        break;
+    }
+    }
+
+    if (fullData && !seekKey.isEmpty())
+    {
+        sql += whereClauseAdded ? " AND " : " WHERE ";
+        sql += seekCondition(sortColExpr, 5);
+    }
 
+    if (fullData)
+    {
         sql += " ORDER BY ";
         sql += sortColExpr;
 
@@ -289,6 +301,9 @@ void StationsModel::buildQuery(sqlite3pp::query &q, int sortCol, int offset, boo
         q.bind(1, BatchSize);
         if (offset)
             q.bind(2, offset);
+
+        if (!seekKey.isEmpty())
+            bindSeekKey(q, 5, seekKey);
     }
 
     // Apply filters
@@ -401,6 +416,8 @@ bool StationsModel::addStation(const QString &name, db_id *outStationId)
     if (outStationId)
         *outStationId = stationId;
 
+    emit Session->stationAdded(stationId);
+
     // Clear filters
     m_nameFilter.clear();
     m_nameFilter.squeeze();
@@ -451,15 +468,19 @@ bool StationsModel::removeStation(db_id stationId)
     return true;
 }
 
-void StationsModel::internalFetch(int first, int sortCol, int /*valRow*/, const QVariant & /*val*/)
+void StationsModel::internalFetch(int first, int sortCol, int valRow, const QVariant &val)
 {
     query q(mDb);
 
-    int offset = first + curPage * ItemsPerPage;
+    // Seek from key if available, skip only rows between key and first
+    const QVariantList seekKey = val.toList();
+    int offset                 = first + curPage * ItemsPerPage;
+    if (!seekKey.isEmpty())
+        offset = first - valRow;
 
-    qDebug() << "Fetching:" << first << "Offset:" << offset;
+    qDebug() << "Fetching:" << first << "Offset:" << offset << "Seek:" << seekKey;
 
-    buildQuery(q, sortCol, offset, true);
+    buildQuery(q, sortCol, offset, true, seekKey);
 
     QList<StationItem> vec(BatchSize);
 
@@ -538,8 +559,7 @@ bool StationsModel::setName(StationsModel::StationItem &item, const QString &val
     // This row has now changed position so we need to invalidate cache
     // HACK: we emit dataChanged for this index (that doesn't exist anymore)
     // but the view will trigger fetching at same scroll position so it is enough
-    cache.clear();
-    cacheFirstRow = 0;
+    clearCache();
 
     return true;
 }
@@ -618,8 +638,7 @@ bool StationsModel::setType(StationsModel::StationItem &item, int val)
         // This row has now changed position so we need to invalidate cache
         // HACK: we emit dataChanged for this index (that doesn't exist anymore)
         // but the view will trigger fetching at same scroll position so it is enough
-        cache.clear();
-        cacheFirstRow = 0;
+        clearCache();
     }
 
     return true;
@@ -659,3 +678,16 @@ bool StationsModel::setPhoneNumber(StationsModel::StationItem &item, qint64 val)
 
     return true;
 }
+
+QVariantList StationsModel::getSeekKey(const StationItem &item, int sortCol) const
+{
+    switch (sortCol)
+    {
+    case NameCol:
+        return {item.name};
+    case TypeCol:
+        return {int(item.type), item.name};
+    }
+
+    return QVariantList();
+}
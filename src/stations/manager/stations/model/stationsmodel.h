@@ -113,8 +113,10 @@ protected:
 
 private:
     friend BaseClass;
-    void buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData);
+    void buildQuery(sqlite3pp::query &q, int sortCol, int offset, bool fullData,
+                    const QVariantList &seekKey = QVariantList());
     Q_INVOKABLE void internalFetch(int firstRow, int sortCol, int valRow, const QVariant &val);
+    QVariantList getSeekKey(const StationItem &item, int sortCol) const;
 
     bool setName(StationItem &item, const QString &val);
     bool setShortName(StationItem &item, const QString &val);
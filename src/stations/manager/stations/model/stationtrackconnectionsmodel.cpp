@@ -626,8 +626,7 @@ bool StationTrackConnectionsModel::setTrackSide(StationTrackConnectionsModel::Tr
     // This row has now changed position so we need to invalidate cache
     // HACK: we emit dataChanged for this index (that doesn't exist anymore)
     // but the view will trigger fetching at same scroll position so it is enough
-    cache.clear();
-    cacheFirstRow = 0;
+    clearCache();
 
     return true;
 }
@@ -653,8 +652,7 @@ bool StationTrackConnectionsModel::setGateTrack(StationTrackConnectionsModel::Tr
     // This row has now changed position so we need to invalidate cache
     // HACK: we emit dataChanged for this index (that doesn't exist anymore)
     // but the view will trigger fetching at same scroll position so it is enough
-    cache.clear();
-    cacheFirstRow = 0;
+    clearCache();
 
     return true;
 }
@@ -687,8 +685,7 @@ bool StationTrackConnectionsModel::setTrack(StationTrackConnectionsModel::TrackC
     // This row has now changed position so we need to invalidate cache
     // HACK: we emit dataChanged for this index (that doesn't exist anymore)
     // but the view will trigger fetching at same scroll position so it is enough
-    cache.clear();
-    cacheFirstRow = 0;
+    clearCache();
 
     return true;
 }
@@ -721,8 +718,7 @@ bool StationTrackConnectionsModel::setGate(StationTrackConnectionsModel::TrackCo
     // This row has now changed position so we need to invalidate cache
     // HACK: we emit dataChanged for this index (that doesn't exist anymore)
     // but the view will trigger fetching at same scroll position so it is enough
-    cache.clear();
-    cacheFirstRow = 0;
+    clearCache();
 
     return true;
 }
@@ -512,48 +512,39 @@ void StationTracksModel::internalFetch(int first, int sortCol, int valRow, const
 {
     query q(mDb);
 
-    int offset   = first - valRow + curPage * ItemsPerPage;
-    bool reverse = false;
+    // Seek from key if available, skip only rows between key and first
+    const QVariantList seekKey = val.toList();
+    int offset                 = first + curPage * ItemsPerPage;
+    if (!seekKey.isEmpty())
+        offset = first - valRow;
 
-    if (valRow > first)
-    {
-        offset  = 0;
-        reverse = true;
-    }
-
-    qDebug() << "Fetching:" << first << "ValRow:" << valRow << val << "Offset:" << offset
-             << "Reverse:" << reverse;
+    qDebug() << "Fetching:" << first << "Offset:" << offset << "Seek:" << seekKey;
 
-    const char *whereCol = nullptr;
+    QByteArray sql = "SELECT id, type, track_length_cm, platf_length_cm, freight_length_cm,"
+                     "max_axes, color_rgb, name, pos FROM station_tracks";
 
-    QByteArray sql       = "SELECT id, type, track_length_cm, platf_length_cm, freight_length_cm,"
-                           "max_axes, color_rgb, name FROM station_tracks";
+    // Position is unique in a station so it can be used for keyset pagination
+    const char *sortColExpr = nullptr;
     switch (sortCol)
     {
     case PosCol:
     default:
     {
-        whereCol = "pos"; // Order by 1 column, no where clause
+        sortColExpr = "pos"; // Order by 1 column, seek key has 1 value
         break;
     }
     }
 
-    //    if(val.isValid())
-    //    {
-    //        sql += " WHERE ";
-    //        sql += whereCol;
-    //        if(reverse)
-    //            sql += "<?3";
-    //        else
-    //            sql += ">?3";
-    //    }
     sql += " WHERE station_id=?4";
 
-    sql += " ORDER BY ";
-    sql += whereCol;
+    if (!seekKey.isEmpty())
+    {
+        sql += " AND ";
+        sql += seekCondition(sortColExpr, 5);
+    }
 
-    if (reverse)
-        sql += " DESC";
+    sql += " ORDER BY ";
+    sql += sortColExpr;
 
     sql += " LIMIT ?1";
     if (offset)
@@ -566,17 +557,8 @@ void StationTracksModel::internalFetch(int first, int sortCol, int valRow, const
 
     q.bind(4, m_stationId);
 
-    //    if(val.isValid())
-    //    {
-    //        switch (sortCol)
-    //        {
-    //        case LineNameCol:
-    //        {
-    //            q.bind(3, val.toString());
-    //            break;
-    //        }
-    //        }
-    //    }
+    if (!seekKey.isEmpty())
+        bindSeekKey(q, 5, seekKey);
 
     QList<TrackItem> vec(BatchSize);
 
@@ -585,8 +567,7 @@ void StationTracksModel::internalFetch(int first, int sortCol, int valRow, const
 
     const QRgb whiteColor = qRgb(255, 255, 255);
 
-    int i                 = reverse ? BatchSize - 1 : 0;
-    const int increment   = reverse ? -1 : 1;
+    int i                 = 0;
 
     for (; it != end; ++it)
     {
@@ -603,18 +584,23 @@ void StationTracksModel::internalFetch(int first, int sortCol, int valRow, const
         else
             item.color = QRgb(r.get<int>(6));
         item.name = r.get<QString>(7);
+        item.pos  = r.get<int>(8);
 
-        i += increment;
+        i += 1;
     }
 
-    if (reverse && i > -1)
-        vec.remove(0, i + 1);
-    else if (i < BatchSize)
+    if (i < BatchSize)
         vec.remove(i, BatchSize - i);
 
     postResult(vec, first);
 }
 
+QVariantList StationTracksModel::getSeekKey(const TrackItem &item, int sortCol) const
+{
+    Q_UNUSED(sortCol)
+    return {item.pos}; // Always sorted by position
+}
+
 bool StationTracksModel::setName(StationTracksModel::TrackItem &item, const QString &name)
 {
     // TODO: check non valid characters
@@ -644,8 +630,7 @@ bool StationTracksModel::setName(StationTracksModel::TrackItem &item, const QStr
         // This row has now changed position so we need to invalidate cache
         // HACK: we emit dataChanged for this index (that doesn't exist anymore)
         // but the view will trigger fetching at same scroll position so it is enough
-        cache.clear();
-        cacheFirstRow = 0;
+        clearCache();
     }
 
     return true;
@@ -38,6 +38,7 @@ struct StationTracksModelItem
     QString name;
     QRgb color;
     QFlags<utils::StationTrackType> type;
+    int pos;
 };
 
 class StationTracksModel : public IPagedItemModelImpl<StationTracksModel, StationTracksModelItem>
@@ -144,6 +145,7 @@ protected:
 private:
     friend BaseClass;
     Q_INVOKABLE void internalFetch(int first, int sortCol, int valRow, const QVariant &val);
+    QVariantList getSeekKey(const TrackItem &item, int sortCol) const;
 
     bool setName(TrackItem &item, const QString &name);
     bool setType(TrackItem &item, QFlags<utils::StationTrackType> type);
@@ -19,6 +19,9 @@
 
 #include "stationsmatchmodel.h"
 
+#include "app/session.h"
+#include "utils/delegates/sql/completionindex.h"
+
 StationsMatchModel::StationsMatchModel(database &db, QObject *parent) :
     ISqlFKMatchModel(parent),
     mDb(db),
@@ -62,6 +65,7 @@ QVariant StationsMatchModel::data(const QModelIndex &idx, int role) const
 
 void StationsMatchModel::autoSuggest(const QString &text)
 {
+    mText = text;
     mQuery.clear();
     if (!text.isEmpty())
     {
@@ -80,6 +84,33 @@ void StationsMatchModel::refreshData()
     if (!mDb.db())
         return;
 
+    if (&mDb == &Session->m_Db)
+    {
+        // Use session cache instead of querying database on every keystroke
+        QVector<CompletionIndex::Entry> matches;
+        if (Session->getCompletionIndex()->findMatches(CompletionIndex::Stations, mText,
+                                                       MaxMatchItems, m_exceptStId, matches))
+        {
+            beginResetModel();
+
+            const int count = qMin(int(matches.size()), MaxMatchItems);
+            for (int i = 0; i < count; i++)
+            {
+                items[i].stationId = matches.at(i).id;
+                items[i].name      = matches.at(i).name;
+            }
+
+            size = count + 1; // Items + Empty
+            if (matches.size() > MaxMatchItems)
+                size++; // Items + Empty + Ellispses
+
+            endResetModel();
+
+            emit resultsReady(false);
+            return;
+        }
+    }
+
     beginResetModel();
 
     char emptyQuery = '%';
@@ -146,8 +177,13 @@ void StationsMatchModel::setFilter(db_id exceptStId)
     if (m_exceptStId)
         sql.append("stations.id<>?2 AND ");
 
-    sql.append("(stations.name LIKE ?1 OR stations.short_name LIKE ?1) LIMIT " QT_STRINGIFY(
-      MaxMatchItems + 1));
+    if (Session->hasFullTextIndex())
+        sql.append("stations.id IN (SELECT rowid FROM stations_fts WHERE name LIKE ?1"
+                   " UNION ALL SELECT rowid FROM stations_fts WHERE short_name LIKE ?1)");
+    else
+        sql.append("(stations.name LIKE ?1 OR stations.short_name LIKE ?1)");
+
+    sql.append(" LIMIT " QT_STRINGIFY(MaxMatchItems + 1));
 
     q_getMatches.prepare(sql.constData());
 }
@@ -62,6 +62,7 @@ private:
 
     db_id m_exceptStId;
 
+    QString mText;
     QByteArray mQuery;
 };
 
@@ -0,0 +1,357 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "railwaytopology.h"
+
+#include "app/session.h"
+
+#include <sqlite3pp/sqlite3pp.h>
+using namespace sqlite3pp;
+
+#include <QDebug>
+
+#include <algorithm>
+#include <queue>
+
+// Return reference to list stored in graph so callers can keep pointers to its items
+template <typename T>
+static const QVector<T> &findList(const QHash<db_id, QVector<T>> &hash, db_id key)
+{
+    static const QVector<T> emptyList;
+
+    auto it = hash.constFind(key);
+    if (it == hash.constEnd())
+        return emptyList;
+    return it.value();
+}
+
+const RailwayTopology::Track *RailwayTopology::Graph::getTrack(db_id trackId) const
+{
+    auto it = tracks.constFind(trackId);
+    if (it == tracks.constEnd())
+        return nullptr;
+    return &it.value();
+}
+
+const RailwayTopology::Segment *RailwayTopology::Graph::getSegment(db_id segmentId) const
+{
+    auto it = segments.constFind(segmentId);
+    if (it == segments.constEnd())
+        return nullptr;
+    return &it.value();
+}
+
+const QVector<db_id> &RailwayTopology::Graph::getStationTracks(db_id stationId) const
+{
+    return findList(stationTracks, stationId);
+}
+
+const QVector<RailwayTopology::GateConnection> &
+RailwayTopology::Graph::getTrackConnections(db_id trackId) const
+{
+    return findList(trackConns, trackId);
+}
+
+const QVector<RailwayTopology::GateConnection> &
+RailwayTopology::Graph::getGateConnections(db_id gateId) const
+{
+    return findList(gateConns, gateId);
+}
+
+const QVector<db_id> &RailwayTopology::Graph::getStationSegments(db_id stationId) const
+{
+    return findList(stationSegments, stationId);
+}
+
+const RailwayTopology::GateConnection *
+RailwayTopology::Graph::findGateConnection(db_id gateId, int gateTrack, db_id trackId) const
+{
+    auto it = trackConns.constFind(trackId);
+    if (it == trackConns.constEnd())
+        return nullptr;
+
+    for (const GateConnection &conn : it.value())
+    {
+        if (conn.gateId == gateId && conn.gateTrack == gateTrack)
+            return &conn;
+    }
+
+    return nullptr;
+}
+
+const RailwayTopology::SegmentConnection *
+RailwayTopology::Graph::findSegmentConnection(db_id segmentId, int gateTrack, bool reversed) const
+{
+    auto it = segmentConns.constFind(segmentId);
+    if (it == segmentConns.constEnd())
+        return nullptr;
+
+    for (const SegmentConnection &conn : it.value())
+    {
+        if ((reversed ? conn.outTrack : conn.inTrack) == gateTrack)
+            return &conn;
+    }
+
+    return nullptr;
+}
+
+bool RailwayTopology::Graph::findRoute(db_id fromStationId, db_id fromInGateId,
+                                       db_id toStationId, bool byRunningTime,
+                                       QVector<db_id> &outSegments, db_id *outArrivalGateId) const
+{
+    outSegments.clear();
+
+    struct Entry
+    {
+        double cost;
+        db_id gateId; // Gate from which train leaves station
+        bool arrived; // Segment of gate leads to destination
+
+        bool operator>(const Entry &other) const
+        {
+            return cost > other.cost;
+        }
+    };
+
+    // Min heap on cost
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+    // Key: leaving gate, Value: best cost and previous leaving gate
+    QHash<db_id, double> costs;
+    QHash<db_id, db_id> prevGates;
+
+    for (db_id gateId : getLeavingGates(fromStationId, fromInGateId))
+    {
+        costs.insert(gateId, 0);
+        prevGates.insert(gateId, 0);
+        queue.push({0, gateId, false});
+    }
+
+    while (!queue.empty())
+    {
+        const Entry entry = queue.top();
+        queue.pop();
+
+        if (entry.arrived)
+        {
+            // Cheapest route found, walk back to origin
+            for (db_id gateId = entry.gateId; gateId; gateId = prevGates.value(gateId))
+                outSegments.prepend(gateSegments.value(gateId));
+
+            if (outArrivalGateId)
+            {
+                const Segment *seg = getSegment(outSegments.last());
+                *outArrivalGateId  = seg->inGateId == entry.gateId ? seg->outGateId : seg->inGateId;
+            }
+            return true;
+        }
+
+        if (entry.cost > costs.value(entry.gateId))
+            continue; // Already reached with lower cost
+
+        const Segment *seg = getSegment(gateSegments.value(entry.gateId));
+        if (!seg)
+            continue;
+
+        const bool reversed      = seg->outGateId == entry.gateId;
+        const db_id arrGateId    = reversed ? seg->inGateId : seg->outGateId;
+        const db_id arrStationId = reversed ? seg->inStationId : seg->outStationId;
+
+        double segCost           = seg->distanceMeters;
+        if (byRunningTime)
+            segCost = seg->distanceMeters * 3.6 / qMax(1, seg->maxSpeedKmH); // Seconds
+
+        const double cost = entry.cost + segCost;
+
+        if (arrStationId == toStationId)
+        {
+            queue.push({cost, entry.gateId, true});
+            continue;
+        }
+
+        for (db_id gateId : getLeavingGates(arrStationId, arrGateId))
+        {
+            auto it = costs.find(gateId);
+            if (it != costs.end() && it.value() <= cost)
+                continue;
+
+            costs.insert(gateId, cost);
+            prevGates.insert(gateId, entry.gateId);
+            queue.push({cost, gateId, false});
+        }
+    }
+
+    return false;
+}
+
+QVector<db_id> RailwayTopology::Graph::getLeavingGates(db_id stationId, db_id inGateId) const
+{
+    QVector<db_id> result;
+
+    auto addTrackGates = [this, &result, inGateId](db_id trackId)
+    {
+        for (const GateConnection &conn : getTrackConnections(trackId))
+        {
+            // Do not go back on same segment
+            if (conn.gateId != inGateId && gateSegments.contains(conn.gateId)
+                && !result.contains(conn.gateId))
+                result.append(conn.gateId);
+        }
+    };
+
+    if (inGateId)
+    {
+        for (const GateConnection &conn : getGateConnections(inGateId))
+            addTrackGates(conn.trackId);
+    }
+    else
+    {
+        for (db_id trackId : getStationTracks(stationId))
+            addTrackGates(trackId);
+    }
+
+    return result;
+}
+
+RailwayTopology::RailwayTopology(sqlite3pp::database &db, QObject *parent) :
+    QObject(parent),
+    mDb(db),
+    m_revision(0)
+{
+    connect(Session, &MeetingSession::stationTrackPlanChanged, this,
+            &RailwayTopology::invalidate);
+    connect(Session, &MeetingSession::stationRemoved, this, &RailwayTopology::invalidate);
+
+    connect(Session, &MeetingSession::segmentAdded, this, &RailwayTopology::invalidate);
+    connect(Session, &MeetingSession::segmentStationsChanged, this, &RailwayTopology::invalidate);
+    connect(Session, &MeetingSession::segmentRemoved, this, &RailwayTopology::invalidate);
+}
+
+RailwayTopology::GraphPtr RailwayTopology::getGraph()
+{
+    if (m_graph || !mDb.db())
+        return m_graph;
+
+    std::shared_ptr<Graph> graph = std::make_shared<Graph>();
+    if (!loadGraph(*graph))
+        return m_graph; // Retry on next call
+
+    m_graph = graph;
+    return m_graph;
+}
+
+void RailwayTopology::invalidate()
+{
+    // Snapshots still used by callers stay valid until released
+    m_graph.reset();
+    m_revision++;
+}
+
+bool RailwayTopology::loadGraph(Graph &graph)
+{
+    try
+    {
+        query q(mDb, "SELECT id,station_id,pos FROM station_tracks");
+        for (auto r : q)
+        {
+            Track track;
+            track.trackId   = r.get<db_id>(0);
+            track.stationId = r.get<db_id>(1);
+            track.pos       = r.get<int>(2);
+            graph.tracks.insert(track.trackId, track);
+            graph.stationTracks[track.stationId].append(track.trackId);
+        }
+
+        q.prepare("SELECT id,track_id,gate_id,gate_track,track_side"
+                  " FROM station_gate_connections ORDER BY id");
+        for (auto r : q)
+        {
+            GateConnection conn;
+            conn.connId    = r.get<db_id>(0);
+            conn.trackId   = r.get<db_id>(1);
+            conn.gateId    = r.get<db_id>(2);
+            conn.gateTrack = r.get<int>(3);
+            conn.trackSide = utils::Side(r.get<int>(4));
+            graph.trackConns[conn.trackId].append(conn);
+            graph.gateConns[conn.gateId].append(conn);
+        }
+
+        q.prepare("SELECT s.id,s.in_gate_id,s.out_gate_id,g1.station_id,g2.station_id,"
+                  "s.distance_meters,s.max_speed_kmh"
+                  " FROM railway_segments s"
+                  " JOIN station_gates g1 ON g1.id=s.in_gate_id"
+                  " JOIN station_gates g2 ON g2.id=s.out_gate_id");
+        for (auto r : q)
+        {
+            Segment seg;
+            seg.segmentId      = r.get<db_id>(0);
+            seg.inGateId       = r.get<db_id>(1);
+            seg.outGateId      = r.get<db_id>(2);
+            seg.inStationId    = r.get<db_id>(3);
+            seg.outStationId   = r.get<db_id>(4);
+            seg.distanceMeters = r.get<int>(5);
+            seg.maxSpeedKmH    = r.get<int>(6);
+            graph.segments.insert(seg.segmentId, seg);
+            graph.stationSegments[seg.inStationId].append(seg.segmentId);
+            graph.stationSegments[seg.outStationId].append(seg.segmentId);
+            graph.gateSegments.insert(seg.inGateId, seg.segmentId);
+            graph.gateSegments.insert(seg.outGateId, seg.segmentId);
+        }
+
+        q.prepare("SELECT id,seg_id,in_track,out_track FROM railway_connections");
+        for (auto r : q)
+        {
+            SegmentConnection conn;
+            conn.connId   = r.get<db_id>(0);
+            conn.inTrack  = r.get<int>(2);
+            conn.outTrack = r.get<int>(3);
+            graph.segmentConns[r.get<db_id>(1)].append(conn);
+        }
+    }
+    catch (std::exception &e)
+    {
+        qWarning() << "RailwayTopology: cannot load" << e.what();
+        return false;
+    }
+
+    auto trackPos = [&graph](db_id trackId) -> int
+    {
+        auto it = graph.tracks.constFind(trackId);
+        return it == graph.tracks.constEnd() ? 0 : it.value().pos;
+    };
+
+    for (QVector<db_id> &list : graph.stationTracks)
+    {
+        std::sort(list.begin(), list.end(), [&trackPos](db_id a, db_id b)
+                  { return trackPos(a) < trackPos(b); });
+    }
+
+    for (QVector<GateConnection> &list : graph.gateConns)
+    {
+        std::sort(list.begin(), list.end(),
+                  [&trackPos](const GateConnection &a, const GateConnection &b)
+                  {
+                      if (a.gateTrack != b.gateTrack)
+                          return a.gateTrack < b.gateTrack;
+                      return trackPos(a.trackId) < trackPos(b.trackId);
+                  });
+    }
+
+    return true;
+}
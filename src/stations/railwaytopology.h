@@ -0,0 +1,175 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RAILWAYTOPOLOGY_H
+#define RAILWAYTOPOLOGY_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+
+#include <memory>
+
+#include "stations/station_utils.h"
+
+namespace sqlite3pp {
+class database;
+} // namespace sqlite3pp
+
+/*!
+ * \brief The RailwayTopology class
+ *
+ * Session wide in-memory copy of railway network: station tracks, gates,
+ * gate connections, segments and segment connections.
+ * Loaded on first use and shared as immutable Graph snapshot, so callers
+ * can keep a snapshot during an operation even if a newer revision is loaded.
+ * Snapshot is dropped when stations or segments are changed.
+ *
+ * \sa MeetingSession::getRailwayTopology()
+ */
+class RailwayTopology : public QObject
+{
+    Q_OBJECT
+public:
+    struct Track
+    {
+        db_id trackId   = 0;
+        db_id stationId = 0;
+        int pos         = 0;
+    };
+
+    struct GateConnection
+    {
+        db_id connId          = 0;
+        db_id trackId         = 0;
+        db_id gateId          = 0;
+        int gateTrack         = 0;
+        utils::Side trackSide = utils::Side::West;
+    };
+
+    struct Segment
+    {
+        db_id segmentId    = 0;
+        db_id inGateId     = 0;
+        db_id outGateId    = 0;
+        db_id inStationId  = 0;
+        db_id outStationId = 0;
+        int distanceMeters = 0;
+        int maxSpeedKmH    = 0;
+    };
+
+    struct SegmentConnection
+    {
+        db_id connId = 0;
+        int inTrack  = 0;
+        int outTrack = 0;
+    };
+
+    class Graph
+    {
+    public:
+        const Track *getTrack(db_id trackId) const;
+        const Segment *getSegment(db_id segmentId) const;
+
+        // Sorted by track position
+        const QVector<db_id> &getStationTracks(db_id stationId) const;
+
+        // Sorted by connection ID
+        const QVector<GateConnection> &getTrackConnections(db_id trackId) const;
+
+        // Sorted by gate track and then by track position
+        const QVector<GateConnection> &getGateConnections(db_id gateId) const;
+
+        // Segments starting or ending in station
+        const QVector<db_id> &getStationSegments(db_id stationId) const;
+
+        const GateConnection *findGateConnection(db_id gateId, int gateTrack, db_id trackId) const;
+
+        /*!
+         * \brief findSegmentConnection
+         * \param segmentId the segment
+         * \param gateTrack track of gate from which train enters segment
+         * \param reversed true if train enters from segment out gate
+         * \return connection starting from \a gateTrack or nullptr
+         */
+        const SegmentConnection *findSegmentConnection(db_id segmentId, int gateTrack,
+                                                       bool reversed) const;
+
+        /*!
+         * \brief findRoute
+         * \param fromStationId origin station
+         * \param fromInGateId gate from which train entered origin, 0 to leave from any gate
+         * \param toStationId destination station
+         * \param byRunningTime if true minimize running time at segment speed, otherwise distance
+         * \param outSegments receives segments from origin to destination
+         * \param outArrivalGateId if not null receives gate from which train enters destination
+         * \return true if a route was found
+         *
+         * Shortest path (Dijkstra) over segments. Train can go from a gate to another gate
+         * of same station only if a station track is connected to both gates.
+         */
+        bool findRoute(db_id fromStationId, db_id fromInGateId, db_id toStationId,
+                       bool byRunningTime, QVector<db_id> &outSegments,
+                       db_id *outArrivalGateId = nullptr) const;
+
+    private:
+        friend class RailwayTopology;
+
+        // Gates with a segment which can be reached from station track connected to in gate
+        QVector<db_id> getLeavingGates(db_id stationId, db_id inGateId) const;
+
+        QHash<db_id, Track> tracks;
+        QHash<db_id, Segment> segments;
+
+        QHash<db_id, QVector<db_id>> stationTracks;
+        QHash<db_id, QVector<db_id>> stationSegments;
+        QHash<db_id, QVector<GateConnection>> trackConns;
+        QHash<db_id, QVector<GateConnection>> gateConns;
+        QHash<db_id, QVector<SegmentConnection>> segmentConns;
+
+        // Key: gate ID, Value: segment starting or ending in gate
+        QHash<db_id, db_id> gateSegments;
+    };
+
+    typedef std::shared_ptr<const Graph> GraphPtr;
+
+    RailwayTopology(sqlite3pp::database &db, QObject *parent = nullptr);
+
+    // Load graph if needed
+    GraphPtr getGraph();
+
+    inline int getRevision() const
+    {
+        return m_revision;
+    }
+
+public slots:
+    void invalidate();
+
+private:
+    bool loadGraph(Graph &graph);
+
+private:
+    sqlite3pp::database &mDb;
+
+    GraphPtr m_graph;
+    int m_revision;
+};
+
+#endif // RAILWAYTOPOLOGY_H
@@ -0,0 +1,202 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "completionindex.h"
+
+#include "app/session.h"
+
+#include <sqlite3pp/sqlite3pp.h>
+using namespace sqlite3pp;
+
+#include <QDebug>
+
+#include <algorithm>
+
+CompletionIndex::CompletionIndex(sqlite3pp::database &db, QObject *parent) :
+    QObject(parent),
+    mDb(db)
+{
+    // Drop only index of changed entity, other writes (stops, triggers) keep indexes valid
+    auto invalidateStations = [this]() { invalidate(Stations); };
+    connect(Session, &MeetingSession::stationAdded, this, invalidateStations);
+    connect(Session, &MeetingSession::stationNameChanged, this, invalidateStations);
+    connect(Session, &MeetingSession::stationRemoved, this, invalidateStations);
+
+    connect(Session, &MeetingSession::rollingstockOwnersChanged, this,
+            [this]() { invalidate(RSOwners); });
+    connect(Session, &MeetingSession::rollingstockModelsChanged, this,
+            [this]() { invalidate(RSModels); });
+
+    auto invalidateJobs = [this]() { invalidate(Jobs); };
+    connect(Session, &MeetingSession::jobAdded, this, invalidateJobs);
+    connect(Session, &MeetingSession::jobChanged, this, invalidateJobs);
+    connect(Session, &MeetingSession::jobRemoved, this, invalidateJobs);
+}
+
+bool CompletionIndex::findMatches(EntityType type, const QString &text, int maxCount,
+                                  db_id exceptId, QVector<Entry> &out)
+{
+    out.clear();
+
+    if (type < 0 || type >= NEntityTypes || !mDb.db())
+        return false;
+
+    Index &index = m_indexes[type];
+
+    if (!index.loaded)
+    {
+        if (!loadIndex(type, index))
+            return false; // Retry on next call
+        index.loaded = true;
+    }
+
+    const QString needle = text.toCaseFolded();
+
+    // Stations and models have more keys per entry, add each entry once
+    QVector<bool> added(index.entries.size(), false);
+
+    auto addMatch = [&](const Key &key) -> bool
+    {
+        if (added.at(key.entryIdx))
+            return true;
+        added[key.entryIdx] = true;
+
+        const Entry &entry  = index.entries.at(key.entryIdx);
+        if (entry.id == exceptId)
+            return true;
+
+        out.append(entry);
+        return out.size() <= maxCount; // One extra to tell there are more matches
+    };
+
+    // Prefix matches are contiguous in sorted keys
+    auto it = std::lower_bound(index.keys.cbegin(), index.keys.cend(), needle,
+                               [](const Key &key, const QString &value)
+                               { return key.key < value; });
+    for (; it != index.keys.cend() && it->key.startsWith(needle); it++)
+    {
+        if (!addMatch(*it))
+            return true;
+    }
+
+    // Then other substring matches, like previous LIKE '%text%' queries
+    for (const Key &key : std::as_const(index.keys))
+    {
+        if (key.key.startsWith(needle) || !key.key.contains(needle))
+            continue;
+
+        if (!addMatch(key))
+            return true;
+    }
+
+    return true;
+}
+
+void CompletionIndex::invalidate()
+{
+    for (int type = 0; type < NEntityTypes; type++)
+        invalidate(EntityType(type));
+}
+
+void CompletionIndex::invalidate(EntityType type)
+{
+    Index &index = m_indexes[type];
+    index.entries.clear();
+    index.entries.squeeze();
+    index.keys.clear();
+    index.keys.squeeze();
+    index.loaded = false;
+}
+
+bool CompletionIndex::loadIndex(EntityType type, Index &index)
+{
+    index.entries.clear();
+    index.keys.clear();
+
+    const char *sql = nullptr;
+    switch (type)
+    {
+    case Stations:
+        sql = "SELECT id,name,short_name FROM stations";
+        break;
+    case RSOwners:
+        sql = "SELECT id,name FROM rs_owners";
+        break;
+    case RSModels:
+        sql = "SELECT id,name,suffix FROM rs_models";
+        break;
+    case Jobs:
+        sql = "SELECT id,category FROM jobs";
+        break;
+    default:
+        return false;
+    }
+
+    try
+    {
+        query q(mDb, sql);
+        for (auto r : q)
+        {
+            Entry entry;
+            entry.id = r.get<db_id>(0);
+
+            QString secondKey;
+            switch (type)
+            {
+            case Stations:
+                entry.name = r.get<QString>(1);
+                secondKey  = r.get<QString>(2); // Short name, might be NULL
+                break;
+            case RSOwners:
+                entry.name = r.get<QString>(1);
+                break;
+            case RSModels:
+                entry.name   = r.get<QString>(1);
+                entry.suffix = r.get<QString>(2);
+                secondKey    = entry.suffix;
+                break;
+            case Jobs:
+                entry.name     = QString::number(entry.id);
+                entry.category = JobCategory(r.get<int>(1));
+                break;
+            default:
+                break;
+            }
+
+            const int entryIdx = index.entries.size();
+            index.entries.append(entry);
+
+            index.keys.append({entry.name.toCaseFolded(), entryIdx});
+            if (!secondKey.isEmpty())
+                index.keys.append({secondKey.toCaseFolded(), entryIdx});
+        }
+    }
+    catch (std::exception &e)
+    {
+        qWarning() << "CompletionIndex: cannot load" << e.what();
+        index.entries.clear();
+        index.keys.clear();
+        return false;
+    }
+
+    std::sort(index.keys.begin(), index.keys.end(),
+              [](const Key &a, const Key &b) { return a.key < b.key; });
+
+    return true;
+}
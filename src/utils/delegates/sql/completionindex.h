@@ -0,0 +1,107 @@
+/*
+ * ModelRailroadTimetablePlanner
+ * Copyright 2016-2023, Filippo Gentile
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMPLETIONINDEX_H
+#define COMPLETIONINDEX_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include "utils/types.h"
+
+namespace sqlite3pp {
+class database;
+} // namespace sqlite3pp
+
+/*!
+ * \brief The CompletionIndex class
+ *
+ * Session wide in-memory index of names used by ISqlFKMatchModel completers.
+ * Each entity type is loaded on first use and kept sorted by case folded key,
+ * so prefix matches are found by binary search and other substring matches
+ * by scanning keys in memory, without querying database on every keystroke.
+ *
+ * An index is dropped when MeetingSession signals changes of its entity type
+ * and reloaded on next use, edits of other tables do not affect it.
+ *
+ * \sa MeetingSession::getCompletionIndex()
+ */
+class CompletionIndex : public QObject
+{
+    Q_OBJECT
+public:
+    enum EntityType
+    {
+        Stations = 0, //!< Name and short name
+        RSOwners,     //!< Name
+        RSModels,     //!< Name and suffix
+        Jobs,         //!< Job number
+        NEntityTypes
+    };
+
+    struct Entry
+    {
+        db_id id = 0;
+        QString name;
+        QString suffix;
+        JobCategory category = JobCategory::FREIGHT;
+    };
+
+    CompletionIndex(sqlite3pp::database &db, QObject *parent = nullptr);
+
+    /*!
+     * \brief findMatches
+     * \param type entity to search
+     * \param text text to find, case insensitive, empty matches all entries
+     * \param maxCount maximum number of matches
+     * \param exceptId entry to skip or 0
+     * \param out receives up to \a maxCount + 1 matches, prefix matches first
+     * \return false if index could not be loaded, callers should then query database
+     *
+     * Extra match tells callers there are more results than \a maxCount
+     */
+    bool findMatches(EntityType type, const QString &text, int maxCount, db_id exceptId,
+                     QVector<Entry> &out);
+
+    void invalidate();
+    void invalidate(EntityType type);
+
+private:
+    struct Key
+    {
+        QString key;
+        int entryIdx;
+    };
+
+    struct Index
+    {
+        QVector<Entry> entries;
+        QVector<Key> keys; // Sorted by key
+        bool loaded = false;
+    };
+
+    bool loadIndex(EntityType type, Index &index);
+
+private:
+    sqlite3pp::database &mDb;
+    Index m_indexes[NEntityTypes];
+};
+
+#endif // COMPLETIONINDEX_H
@@ -141,3 +141,44 @@ qint64 IPagedItemModel::recalcTotalItemCount()
     // NOTE: either override this or refreshData()
     return 0; // Default implementation
 }
+
+QByteArray IPagedItemModel::seekCondition(const char *sortExpr, int firstParam)
+{
+    const QByteArray expr = sortExpr;
+    const int count       = expr.count(',') + 1;
+
+    QByteArray sql        = "(" + expr + ")>(";
+    for (int i = 0; i < count; i++)
+    {
+        if (i)
+            sql += ',';
+        sql += '?';
+        sql += QByteArray::number(firstParam + i);
+    }
+    sql += ')';
+    return sql;
+}
+
+void IPagedItemModel::bindSeekKey(sqlite3pp::query &q, int firstParam, const QVariantList &key)
+{
+    for (int i = 0; i < key.size(); i++)
+    {
+        const QVariant &v = key.at(i);
+        const int idx     = firstParam + i;
+        switch (v.typeId())
+        {
+        case QMetaType::QString:
+            q.bind(idx, v.toString());
+            break;
+        case QMetaType::QTime:
+            q.bind(idx, v.toTime());
+            break;
+        case QMetaType::Double:
+            q.bind(idx, v.toDouble());
+            break;
+        default:
+            q.bind(idx, v.toLongLong());
+            break;
+        }
+    }
+}
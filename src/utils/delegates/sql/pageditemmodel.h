@@ -26,7 +26,8 @@
 
 namespace sqlite3pp {
 class database;
-}
+class query;
+} // namespace sqlite3pp
 
 /*!
  * \brief The IPagedItemModel class
@@ -135,6 +136,27 @@ public:
 protected:
     virtual qint64 recalcTotalItemCount();
 
+    /*!
+     * \brief seekCondition
+     * \param sortExpr comma separated sort columns, all in ascending order
+     * \param firstParam index of first parameter
+     * \return condition to select rows after the seek key
+     *
+     * Keyset pagination: instead of skipping rows with OFFSET,
+     * rows are selected after the sort key of the last row of previous batch.
+     * Sort expression must give a total order, so last column must be unique.
+     *
+     * \sa bindSeekKey()
+     */
+    static QByteArray seekCondition(const char *sortExpr, int firstParam);
+
+    /*!
+     * \brief bindSeekKey
+     *
+     * Bind values of a seek key to parameters generated by \ref seekCondition()
+     */
+    static void bindSeekKey(sqlite3pp::query &q, int firstParam, const QVariantList &key);
+
 protected:
     sqlite3pp::database &mDb;
     qint64 totalItemsCount;
@@ -22,7 +22,11 @@
 
 #include "pageditemmodel.h"
 
+#include "utils/worker_event_types.h"
+
 #include <QEvent>
+#include <QMap>
+#include <QVariant>
 
 /*!
  * \brief IPagedItemModelImpl common implementation
@@ -31,6 +35,10 @@
  *
  * SuperType is the model inheriting this class
  * ModelItemType is the item to store in cache which represents a signle row
+ *
+ * Fetching is deferred, not threaded: internalFetch() runs on the GUI thread
+ * on next event loop iteration, on the model connection and with current filters.
+ * Batches are kept small and seek from known keys so each query stays short.
  */
 template <typename SuperType, typename ModelItemType>
 class IPagedItemModelImpl : public IPagedItemModel
@@ -51,6 +59,7 @@ public:
 
     // Cached rows management
     virtual void clearCache() override;
+    virtual void refreshData(bool forceUpdate = false) override;
 
 protected:
     typedef QList<ModelItemType> Cache;
@@ -72,6 +81,25 @@ protected:
 
         Cache items;
         int firstRow;
+        int generation;
+    };
+
+    /*!
+     * \brief The FetchEvent class
+     *
+     * This event is posted to start fetching pending batch on next event loop iteration
+     * so that requesting rows from data() never blocks on database queries
+     */
+    class FetchEvent : public QEvent
+    {
+    public:
+        static constexpr Type _Type = Type(CustomEvents::PagedModelFetch);
+        inline FetchEvent() :
+            QEvent(_Type)
+        {
+        }
+
+        int generation;
     };
 
     bool event(QEvent *e) override;
@@ -81,10 +109,60 @@ protected:
     void postResult(const Cache &items, int firstRow);
     void handleResult(const Cache &items, int firstRow);
 
+private:
+    void startFetch(int batchRow);
+    void runPendingFetch();
+    void fetchNextBatch();
+    void storeSpareRows(int firstRow, const Cache &items);
+
 protected:
+
+    /*!
+     * \brief getSeekKey
+     * \param item the last row of a batch
+     * \param sortCol current sorting column
+     * \return values of sort columns for \a item
+     *
+     * SuperType can hide this to enable keyset pagination.
+     * Return an empty list if \a sortCol cannot be used to seek
+     * and an invalid QVariant for NULL values.
+     * Keys are then passed to internalFetch() as \a val
+     * with \a valRow being the local row following the key row.
+     *
+     * \sa IPagedItemModel::seekCondition()
+     */
+    inline QVariantList getSeekKey(const ModelItemType & /*item*/, int /*sortCol*/) const
+    {
+        return QVariantList();
+    }
+
+protected:
+    // Number of batches to read ahead in scroll direction
+    static constexpr int ReadAheadBatches = 2;
+
+    // Number of batches evicted from cache to keep for scrolling back
+    static constexpr int MaxSpareBatches = 8;
+
     Cache cache;
     int cacheFirstRow;
     int firstPendingRow;
+
+    // Batch requested while another one was pending, -1 if none
+    int queuedRow;
+
+    // Last batch requested by views, read ahead starts from it
+    int lastRequestedRow;
+    int scrollDirection;
+
+    // Incremented when cache is cleared to discard results of previous fetching
+    int cacheGeneration;
+
+    // Recently evicted batches, most recent first
+    QList<std::pair<int, Cache>> spareBatches;
+
+    // Seek keys by absolute row, each key is the one of previous row
+    QMap<int, QVariantList> seekKeys;
+    int seekKeysSortColumn;
 };
 
 #endif // IPAGEDITEMMODELHELPER_H
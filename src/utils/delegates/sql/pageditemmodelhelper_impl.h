@@ -32,7 +32,12 @@ IPagedItemModelImpl<SuperType, ModelItemType>::IPagedItemModelImpl(const int ite
                                                                    QObject *parent) :
     IPagedItemModel(itemsPerPage, db, parent),
     cacheFirstRow(0),
-    firstPendingRow(-BatchSize_)
+    firstPendingRow(-BatchSize_),
+    queuedRow(-1),
+    lastRequestedRow(0),
+    scrollDirection(1),
+    cacheGeneration(0),
+    seekKeysSortColumn(-1)
 {
 }
 
@@ -54,6 +59,24 @@ void IPagedItemModelImpl<SuperType, ModelItemType>::clearCache()
     cache.clear();
     cache.squeeze();
     cacheFirstRow = 0;
+
+    // Discard pending fetching, its results would not be valid anymore
+    firstPendingRow = -BatchSize_;
+    queuedRow       = -1;
+    spareBatches.clear();
+    cacheGeneration++;
+
+    // Rows might have been reordered so keys are not at the same row anymore
+    seekKeys.clear();
+    seekKeysSortColumn = -1;
+}
+
+template <typename SuperType, typename ModelItemType>
+void IPagedItemModelImpl<SuperType, ModelItemType>::refreshData(bool forceUpdate)
+{
+    // Rows might have been added or removed so keys are not at the same row anymore
+    seekKeys.clear();
+    IPagedItemModel::refreshData(forceUpdate);
 }
 
 template <typename SuperType, typename ModelItemType>
@@ -64,7 +87,18 @@ bool IPagedItemModelImpl<SuperType, ModelItemType>::event(QEvent *e)
         ResultEvent *ev = static_cast<ResultEvent *>(e);
         ev->setAccepted(true);
 
-        handleResult(ev->items, ev->firstRow);
+        if (ev->generation == cacheGeneration)
+            handleResult(ev->items, ev->firstRow);
+
+        return true;
+    }
+    else if (e->type() == FetchEvent::_Type)
+    {
+        FetchEvent *ev = static_cast<FetchEvent *>(e);
+        ev->setAccepted(true);
+
+        if (ev->generation == cacheGeneration)
+            runPendingFetch();
 
         return true;
     }
@@ -75,38 +109,152 @@ bool IPagedItemModelImpl<SuperType, ModelItemType>::event(QEvent *e)
 template <typename SuperType, typename ModelItemType>
 void IPagedItemModelImpl<SuperType, ModelItemType>::fetchRow(int row)
 {
-    if (firstPendingRow != -BatchSize_)
-        return; // Currently fetching another batch, wait for it to finish first
+    if (row >= cacheFirstRow && row < cacheFirstRow + cache.size())
+        return; // Already cached
 
-    if (row >= firstPendingRow && row < firstPendingRow + BatchSize_)
+    const int batchRow = row - row % BatchSize_;
+    qDebug() << "Requested:" << row << "From:" << batchRow;
+
+    // Remember scroll direction to read ahead following batches
+    scrollDirection  = batchRow < lastRequestedRow ? -1 : 1;
+    lastRequestedRow = batchRow;
+
+    if (batchRow == firstPendingRow)
         return; // Already fetching this batch
 
-    if (row >= cacheFirstRow && row < cacheFirstRow + cache.size())
-        return; // Already cached
+    if (firstPendingRow != -BatchSize_)
+    {
+        // Currently fetching another batch, fetch this one when it finishes
+        queuedRow = batchRow;
+        return;
+    }
 
-    // TODO: abort previous fetching here
+    startFetch(batchRow);
+}
+
+template <typename SuperType, typename ModelItemType>
+void IPagedItemModelImpl<SuperType, ModelItemType>::startFetch(int batchRow)
+{
+    firstPendingRow = batchRow;
 
-    const int remainder = row % BatchSize_;
-    firstPendingRow     = row - remainder;
-    qDebug() << "Requested:" << row << "From:" << firstPendingRow;
+    // Reuse recently evicted batch without querying database
+    for (int i = 0; i < spareBatches.size(); i++)
+    {
+        if (spareBatches.at(i).first == batchRow)
+        {
+            postResult(spareBatches.takeAt(i).second, batchRow);
+            return;
+        }
+    }
+
+    // Do not query database inside data(), fetch on next event loop iteration
+    FetchEvent *ev = new FetchEvent;
+    ev->generation = cacheGeneration;
+    qApp->postEvent(this, ev);
+}
+
+template <typename SuperType, typename ModelItemType>
+void IPagedItemModelImpl<SuperType, ModelItemType>::runPendingFetch()
+{
+    if (firstPendingRow == -BatchSize_)
+        return; // Cache was cleared in the meantime
+
+    if (seekKeysSortColumn != sortColumn)
+    {
+        seekKeys.clear();
+        seekKeysSortColumn = sortColumn;
+    }
 
+    // Seek from nearest known key before requested batch instead of skipping all previous rows
     QVariant val;
-    int valRow = 0;
+    int valRow         = 0;
+
+    const int pageBase = curPage * IPagedItemModel::ItemsPerPage;
+    auto key           = seekKeys.upperBound(pageBase + firstPendingRow);
+    if (key != seekKeys.begin())
+    {
+        --key;
+        valRow = key.key() - pageBase;
+        val    = key.value();
+    }
 
-    // TODO: use a custom QRunnable
-    //     QMetaObject::invokeMethod(this, "internalFetch", Qt::QueuedConnection,
-    //                               Q_ARG(int, firstPendingRow), Q_ARG(int, sortCol),
-    //                               Q_ARG(int, valRow), Q_ARG(QVariant, val));
     SuperType *self = static_cast<SuperType *>(this);
     self->internalFetch(firstPendingRow, sortColumn, val.isNull() ? 0 : valRow, val);
 }
 
+template <typename SuperType, typename ModelItemType>
+void IPagedItemModelImpl<SuperType, ModelItemType>::fetchNextBatch()
+{
+    if (firstPendingRow != -BatchSize_)
+        return; // Views already requested another batch
+
+    if (queuedRow != -1)
+    {
+        const int row = queuedRow;
+        queuedRow     = -1;
+        if (row < cacheFirstRow || row >= cacheFirstRow + cache.size())
+        {
+            startFetch(row);
+            return;
+        }
+    }
+
+    if (lastRequestedRow < cacheFirstRow || lastRequestedRow >= cacheFirstRow + cache.size())
+        return; // Requested batch is not cached, do not read ahead from a stale position
+
+    // Read ahead next batch in scroll direction so it's ready before views reach it
+    const int nextRow =
+      scrollDirection > 0 ? cacheFirstRow + cache.size() : cacheFirstRow - BatchSize_;
+    if (nextRow < 0 || nextRow >= curItemCount)
+        return;
+
+    // Do not go too far and do not evict the batch requested by views
+    const int distance = qAbs(nextRow - lastRequestedRow);
+    if (distance > ReadAheadBatches * BatchSize_
+        || distance + BatchSize_ > IPagedItemModel::ItemsPerPage)
+        return;
+
+    qDebug() << "Read ahead:" << nextRow;
+    startFetch(nextRow);
+}
+
+template <typename SuperType, typename ModelItemType>
+void IPagedItemModelImpl<SuperType, ModelItemType>::storeSpareRows(int firstRow,
+                                                                   const Cache &items)
+{
+    for (int i = 0; i < items.size();)
+    {
+        const int row = firstRow + i;
+        const int n   = qMin(BatchSize_ - row % BatchSize_, int(items.size()) - i);
+
+        // Store only whole batches, partial ones will be fetched again
+        if (row % BatchSize_ == 0 && (n == BatchSize_ || row + n >= curItemCount))
+        {
+            for (int j = 0; j < spareBatches.size(); j++)
+            {
+                if (spareBatches.at(j).first == row)
+                {
+                    spareBatches.removeAt(j);
+                    break;
+                }
+            }
+            spareBatches.prepend({row, items.mid(i, n)});
+        }
+
+        i += n;
+    }
+
+    while (spareBatches.size() > MaxSpareBatches)
+        spareBatches.removeLast();
+}
+
 template <typename SuperType, typename ModelItemType>
 void IPagedItemModelImpl<SuperType, ModelItemType>::postResult(const Cache &items, int firstRow)
 {
     ResultEvent *ev = new ResultEvent;
     ev->items       = items;
     ev->firstRow    = firstRow;
+    ev->generation  = cacheGeneration;
 
     qApp->postEvent(this, ev);
 }
@@ -116,6 +264,24 @@ void IPagedItemModelImpl<SuperType, ModelItemType>::handleResult(const Cache &it
 {
     Cache itemsCopy = items;
 
+    // Store key of last row so next batch can seek from it
+    if (!items.isEmpty() && seekKeysSortColumn == sortColumn
+        && (items.size() == BatchSize_ || firstRow + items.size() >= curItemCount))
+    {
+        const SuperType *self  = static_cast<const SuperType *>(this);
+        const QVariantList key = self->getSeekKey(items.last(), sortColumn);
+
+        bool isValid           = !key.isEmpty();
+        for (const QVariant &v : key)
+        {
+            if (!v.isValid())
+                isValid = false; // NULL values cannot be compared
+        }
+
+        if (isValid)
+            seekKeys.insert(curPage * IPagedItemModel::ItemsPerPage + firstRow + items.size(), key);
+    }
+
     int lastRow =
       firstRow + itemsCopy.count(); // Last row + 1 extra to re-trigger possible next batch
     if (lastRow >= curItemCount)
@@ -153,6 +319,7 @@ void IPagedItemModelImpl<SuperType, ModelItemType>::handleResult(const Cache &it
             const int remainder = extra % BatchSize_;
             const int n         = remainder ? extra + BatchSize_ - remainder : extra;
             qDebug() << "RES: removing last" << n;
+            storeSpareRows(cacheFirstRow, cache.mid(0, n));
             cache.remove(0, n);
             cacheFirstRow += n;
         }
@@ -168,6 +335,8 @@ void IPagedItemModelImpl<SuperType, ModelItemType>::handleResult(const Cache &it
             if (cache.size() > IPagedItemModel::ItemsPerPage)
             {
                 const int n = cache.size() - IPagedItemModel::ItemsPerPage;
+                storeSpareRows(firstRow + IPagedItemModel::ItemsPerPage,
+                               cache.mid(IPagedItemModel::ItemsPerPage, n));
                 cache.remove(IPagedItemModel::ItemsPerPage, n);
                 qDebug() << "RES: removing first" << n;
             }
@@ -175,6 +344,7 @@ void IPagedItemModelImpl<SuperType, ModelItemType>::handleResult(const Cache &it
         else
         {
             qDebug() << "RES: replacing";
+            storeSpareRows(cacheFirstRow, cache);
             cache = itemsCopy;
         }
         cacheFirstRow = firstRow;
@@ -192,6 +362,8 @@ void IPagedItemModelImpl<SuperType, ModelItemType>::handleResult(const Cache &it
     emit itemsReady(firstRow, lastRow);
 
     qDebug() << "TOTAL: From:" << cacheFirstRow << "To:" << cacheFirstRow + cache.size() - 1;
+
+    fetchNextBatch();
 }
 
 #endif // IPAGEDITEMMODELHELPER_IMPL_H
@@ -32,6 +32,8 @@ public:
     static constexpr const char *allFiles = QT_TRANSLATE_NOOP("FileFormats", "All Files (*.*)");
     static constexpr const char *odsFormat =
       QT_TRANSLATE_NOOP("FileFormats", "OpenDocument Sheet (*.ods)");
+    static constexpr const char *csvFormat =
+      QT_TRANSLATE_NOOP("FileFormats", "Comma/Tab Separated Values (*.csv *.tsv *.txt)");
     static constexpr const char *odtFormat =
       QT_TRANSLATE_NOOP("FileFormats", "OpenDocument Text (*.odt)");
     static constexpr const char *tttFormat =
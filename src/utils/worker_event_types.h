@@ -49,6 +49,9 @@ enum class CustomEvents
     RsOwnersModelResult,
     RsOnDemandListModelResult,
 
+    // Paged models
+    PagedModelFetch,
+
     // Shift
     ShiftWorkerResult,
 
@@ -26,16 +26,12 @@
 #include <QToolBar>
 #include <QComboBox>
 
-#include <QFileDialog>
-#include "utils/files/recentdirstore.h"
-#include "utils/owningqpointer.h"
-
 #include "app/session.h"
 
 #include "odt_export/sessionrsexport.h"
 #include "utils/files/openfileinfolder.h"
 
-#include "utils/files/file_format_names.h"
+#include "odt_export/common/sheetfiledialog.h"
 
 #include <QDebug>
 
@@ -102,27 +98,20 @@ void SessionStartEndRSViewer::exportSheet()
 {
     const QLatin1String session_rs_key = QLatin1String("session_rs_dir");
 
-    OwningQPointer<QFileDialog> dlg    = new QFileDialog(this, tr("Expoert RS session plan"));
-    dlg->setFileMode(QFileDialog::AnyFile);
-    dlg->setAcceptMode(QFileDialog::AcceptSave);
-    dlg->setDirectory(RecentDirStore::getDir(session_rs_key, RecentDirStore::Documents));
-
-    QStringList filters;
-    filters << FileFormats::tr(FileFormats::odtFormat);
-    dlg->setNameFilters(filters);
-
-    if (dlg->exec() != QDialog::Accepted || !dlg)
-        return;
-
-    QString fileName = dlg->selectedUrls().value(0).toLocalFile();
+    bool asPdf                         = false;
+    QString fileName                   = SheetFileDialog::getSaveFileName(
+      this, tr("Expoert RS session plan"), session_rs_key, QString(), asPdf);
     if (fileName.isEmpty())
         return;
 
-    RecentDirStore::setPath(session_rs_key, fileName);
-
     SessionRSExport w(model->mode(), model->order());
     w.write();
-    w.save(fileName);
+    const bool ok = asPdf ? w.savePdf(fileName) : w.save(fileName);
+    if (!ok)
+    {
+        SheetFileDialog::showSaveError(this, fileName);
+        return;
+    }
 
     utils::OpenFileInFolderDlg::askUser(tr("Session RS Plan Saved"), fileName, this);
 }
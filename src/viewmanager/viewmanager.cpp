@@ -689,7 +689,7 @@ bool ViewManager::requestJobCreation()
 bool ViewManager::requestClearJob(bool evenIfEditing)
 {
     if (!jobEditor)
-        return false;
+        return true; // No editor, nothing to clear
 
     if (jobEditor->isEdited() && !evenIfEditing)
         return false;